@@ -11,42 +11,51 @@
 #define MAX_LINE 512              // Maximum line length for input/output
 #define MAX_USERS 100             // Maximum number of users in the system
 #define USERNAME_LENGTH 50        // Maximum length for a username
+#define USER_REPORT_SLOTS 256     // Hash slots for the user report's names, a power of two above twice MAX_USERS
 #define PASSWORD_LENGTH 50        // Maximum length for a password
 #define EMAIL_LENGTH 100          // Maximum length for an email
 #define PHONE_LENGTH 20           // Maximum length for a phone number
 #define ADDRESS_LENGTH 200        // Maximum length for an address
 #define MAX_ATTEMPTS 3            // Maximum login attempts before lockout
-#define MAX_BUSES 100             // Maximum number of buses in the system
-#define MAX_SEATS 50              // Maximum number of seats per bus
 #define MAX_BOOKINGS 100           // Maximum bookings per user
-#define SEATS_PER_ROW 4           // Number of seats per row in a bus
-#define SST_RATE 0.06             // Sales and Service Tax (SST) rate (6%)
 #define MAX_LENGTH 256            // General maximum string length
 #define MAX_NOTIFICATIONS 100     // Maximum number of notifications stored
+#define FREE_BUS_SLOT 0           // Bus ID of a deleted slot waiting to be reused (real IDs start at 1)
+#define SEAT_CHANGES_FILE "seat_changes.txt" // Seat changes made since buses.txt and seats.txt were last written
+#define SEAT_CHANGE_CHECKPOINT 50 // Seat changes logged before they are folded into buses.txt and seats.txt
+#define WAITLIST_POLICY WAITLIST_FIFO // Order in which waitlisted parties are offered freed seats
+#define BOOKING_WAITLISTED -1     // bookSeat() result when the customer joined the waitlist instead
+#define PLATE_LENGTH 20           // Maximum length for a bus number plate
+#define CITY_LENGTH 50            // Maximum length for a source or destination
+#define TIME_LENGTH 20            // Maximum length for a departure or arrival time as typed
+
+// Structure to store the booking detail of one bus. It is only read when seats are booked,
+// cancelled or shown, so it is kept apart from the schedule that every listing walks through.
+// The tickets themselves are in ticketIndex.
+struct BusBookings {
+    int reservedSeats[MAX_SEATS];       // Array storing reserved seat numbers
+    int reservedCount;                  // Count of reserved seats
+};
 
 // Structure to store bus reservation details
 struct BusReservation {
     int busID;                        // Unique identifier for each bus
-    char busNumberPlate[20];           // Bus number plate
+    string_id busNumberPlate;          // Bus number plate (interned)
     char date[11];                     // Date of travel (Format: YYYY-MM-DD)
-    char source[50];                   // Starting location
-    char destination[50];               // Destination location
-    char departureTime[20];             // Departure time (Format: HH:MM AM/PM)
-    char arrivalTime[20];               // Arrival time (Format: HH:MM AM/PM)
+    string_id source;                  // Starting location (interned)
+    string_id destination;             // Destination location (interned)
+    int departureDay;                   // Travel date as days since 1970-01-01, parsed from date
+    int departureMinute;                // Departure time as minutes after midnight (shown as HH:MMAM/PM)
+    int arrivalMinute;                  // Arrival time as minutes after midnight
     int totalSeats;                     // Total seats available on the bus
     int availableSeats;                 // Seats available for booking
-    float fare;                         // Ticket price per seat
-    int reservedSeats[MAX_SEATS];       // Array storing reserved seat numbers
-    int reservedCount;                  // Count of reserved seats
-    int bookings[MAX_BOOKINGS][MAX_SEATS];  // 2D array to store seat numbers per booking
-    int ticketNumbers[MAX_BOOKINGS];    // Array to store unique 6-digit ticket numbers
-    int seatCounts[MAX_BOOKINGS];       // Number of seats booked per booking
-    int bookingCount;                   // Total number of bookings made
+    money_t fare;                       // Ticket price per seat, in sen
+    struct BusBookings *detail;         // Booking detail, in busBookings[] at the same slot
     int totalBookings;                  // Total successful bookings
     int totalCancellations;             // Total number of canceled bookings
-    float totalRevenue;                 // Total revenue generated from bookings
-    float lostRevenue;                  // Revenue lost due to cancellations
-    float netRevenue;                   // Net revenue after deductions
+    money_t totalRevenue;               // Total revenue generated from bookings
+    money_t lostRevenue;                // Revenue lost due to cancellations
+    money_t netRevenue;                 // Net revenue after deductions
     int totalBookedSeats;              // Counter for the total number of booked seats
     int totalCanceledSeats;            // Counter for the total number of canceled seats
 };
@@ -60,6 +69,17 @@ struct user {
     char address[ADDRESS_LENGTH];       // User address
 };
 
+// Structure to store the trips of one booking as they are finalized (two for a round trip).
+// It belongs to the command making the booking, so bookings never share state.
+struct BookingTrips {
+    int ticketNumbers[2];               // Ticket number of each trip
+    money_t totalFares[2];              // Amount charged for each trip, with SST
+    int busIndices[2];                  // Bus slot of each trip
+    int seatCounts[2];                  // Seats booked on each trip
+    money_t seatFares[2];               // Price each seat was sold at
+    int *seatNumbers[2];                // Seats booked on each trip, in the request arena
+};
+
 // Array to store user details, with a maximum of MAX_USERS
 struct user users[MAX_USERS];
 int userCount = 1; // Starts with 1 since admin is the first user
@@ -73,6 +93,59 @@ struct user admin = {
     "Admin Address"    // Admin address
 };
 
+// Schedules ordered by departure time, rebuilt whenever buses are loaded, added, moved or removed
+struct DepartureIndex departureIndex;
+
+// Booking detail of every bus slot; buses[i].detail points to busBookings[i]
+struct BusBookings busBookings[MAX_BUSES];
+
+// Slots of deleted buses, reused before the bus list grows so no bus ever has to move
+int freeBusSlots[MAX_BUSES];
+int freeBusSlotCount = 0;
+
+// Slots whose seats changed since they were last written; a booking saves only these
+int dirtyBusSlots[MAX_BUSES];
+int dirtyBusSlotCount = 0;
+int busSlotDirty[MAX_BUSES];
+int pendingSeatChanges = 0; // Lines in seat_changes.txt not yet folded into buses.txt and seats.txt
+
+// Per-seat price of every bus slot from the load factor and days to departure. Prices are brought
+// up to date once per menu command, so the price listed is the price charged within a command.
+struct PricingTiers pricingTiers;
+struct PriceTable priceTable;
+
+// How far an append-only journal has been read, so the next read starts after the lines already seen
+struct JournalReplay {
+    struct FileFingerprint source;   // Journal when it was last read; its inode changes when it is rewritten
+    long replayedBytes;              // Bytes already applied (0 = not read yet)
+};
+
+// Every reservation by ticket number, kept current from reservation.txt and updated in place
+// when a booking is saved or cancelled
+struct TicketIndex ticketIndex;
+struct JournalReplay ticketReplay; // reservation.txt lines applied to ticketIndex
+
+// Bookings per bus plate of the user who booked last, kept current from the tail of reservation.txt
+struct PlateBookings {
+    char busNumberPlate[PLATE_LENGTH]; // Bus number plate as written in the reservation
+    int count;                         // Reservations of the user on that bus
+};
+char plateCountUser[USERNAME_LENGTH];   // User the counts belong to
+struct PlateBookings *plateCounts = NULL;
+int plateCountSize = 0;
+int plateCountCapacity = 0;
+struct JournalReplay plateCountReplay;
+
+// Text files a state snapshot is checked against, in the order their fingerprints are kept
+const char *snapshotSourceFiles[] = { "buses.txt", "seats.txt", "user.txt", SEAT_CHANGES_FILE };
+#define SNAPSHOT_SOURCE_COUNT 4
+struct FileFingerprint savedSnapshotSources[SNAPSHOT_SOURCE_COUNT]; // Files as of the last snapshot written or loaded
+struct JournalReplay savedSnapshotTickets; // How far the ticket index in that snapshot had read reservation.txt
+
+// Recurring timetables; their trips are created in memory only when searched for or booked
+struct ScheduleTemplate templates[MAX_TEMPLATES];
+int templateCount = 0;
+
 // Structure to store notification details
 struct notification {
     union {
@@ -85,6 +158,20 @@ struct notification {
     int isEmail;          // Boolean flag: 1 for email, 0 for SMS
 };
 
+// Structure to store one change to a bus schedule
+struct ScheduleChange {
+    int busID;            // Bus to change
+    int field;            // Field to change, numbered as in the update menu (1 Date ... 8 Fare)
+    char newValue[50];    // New value, normalized once it is applied
+    char oldValue[50];    // Previous value, filled in when the change is applied
+};
+
+// Structure to remember a cancelled booking until its passenger can be notified
+struct CancelledTicket {
+    char username[USERNAME_LENGTH]; // Passenger who booked
+    int ticketNumber;               // Ticket that was cancelled
+};
+
 // --- User Management ---
 void loadUsers();            // Load user data from a file
 void saveUsers();            // Save user data to a file
@@ -95,46 +182,95 @@ int loginAdmin();            // Handle admin login
 
 // --- Bus Schedule Management ---
 void addBusSchedule(struct BusReservation buses[], int *busCount, int maxBuses);  // Add a new bus schedule
-void logBusUpdate(int busID, int ticketNumber, const char *oldValue, const char *newValue); // Log changes to bus schedule
+void logBusUpdate(FILE *file, int busID, int ticketNumber, const char *oldValue, const char *newValue); // Log changes to bus schedule
+int applyScheduleChange(struct BusReservation *bus, struct ScheduleChange *change, char *error, size_t errorSize); // Apply one field change to a bus
+int applyScheduleChanges(struct BusReservation buses[], int busCount, struct ScheduleChange changes[], int changeCount, char *error, size_t errorSize); // Apply changes all-or-nothing and save once
+void bulkUpdateBusSchedules(struct BusReservation buses[], int *busCount); // Apply schedule changes from a CSV file
 void updateBusSchedule(struct BusReservation buses[], int *busCount, struct user currentUser); // Update an existing bus schedule
 void deleteBusSchedule(struct BusReservation buses[], int *busCount); // Delete a bus schedule
+void addRecurringSchedule(); // Add a recurring timetable template
+int findBusIndex(const struct BusReservation buses[], int busCount, int busID); // Find a bus by its ID
+int isFreeBusSlot(const struct BusReservation *bus); // Check if a slot belongs to a deleted bus
+int nextBusSlot(int busCount); // Slot the next new bus goes into, or -1 if full
+void claimBusSlot(int *busCount, int slot); // Take the slot returned by nextBusSlot
+void releaseBusSlot(struct BusReservation buses[], int slot); // Free a bus's slot in O(1) without moving other buses
+void clearBusSlot(struct BusReservation *bus); // Mark a slot as holding no bus
+void attachBusBookings(struct BusReservation buses[], int maxBuses); // Point every slot at its booking detail
+void resetBusSlot(struct BusReservation *bus); // Empty a slot for a new bus
+int cancelOrphanedReservations(const int busIDs[], int count, struct DurableFile files[], struct CancelledTicket **tickets, money_t *refunded); // Prepare the cancellation of every reservation on removed buses
+int shouldPersistBus(const struct BusReservation *bus); // Check if a bus is saved to file
+int materializeTemplateTrip(struct BusReservation buses[], int *busCount, const struct ScheduleTemplate *tpl, int epochDay); // Create a template trip on demand
+void fillTemplateTrip(struct BusReservation *bus, const struct ScheduleTemplate *tpl, int epochDay); // Fill a bus with a template's trip
+int listTemplateTrips(const struct BusReservation buses[], int busCount, const char *source, const char *destination, int fromDay, int days, struct BusReservation trips[], int maxTrips); // Upcoming template trips not in memory, for listing
+void releaseIdleTemplateTrips(struct BusReservation buses[], int busCount); // Free template trips nobody has booked
 
 // --- Bus Information Display ---
-void printBus(struct BusReservation bus); // Print bus details
-void checkBusStatus(struct BusReservation buses[], int busCount); // Check status of buses
-void searchBuses(struct BusReservation buses[], int busCount); // Search for available buses
+void appendBusRow(struct OutputBuffer *out, const struct BusReservation *bus); // Add one bus table row to a frame
+void appendPricedBusRow(struct OutputBuffer *out, const struct BusReservation *bus, money_t price); // Add a row with a given price
+money_t listedTripPrice(const struct BusReservation *trip); // Current price of a trip that has no slot
+void checkBusStatus(const struct BusReservation buses[], int busCount); // Check status of buses
+void searchBuses(const struct BusReservation buses[], int busCount); // Search for available buses
 int loadBuses(struct BusReservation buses[], int maxBuses); // Load bus schedules from file
-void saveBuses(struct BusReservation buses[], int busCount); // Save bus schedules to file
+int parseScheduleTimes(struct BusReservation *bus, const char *departureTime, const char *arrivalTime); // Validate a bus's date and times
+string_id internFieldText(struct StringView field, int size); // Intern a field cut to a fixed text size
+int departureKey(const struct BusReservation *bus); // Departure time as minutes since 1970-01-01
+int compareDepartures(const void *a, const void *b); // Order buses by departure time for qsort
+void rebuildDepartureIndex(const struct BusReservation buses[], int busCount); // Re-sort all schedules by departure
+void showNextDepartures(const struct BusReservation buses[], int busCount); // List the next departures from a city
+void purgePastTrips(struct BusReservation buses[], int *busCount); // Move departed trips to bus_history.txt
+void archivePastTravel(const struct BusReservation buses[], int busCount); // Move bookings of earlier travel months to the archive
+void saveBuses(const struct BusReservation buses[], int busCount); // Save bus schedules to file
+void writeBusFile(FILE *file, const struct BusReservation buses[], int busCount); // Write buses.txt format
+int saveSchedule(const struct BusReservation buses[], int busCount); // Save buses.txt and seats.txt together
+int beginScheduleWrite(struct DurableFile files[], const struct BusReservation buses[], int busCount); // Write the schedule files, uncommitted
+void clearSeatChanges(); // Forget the seat changes a committed schedule holds
+int loadStateSnapshot(struct BusReservation buses[], int *busCount); // Restore the loaded state from the snapshot image
+void markBusDirty(int slot); // Remember that a bus's seats changed
+int busSlotOf(const struct BusReservation *bus); // Slot of a bus in the schedule array
+void refreshSeatPrices(const struct BusReservation buses[], int busCount); // Reprice changed trips, or all of them once a day
+int saveSeatChanges(const struct BusReservation buses[], int busCount); // Append the changed buses' seats to seat_changes.txt
+int loadSeatChanges(struct BusReservation buses[], int busCount); // Apply seat_changes.txt after loading the files
+void checkpointSeatChanges(const struct BusReservation buses[], int busCount); // Fold logged seat changes into the files
+void saveStateSnapshot(const struct BusReservation buses[], int busCount); // Write the snapshot image for the next start
+void importBusSchedules(struct BusReservation buses[], int *busCount); // Bulk import trips from a CSV file
+int compareInts(const void *a, const void *b); // Compare two integers for qsort
+void writeBusLine(FILE *file, const struct BusReservation *bus); // Write one bus in buses.txt format
 
 // --- Seat Management ---
-int loadSeats(struct BusReservation buses[], int maxBuses); // Load seat reservation details
-void saveSeats(struct BusReservation buses[], int busCount); // Save seat reservation details
-void showSeats(struct BusReservation bus); // Display available and reserved seats
-void viewAvailability(struct BusReservation buses[], int busCount); // View seat availability
+int loadSeats(struct BusReservation buses[], int busCount); // Load seat reservation details
+void saveSeats(const struct BusReservation buses[], int busCount); // Save seat reservation details
+void writeSeatFile(FILE *file, const struct BusReservation buses[], int busCount); // Write seats.txt format
+void showSeats(const struct BusReservation *bus); // Display available and reserved seats
+void viewAvailability(const struct BusReservation buses[], int busCount); // View seat availability
 
 // --- Booking Management ---
-float calculateFare(int numSeats, float farePerSeat); // Calculate fare including taxes
+money_t calculateFare(int numSeats, money_t farePerSeat); // Calculate fare including taxes
 int bookSeat(struct user currentUser, struct BusReservation *bus, int seatNumbers[], int *numSeats); // Book seats
 void processBooking(struct user currentUser, struct BusReservation buses[], int *busCount); // Process the booking
-void processPayment(float totalFare); // Handle payment process
-void viewBookingHistory(struct user currentUser); // View user’s past bookings
-void saveFrequentBooking(struct user currentUser, int busID, char *busNumberPlate, char *bookingDate, char *source, char *destination); // Save frequent bookings for quick access
+int processPayment(money_t totalFare); // Handle payment process; returns 0 if the customer cancels
+void viewBookingHistory(struct user currentUser, const struct BusReservation buses[], int busCount); // View user’s past bookings, newest first
+void saveFrequentBooking(struct user currentUser, int busID, const char *busNumberPlate, char *bookingDate, const char *source, const char *destination); // Save frequent bookings for quick access
 int findFrequentBookings(struct user currentUser, char busNumberPlates[][20],char sources[][50], char destinations[][50], int *tripCount); // Find user’s frequent bookings
 void bookFrequentBooking(struct user currentUser, struct BusReservation buses[], int busCount); // Book using frequent booking data
-void finalizeBooking(struct user currentUser, struct BusReservation buses[], int busCount,int busIndex, int numSeats, int seatNumbers[], char *bookingDate,int tripIndex, int totalTrips, int *ticketNumbers, float *totalFares, int *busIndices); // Finalize booking process
+void finalizeBooking(struct user currentUser, struct BusReservation buses[], int busCount,int busIndex, int numSeats, int seatNumbers[], char *bookingDate,int tripIndex, int totalTrips, struct BookingTrips *trips); // Finalize booking process
 
 // --- Ticket and Reservation Management ---
 int generateTicketNumber(); // Generate a unique 6-digit ticket number
 bool IsUnique(int ticketNumber); // Check if the ticket number is unique
-int loadTicketNumbers(struct BusReservation buses[], int busCount); // Load ticket numbers from file
-void saveReservation(struct user currentUser, int ticketNumber, int busID, char *busNumberPlate, int numSeats, int seatNumbers[], char *bookingDate, float finalAmount); // Save a reservation
-void getTicketDetails(struct BusReservation buses[], int busCount); // Retrieve ticket details
-void displayTicketDetails(struct BusReservation *bus, int ticketNumber, char *bookingDate); // Display a specific ticket's details
+int syncTicketIndex(); // Bring the ticket index up to date with reservation.txt
+int openJournalTail(struct RecordReader *reader, const char *path, struct JournalReplay *replay); // Open a journal after the lines already read
+void closeJournalTail(struct RecordReader *reader, struct JournalReplay *replay); // Remember how far a journal was read
+int countPlateBookings(const char *username, const char *busNumberPlate); // Reservations of a user on one bus
+int saveReservation(struct user currentUser, int ticketNumber, int busID, const char *busNumberPlate, int numSeats, int seatNumbers[], char *bookingDate, money_t finalAmount); // Save a reservation; returns 0 if it was not written
+void getTicketDetails(const struct BusReservation buses[], int busCount); // Retrieve ticket details
+void displayTicketDetails(const struct BusReservation *bus, const struct TicketEntry *ticket); // Display a specific ticket's details
+void displayArchivedTicket(const struct ReservationRecord *record); // Display a ticket of an archived travel month
 
 // --- Cancellation and Refund Management ---
-void processRefund(float refundAmount); // Process refund after cancellation
-void logCancellation(char *username, int ticketNumber, int busID, char *busNumberPlate, char *date, int numSeats, int canceledSeats[], float refundAmount); // Log a cancellation event
-void updateFilesAfterCancellation(struct BusReservation buses[], int busCount, int busID, int numSeats, int ticketNumber, char *username); // Update files after cancellation
+void processRefund(money_t refundAmount); // Process refund after cancellation
+void formatCancellation(char *line, size_t size, const char *username, int ticketNumber, int busID, const char *busNumberPlate, const char *date, int numSeats, const int canceledSeats[], money_t refundAmount); // Build a cancellations.txt line
+int updateFilesAfterCancellation(int ticketNumber, long lineOffset, long lineLength, const char *cancellationLine); // Move a booking to cancellations.txt; 0 if nothing changed
+void releaseSeats(struct BusReservation *bus, const int seats[], int count); // Free a booking's seats on a bus
 void cancelBooking(struct user currentUser, struct BusReservation buses[], int busCount); // Handle booking cancellation
 
 // --- User Notifications ---
@@ -142,8 +278,11 @@ struct user getUserDetails(const char *username); // Retrieve user details
 void saveNotification(struct notification *notif, int ticketNumber); // Save notifications to file
 void checkAndRemoveUserUpdate(const char *currentUser); // Remove outdated user updates
 void appendUserToTempFile(const char *username); // Append user data to a temporary file
-void notifyUser(const char *username, int ticketNumber); // Notify user about ticket updates
-void notifyUsersOfBusUpdate(int busID, const char *oldValue, const char *newValue); // Notify users of schedule changes
+void notifyUser(const char *username, int ticketNumber, const char *category); // Notify user about ticket updates or cancellations
+void notifyUsersOfBusChanges(const struct ScheduleChange changes[], int changeCount); // Notify users of schedule changes in one pass
+void offerSeatsToWaitlist(const struct BusReservation *bus); // Hold freed seats for waitlisted customers and notify them
+void offerExpiredHolds(const struct BusReservation buses[], int busCount); // Pass seats of run-out holds to the waitlist
+int askToJoinWaitlist(struct user currentUser, const struct BusReservation *bus, int numSeats); // Offer the waitlist on a sold-out trip
 void viewNotifications(struct user *currentUser); // View all notifications
 void displayNotification(const char *filename, const char *type, struct user *currentUser); // Display specific notifications
 void printEmailMessage(const char *category, const char *recipient, int ticketNumber); // Print email notification
@@ -152,16 +291,23 @@ void printSmsMessage(const char *category, const char *recipient, int ticketNumb
 // --- Reports and Analytics ---
 void generateReports(struct BusReservation buses[], int busCount); // Generate reports
 void generateBusReport(struct BusReservation buses[], int busCount); // Generate report for buses
-void printReportHeader(); // Print the header for a report
+void appendReportHeader(struct OutputBuffer *out); // Add the header of a bus report to a frame
 void printBusReport(); // Print bus reports
+int parseBusReportLine(struct StringView line, struct BusReservation *bus); // Parse one line of bus_report.txt
+void appendBusReportRow(struct OutputBuffer *out, const struct BusReservation *bus); // Add one bus report row to a frame
 void filterBusReport(int filterType, char *filterValue, char comparison, float filterNumber); // Filter bus reports based on criteria
+int *userReportRow(struct StringView name, char usernames[][USERNAME_LENGTH], int rows[]); // Report row slot of a username
 void generateUserReport(); // Generate report for user activities
-void printHeader(const char *title); // Print reservation/cancellation report
 void printUserReport(); // Print user reports
 void printReservations(); // Print all reservations
 void printCancellations(); // Print all canceled bookings
 void filterRecords(const char *filename, int filterType, const char *filterValue); // Filter reservation/cancellation reports based on criteria
-void viewReport(); // View generated reports
+void filterRecordsByCriteria(const char *filename, const struct IndexCriterion criteria[], int criteriaCount); // Filter on several criteria, using the record index
+int recordMatchesCriteria(const struct ReservationRecord *record, const struct IndexCriterion criteria[], int criteriaCount); // Check a record against filter criteria
+int readFilterCriteria(struct IndexCriterion criteria[]); // Ask for a value for each filter field
+void viewReport(const struct BusReservation buses[], int busCount); // View generated reports
+void showOccupancyAnalytics(const struct BusReservation buses[], int busCount); // Load factor by route, hour and day
+int appendHistoryTrips(struct OccupancyTrip **trips, int tripCount, int *capacity); // Add departed trips to the cube's input
 
 
 // Function to load users from the file into the users array
@@ -189,7 +335,8 @@ void loadUsers() {
 
 // Function to save all user data to the file
 void saveUsers() {
-    FILE *file = fopen("user.txt", "w");  // Open the file in write mode (overwrite)
+    struct DurableFile out;  // user.txt is only replaced once the new copy is on disk
+    FILE *file = beginDurableWrite(&out, "user.txt", 1);
     if (file == NULL) {  // Check if file opening was successful
         printf("Error opening file for saving users.\n");
         return;
@@ -205,7 +352,7 @@ void saveUsers() {
                 users[i].address);  // Write address (includes spaces)
     }
 
-    fclose(file);  // Close the file after writing to save changes
+    commitDurableWrite(&out);  // Swap the new file in to save changes
 }
 
 // Function to register a new user
@@ -304,23 +451,7 @@ int updateUser() {
 
         // Save changes to file if a valid update was made
         if (choice >= 1 && choice <= 4) {
-            FILE *file = fopen("user.txt", "w");  // Open file in write mode to save updates
-            if (file == NULL) {  // Check if file opening failed
-                printf("Error saving user data!\n");
-                return 0;
-            }
-
-            // Save all users (including updated user) back to the file
-            for (int i = 0; i < userCount; i++) {
-                fprintf(file, "%s %s %s %s %s\n",
-                        users[i].username,  // Write username
-                        users[i].password,  // Write password
-                        users[i].email,     // Write email
-                        users[i].phone,     // Write phone number
-                        users[i].address);  // Write address
-            }
-
-            fclose(file);  // Close the file after writing
+            saveUsers();  // Save all users (including updated user) back to the file
             printf("Information updated successfully!\n");  // Confirm success
         }
 
@@ -424,244 +555,798 @@ int loginAdmin() {
 // Function to add a new bus schedule
 void addBusSchedule(struct BusReservation buses[], int *busCount, int maxBuses) {
     // Check if adding another bus exceeds the maximum allowed limit
-    if (*busCount >= maxBuses) {
+    int slot = nextBusSlot(*busCount);
+    if (slot == -1 || slot >= maxBuses) {
         printf("Cannot add more buses. Maximum limit reached.\n");
         return;
     }
 
-    // Pointer to the next available slot in the bus list
-    struct BusReservation *bus = &buses[*busCount];
+    // Pointer to the next available slot in the bus list (a deleted bus's slot is reused first)
+    struct BusReservation *bus = &buses[slot];
+    resetBusSlot(bus); // Nothing may be left over from a deleted bus
 
     // Collecting bus information from the user
     printf("\nEnter Bus ID: ");
     scanf("%d", &bus->busID); // Unique ID for the bus
+    if (bus->busID < 1 || bus->busID >= TEMPLATE_TRIP_ID_BASE) {
+        printf("Error: Bus IDs must be between 1 and %d; higher IDs belong to recurring schedules.\n", TEMPLATE_TRIP_ID_BASE - 1);
+        clearBusSlot(bus); // The bus is not added; the slot stays free
+        return;
+    }
+
+    char plate[PLATE_LENGTH], source[CITY_LENGTH], destination[CITY_LENGTH];
+    char departureTime[TIME_LENGTH], arrivalTime[TIME_LENGTH];
 
     printf("Enter Bus Number Plate: ");
-    scanf("%19s", bus->busNumberPlate); // License plate of the bus
+    scanf("%19s", plate); // License plate of the bus
 
     printf("Enter Date (YYYY-MM-DD): ");
     scanf("%10s", bus->date); // Travel date in a standard format
 
     printf("Enter Source: ");
-    scanf("%49s", bus->source); // City or location where the journey starts
+    scanf("%49s", source); // City or location where the journey starts
 
     printf("Enter Destination: ");
-    scanf("%49s", bus->destination); // Final destination of the bus
+    scanf("%49s", destination); // Final destination of the bus
 
     printf("Enter Departure Time: ");
-    scanf("%19s", bus->departureTime); // Time when the bus departs
+    scanf("%19s", departureTime); // Time when the bus departs
 
     printf("Enter Arrival Time: ");
-    scanf("%19s", bus->arrivalTime); // Expected arrival time at the destination
+    scanf("%19s", arrivalTime); // Expected arrival time at the destination
+
+    // Names are kept as dictionary IDs, so searches compare numbers instead of text
+    bus->busNumberPlate = internString(plate);
+    bus->source = internString(source);
+    bus->destination = internString(destination);
+
+    // Parse the date and times once so they are never compared as strings again
+    if (!parseScheduleTimes(bus, departureTime, arrivalTime)) {
+        printf("Error: Invalid date or time! Use YYYY-MM-DD and HH:MMAM/PM.\n");
+        clearBusSlot(bus); // The bus is not added; the slot stays free
+        return;
+    }
 
     printf("Enter Total Seats: ");
     scanf("%d", &bus->totalSeats); // Total seating capacity of the bus
 
     bus->availableSeats = bus->totalSeats; // Initially, all seats are unoccupied
 
+    char fareText[MONEY_TEXT_LENGTH];
     printf("Enter Fare (RM): ");
-    scanf("%f", &bus->fare); // Cost of a single ticket for the bus
+    scanf("%31s", fareText); // Cost of a single ticket for the bus
+    if (!parseMoneyText(fareText, &bus->fare) || bus->fare < 0) {
+        printf("Error: Invalid fare amount!\n");
+        clearBusSlot(bus); // The bus is not added; the slot stays free
+        return;
+    }
 
-    bus->reservedCount = 0; // No reservations initially
+    bus->detail->reservedCount = 0; // No reservations initially
 
-    (*busCount)++; // Increment the count of registered buses
+    insertDepartureEntry(&departureIndex, departureKey(bus), slot); // Index the new departure
+    claimBusSlot(busCount, slot); // Count the bus as registered
 
-    saveBuses(buses, *busCount); // Save updated bus data to the file
+    saveSchedule(buses, *busCount); // Save bus and seat data; seats.txt lines follow buses.txt, including reused slots
 
     printf("Bus schedule added successfully!\n");
 }
 
-// Function to log changes made to a bus schedule
-void logBusUpdate(int busID, int ticketNumber, const char *oldValue, const char *newValue) {
-    // Open the file where updates are logged, using append mode
-    FILE *file = fopen("updates.txt", "a");
-    if (!file) {
-        printf("Error: Could not open updates.txt for writing.\n");
+// Function to add a recurring timetable instead of entering every dated trip by hand
+void addRecurringSchedule() {
+    if (templateCount >= MAX_TEMPLATES) {
+        printf("Cannot add more recurring schedules. Maximum limit reached.\n");
+        return;
+    }
+
+    char plate[20], source[50], destination[50], days[20], departure[20], arrival[20];
+    char fareText[MONEY_TEXT_LENGTH], validFrom[20], validTo[20];
+    int totalSeats;
+
+    // Collecting the timetable from the admin
+    printf("\nEnter Bus Number Plate: ");
+    scanf("%19s", plate);
+    printf("Enter Source: ");
+    scanf("%49s", source);
+    printf("Enter Destination: ");
+    scanf("%49s", destination);
+    printf("Enter Days of Week, Monday first (e.g. MTWTF-- or 1111100): ");
+    scanf("%19s", days);
+    printf("Enter Departure Time: ");
+    scanf("%19s", departure);
+    printf("Enter Arrival Time: ");
+    scanf("%19s", arrival);
+    printf("Enter Total Seats: ");
+    if (scanf("%d", &totalSeats) != 1) {
+        printf("Error: Invalid seat count!\n");
+        while (getchar() != '\n'); // Clear invalid input
         return;
     }
+    printf("Enter Fare (RM): ");
+    scanf("%31s", fareText);
+    printf("Enter First Travel Date (YYYY-MM-DD): ");
+    scanf("%19s", validFrom);
+    printf("Enter Last Travel Date (YYYY-MM-DD): ");
+    scanf("%19s", validTo);
+
+    // The next free template number
+    int templateID = 1;
+    for (int i = 0; i < templateCount; i++) {
+        if (templates[i].templateID >= templateID) {
+            templateID = templates[i].templateID + 1;
+        }
+    }
+
+    // Build the line exactly as it is stored so input and file share one parser and its checks
+    char line[MAX_LINE];
+    int length = snprintf(line, sizeof(line), "%d,%s,%s,%s,%s,%s,%s,%d,%s,%s,%s",
+                          templateID, plate, source, destination, days, departure, arrival,
+                          totalSeats, fareText, validFrom, validTo);
+    struct StringView view = { line, length };
+
+    struct ScheduleTemplate *tpl = &templates[templateCount];
+    if (!parseScheduleTemplate(view, tpl)) {
+        printf("Error: Invalid schedule! Check the days, times, seats (1-%d), fare and dates (at most %d days apart).\n",
+               MAX_TEMPLATE_SEATS, MAX_TEMPLATE_DAYS - 1);
+        return;
+    }
+
+    if (!appendScheduleTemplate(tpl)) return;
+    templateCount++;
+
+    printf("Recurring schedule %d added successfully! Its trips appear in searches as they come up.\n", templateID);
+}
+
+// Function to find the position of a bus in the array by its ID
+int findBusIndex(const struct BusReservation buses[], int busCount, int busID) {
+    for (int i = 0; i < busCount; i++) {
+        if (buses[i].busID == busID && !isFreeBusSlot(&buses[i])) {
+            return i;
+        }
+    }
+    return -1; // Not found
+}
+
+// Function to check whether a slot belongs to a deleted bus
+int isFreeBusSlot(const struct BusReservation *bus) {
+    return bus->busID == FREE_BUS_SLOT;
+}
+
+// Function to pick the slot for a new bus: the most recently freed one, else the end of the list
+int nextBusSlot(int busCount) {
+    if (freeBusSlotCount > 0) return freeBusSlots[freeBusSlotCount - 1];
+    return busCount < MAX_BUSES ? busCount : -1;
+}
+
+// Function to take the slot returned by nextBusSlot once the new bus is complete
+void claimBusSlot(int *busCount, int slot) {
+    markPriceStale(&priceTable, slot); // A new trip needs a price
+    if (slot == *busCount) {
+        (*busCount)++; // The list grew
+    } else {
+        freeBusSlotCount--; // A freed slot was reused
+    }
+}
+
+// Function to delete a bus by freeing its slot; other buses keep their slots, so nothing is copied
+void releaseBusSlot(struct BusReservation buses[], int slot) {
+    struct BusReservation *bus = &buses[slot];
+    if (isFreeBusSlot(bus)) return;
+
+    removeDepartureEntry(&departureIndex, departureKey(bus), slot);
+    clearBusSlot(bus);
+    freeBusSlots[freeBusSlotCount++] = slot;
+}
+
+// Function to mark a slot as free, clearing the fields searches match on
+// so a free slot never matches an ID, plate or route
+void clearBusSlot(struct BusReservation *bus) {
+    bus->busID = FREE_BUS_SLOT;
+    bus->busNumberPlate = NO_STRING;
+    bus->source = NO_STRING;
+    bus->destination = NO_STRING;
+}
+
+// Function to give every bus slot its booking detail; called once before any bus is loaded
+void attachBusBookings(struct BusReservation buses[], int maxBuses) {
+    for (int i = 0; i < maxBuses && i < MAX_BUSES; i++) {
+        buses[i].detail = &busBookings[i];
+        memset(buses[i].detail, 0, sizeof(*buses[i].detail));
+    }
+}
+
+// Function to empty a slot before a new bus is written into it, keeping its booking detail attached
+void resetBusSlot(struct BusReservation *bus) {
+    struct BusBookings *detail = bus->detail;
+    memset(bus, 0, sizeof(*bus));
+    memset(detail, 0, sizeof(*detail));
+    bus->detail = detail;
+}
+
+// Function to check whether a bus belongs in buses.txt and seats.txt.
+// Template trips are recreated from templates.txt, so they are only saved once they hold reservations.
+int shouldPersistBus(const struct BusReservation *bus) {
+    if (isFreeBusSlot(bus)) return 0; // Deleted
+    return bus->busID < TEMPLATE_TRIP_ID_BASE || bus->detail->reservedCount > 0 || bus->availableSeats < bus->totalSeats;
+}
+
+// Function to fill a bus with a template's trip on one day; its booking detail is left alone
+void fillTemplateTrip(struct BusReservation *bus, const struct ScheduleTemplate *tpl, int epochDay) {
+    bus->busID = templateTripID(tpl, epochDay);
+    bus->busNumberPlate = internString(tpl->busNumberPlate);
+    formatDate(epochDay, bus->date);
+    bus->source = internString(tpl->source);
+    bus->destination = internString(tpl->destination);
+    bus->departureDay = epochDay;
+    bus->departureMinute = tpl->departureMinute;
+    bus->arrivalMinute = tpl->arrivalMinute;
+    bus->totalSeats = tpl->totalSeats;
+    bus->availableSeats = tpl->totalSeats;
+    bus->fare = tpl->fare;
+}
+
+// Function to create a template's trip on one day, or find it if it is already in memory.
+// Only a booking creates one; searches list template trips without taking a slot.
+int materializeTemplateTrip(struct BusReservation buses[], int *busCount, const struct ScheduleTemplate *tpl, int epochDay) {
+    int busID = templateTripID(tpl, epochDay);
+    int existing = findBusIndex(buses, *busCount, busID);
+    if (existing != -1) {
+        return existing; // Already materialized, or loaded because it has reservations
+    }
+
+    int slot = nextBusSlot(*busCount);
+    if (slot == -1) {
+        return -1; // No room for another trip
+    }
+
+    // Fill the next free slot from the template
+    struct BusReservation *bus = &buses[slot];
+    resetBusSlot(bus); // No reservations, bookings or report totals yet
+    fillTemplateTrip(bus, tpl, epochDay);
+
+    insertDepartureEntry(&departureIndex, departureKey(bus), slot); // Index the new departure
+    claimBusSlot(busCount, slot);
+    refreshSeatPrices(buses, *busCount); // Booked straight away
+    return slot;
+}
+
+// Function to collect the upcoming template trips on a route that are not in memory yet (NULL matches
+// any city). They are written to trips[] as temporary rows for a search to list; nothing is claimed.
+// Returns the number of trips collected, at most maxTrips.
+int listTemplateTrips(const struct BusReservation buses[], int busCount, const char *source, const char *destination,
+                      int fromDay, int days, struct BusReservation trips[], int maxTrips) {
+    int now = currentDepartureKey();
+    int count = 0;
+
+    for (int i = 0; i < templateCount; i++) {
+        const struct ScheduleTemplate *tpl = &templates[i];
+
+        // Only templates on the requested route
+        if ((source && strcasecmp(tpl->source, source) != 0) ||
+            (destination && strcasecmp(tpl->destination, destination) != 0)) {
+            continue;
+        }
+
+        for (int day = fromDay; day < fromDay + days && count < maxTrips; day++) {
+            if (!templateRunsOn(tpl, day) || day * MINUTES_PER_DAY + tpl->departureMinute < now) {
+                continue; // No trip that day, or it has already left
+            }
+            if (findBusIndex(buses, busCount, templateTripID(tpl, day)) != -1) {
+                continue; // Booked before, so it is listed with the other buses
+            }
+            memset(&trips[count], 0, sizeof(trips[count])); // No booking detail: the row is only displayed
+            fillTemplateTrip(&trips[count], tpl, day);
+            count++;
+        }
+    }
+    return count;
+}
+
+// Function to free the slots of template trips nobody holds a seat on, such as one left behind by a
+// booking that was not paid for. They are listed from templates.txt again and recreated when booked.
+void releaseIdleTemplateTrips(struct BusReservation buses[], int busCount) {
+    for (int i = 0; i < busCount; i++) {
+        if (!isFreeBusSlot(&buses[i]) && buses[i].busID >= TEMPLATE_TRIP_ID_BASE && !shouldPersistBus(&buses[i])) {
+            releaseBusSlot(buses, i);
+        }
+    }
+}
 
+// Function to log changes made to a bus schedule to an open updates.txt
+void logBusUpdate(FILE *file, int busID, int ticketNumber, const char *oldValue, const char *newValue) {
     // Write the update details in a structured format
     fprintf(file, "%d, %d, %s, %s\n", ticketNumber, busID, oldValue, newValue);
-    fclose(file); // Close the file to save changes
+}
+
+// Function to copy a new text value into a bus field if it fits
+static int copyScheduleText(char *field, size_t size, const char *value, char *error, size_t errorSize) {
+    if (strlen(value) >= size) {
+        snprintf(error, errorSize, "Value is longer than %d characters!", (int)size - 1);
+        return 0;
+    }
+    strcpy(field, value);
+    return 1;
+}
+
+// Function to apply one change to a bus, keeping the bus unchanged if the value is invalid.
+// Fields are numbered as in the update menu: 1 Date ... 8 Fare.
+int applyScheduleChange(struct BusReservation *bus, struct ScheduleChange *change, char *error, size_t errorSize) {
+    char text[CITY_LENGTH];                                      // New name, checked for length before it is interned
+    char departureTime[TIME_LENGTH], arrivalTime[TIME_LENGTH];   // Times to parse with a new date or time
+    formatTime(bus->departureMinute, departureTime);
+    formatTime(bus->arrivalMinute, arrivalTime);
+
+    switch (change->field) {
+        case 1: // Update travel date
+            strcpy(change->oldValue, bus->date); // Store old date for logging
+            if (!copyScheduleText(bus->date, sizeof(bus->date), change->newValue, error, errorSize) ||
+                !parseScheduleTimes(bus, departureTime, arrivalTime)) {
+                strcpy(bus->date, change->oldValue); // Keep the previous valid date
+                snprintf(error, errorSize, "Invalid date! Use YYYY-MM-DD.");
+                return 0;
+            }
+            break;
+
+        case 2: // Update bus number plate
+            strcpy(change->oldValue, stringText(bus->busNumberPlate)); // Store old plate number
+            if (!copyScheduleText(text, PLATE_LENGTH, change->newValue, error, errorSize)) return 0;
+            bus->busNumberPlate = internString(text);
+            break;
+
+        case 3: // Update bus source location
+            strcpy(change->oldValue, stringText(bus->source)); // Store old source
+            if (!copyScheduleText(text, CITY_LENGTH, change->newValue, error, errorSize)) return 0;
+            bus->source = internString(text);
+            break;
+
+        case 4: // Update bus destination location
+            strcpy(change->oldValue, stringText(bus->destination)); // Store old destination
+            if (!copyScheduleText(text, CITY_LENGTH, change->newValue, error, errorSize)) return 0;
+            bus->destination = internString(text);
+            break;
+
+        case 5: // Update departure time
+        case 6: { // Update arrival time
+            char *time = change->field == 5 ? departureTime : arrivalTime;
+            strcpy(change->oldValue, time); // Store old time
+            if (!copyScheduleText(time, TIME_LENGTH, change->newValue, error, errorSize) ||
+                !parseScheduleTimes(bus, departureTime, arrivalTime)) { // The bus keeps its times if either is invalid
+                snprintf(error, errorSize, "Invalid time! Use HH:MMAM/PM.");
+                return 0;
+            }
+            break;
+        }
+
+        case 7: { // Update total seats
+            int bookedSeats = bus->totalSeats - bus->availableSeats; // Calculate already booked seats
+            char *end;
+            long newTotalSeats = strtol(change->newValue, &end, 10);
+            sprintf(change->oldValue, "%d", bus->totalSeats); // Store old seat count
+
+            if (end == change->newValue || *end != '\0') {
+                snprintf(error, errorSize, "Invalid number of seats!");
+                return 0;
+            }
+            // Ensure new total seats are not less than already booked seats
+            if (newTotalSeats < bookedSeats) {
+                snprintf(error, errorSize, "New total seats cannot be less than already booked seats (%d).", bookedSeats);
+                return 0;
+            }
+
+            bus->totalSeats = (int)newTotalSeats; // Update total seats
+            bus->availableSeats = bus->totalSeats - bookedSeats; // Adjust available seats
+            sprintf(change->newValue, "%d", bus->totalSeats); // Store new seat count for logging
+            break;
+        }
+
+        case 8: { // Update bus fare
+            money_t newFare;
+            formatMoney(bus->fare, change->oldValue); // Store old fare value
+            if (!parseMoneyText(change->newValue, &newFare) || newFare < 0) {
+                snprintf(error, errorSize, "Invalid fare amount!");
+                return 0;
+            }
+            bus->fare = newFare;
+            formatMoney(bus->fare, change->newValue); // Store new fare for logging
+            break;
+        }
+
+        default: // Handle invalid field
+            snprintf(error, errorSize, "Invalid choice!");
+            return 0;
+    }
+    return 1;
+}
+
+// Function to apply a set of schedule changes as one transaction.
+// Either every change is applied and buses.txt is written once, or nothing changes.
+// Returns -1 on success, or the position of the change that was rejected.
+int applyScheduleChanges(struct BusReservation buses[], int busCount, struct ScheduleChange changes[], int changeCount, char *error, size_t errorSize) {
+    struct BusReservation *backups = malloc((size_t)(changeCount > 0 ? changeCount : 1) * sizeof(*backups));
+    int *backupSlots = malloc((size_t)(changeCount > 0 ? changeCount : 1) * sizeof(int));
+    int backupCount = 0, failed = -1, moved = 0;
+
+    if (!backups || !backupSlots) {
+        free(backups);
+        free(backupSlots);
+        snprintf(error, errorSize, "Not enough memory for the update!");
+        return 0;
+    }
+
+    for (int i = 0; i < changeCount && failed == -1; i++) {
+        int slot = findBusIndex(buses, busCount, changes[i].busID);
+        if (slot == -1) {
+            snprintf(error, errorSize, "Bus ID %d not found!", changes[i].busID);
+            failed = i;
+            break;
+        }
+
+        // Keep each bus as it was before its first change, in case a later change is rejected
+        int saved = 0;
+        for (int j = 0; j < backupCount && !saved; j++) {
+            saved = backupSlots[j] == slot;
+        }
+        if (!saved) {
+            backups[backupCount] = buses[slot];
+            backupSlots[backupCount++] = slot;
+        }
+
+        if (!applyScheduleChange(&buses[slot], &changes[i], error, errorSize)) {
+            failed = i;
+        }
+        moved = moved || changes[i].field == 1 || changes[i].field == 5;
+    }
+
+    if (failed != -1) {
+        // Roll every touched bus back to its original state
+        for (int j = 0; j < backupCount; j++) {
+            buses[backupSlots[j]] = backups[j];
+        }
+    } else {
+        // Fares, seats and dates all feed the price
+        for (int j = 0; j < backupCount; j++) {
+            markPriceStale(&priceTable, backupSlots[j]);
+        }
+
+        // A new date or departure time moves buses in the departure order
+        if (moved) {
+            rebuildDepartureIndex(buses, busCount);
+        }
+        saveBuses(buses, busCount); // One rewrite for the whole set
+    }
+
+    free(backups);
+    free(backupSlots);
+    return failed;
 }
 
 // Function to modify an existing bus schedule
 void updateBusSchedule(struct BusReservation buses[], int *busCount, struct user currentUser) {
-    int busID, choice, found = 0;
+    struct ScheduleChange change; // The field and value chosen below
+    char error[100];              // Why a value was rejected
 
     // Prompt user to enter the Bus ID they want to update
     printf("\nEnter Bus ID to update: ");
-    scanf("%d", &busID);
+    scanf("%d", &change.busID);
 
     // Search for the bus in the list by comparing Bus ID
-    for (int i = 0; i < *busCount; i++) {
-        if (buses[i].busID == busID) { // If the entered Bus ID matches a stored bus
-            found = 1; // Mark that we found the bus
-
-            // Display update options to the user
-            printf("\nBus found! What would you like to update?\n");
-            printf("1. Date\n2. Bus Number Plate\n3. Source\n4. Destination\n5. Departure Time\n6. Arrival Time\n7. Total Seats\n8. Fare\n");
-            printf("Enter your choice: ");
-            scanf("%d", &choice);
-
-            // Variables to store old and new values for logging
-            char oldValue[50], newValue[50];
-
-            // Switch case to handle each update option
-            switch (choice) {
-                case 1: // Update travel date
-                    strcpy(oldValue, buses[i].date); // Store old date for logging
-                    printf("Enter new Date (YYYY-MM-DD): ");
-                    scanf("%10s", buses[i].date); // Get new date input
-                    strcpy(newValue, buses[i].date); // Store new date for logging
-                    break;
+    if (findBusIndex(buses, *busCount, change.busID) == -1) {
+        // If no bus with the entered Bus ID is found, display an error message
+        printf("Bus ID not found!\n");
+        return;
+    }
 
-                case 2: // Update bus number plate
-                    strcpy(oldValue, buses[i].busNumberPlate); // Store old plate number
-                    printf("Enter new Bus Number Plate: ");
-                    scanf("%19s", buses[i].busNumberPlate); // Get new plate number
-                    strcpy(newValue, buses[i].busNumberPlate); // Store new plate for logging
-                    break;
+    // Display update options to the user
+    printf("\nBus found! What would you like to update?\n");
+    printf("1. Date\n2. Bus Number Plate\n3. Source\n4. Destination\n5. Departure Time\n6. Arrival Time\n7. Total Seats\n8. Fare\n");
+    printf("Enter your choice: ");
+    scanf("%d", &change.field);
+
+    // Prompt for the new value of the chosen field
+    static const char *prompts[] = {
+        "Enter new Date (YYYY-MM-DD): ", "Enter new Bus Number Plate: ", "Enter new Source: ",
+        "Enter new Destination: ", "Enter new Departure Time: ", "Enter new Arrival Time: ",
+        "Enter new Total Seats: ", "Enter new Fare (RM): "
+    };
+    if (change.field < 1 || change.field > 8) {
+        printf("Invalid choice!\n");
+        return;
+    }
+    printf("%s", prompts[change.field - 1]);
+    scanf("%49s", change.newValue);
 
-                case 3: // Update bus source location
-                    strcpy(oldValue, buses[i].source); // Store old source
-                    printf("Enter new Source: ");
-                    scanf("%49s", buses[i].source); // Get new source input
-                    strcpy(newValue, buses[i].source); // Store new source for logging
-                    break;
+    // A single update is a batch of one
+    if (applyScheduleChanges(buses, *busCount, &change, 1, error, sizeof(error)) != -1) {
+        printf("Error: %s\n", error);
+        return; // Exit function if invalid input
+    }
+    printf("Bus schedule updated successfully!\n");
 
-                case 4: // Update bus destination location
-                    strcpy(oldValue, buses[i].destination); // Store old destination
-                    printf("Enter new Destination: ");
-                    scanf("%49s", buses[i].destination); // Get new destination input
-                    strcpy(newValue, buses[i].destination); // Store new destination for logging
-                    break;
+    // Notify users about the schedule update if needed
+    notifyUsersOfBusChanges(&change, 1);
+}
 
-                case 5: // Update departure time
-                    strcpy(oldValue, buses[i].departureTime); // Store old departure time
-                    printf("Enter new Departure Time: ");
-                    scanf("%19s", buses[i].departureTime); // Get new departure time input
-                    strcpy(newValue, buses[i].departureTime); // Store new time for logging
-                    break;
+// Function to read a change field given by number (1-8) or by name
+static int parseChangeField(struct StringView field) {
+    static const char *names[] = { "date", "plate", "source", "destination", "departure", "arrival", "seats", "fare" };
+    int number;
+    if (parseIntView(field, &number)) {
+        return number >= 1 && number <= 8 ? number : 0;
+    }
+    for (int i = 0; i < 8; i++) {
+        if (field.length == (int)strlen(names[i]) && strncasecmp(field.data, names[i], (size_t)field.length) == 0) {
+            return i + 1;
+        }
+    }
+    return 0;
+}
 
-                case 6: // Update arrival time
-                    strcpy(oldValue, buses[i].arrivalTime); // Store old arrival time
-                    printf("Enter new Arrival Time: ");
-                    scanf("%19s", buses[i].arrivalTime); // Get new arrival time input
-                    strcpy(newValue, buses[i].arrivalTime); // Store new time for logging
-                    break;
+// Function to apply many schedule changes from a CSV file at once (e.g. after a weather disruption)
+void bulkUpdateBusSchedules(struct BusReservation buses[], int *busCount) {
+    char filename[MAX_IMPORT_PATH];
+    printf("\nEnter CSV file of changes (busID,field,newValue): ");
+    scanf("%255s", filename);
 
-                case 7: { // Update total seats
-                    int bookedSeats = buses[i].totalSeats - buses[i].availableSeats; // Calculate already booked seats
-                    int newTotalSeats;
-                    sprintf(oldValue, "%d", buses[i].totalSeats); // Store old seat count
-                    printf("Enter new Total Seats: ");
-                    scanf("%d", &newTotalSeats); // Get new seat count input
-
-                    // Ensure new total seats are not less than already booked seats
-                    if (newTotalSeats < bookedSeats) {
-                        printf("Error: New total seats cannot be less than already booked seats (%d).\n", bookedSeats);
-                        return; // Exit function if invalid input
-                    }
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, filename)) {
+        printf("Error: Could not open %s for reading.\n", filename);
+        return;
+    }
 
-                    buses[i].totalSeats = newTotalSeats; // Update total seats
-                    buses[i].availableSeats = newTotalSeats - bookedSeats; // Adjust available seats
-                    sprintf(newValue, "%d", newTotalSeats); // Store new seat count for logging
-                    break;
-                }
+    struct ScheduleChange *changes = NULL; // Changes in file order
+    int changeCount = 0, capacity = 0, lineNumber = 0, badLines = 0;
+    struct StringView line;
+    struct StringView fields[MAX_RECORD_FIELDS];
 
-                case 8: // Update bus fare
-                    sprintf(oldValue, "%.2f", buses[i].fare); // Store old fare value
-                    printf("Enter new Fare (RM): ");
-                    scanf("%f", &buses[i].fare); // Get new fare input
-                    sprintf(newValue, "%.2f", buses[i].fare); // Store new fare for logging
-                    break;
+    while (readRecordLine(&reader, &line)) {
+        lineNumber++;
+        if (line.length == 0) continue;
+        int count = splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS);
+        int headerBusID;
+        if (lineNumber == 1 && count == 3 && !parseIntView(fields[0], &headerBusID)) {
+            continue; // Header line
+        }
 
-                default: // Handle invalid choice input
-                    printf("Invalid choice!\n");
-                    return;
+        if (changeCount == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            struct ScheduleChange *grown = realloc(changes, (size_t)capacity * sizeof(*changes));
+            if (!grown) {
+                printf("Error: Not enough memory for the update.\n");
+                free(changes);
+                closeRecordReader(&reader);
+                return;
             }
+            changes = grown;
+        }
 
-            // Save the updated bus details to file
-            saveBuses(buses, *busCount);
-            printf("Bus schedule updated successfully!\n");
-
-            // Notify users about the schedule update if needed
-            notifyUsersOfBusUpdate(busID, oldValue, newValue);
-            return;
+        struct ScheduleChange *change = &changes[changeCount];
+        if (count != 3 || !parseIntView(fields[0], &change->busID) || !(change->field = parseChangeField(fields[1])) ||
+            fields[2].length == 0 || fields[2].length >= (int)sizeof(change->newValue)) {
+            printf("  Line %d: expected busID,field,newValue\n", lineNumber);
+            badLines++;
+            continue;
         }
+        copyView(fields[2], change->newValue, sizeof(change->newValue));
+        changeCount++;
     }
+    closeRecordReader(&reader);
 
-    // If no bus with the entered Bus ID is found, display an error message
-    if (!found) {
-        printf("Bus ID not found!\n");
+    if (badLines > 0 || changeCount == 0) {
+        printf("Update rejected: %d invalid line(s), %d change(s) read, nothing was changed.\n", badLines, changeCount);
+        free(changes);
+        return;
     }
+
+    char error[100];
+    int failed = applyScheduleChanges(buses, *busCount, changes, changeCount, error, sizeof(error));
+    if (failed != -1) {
+        printf("Update rejected: change %d (bus %d): %s Nothing was changed.\n", failed + 1, changes[failed].busID, error);
+        free(changes);
+        return;
+    }
+    printf("%d schedule change(s) applied successfully!\n", changeCount);
+
+    // Every affected passenger is notified once, for all of their changes
+    notifyUsersOfBusChanges(changes, changeCount);
+    free(changes);
 }
 
-// Function to remove a bus from the schedule
+// Function to remove a bus from the schedule, cancelling and refunding its reservations
 void deleteBusSchedule(struct BusReservation buses[], int *busCount) {
-    int busID, found = 0; // Variables to store the bus ID and a flag to check if the bus is found
+    int busID; // Bus ID entered by the admin
 
     // Prompt user to enter the Bus ID that needs to be deleted
     printf("\nEnter Bus ID to delete: ");
     scanf("%d", &busID);
 
-    // Loop through the list of buses to find the matching Bus ID
-    for (int i = 0; i < *busCount; i++) {
-        if (buses[i].busID == busID) { // If the entered Bus ID matches a stored bus
-            found = 1; // Set flag indicating the bus was found
+    int slot = findBusIndex(buses, *busCount, busID);
+    if (slot == -1) {
+        // If the bus with the entered Bus ID was not found, display an error message
+        printf("Bus ID not found!\n");
+        return;
+    }
 
-            // Shift all subsequent buses left to overwrite the deleted bus entry
-            for (int j = i; j < *busCount - 1; j++) {
-                buses[j] = buses[j + 1]; // Move the next bus one position up
-            }
+    // Passengers lose their trip, so ask before deleting a bus that has bookings
+    int bookedSeats = buses[slot].totalSeats - buses[slot].availableSeats;
+    if (bookedSeats > 0) {
+        char confirm;
+        printf("Bus %d has %d booked seat(s). Delete it and refund its passengers? (Y/N): ", busID, bookedSeats);
+        scanf(" %c", &confirm);
+        if (confirm != 'Y' && confirm != 'y') {
+            printf("Deletion canceled.\n");
+            return;
+        }
+    }
+
+    // Reservations on the bus would otherwise point at a trip that no longer exists, so they are
+    // cancelled in the same commit as the schedule: a crash leaves the bus and its bookings, or neither
+    struct DurableFile files[5]; // buses.txt, seats.txt, seat_changes.txt, reservation.txt, cancellations.txt
+    struct CancelledTicket *tickets = NULL;
+    money_t refunded = 0;
+    int cancelled = 0;
+    if (bookedSeats > 0) {
+        cancelled = cancelOrphanedReservations(&busID, 1, &files[3], &tickets, &refunded);
+        if (cancelled < 0) {
+            printf("Error: Bus %d was not deleted. Please try again.\n", busID);
+            return;
+        }
+    }
+    int fileCount = cancelled > 0 ? 5 : 3;
+
+    // Free the slot; no other bus moves
+    struct BusReservation removed = buses[slot];
+    releaseBusSlot(buses, slot);
+
+    // Save the schedule files with the reservation files so seats.txt stays aligned with buses.txt
+    int saved = beginScheduleWrite(files, buses, *busCount);
+    if (!saved && cancelled > 0) {
+        abortDurableWrite(&files[3]);
+        abortDurableWrite(&files[4]);
+    }
+    if (saved) saved = commitDurableWrites(files, fileCount);
+    if (!saved) {
+        // Nothing on disk changed, so put the bus back in its slot
+        buses[slot] = removed;
+        freeBusSlotCount--; // The release pushed the slot last
+        insertDepartureEntry(&departureIndex, departureKey(&buses[slot]), slot);
+        free(tickets);
+        printf("Error: Bus %d was not deleted. Please try again.\n", busID);
+        return;
+    }
+    clearSeatChanges();
+    closeWaitlist(busID); // Nobody can get seats on it any more
+    printf("Bus schedule deleted successfully.\n");
 
-            // Reduce the total bus count since one bus is deleted
-            (*busCount)--;
+    // Tell the passengers only now that their cancellations are saved
+    for (int i = 0; i < cancelled; i++) {
+        notifyUser(tickets[i].username, tickets[i].ticketNumber, "Cancellation");
+    }
+    free(tickets);
+    if (cancelled > 0) {
+        char amountText[MONEY_TEXT_LENGTH];
+        printf("%d reservation(s) cancelled, RM %s refunded to passengers.\n", cancelled, formatMoney(refunded, amountText));
+    }
+}
+
+// Function to move every reservation on removed buses to cancellations.txt with a full refund, in one
+// pass over reservation.txt. The new reservation.txt and cancellations.txt are left uncommitted in
+// files[0] and files[1] for the caller to commit with the schedule; the cancelled tickets are listed
+// in *tickets (freed by the caller) so their passengers are notified after the commit.
+// Returns the number of reservations cancelled (0 leaves no files open), or -1 if the files could not be written.
+int cancelOrphanedReservations(const int busIDs[], int count, struct DurableFile files[], struct CancelledTicket **tickets, money_t *refunded) {
+    int *sortedIDs = arenaAlloc(requestArena(), (size_t)count, sizeof(int));
+    if (!sortedIDs) return -1;
+    memcpy(sortedIDs, busIDs, (size_t)count * sizeof(int));
+    qsort(sortedIDs, (size_t)count, sizeof(int), compareInts); // For bsearch per reservation
+
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, "reservation.txt")) {
+        printf("Error: Unable to access reservation file.\n");
+        return -1;
+    }
+    if (!beginDurableWrite(&files[0], "reservation.txt", 0)) { // Reservations that stay
+        closeRecordReader(&reader);
+        return -1;
+    }
+    if (!beginDurableAppend(&files[1], "cancellations.txt", 0)) { // Reservations that are cancelled
+        closeRecordReader(&reader);
+        abortDurableWrite(&files[0]);
+        return -1;
+    }
+
+    struct StringView line;            // Current reservation line
+    struct ReservationRecord record;   // Parsed reservation fields
+    int cancelled = 0, capacity = 0, complete = 1;
+    *tickets = NULL;
+    *refunded = 0;
+
+    while (readRecordLine(&reader, &line)) {
+        if (parseReservationRecord(line, &record) &&
+            bsearch(&record.busID, sortedIDs, (size_t)count, sizeof(int), compareInts)) {
+            if (cancelled == capacity) {
+                capacity = capacity ? capacity * 2 : 16;
+                struct CancelledTicket *grown = realloc(*tickets, (size_t)capacity * sizeof(**tickets));
+                if (!grown) {
+                    printf("Error: Not enough memory to cancel the reservations.\n");
+                    complete = 0;
+                    break;
+                }
+                *tickets = grown;
+            }
 
-            printf("Bus schedule deleted successfully.\n");
-            break; // Exit the loop since deletion is completed
+            // The whole booking is refunded, so the line moves across unchanged
+            fwrite(line.data, 1, (size_t)line.length, files[1].file);
+            fputc('\n', files[1].file);
+            copyView(record.username, (*tickets)[cancelled].username, USERNAME_LENGTH);
+            (*tickets)[cancelled].ticketNumber = record.ticketNumber;
+            *refunded += record.amount;
+            cancelled++;
+            continue;
         }
+        fwrite(line.data, 1, (size_t)line.length, files[0].file);
+        fputc('\n', files[0].file);
     }
 
-    // If the bus with the entered Bus ID was not found, display an error message
-    if (!found) {
-        printf("Bus ID not found!\n");
+    closeRecordReader(&reader);
+
+    if (cancelled == 0 || !complete) {
+        abortDurableWrite(&files[0]); // Nothing changed
+        abortDurableWrite(&files[1]);
+        free(*tickets);
+        *tickets = NULL;
+        return complete ? 0 : -1;
     }
+    return cancelled;
+}
+
+// Function to add a single bus's details to a frame as a formatted table row.
+void appendBusRow(struct OutputBuffer *out, const struct BusReservation *bus) {
+    appendPricedBusRow(out, bus, seatPrice(&priceTable, busSlotOf(bus))); // Current price, not the base fare
+}
 
-    // Save the updated bus list to file after deletion
-    saveBuses(buses, *busCount);
+// Function to add a bus's row with the price given, for a trip that has no slot in the price table
+void appendPricedBusRow(struct OutputBuffer *out, const struct BusReservation *bus, money_t price) {
+    char fareText[MONEY_TEXT_LENGTH], departureTime[TIME_LENGTH], arrivalTime[TIME_LENGTH];
+    formatTime(bus->departureMinute, departureTime);
+    formatTime(bus->arrivalMinute, arrivalTime);
+    appendOutput(out, "| %-5d | %-12s | %-10s | %-15s | %-15s | %-10s | %-10s | %-5d | %-5d | %-6s |\n",
+                 bus->busID, stringText(bus->busNumberPlate), bus->date, stringText(bus->source), stringText(bus->destination),
+                 departureTime, arrivalTime, bus->totalSeats, bus->availableSeats,
+                 formatMoney(price, fareText));
 }
 
-// Function to print a single bus's details in a formatted table row.
-void printBus(struct BusReservation bus) {
-    printf("| %-5d | %-12s | %-10s | %-15s | %-15s | %-10s | %-10s | %-5d | %-5d | %-6.2f |\n",
-           bus.busID, bus.busNumberPlate, bus.date, bus.source, bus.destination,
-           bus.departureTime, bus.arrivalTime, bus.totalSeats, bus.availableSeats, bus.fare);
+// Function to price a listed template trip the way refreshSeatPrices prices the buses in memory
+money_t listedTripPrice(const struct BusReservation *trip) {
+    money_t price;
+    priceTrips(&pricingTiers, &trip->fare, &trip->availableSeats, &trip->totalSeats, &trip->departureDay,
+               currentDepartureKey() / MINUTES_PER_DAY, 1, &price);
+    return price;
 }
 
 // Function to display the status of all buses in the system.
-void checkBusStatus(struct BusReservation buses[], int busCount) {
+void checkBusStatus(const struct BusReservation buses[], int busCount) {
     // If no buses exist, inform the user and return.
-    if (busCount == 0) {
+    if (busCount - freeBusSlotCount == 0) {
         printf("\nNo buses found in the system!\n");
         return;
     }
 
-    // Print the header for the table.
-    printBusHeader();
+    // Render the whole table, then print it in one write.
+    struct OutputBuffer *out = beginFrame();
+    appendBusHeader(out);
 
-    // Iterate through the list of buses and print each one's details.
+    // Iterate through the list of buses and add each one's details.
     for (int i = 0; i < busCount; i++) {
-        printBus(buses[i]);
+        if (isFreeBusSlot(&buses[i])) continue; // Deleted bus
+        appendBusRow(out, &buses[i]);
     }
 
-    // Print a line to mark the end of the bus list.
-    printf("============================================================================================================================\n");
+    // Add a line to mark the end of the bus list.
+    appendBusTableEnd(out);
+    emitFrame();
 }
 
 // Function to search for available buses based on user input.
-void searchBuses(struct BusReservation buses[], int busCount) {
+void searchBuses(const struct BusReservation buses[], int busCount) {
     char source[50], destination[50]; // Stores the source and destination entered by the user.
     int tripType; // Determines whether the user wants a one-way or round-trip search.
 
@@ -680,182 +1365,750 @@ void searchBuses(struct BusReservation buses[], int busCount) {
     fgets(destination, sizeof(destination), stdin);
     destination[strcspn(destination, "\n")] = '\0'; // Remove trailing newline.
 
+    // The coming week's trips of recurring schedules are listed as temporary rows; only a booking creates one
+    int today = currentDepartureKey() / MINUTES_PER_DAY;
+    int maxTrips = templateCount * TEMPLATE_SEARCH_DAYS;
+    struct BusReservation *trips = arenaAlloc(requestArena(), (size_t)maxTrips, sizeof(struct BusReservation));
+    if (!trips) maxTrips = 0; // List the buses in memory only
+
     int found = 0; // Tracks whether a matching bus is found.
+    struct OutputBuffer *out = beginFrame(); // Both tables are printed together in one write
+
+    // Cities are matched case-insensitively through their folded dictionary IDs. The typed names are
+    // only looked up: a city no bus serves is not a known string, and matches nothing.
+    string_id wantedSource = findString(source, 1);
+    string_id wantedDestination = findString(destination, 1);
+    int knownRoute = wantedSource != NO_STRING && wantedDestination != NO_STRING;
 
     // Search for one-way trip buses.
-    printf("\n--- One-way trip buses ---\n");
-    printBusHeader();
+    appendOutput(out, "\n--- One-way trip buses ---\n");
+    appendBusHeader(out);
     for (int i = 0; i < busCount; i++) {
         // Compare the source and destination case-insensitively.
-        if (strcasecmp(buses[i].source, source) == 0 && strcasecmp(buses[i].destination, destination) == 0) {
-            printBus(buses[i]); // Print matching bus details.
+        if (knownRoute && foldedString(buses[i].source) == wantedSource && foldedString(buses[i].destination) == wantedDestination) {
+            appendBusRow(out, &buses[i]); // Add matching bus details.
             found = 1; // Mark that at least one bus was found.
         }
     }
-    printf("============================================================================================================================\n");
+    int tripCount = listTemplateTrips(buses, busCount, source, destination, today, TEMPLATE_SEARCH_DAYS, trips, maxTrips);
+    for (int i = 0; i < tripCount; i++) {
+        appendPricedBusRow(out, &trips[i], listedTripPrice(&trips[i]));
+        found = 1;
+    }
+    appendBusTableEnd(out);
 
     // If user requested a round trip, search for return route as well.
     if (tripType == 2) {
-        printf("\n--- Return trip buses ---\n");
-        printBusHeader();
+        appendOutput(out, "\n--- Return trip buses ---\n");
+        appendBusHeader(out);
         for (int i = 0; i < busCount; i++) {
             // Look for buses where the source and destination are swapped.
-            if (strcasecmp(buses[i].source, destination) == 0 && strcasecmp(buses[i].destination, source) == 0) {
-                printBus(buses[i]);
+            if (knownRoute && foldedString(buses[i].source) == wantedDestination && foldedString(buses[i].destination) == wantedSource) {
+                appendBusRow(out, &buses[i]);
                 found = 1;
             }
         }
-        printf("============================================================================================================================\n");
+        tripCount = listTemplateTrips(buses, busCount, destination, source, today, TEMPLATE_SEARCH_DAYS, trips, maxTrips);
+        for (int i = 0; i < tripCount; i++) {
+            appendPricedBusRow(out, &trips[i], listedTripPrice(&trips[i]));
+            found = 1;
+        }
+        appendBusTableEnd(out);
     }
 
     // If no matching buses were found, inform the user.
     if (!found) {
-        printf("\nNo matching buses found for the given route(s).\n");
+        appendOutput(out, "\nNo matching buses found for the given route(s).\n");
     }
+    emitFrame();
+}
+
+// Function to intern a field, cut to the length a fixed-size text field of that size holds
+string_id internFieldText(struct StringView field, int size) {
+    if (field.length > size - 1) field.length = size - 1;
+    return internStringView(field);
 }
 
 // Function to load bus schedules from a file into memory.
 int loadBuses(struct BusReservation buses[], int maxBuses) {
-    FILE *file = fopen("buses.txt", "r"); // Open the file in read mode.
-    if (!file) { // Check if the file was opened successfully.
+    struct RecordReader reader; // Block-wise reader shared by all record loaders
+    if (!openRecordReader(&reader, "buses.txt")) { // Check if the file was opened successfully.
         printf("Error: Could not open buses.txt for reading.\n");
         return 0; // Return 0 to indicate that no buses were loaded.
     }
 
     int count = 0; // Tracks the number of buses successfully loaded.
+    struct StringView line; // Current line, pointing into the reader's block
+    struct BusRecord record; // Parsed fields of the current line
 
     // Read bus details from the file while respecting the max bus limit.
-    while (count < maxBuses && fscanf(file, "%d,%19[^,],%10[^,],%49[^,],%49[^,],%19[^,],%19[^,],%d,%d,%f",
-                  &buses[count].busID, buses[count].busNumberPlate, buses[count].date,
-                  buses[count].source, buses[count].destination,
-                  buses[count].departureTime, buses[count].arrivalTime,
-                  &buses[count].totalSeats, &buses[count].availableSeats,
-                  &buses[count].fare) == 10) { // Ensure all 10 fields are read successfully.
-        buses[count].reservedCount = 0; // Initialize reserved seat count to 0.
+    while (count < maxBuses && readRecordLine(&reader, &line)) {
+        if (!parseBusRecord(line, &record)) { // Ensure all 10 fields are read successfully.
+            continue; // Skip malformed lines instead of stopping the load
+        }
+
+        // Copy the fields into the bus slot, the only place the text is kept
+        struct BusReservation *bus = &buses[count];
+        char departureTime[TIME_LENGTH], arrivalTime[TIME_LENGTH];
+        bus->busID = record.busID;
+        bus->busNumberPlate = internFieldText(record.busNumberPlate, PLATE_LENGTH);
+        copyView(record.date, bus->date, sizeof(bus->date));
+        bus->source = internFieldText(record.source, CITY_LENGTH);
+        bus->destination = internFieldText(record.destination, CITY_LENGTH);
+        copyView(record.departureTime, departureTime, sizeof(departureTime));
+        copyView(record.arrivalTime, arrivalTime, sizeof(arrivalTime));
+        bus->totalSeats = record.totalSeats;
+        bus->availableSeats = record.availableSeats;
+        bus->fare = record.fare;
+        bus->detail->reservedCount = 0; // Initialize reserved seat count to 0.
+
+        // Validate the date and times once, here, instead of comparing strings later
+        if (!parseScheduleTimes(bus, departureTime, arrivalTime)) {
+            printf("Warning: Skipping bus %d with an invalid date or time.\n", bus->busID);
+            continue;
+        }
         count++; // Increment the counter after successfully reading a bus record.
     }
 
-    fclose(file); // Close the file after reading.
+    closeRecordReader(&reader); // Close the file after reading.
     return count; // Return the number of buses loaded.
 }
 
-void saveBuses(struct BusReservation buses[], int busCount) {
-    FILE *file = fopen("buses.txt", "w"); // Open the file in write mode
-    if (!file) {
-        printf("Error: Could not open buses.txt for writing.\n");
-        return; // Exit the function if the file cannot be opened
-    }
+// Function to write one bus as a line of buses.txt
+void writeBusLine(FILE *file, const struct BusReservation *bus) {
+    char fareText[MONEY_TEXT_LENGTH], departureTime[TIME_LENGTH], arrivalTime[TIME_LENGTH];
+    formatTime(bus->departureMinute, departureTime);
+    formatTime(bus->arrivalMinute, arrivalTime);
+    fprintf(file, "%d,%s,%s,%s,%s,%s,%s,%d,%d,%s\n",
+            bus->busID, stringText(bus->busNumberPlate), bus->date,
+            stringText(bus->source), stringText(bus->destination),
+            departureTime, arrivalTime,
+            bus->totalSeats, bus->availableSeats, formatMoney(bus->fare, fareText));
+}
 
+// Function to write every saved bus in buses.txt format
+void writeBusFile(FILE *file, const struct BusReservation buses[], int busCount) {
     // Iterate through the list of buses and write their details to the file
     for (int i = 0; i < busCount; i++) {
-        fprintf(file, "%d,%s,%s,%s,%s,%s,%s,%d,%d,%.2f\n",
-                buses[i].busID, buses[i].busNumberPlate, buses[i].date,
-                buses[i].source, buses[i].destination,
-                buses[i].departureTime, buses[i].arrivalTime,
-                buses[i].totalSeats, buses[i].availableSeats, buses[i].fare);
+        if (!shouldPersistBus(&buses[i])) continue; // Unbooked template trips are rebuilt on demand
+        writeBusLine(file, &buses[i]);
     }
+}
 
-    fclose(file); // Close the file after writing
+// Function to save all bus schedules, replacing buses.txt only once the new file is on disk
+void saveBuses(const struct BusReservation buses[], int busCount) {
+    if (pendingSeatChanges > 0 || dirtyBusSlotCount > 0) {
+        saveSchedule(buses, busCount); // Logged seat changes must be folded into both files together
+        return;
+    }
+    struct DurableFile out;
+    if (!beginDurableWrite(&out, "buses.txt", 1)) return;
+    writeBusFile(out.file, buses, busCount);
+    commitDurableWrite(&out);
 }
 
-int loadSeats(struct BusReservation buses[], int maxBuses) {
-    FILE *file = fopen("seats.txt", "r"); // Open the seats file in read mode
-    if (!file) return 0; // Return 0 if file cannot be opened
+// Function to save buses.txt and seats.txt together; their lines are matched by position,
+// so after a crash both files are either old or new, never one of each.
+// The new files hold every logged seat change, so seat_changes.txt is emptied in the same step.
+int saveSchedule(const struct BusReservation buses[], int busCount) {
+    struct DurableFile files[3];
+    if (!beginScheduleWrite(files, buses, busCount)) return 0;
+    if (!commitDurableWrites(files, 3)) return 0;
+    clearSeatChanges();
+    return 1;
+}
 
-    int count = 0; // Tracks number of buses loaded
+// Function to write buses.txt, seats.txt and an empty seat_changes.txt into files[0..2] without
+// committing them, so a caller can commit other files in the same step. Returns 0 if nothing was written.
+int beginScheduleWrite(struct DurableFile files[], const struct BusReservation buses[], int busCount) {
+    if (!beginDurableWrite(&files[0], "buses.txt", 1)) return 0;
+    if (!beginDurableWrite(&files[1], "seats.txt", 1)) {
+        abortDurableWrite(&files[0]);
+        return 0;
+    }
+    if (!beginDurableWrite(&files[2], SEAT_CHANGES_FILE, 0)) {
+        abortDurableWrite(&files[0]);
+        abortDurableWrite(&files[1]);
+        return 0;
+    }
+    writeBusFile(files[0].file, buses, busCount);
+    writeSeatFile(files[1].file, buses, busCount);
+    return 1;
+}
+
+// Function to forget the logged seat changes once a saved schedule holds all of them
+void clearSeatChanges() {
+    for (int i = 0; i < dirtyBusSlotCount; i++) {
+        busSlotDirty[dirtyBusSlots[i]] = 0;
+    }
+    dirtyBusSlotCount = 0;
+    pendingSeatChanges = 0;
+}
+
+// Function to remember that a bus's seats changed, so the next save writes it
+void markBusDirty(int slot) {
+    markPriceStale(&priceTable, slot); // Its load factor moved
+    if (slot < 0 || slot >= MAX_BUSES || busSlotDirty[slot]) return;
+    busSlotDirty[slot] = 1;
+    dirtyBusSlots[dirtyBusSlotCount++] = slot;
+}
+
+// Function to find the slot of a bus; its booking detail sits at the same slot
+int busSlotOf(const struct BusReservation *bus) {
+    return (int)(bus->detail - busBookings);
+}
+
+// Function to bring the published seat prices up to date. On a new day every trip is repriced in
+// one batch, because days to departure moved for all of them; otherwise only the trips whose seats,
+// fare or date changed since the last refresh are.
+void refreshSeatPrices(const struct BusReservation buses[], int busCount) {
+    int today = currentDepartureKey() / MINUTES_PER_DAY;
+    int full = priceTable.pricedDay != today;
+    int count = full ? busCount : priceTable.staleCount;
+    if (count == 0) {
+        if (full) priceTable.pricedDay = today;
+        return;
+    }
+
+    // Gather the inputs column by column for the batch, in the command's arena
+    struct RequestArena *arena = requestArena();
+    money_t *fares = arenaAlloc(arena, (size_t)count, sizeof(money_t));
+    money_t *prices = arenaAlloc(arena, (size_t)count, sizeof(money_t));
+    int *available = arenaAlloc(arena, (size_t)count, sizeof(int));
+    int *total = arenaAlloc(arena, (size_t)count, sizeof(int));
+    int *departureDays = arenaAlloc(arena, (size_t)count, sizeof(int));
+    if (!fares || !prices || !available || !total || !departureDays) return; // Prices stay as they were
+    for (int i = 0; i < count; i++) {
+        const struct BusReservation *bus = &buses[full ? i : priceTable.staleSlots[i]];
+        fares[i] = bus->fare;
+        available[i] = bus->availableSeats;
+        total[i] = bus->totalSeats;
+        departureDays[i] = bus->departureDay;
+    }
+
+    if (full) {
+        money_t *next = beginRepricing(&priceTable);
+        priceTrips(&pricingTiers, fares, available, total, departureDays, today, count, next);
+        publishPrices(&priceTable, next, today);
+        return;
+    }
 
-    // Read bus seat data from the file while space is available in array
-    while (fscanf(file, "%d,%d", &buses[count].busID, &buses[count].reservedCount) == 2) {
-        // Read the reserved seat numbers for the bus
-        for (int i = 0; i < buses[count].reservedCount; i++) {
-            fscanf(file, ",%d", &buses[count].reservedSeats[i]);
+    priceTrips(&pricingTiers, fares, available, total, departureDays, today, count, prices);
+    for (int i = 0; i < count; i++) {
+        setSeatPrice(&priceTable, priceTable.staleSlots[i], prices[i]);
+    }
+    clearStalePrices(&priceTable);
+}
+
+// Function to save the seats of the changed buses only, as one line each appended to seat_changes.txt:
+// availableSeats followed by the bus's seats.txt line (availableSeats,busID,reservedCount,seat,seat,...).
+// A booking then costs one small write whatever the size of the fleet. Every SEAT_CHANGE_CHECKPOINT
+// lines the changes are folded into buses.txt and seats.txt and the log starts again.
+int saveSeatChanges(const struct BusReservation buses[], int busCount) {
+    if (dirtyBusSlotCount == 0) return 1;
+
+    FILE *file = fopen(SEAT_CHANGES_FILE, "a");
+    if (!file) return saveSchedule(buses, busCount); // Save everything the slow way instead
+
+    for (int i = 0; i < dirtyBusSlotCount; i++) {
+        const struct BusReservation *bus = &buses[dirtyBusSlots[i]];
+        fprintf(file, "%d,%d,%d", bus->availableSeats, bus->busID, bus->detail->reservedCount);
+        for (int j = 0; j < bus->detail->reservedCount; j++) {
+            fprintf(file, ",%d", bus->detail->reservedSeats[j]);
         }
-        count++; // Increment the count of buses loaded
+        fprintf(file, "\n");
+    }
+    if (!syncAndCloseFile(file)) return saveSchedule(buses, busCount);
 
-        // Stop reading if we reach the maximum allowed buses
-        if (count >= maxBuses) break;
+    pendingSeatChanges += dirtyBusSlotCount;
+    for (int i = 0; i < dirtyBusSlotCount; i++) {
+        busSlotDirty[dirtyBusSlots[i]] = 0;
     }
+    dirtyBusSlotCount = 0;
 
-    fclose(file); // Close the file after reading
-    return count; // Return the number of buses loaded from file
+    if (pendingSeatChanges >= SEAT_CHANGE_CHECKPOINT) {
+        return saveSchedule(buses, busCount); // Checkpoint
+    }
+    return 1;
 }
 
-void saveSeats(struct BusReservation buses[], int busCount) {
-    FILE *file = fopen("seats.txt", "w"); // Open the file in write mode
-    if (!file) {
-        printf("Error opening seats.txt for writing!\n");
-        return; // Exit the function if the file cannot be opened
+// Function to apply seat_changes.txt on top of buses.txt and seats.txt after they are loaded.
+// Each line holds a bus's whole seat state, so the last line for a bus wins.
+int loadSeatChanges(struct BusReservation buses[], int busCount) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, SEAT_CHANGES_FILE)) return 0; // Nothing logged
+
+    struct StringView line;
+    struct SeatRecord record;
+    int seats[MAX_SEATS];
+    int count = 0;
+    while (readRecordLine(&reader, &line)) {
+        // availableSeats, then the rest of the line is in seats.txt format
+        const char *comma = memchr(line.data, ',', (size_t)line.length);
+        if (!comma) continue;
+        struct StringView availableField = { line.data, (int)(comma - line.data) };
+        struct StringView seatLine = { comma + 1, line.length - availableField.length - 1 };
+        int availableSeats;
+        if (!parseIntView(availableField, &availableSeats) || !parseSeatRecord(seatLine, &record, seats, MAX_SEATS)) {
+            continue; // Skip malformed lines, such as one cut short by a crash
+        }
+
+        int index = findBusIndex(buses, busCount, record.busID);
+        if (index == -1) continue; // Deleted since; the next checkpoint drops the line
+        buses[index].availableSeats = availableSeats;
+        buses[index].detail->reservedCount = record.reservedCount;
+        memcpy(buses[index].detail->reservedSeats, seats, (size_t)record.reservedCount * sizeof(int));
+        count++;
     }
 
-    // Iterate through each bus and save its seat reservation details
+    closeRecordReader(&reader);
+    return count;
+}
+
+// Function to fold the logged seat changes into buses.txt and seats.txt, at logout and exit
+void checkpointSeatChanges(const struct BusReservation buses[], int busCount) {
+    if (pendingSeatChanges > 0 || dirtyBusSlotCount > 0) {
+        saveSchedule(buses, busCount);
+    }
+}
+
+// Function to start from the snapshot image instead of parsing buses.txt, seats.txt and user.txt.
+// The image is used only if none of those files changed since it was written; the schedules,
+// booking detail and users are copied out of one mapping and the detail pointers are fixed up.
+// The interned strings are restored first, so the plates and cities in the image keep their IDs.
+// The ticket index comes back with how far it had read reservation.txt, so the first ticket
+// lookup reads only the reservations added since. The reports keep no running totals between
+// views (each one is summed from the journals and the archive), so there are none to restore.
+int loadStateSnapshot(struct BusReservation buses[], int *busCount) {
+    struct MappedSnapshot snapshot;
+    if (!mapSnapshot(STATE_SNAPSHOT_FILE, &snapshot)) return 0;
+
+    // Sections: schedules, their booking detail, users, interned strings, ticket entries,
+    // ticket seat numbers, and how far the ticket index had read reservation.txt
+    const struct SnapshotSection *sections = snapshot.sections;
+    int usable = snapshot.sourceCount == SNAPSHOT_SOURCE_COUNT && snapshot.sectionCount == 7 &&
+                 sections[0].elementSize == (int)sizeof(struct BusReservation) && sections[0].count <= MAX_BUSES &&
+                 sections[1].elementSize == (int)sizeof(struct BusBookings) && sections[1].count == sections[0].count &&
+                 sections[2].elementSize == (int)sizeof(struct user) && sections[2].count <= MAX_USERS &&
+                 sections[3].elementSize == 1 &&
+                 sections[4].elementSize == (int)sizeof(struct TicketEntry) &&
+                 sections[5].elementSize == (int)sizeof(int) &&
+                 sections[6].elementSize == (int)sizeof(struct JournalReplay) && sections[6].count == 1;
+    struct FileFingerprint current[SNAPSHOT_SOURCE_COUNT];
+    for (int i = 0; usable && i < SNAPSHOT_SOURCE_COUNT; i++) {
+        usable = fingerprintFile(snapshotSourceFiles[i], &current[i]) && sameFingerprint(&current[i], &snapshot.sources[i]);
+    }
+    usable = usable && importInternedStrings(sections[3].data, sections[3].count);
+    if (!usable) { // Out of date or from another build; the text files are parsed instead
+        unmapSnapshot(&snapshot);
+        return 0;
+    }
+
+    *busCount = sections[0].count;
+    memcpy(buses, sections[0].data, (size_t)*busCount * sizeof(struct BusReservation));
+    attachBusBookings(buses, MAX_BUSES); // The pointers in the image are from the process that wrote it
+    memcpy(busBookings, sections[1].data, (size_t)*busCount * sizeof(struct BusBookings));
+    userCount = sections[2].count;
+    memcpy(users, sections[2].data, (size_t)userCount * sizeof(struct user));
+
+    // syncTicketIndex() replays the tail of reservation.txt, or rebuilds if it was rewritten since
+    memcpy(&savedSnapshotTickets, sections[6].data, sizeof(savedSnapshotTickets));
+    if (restoreTicketIndex(&ticketIndex, sections[4].data, sections[4].count, sections[5].data, sections[5].count)) {
+        ticketReplay = savedSnapshotTickets;
+    }
+    unmapSnapshot(&snapshot);
+
+    memcpy(savedSnapshotSources, current, sizeof(current));
+    return 1;
+}
+
+// Function to write the snapshot image at logout and exit. It holds what a start from the text
+// files would load (deleted slots and unbooked template trips are left out, as in buses.txt).
+void saveStateSnapshot(const struct BusReservation buses[], int busCount) {
+    if (durableWriteFailureCount() > 0) return; // Memory may hold changes the files do not
+    if (pendingSeatChanges > 0 || dirtyBusSlotCount > 0) return; // Taken only right after a checkpoint
+
+    struct FileFingerprint sources[SNAPSHOT_SOURCE_COUNT];
+    int unchanged = 1;
+    for (int i = 0; i < SNAPSHOT_SOURCE_COUNT; i++) {
+        if (!fingerprintFile(snapshotSourceFiles[i], &sources[i])) return; // A missing file is reported by the text load
+        unchanged = unchanged && sameFingerprint(&sources[i], &savedSnapshotSources[i]);
+    }
+
+    // The ticket index goes in read to the end of reservation.txt, or empty if it cannot be read
+    struct JournalReplay tickets = { { 0 }, 0 };
+    if (syncTicketIndex()) tickets = ticketReplay;
+    unchanged = unchanged && sameFingerprint(&tickets.source, &savedSnapshotTickets.source) &&
+                tickets.replayedBytes == savedSnapshotTickets.replayedBytes;
+    if (unchanged) return; // The image on disk is still current
+
+    // Keep the saved buses in file order, with their detail beside them
+    struct BusReservation *kept = malloc(MAX_BUSES * sizeof(*kept));
+    struct BusBookings *keptBookings = malloc(MAX_BUSES * sizeof(*keptBookings));
+    if (!kept || !keptBookings) {
+        free(kept);
+        free(keptBookings);
+        return;
+    }
+    int keptCount = 0;
     for (int i = 0; i < busCount; i++) {
-        fprintf(file, "%d,%d", buses[i].busID, buses[i].reservedCount); // Write bus ID and reserved count
+        if (!shouldPersistBus(&buses[i])) continue;
+        kept[keptCount] = buses[i];
+        keptBookings[keptCount++] = *buses[i].detail;
+    }
+
+    // The schedules hold string IDs, so every interned string goes in with them, in ID order
+    char *stringPool = NULL;
+    long stringBytes = exportInternedStrings(&stringPool);
+    if (stringBytes < 0) {
+        free(stringPool);
+        free(kept);
+        free(keptBookings);
+        return;
+    }
 
-        // Write each reserved seat number to the file
-        for (int j = 0; j < buses[i].reservedCount; j++) {
-            fprintf(file, ",%d", buses[i].reservedSeats[j]);
+    int ticketCount = tickets.replayedBytes > 0 ? ticketIndex.count : 0;
+    struct SnapshotSection sections[7] = {
+        { kept, (int)sizeof(struct BusReservation), keptCount },
+        { keptBookings, (int)sizeof(struct BusBookings), keptCount },
+        { users, (int)sizeof(struct user), userCount },
+        { stringPool, 1, (int)stringBytes },
+        { ticketIndex.entries, (int)sizeof(struct TicketEntry), ticketCount },
+        { ticketIndex.seats, (int)sizeof(int), ticketCount ? ticketIndex.seatCount : 0 },
+        { &tickets, (int)sizeof(struct JournalReplay), 1 },
+    };
+    if (writeSnapshot(STATE_SNAPSHOT_FILE, sources, SNAPSHOT_SOURCE_COUNT, sections, 7)) {
+        memcpy(savedSnapshotSources, sources, sizeof(sources));
+        savedSnapshotTickets = tickets;
+    }
+    free(stringPool);
+    free(kept);
+    free(keptBookings);
+}
+
+// Function to import many trips from a CSV file at once; either every trip is added or none is
+void importBusSchedules(struct BusReservation buses[], int *busCount) {
+    char filename[MAX_IMPORT_PATH];
+    printf("\nEnter CSV file to import (busID,plate,date,source,destination,departure,arrival,totalSeats,fare): ");
+    scanf("%255s", filename);
+
+    // Parse and validate every line in parallel
+    struct ScheduleImport import;
+    if (!loadScheduleImport(filename, &import)) return;
+
+    // Bus IDs must also be new to the live schedule
+    int existingIDs[MAX_BUSES];
+    for (int i = 0; i < *busCount; i++) {
+        existingIDs[i] = buses[i].busID;
+    }
+    qsort(existingIDs, (size_t)*busCount, sizeof(int), compareInts);
+    checkImportAgainstExisting(&import, existingIDs, *busCount);
+
+    if (import.errorCount > 0) {
+        printf("Import rejected: %d problem(s) found, nothing was changed.\n", import.errorCount);
+        for (int i = 0; i < import.errorCount && i < MAX_IMPORT_ERRORS; i++) {
+            printf("  Line %d: %s\n", import.errorLines[i], import.errorReasons[i]);
         }
-        fprintf(file, "\n"); // Move to the next line for the next bus
+        freeScheduleImport(&import);
+        return;
+    }
+    if (*busCount + import.tripCount > MAX_BUSES) {
+        printf("Import rejected: %d trip(s) would exceed the limit of %d buses, nothing was changed.\n",
+               import.tripCount, MAX_BUSES);
+        freeScheduleImport(&import);
+        return;
     }
 
-    fclose(file); // Close the file after writing
+    // Build the new trips after the current ones; they only count once the files are swapped in
+    for (int i = 0; i < import.tripCount; i++) {
+        const struct ImportedTrip *trip = &import.trips[i];
+        struct BusReservation *bus = &buses[*busCount + i];
+
+        resetBusSlot(bus); // No reservations, bookings or report totals yet
+        bus->busID = trip->busID;
+        bus->busNumberPlate = internFieldText(trip->busNumberPlate, PLATE_LENGTH);
+        formatDate(trip->departureDay, bus->date);
+        bus->source = internFieldText(trip->source, CITY_LENGTH);
+        bus->destination = internFieldText(trip->destination, CITY_LENGTH);
+        bus->departureDay = trip->departureDay;
+        bus->departureMinute = trip->departureMinute;
+        bus->arrivalMinute = trip->arrivalMinute;
+        bus->totalSeats = trip->totalSeats;
+        bus->availableSeats = trip->totalSeats;
+        bus->fare = trip->fare;
+    }
+    int newCount = *busCount + import.tripCount;
+    int imported = import.tripCount;
+    freeScheduleImport(&import);
+
+    // Write both files completely, then swap them in together so they can never disagree
+    if (!saveSchedule(buses, newCount)) {
+        printf("Import failed while saving, nothing was changed.\n");
+        return; // busCount is unchanged, so the new slots are ignored
+    }
+
+    // The files now hold the new trips; make them live and index them
+    *busCount = newCount;
+    rebuildDepartureIndex(buses, *busCount);
+    invalidatePrices(&priceTable); // Price the new trips along with the rest
+    printf("%d trip(s) imported successfully!\n", imported);
+}
+
+// Function to compare two integers for qsort
+int compareInts(const void *a, const void *b) {
+    int left = *(const int *)a, right = *(const int *)b;
+    return (left > right) - (left < right);
 }
 
-void showSeats(struct BusReservation bus) {
-    int reservedSeats[MAX_SEATS] = {0}; // Initialize an array to track reserved seats
+// Function to parse a bus's date and the given times into numbers; only the numbers are kept,
+// so "8:00pm" is shown and saved as "08:00PM"
+int parseScheduleTimes(struct BusReservation *bus, const char *departureTime, const char *arrivalTime) {
+    struct StringView date = { bus->date, (int)strlen(bus->date) };
+    struct StringView departure = { departureTime, (int)strlen(departureTime) };
+    struct StringView arrival = { arrivalTime, (int)strlen(arrivalTime) };
+    int day, departureMinute, arrivalMinute;
 
-    // Mark the reserved seats in the array
-    for (int i = 0; i < bus.reservedCount; i++) {
-        reservedSeats[bus.reservedSeats[i] - 1] = 1; // Mark the seat as reserved
+    if (!parseDateView(date, &day) || !parseTimeView(departure, &departureMinute) ||
+        !parseTimeView(arrival, &arrivalMinute)) {
+        return 0; // Leave the bus unchanged
     }
 
-    printf("\nSeats Layout (Available in Green, Reserved in Red):\n");
+    bus->departureDay = day;
+    bus->departureMinute = departureMinute;
+    bus->arrivalMinute = arrivalMinute;              // An arrival before departure means the next day
+    return 1;
+}
+
+// Function to get a bus's departure as minutes since 1970-01-01
+int departureKey(const struct BusReservation *bus) {
+    return bus->departureDay * MINUTES_PER_DAY + bus->departureMinute;
+}
 
-    // Display seat numbers with color coding for availability
-    for (int i = 0; i < bus.totalSeats; i++) {
-        if (reservedSeats[i]) {
-            printf("\033[0;31m[%2d]\033[0m ", i + 1); // Reserved seats in red
-        } else {
-            printf("\033[0;32m[%2d]\033[0m ", i + 1); // Available seats in green
+// Function to order buses by departure time for qsort
+int compareDepartures(const void *a, const void *b) {
+    int keyA = departureKey((const struct BusReservation *)a);
+    int keyB = departureKey((const struct BusReservation *)b);
+    return (keyA > keyB) - (keyA < keyB);
+}
+
+// Function to rebuild the departure index after buses are loaded, moved or removed
+void rebuildDepartureIndex(const struct BusReservation buses[], int busCount) {
+    int keys[MAX_BUSES];
+    for (int i = 0; i < busCount && i < MAX_BUSES; i++) {
+        keys[i] = isFreeBusSlot(&buses[i]) ? -1 : departureKey(&buses[i]); // Free slots are left out
+    }
+    buildDepartureIndex(&departureIndex, keys, busCount);
+}
+
+// Function to list the next departures from a city at or after a given date and time
+void showNextDepartures(const struct BusReservation buses[], int busCount) {
+    char source[50], dateText[20], timeText[20];
+    int limit, day, minute;
+
+    printf("Enter Source: ");
+    scanf("%49s", source);
+    printf("Enter Date (YYYY-MM-DD): ");
+    scanf("%19s", dateText);
+    printf("Enter Time (HH:MMAM/PM): ");
+    scanf("%19s", timeText);
+    printf("How many departures to show: ");
+    if (scanf("%d", &limit) != 1 || limit < 1) {
+        printf("Invalid number!\n");
+        while (getchar() != '\n'); // Clear invalid input
+        return;
+    }
+
+    struct StringView dateView = { dateText, (int)strlen(dateText) };
+    struct StringView timeView = { timeText, (int)strlen(timeText) };
+    if (!parseDateView(dateView, &day) || !parseTimeView(timeView, &minute)) {
+        printf("Error: Invalid date or time! Use YYYY-MM-DD and HH:MMAM/PM.\n");
+        return;
+    }
+
+    // Upcoming trips of recurring schedules from this city are listed as temporary rows, in departure order
+    int today = currentDepartureKey() / MINUTES_PER_DAY;
+    int maxTrips = templateCount * TEMPLATE_SEARCH_DAYS;
+    struct BusReservation *trips = arenaAlloc(requestArena(), (size_t)maxTrips, sizeof(struct BusReservation));
+    int tripCount = trips ? listTemplateTrips(buses, busCount, source, NULL, day > today ? day : today, TEMPLATE_SEARCH_DAYS, trips, maxTrips) : 0;
+    if (tripCount > 1) qsort(trips, (size_t)tripCount, sizeof(struct BusReservation), compareDepartures);
+
+    struct OutputBuffer *out = beginFrame();
+    appendOutput(out, "\n--- Next departures from %s ---\n", source);
+    appendBusHeader(out);
+
+    // Jump straight to the first departure at or after the requested time, then walk forward in time order,
+    // merging the listed template trips in as their departures come up
+    int fromKey = day * MINUTES_PER_DAY + minute;
+    string_id wantedSource = findString(source, 1); // Looked up only; NO_STRING if no bus leaves from there
+    int next = 0; // Next listed template trip
+    while (next < tripCount && departureKey(&trips[next]) < fromKey) next++;
+    int shown = 0;
+    int i = wantedSource != NO_STRING ? findFirstDeparture(&departureIndex, fromKey) : departureIndex.count;
+    while (shown < limit && (i < departureIndex.count || next < tripCount)) {
+        if (next < tripCount && (i == departureIndex.count || departureKey(&trips[next]) < departureIndex.entries[i].key)) {
+            appendPricedBusRow(out, &trips[next], listedTripPrice(&trips[next]));
+            next++;
+            shown++;
+            continue;
+        }
+        int slot = departureIndex.entries[i++].slot;
+        if (slot < busCount && foldedString(buses[slot].source) == wantedSource) {
+            appendBusRow(out, &buses[slot]);
+            shown++;
         }
+    }
+    appendBusTableEnd(out);
+
+    if (!shown) {
+        appendOutput(out, "\nNo departures from %s after that time.\n", source);
+    }
+    emitFrame();
+}
+
+// Function to move trips that have already departed from buses.txt and seats.txt to bus_history.txt
+void purgePastTrips(struct BusReservation buses[], int *busCount) {
+    // Every index entry before the current time has already departed
+    int pastCount = findFirstDeparture(&departureIndex, currentDepartureKey());
+    if (pastCount == 0) {
+        printf("No past trips to purge.\n");
+        archivePastTravel(buses, *busCount); // Trips purged earlier may have left in a month now over
+        return;
+    }
+
+    char confirm;
+    printf("Purge %d trip(s) that departed before now? (Y/N): ", pastCount);
+    scanf(" %c", &confirm);
+    if (confirm != 'y' && confirm != 'Y') {
+        printf("Purge canceled.\n");
+        return;
+    }
+
+    FILE *history = fopen("bus_history.txt", "a"); // Departed trips are kept, not lost
+    if (!history) {
+        printf("Error: Could not open bus_history.txt for writing.\n");
+        return;
+    }
+
+    int pastSlots[MAX_BUSES];
+    for (int i = 0; i < pastCount; i++) {
+        pastSlots[i] = departureIndex.entries[i].slot;
+        writeBusLine(history, &buses[pastSlots[i]]);
+    }
+    fclose(history);
 
-        // Extra spacing to visually separate seat sections
-        if ((i + 1) % (SEATS_PER_ROW / 2) == 0) {
-            printf("   "); // Adds space between left and right seat sections
+    // Free the purged trips' slots and end their waitlists; the remaining buses stay where they are
+    for (int i = 0; i < pastCount; i++) {
+        closeWaitlist(buses[pastSlots[i]].busID);
+        releaseBusSlot(buses, pastSlots[i]);
+    }
+
+    saveSchedule(buses, *busCount);
+
+    printf("%d past trip(s) moved to bus_history.txt.\n", pastCount);
+    archivePastTravel(buses, *busCount);
+}
+
+// Function to move the reservations and cancellations of purged trips that left before this month
+// into the columnar archive, so the journals keep only this month's and future travel
+void archivePastTravel(const struct BusReservation buses[], int busCount) {
+    int scheduledIDs[MAX_BUSES];
+    int scheduledCount = 0;
+    for (int i = 0; i < busCount; i++) {
+        if (buses[i].busID != FREE_BUS_SLOT) scheduledIDs[scheduledCount++] = buses[i].busID;
+    }
+
+    const char *journals[] = { "reservation.txt", "cancellations.txt" };
+    int partitionCount;
+    int archived = archiveTravelMonths(journals, 2, scheduledIDs, scheduledCount,
+                                       currentDepartureKey() / MINUTES_PER_DAY, &partitionCount);
+    if (archived > 0) {
+        printf("%d booking record(s) of earlier travel months moved to %d archive partition(s).\n", archived, partitionCount);
+    }
+}
+
+// Function to load the reserved seats of the loaded buses from seats.txt. Each line is matched to its
+// bus by ID, not by position, since loadBuses skips rows it cannot use; lines of buses that were not
+// loaded are dropped. Returns the number of buses whose seats were loaded.
+int loadSeats(struct BusReservation buses[], int busCount) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, "seats.txt")) return 0; // Return 0 if file cannot be opened
+
+    int count = 0; // Tracks number of buses loaded
+    struct StringView line;
+    struct SeatRecord record;
+    int seats[MAX_SEATS];
+
+    while (readRecordLine(&reader, &line)) {
+        // Parse the bus ID, reserved count and reserved seat numbers in one pass
+        if (!parseSeatRecord(line, &record, seats, MAX_SEATS)) {
+            continue; // Skip malformed lines
         }
+        int busIndex = findBusIndex(buses, busCount, record.busID);
+        if (busIndex == -1) continue; // No such bus in buses.txt
+        memcpy(buses[busIndex].detail->reservedSeats, seats, (size_t)record.reservedCount * sizeof(int));
+        buses[busIndex].detail->reservedCount = record.reservedCount;
+        count++; // Increment the count of buses loaded
+    }
 
-        // Move to the next line after every SEATS_PER_ROW seats
-        if ((i + 1) % SEATS_PER_ROW == 0) {
-            printf("\n");
+    closeRecordReader(&reader); // Close the file after reading
+    return count; // Return the number of buses loaded from file
+}
+
+// Function to write the seat table in seats.txt format to the given file
+void writeSeatFile(FILE *file, const struct BusReservation buses[], int busCount) {
+    // Iterate through each bus and save its seat reservation details
+    for (int i = 0; i < busCount; i++) {
+        if (!shouldPersistBus(&buses[i])) continue; // Same buses as buses.txt, so the lines stay aligned
+        fprintf(file, "%d,%d", buses[i].busID, buses[i].detail->reservedCount); // Write bus ID and reserved count
+
+        // Write each reserved seat number to the file
+        for (int j = 0; j < buses[i].detail->reservedCount; j++) {
+            fprintf(file, ",%d", buses[i].detail->reservedSeats[j]);
         }
+        fprintf(file, "\n"); // Move to the next line for the next bus
+    }
+}
+
+// Function to save the seat table, replacing seats.txt only once the new file is on disk
+void saveSeats(const struct BusReservation buses[], int busCount) {
+    if (pendingSeatChanges > 0 || dirtyBusSlotCount > 0) {
+        saveSchedule(buses, busCount); // Logged seat changes must be folded into both files together
+        return;
     }
-    printf("\n"); // Ensure there's a newline at the end for readability
+    struct DurableFile out;
+    if (!beginDurableWrite(&out, "seats.txt", 1)) return;
+    writeSeatFile(out.file, buses, busCount);
+    commitDurableWrite(&out);
+}
+
+// Function to show a bus's seat map, available seats in green and reserved ones in red
+void showSeats(const struct BusReservation *bus) {
+    struct OutputBuffer *out = beginFrame();
+    appendSeatMap(out, bus->totalSeats, bus->detail->reservedSeats, bus->detail->reservedCount);
+    char priceText[MONEY_TEXT_LENGTH];
+    appendOutput(out, "Price per seat: RM %s (before SST)\n", formatMoney(seatPrice(&priceTable, busSlotOf(bus)), priceText));
+    emitFrame(); // The whole map in one write
 }
 
-void viewAvailability(struct BusReservation buses[], int busCount) {
+void viewAvailability(const struct BusReservation buses[], int busCount) {
     int busID, busIndex = -1; // Initialize variables
     printf("Enter Bus ID to check availability: ");
     scanf("%d", &busID);
 
     // Search for the bus with the given ID
-    for (int i = 0; i < busCount; i++) {
-        if (buses[i].busID == busID) {
-            busIndex = i; // Store the index of the matching bus
-            break;
-        }
-    }
+    busIndex = findBusIndex(buses, busCount, busID);
 
     if (busIndex == -1) {
         printf("Error: Bus ID not found!\n"); // Notify user if bus doesn't exist
     } else {
-        showSeats(buses[busIndex]); // Display seat availability for the found bus
+        showSeats(&buses[busIndex]); // Display seat availability for the found bus
     }
 }
 
-float calculateFare(int numSeats, float farePerSeat) {
-    float tripFare = numSeats * farePerSeat; // Calculate the total base fare for the seats.
-    float sst = tripFare * SST_RATE;        // Compute SST (Sales & Services Tax).
-    float finalAmount = tripFare + sst;     // Add SST to the base fare to get the final price.
+money_t calculateFare(int numSeats, money_t farePerSeat) {
+    money_t tripFare = numSeats * farePerSeat; // Calculate the total base fare for the seats.
+    money_t sst = calculateSST(tripFare);      // Compute SST (Sales & Services Tax), rounded to the sen.
+    money_t finalAmount = tripFare + sst;      // Add SST to the base fare to get the final price.
 
     return finalAmount; // Return the total fare amount including tax.
 }
@@ -869,9 +2122,17 @@ int bookSeat(struct user currentUser, struct BusReservation *bus, int seatNumber
         return 0; // Exit if invalid input is provided.
     }
 
+    // Seats freed since the last offer go to the waitlist first; seats held for other
+    // waitlisted customers are not on sale.
+    offerSeatsToWaitlist(bus);
+    int heldForOthers = heldSeatsForOthers(bus->busID, currentUser.username, time(NULL));
+
     // Check if there are enough available seats for the booking.
-    if (*numSeats > bus->availableSeats) {
+    if (*numSeats > bus->availableSeats - heldForOthers) {
         printf("Error: Not enough available seats!\n");
+        if (askToJoinWaitlist(currentUser, bus, *numSeats)) {
+            return BOOKING_WAITLISTED; // Waiting for seats on this trip instead
+        }
         return 0; // Exit if not enough seats are available.
     }
 
@@ -886,8 +2147,8 @@ int bookSeat(struct user currentUser, struct BusReservation *bus, int seatNumber
         }
 
         // Check if the selected seat is already reserved.
-        for (int j = 0; j < bus->reservedCount; j++) {
-            if (bus->reservedSeats[j] == seatNumbers[i]) {
+        for (int j = 0; j < bus->detail->reservedCount; j++) {
+            if (bus->detail->reservedSeats[j] == seatNumbers[i]) {
                 printf("Error: Seat %d is already booked! Try again.\n", seatNumbers[i]);
                 return 0; // Exit if the seat is already taken.
             }
@@ -899,14 +2160,9 @@ int bookSeat(struct user currentUser, struct BusReservation *bus, int seatNumber
 
     // Store the booked seat numbers in the bus reservation record.
     for (int j = 0; j < *numSeats; j++) {
-        bus->reservedSeats[bus->reservedCount++] = seatNumbers[j];  // Mark seat as reserved.
+        bus->detail->reservedSeats[bus->detail->reservedCount++] = seatNumbers[j];  // Mark seat as reserved.
     }
 
-    // Save the ticket number and seat count for this booking.
-    bus->ticketNumbers[bus->bookingCount] = ticketNumber;
-    bus->seatCounts[bus->bookingCount] = *numSeats;
-    bus->bookingCount++;
-
     // Update the available seats count after booking.
     bus->availableSeats -= *numSeats;
 
@@ -940,10 +2196,8 @@ void processBooking(struct user currentUser, struct BusReservation buses[], int
     time(&t);
     strftime(bookingDate, sizeof(bookingDate), "%Y-%m-%d", localtime(&t));
 
-    // Arrays to store booking details for up to 2 trips (for round-trip bookings).
-    int ticketNumbers[2];  // Stores ticket numbers for one-way or round-trip.
-    float totalFares[2];   // Stores fare details for each booked trip.
-    int busIndices[2];     // Stores indices of the selected buses.
+    // Booking details for up to 2 trips (for round-trip bookings).
+    struct BookingTrips trips;
 
     // Loop runs once for one-way, twice for round-trip bookings.
     for (int tripIndex = 0; tripIndex < (tripType == 2 ? 2 : 1); tripIndex++) {
@@ -956,11 +2210,14 @@ void processBooking(struct user currentUser, struct BusReservation buses[], int
         }
 
         // Search for the bus with the given Bus ID in the available buses array.
-        busIndex = -1; // Initialize as -1 (not found)
-        for (int j = 0; j < *busCount; j++) {
-            if (buses[j].busID == busID) {
-                busIndex = j; // Store index if bus is found
-                break;
+        busIndex = findBusIndex(buses, *busCount, busID);
+
+        // A recurring schedule's trip may not have been created yet, so create it on first booking
+        if (busIndex == -1) {
+            int travelDay;
+            int templateIndex = findTemplateTrip(templates, templateCount, busID, &travelDay);
+            if (templateIndex != -1) {
+                busIndex = materializeTemplateTrip(buses, busCount, &templates[templateIndex], travelDay);
             }
         }
 
@@ -971,16 +2228,21 @@ void processBooking(struct user currentUser, struct BusReservation buses[], int
         }
 
         // Store the bus index for finalizing the booking later.
-        busIndices[tripIndex] = busIndex;
+        trips.busIndices[tripIndex] = busIndex;
 
         // Display available seats for the selected bus.
-        showSeats(buses[busIndex]);
+        showSeats(&buses[busIndex]);
 
         // Attempt to book seats for the selected bus.
         int seatNumbers[MAX_SEATS], numSeats;
-        if (bookSeat(currentUser, &buses[busIndex], seatNumbers, &numSeats) > 0) {
+        int booked = bookSeat(currentUser, &buses[busIndex], seatNumbers, &numSeats);
+        if (booked > 0) {
             // If seat booking is successful, finalize the booking process.
-            finalizeBooking(currentUser, buses, *busCount, busIndex, numSeats, seatNumbers,bookingDate, tripIndex, tripType, ticketNumbers, totalFares, busIndices);
+            finalizeBooking(currentUser, buses, *busCount, busIndex, numSeats, seatNumbers,bookingDate, tripIndex, tripType, &trips);
+        } else if (booked == BOOKING_WAITLISTED && tripIndex == 0) {
+            // Nothing is booked yet, so the customer can leave and wait for the notification
+            printf("Booking ended. You will be notified when seats are held for you.\n");
+            return;
         } else {
             // If no seats were successfully booked, allow the user to retry.
             printf("No seats booked. Please try again.\n");
@@ -989,8 +2251,10 @@ void processBooking(struct user currentUser, struct BusReservation buses[], int
     }
 }
 
-void processPayment(float totalFare) {
+int processPayment(money_t totalFare) {
     int paymentMethod, walletChoice;
+    char amountText[MONEY_TEXT_LENGTH];
+    formatMoney(totalFare, amountText); // Format the amount once for every message below
     int valid = 0; // Flag to check if payment was successful
 
     do {
@@ -1012,7 +2276,7 @@ void processPayment(float totalFare) {
                 }
 
                 valid = 1; // Mark payment as successful
-                printf("Payment of RM %.2f completed via Credit/Debit Card.\n", totalFare);
+                printf("Payment of RM %s completed via Credit/Debit Card.\n", amountText);
                 break;
             }
             case 2: { // Digital Wallet Payment
@@ -1032,7 +2296,7 @@ void processPayment(float totalFare) {
                 // Simulating processing of payment
                 printf("Processing Digital Wallet payment...\n");
                 valid = 1; // Mark payment as successful
-                printf("Payment of RM %.2f completed via ", totalFare);
+                printf("Payment of RM %s completed via ", amountText);
 
                 // Display payment confirmation based on selected wallet
                 switch (walletChoice) {
@@ -1044,7 +2308,7 @@ void processPayment(float totalFare) {
             }
             case 3: // Cancel Payment Option
                 printf("Payment canceled.\n");
-                return; // Exit the function
+                return 0; // Exit the function, nothing paid
             default:
                 printf("Invalid choice. Try again.\n");
         }
@@ -1054,91 +2318,136 @@ void processPayment(float totalFare) {
     printf("\nPayment Successful\n");
     printf("Generating receipt...\n");
     printf("=================================\n");
-    printf(" Total Paid: RM %.2f\n", totalFare);
+    printf(" Total Paid: RM %s\n", amountText);
     printf(" Payment Method: %s\n",
            (paymentMethod == 1) ? "Credit/Debit Card" :
            (walletChoice == 1) ? "Touch 'n Go eWallet" :
            (walletChoice == 2) ? "GrabPay" : "ShopeePay");
     printf(" Thank you for your booking!\n");
     printf("=================================\n");
+    return 1;
 }
 
-void viewBookingHistory(struct user currentUser) {
-    FILE *file = fopen("reservation.txt", "r"); // Open reservation file in read mode
-    if (!file) {
+// Function to view a user's past bookings, newest first, a page at a time.
+// The user's bookings come from the cached booking history, so only the lines shown are read,
+// and each one is joined with its trip's route and departure. Bookings of archived travel months
+// are older than any in the journal, so they make up the last pages.
+void viewBookingHistory(struct user currentUser, const struct BusReservation buses[], int busCount) {
+    struct BookingHistory *history = getBookingHistory(currentUser.username);
+    struct RecordReader reader;
+    if (!history || !openRecordReader(&reader, "reservation.txt")) { // Open reservation file in read mode
         printf("Error: Could not open reservation file!\n");
         return; // Exit function if file is not found
     }
 
-    char username[50];         // Stores username from file
-    int ticketNumber, busID, numSeats;
-    char busPlateNumber[20], date[20]; // Stores bus details
-    int seatNumbers[10];       // Assumption: Max 10 seats per booking
-    float finalAmount;
-    int found = 0;             // Flag to track if user has any bookings
-
-    // Display header for booking history
-    printf("\n===========================================\n");
-    printf("         Booking History - %s\n", currentUser.username);
-    printf("===========================================\n");
+    struct ReservationRecord *archived; // Bookings of archived travel months, oldest first
+    int archivedCount = loadArchivedBookings(currentUser.username, &archived);
+    if (archivedCount < 0) {
+        printf("Warning: Archived bookings could not be read; only recent travel is shown.\n");
+        archivedCount = 0;
+    }
 
-    // Read each booking entry from file
-    while (fscanf(file, "%49[^,],%d,%d,%19[^,],%19[^,],%d,",
-                  username, &ticketNumber, &busID, busPlateNumber, date, &numSeats) == 6) {
-        // Check if the record belongs to the current user
-        if (strcmp(username, currentUser.username) == 0) {
-            found = 1; // Mark that at least one booking was found
+    struct StringView line;            // Current reservation line
+    struct ReservationRecord record;   // Parsed reservation fields
+    char amountText[MONEY_TEXT_LENGTH]; // Formatted amount paid
+    int bookingCount = archivedCount + history->count; // Archived bookings, then the journal's
+    int pageCount = (bookingCount + HISTORY_PAGE_SIZE - 1) / HISTORY_PAGE_SIZE;
+    int page = 0;                      // Current page, counted from 0 (newest bookings)
+    char command = 'N';
 
-            // Read seat numbers for the booking
-            for (int i = 0; i < numSeats; i++) {
-                fscanf(file, "%d,", &seatNumbers[i]);
+    while (command != 'Q') {
+        // Display header for booking history
+        printf("\n===========================================\n");
+        printf("         Booking History - %s\n", currentUser.username);
+        if (pageCount > 1) {
+            printf("         Page %d of %d (newest first)\n", page + 1, pageCount);
+        }
+        printf("===========================================\n");
+
+        // Show this page's bookings, newest first
+        int first = bookingCount - 1 - page * HISTORY_PAGE_SIZE;
+        for (int i = first; i >= 0 && i > first - HISTORY_PAGE_SIZE; i--) {
+            if (i < archivedCount) {
+                record = archived[i];
+            } else if (!seekRecordReader(&reader, history->offsets[i - archivedCount]) ||
+                       !readRecordLine(&reader, &line) || !parseReservationRecord(line, &record)) {
+                continue; // Skip a line that cannot be read back
             }
-            fscanf(file, "%f\n", &finalAmount); // Read final amount paid
 
             // Display booking details
-            printf("\nBus ID: %d\n", busID);
-            printf("Bus Plate: %s\n", busPlateNumber);
-            printf("Travel Date: %s\n", date);
-            printf("Ticket No: %d\n", ticketNumber);
-            printf("Seats: ");
-            for (int i = 0; i < numSeats; i++) {
-                printf("%d ", seatNumbers[i]); // Print seat numbers
+            printf("\nBus ID: %d\n", record.busID);
+            printf("Bus Plate: %.*s\n", record.busNumberPlate.length, record.busNumberPlate.data);
+            printf("Travel Date: %.*s\n", record.date.length, record.date.data);
+
+            // Join the trip the booking is on; an archived booking's trip has left, and its ID
+            // may have been given to a newer trip
+            int busIndex = i < archivedCount ? -1 : findBusIndex(buses, busCount, record.busID);
+            if (busIndex != -1) {
+                char departureTime[TIME_LENGTH];
+                formatTime(buses[busIndex].departureMinute, departureTime);
+                printf("Route: %s -> %s\n", stringText(buses[busIndex].source), stringText(buses[busIndex].destination));
+                printf("Departure: %s %s\n", buses[busIndex].date, departureTime);
+            } else {
+                printf("Route: (trip no longer scheduled)\n");
             }
-            printf("\nTotal Amount: RM %.2f\n", finalAmount);
+
+            printf("Ticket No: %d\n", record.ticketNumber);
+            printf("Seats: %.*s\n", record.seatList.length, record.seatList.data); // Print seat numbers
+            printf("Total Amount: RM %s\n", formatMoney(record.amount, amountText));
             printf("-------------------------------------------\n");
-        } else {
-            fscanf(file, "%*[^\n]\n"); // Skip the remaining data of unmatched records
         }
-    }
 
-    fclose(file); // Close file after reading
+        if (bookingCount == 0) { // If no bookings were found
+            printf("\nNo booking history found.\n");
+        }
+
+        printf("\n===========================================\n");
+        if (pageCount <= 1) break; // Everything fit on one page
+
+        // Ask what to do next until the answer moves to another page or quits
+        int moved = 0;
+        while (!moved) {
+            printf("[N]ext page (older), [P]revious page (newer), [Q]uit: ");
+            if (scanf(" %c", &command) != 1) {
+                command = 'Q'; // End of input
+            }
+            command = (char)toupper((unsigned char)command);
 
-    if (!found) { // If no bookings were found
-        printf("\nNo booking history found.\n");
+            if (command == 'N') {
+                if (page == pageCount - 1) {
+                    printf("Already on the oldest page.\n");
+                    continue;
+                }
+                page++;
+                moved = 1;
+            } else if (command == 'P') {
+                if (page == 0) {
+                    printf("Already on the newest page.\n");
+                    continue;
+                }
+                page--;
+                moved = 1;
+            } else if (command == 'Q') {
+                moved = 1;
+            } else {
+                printf("Invalid choice!\n");
+            }
+        }
     }
 
-    printf("\n===========================================\n");
+    closeRecordReader(&reader); // Close file after reading
 }
 
-void saveFrequentBooking(struct user currentUser, int busID, char *busNumberPlate, char *bookingDate, char *source, char *destination) {
-    FILE *file = fopen("reservation.txt", "r");
-    if (!file) {
+void saveFrequentBooking(struct user currentUser, int busID, const char *busNumberPlate, char *bookingDate, const char *source, const char *destination) {
+    // Count how many times this user booked the same bus
+    int count = countPlateBookings(currentUser.username, busNumberPlate);
+    if (count < 0) {
         printf("Error: Could not open reservation file!\n");
         return;
     }
 
-    char line[300], username[50], busPlate[20], date[15];
-    int ticketNumber, resBusID, numSeats, count = 0;
-    float fare;
-
-    // Count how many times this user booked the same bus
-    while (fgets(line, sizeof(line), file)) {
-        sscanf(line, "%[^,],%d,%d,%[^,],%[^,],%d,", username, &ticketNumber, &resBusID, busPlate, date, &numSeats);
-        if (strcmp(username, currentUser.username) == 0 && strcmp(busPlate, busNumberPlate) == 0) {
-            count++;
-        }
-    }
-    fclose(file);
+    char line[300];
+    FILE *file;
 
     // If booked 5+ times, check if it's already saved
     if (count >= 5) {
@@ -1175,6 +2484,57 @@ void saveFrequentBooking(struct user currentUser, int busID, char *busNumberPlat
     }
 }
 
+// Function to count a user's reservations on one bus. The counts per plate are kept for the
+// user who booked last and brought up to date from the lines appended to reservation.txt since,
+// so a booking reads its own new line instead of the whole file. Returns -1 if the file is missing.
+int countPlateBookings(const char *username, const char *busNumberPlate) {
+    if (strcmp(plateCountUser, username) != 0) { // Another user: count from the start
+        snprintf(plateCountUser, sizeof(plateCountUser), "%s", username);
+        plateCountReplay.replayedBytes = 0;
+    }
+
+    struct RecordReader reader;
+    int opened = openJournalTail(&reader, "reservation.txt", &plateCountReplay);
+    if (!opened) return -1;
+    if (opened == 2) plateCountSize = 0;
+
+    struct StringView line;
+    struct ReservationRecord record;
+    while (readRecordLine(&reader, &line)) {
+        if (!parseReservationRecord(line, &record) || !viewEquals(record.username, username)) continue;
+        if (record.busNumberPlate.length >= PLATE_LENGTH) continue; // Cannot match a plate
+
+        // Plates are kept as text: a booking only reads reservation.txt, so it adds nothing to the
+        // string dictionary, and a plate that is not interned yet is still counted when it comes back
+        int found = -1;
+        for (int i = 0; i < plateCountSize; i++) {
+            if (viewEquals(record.busNumberPlate, plateCounts[i].busNumberPlate)) {
+                found = i;
+                break;
+            }
+        }
+        if (found == -1) {
+            if (plateCountSize == plateCountCapacity) {
+                int capacity = plateCountCapacity ? plateCountCapacity * 2 : 16;
+                struct PlateBookings *grown = realloc(plateCounts, (size_t)capacity * sizeof(*grown));
+                if (!grown) continue;
+                plateCounts = grown;
+                plateCountCapacity = capacity;
+            }
+            found = plateCountSize++;
+            copyView(record.busNumberPlate, plateCounts[found].busNumberPlate, PLATE_LENGTH);
+            plateCounts[found].count = 0;
+        }
+        plateCounts[found].count++;
+    }
+    closeJournalTail(&reader, &plateCountReplay);
+
+    for (int i = 0; i < plateCountSize; i++) {
+        if (strcmp(plateCounts[i].busNumberPlate, busNumberPlate) == 0) return plateCounts[i].count;
+    }
+    return 0;
+}
+
 int findFrequentBookings(struct user currentUser, char busNumberPlates[][20],char sources[][50], char destinations[][50], int *tripCount) {
     FILE *file = fopen("frequent_bookings.txt", "r");
     if (!file) {
@@ -1227,12 +2587,13 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
         return;  // Exit if the selection is invalid.
     }
 
-    // Declare variables to store the details of the selected frequent trip.
-    char selectedBusNumberPlate[20], selectedSource[50], selectedDestination[50];
-    // Copy the selected bus number plate, source, and destination to the respective variables.
-    strcpy(selectedBusNumberPlate, frequentBusNumberPlates[tripChoice - 1]);
-    strcpy(selectedSource, sources[tripChoice - 1]);
-    strcpy(selectedDestination, destinations[tripChoice - 1]);
+    // Look up the bus number plate, source, and destination of the selected frequent trip once, so
+    // matching a bus against it is three integer comparisons. They are only looked up: text no bus
+    // holds any more is NO_STRING, and then no bus matches.
+    string_id selectedBusNumberPlate = findString(frequentBusNumberPlates[tripChoice - 1], 0);
+    string_id selectedSource = findString(sources[tripChoice - 1], 0);
+    string_id selectedDestination = findString(destinations[tripChoice - 1], 0);
+    int knownTrip = selectedBusNumberPlate != NO_STRING && selectedSource != NO_STRING && selectedDestination != NO_STRING;
 
     // Get the current date for booking.
     time_t t;
@@ -1247,10 +2608,10 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
 
     // Iterate through all buses and find the ones that match the selected bus route (bus number, source, and destination).
     // For each matching bus, add the available travel date to the availableDates array.
-    for (int i = 0; i < busCount; i++) {
-        if (strcmp(buses[i].busNumberPlate, selectedBusNumberPlate) == 0 &&
-            strcmp(buses[i].source, selectedSource) == 0 &&
-            strcmp(buses[i].destination, selectedDestination) == 0) {
+    for (int i = 0; knownTrip && i < busCount; i++) {
+        if (buses[i].busNumberPlate == selectedBusNumberPlate &&
+            buses[i].source == selectedSource &&
+            buses[i].destination == selectedDestination) {
             strcpy(availableDates[dateCount], buses[i].date);  // Add the travel date to the array.
             dateCount++;  // Increment the count of available dates.
         }
@@ -1282,9 +2643,9 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
     // Search for the bus index that matches the selected bus route and travel date.
     int busIndex = -1;
     for (int i = 0; i < busCount; i++) {
-        if (strcmp(buses[i].busNumberPlate, selectedBusNumberPlate) == 0 &&
-            strcmp(buses[i].source, selectedSource) == 0 &&
-            strcmp(buses[i].destination, selectedDestination) == 0 &&
+        if (buses[i].busNumberPlate == selectedBusNumberPlate &&
+            buses[i].source == selectedSource &&
+            buses[i].destination == selectedDestination &&
             strcmp(buses[i].date, travelDate) == 0) {
             busIndex = i;  // Found the matching bus, store its index.
             break;
@@ -1299,19 +2660,17 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
 
     // Now we will display the available seats for the selected bus on the chosen travel date.
     printf("\nAvailable seats for One-Way Trip:\n");
-    showSeats(buses[busIndex]);  // Call the showSeats function to display the available seats.
+    showSeats(&buses[busIndex]);  // Call the showSeats function to display the available seats.
 
     int seatNumbers[MAX_SEATS], numSeats;
-    // Arrays to store booking details for up to 2 trips (for round-trip bookings)
-    int ticketNumbers[2];  // Stores ticket numbers for each trip
-    float totalFares[2];   // Stores fare details for each trip
-    int busIndices[2];     // Stores the indices of selected buses for each trip
+    // Booking details for up to 2 trips (for round-trip bookings)
+    struct BookingTrips trips;
 
 
     // Call the bookSeat function to allow the user to select seats for the one-way trip.
     // If the user successfully books seats, finalize the booking.
     if (bookSeat(currentUser, &buses[busIndex], seatNumbers, &numSeats) > 0) {
-        finalizeBooking(currentUser, buses, busCount, busIndex, numSeats, seatNumbers, bookingDate, 0, 1, ticketNumbers, totalFares, busIndices);  // Finalize the outbound trip booking
+        finalizeBooking(currentUser, buses, busCount, busIndex, numSeats, seatNumbers, bookingDate, 0, 1, &trips);  // Finalize the outbound trip booking
     } else {
         printf("No seats booked for outbound trip.\n");
         return;
@@ -1330,12 +2689,16 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
             printf("\nAvailable Return Dates:\n");
             char returnAvailableDates[MAX_BOOKINGS][11];
             int returnDateCount = 0;
+            string_id returnBusNumberPlate = findString(frequentBusNumberPlates[1], 0);
+            string_id returnSource = findString(destinations[0], 0);
+            string_id returnDestination = findString(sources[0], 0);
+            int knownReturn = returnBusNumberPlate != NO_STRING && returnSource != NO_STRING && returnDestination != NO_STRING;
 
             // Iterate through all buses to find return trips (destination and source are reversed).
-            for (int i = 0; i < busCount; i++) {
-                if (strcmp(buses[i].busNumberPlate, frequentBusNumberPlates[1]) == 0 &&
-                    strcmp(buses[i].source, destinations[0]) == 0 &&
-                    strcmp(buses[i].destination, sources[0]) == 0) {
+            for (int i = 0; knownReturn && i < busCount; i++) {
+                if (buses[i].busNumberPlate == returnBusNumberPlate &&
+                    buses[i].source == returnSource &&
+                    buses[i].destination == returnDestination) {
                     strcpy(returnAvailableDates[returnDateCount], buses[i].date);  // Store return dates.
                     returnDateCount++;  // Increment return date counter.
                 }
@@ -1362,9 +2725,9 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
 
                 // Find the bus index for the return trip based on selected details.
                 for (int i = 0; i < busCount; i++) {
-                    if (strcmp(buses[i].busNumberPlate, frequentBusNumberPlates[1]) == 0 &&
-                        strcmp(buses[i].source, destinations[0]) == 0 &&
-                        strcmp(buses[i].destination, sources[0]) == 0 &&
+                    if (buses[i].busNumberPlate == returnBusNumberPlate &&
+                        buses[i].source == returnSource &&
+                        buses[i].destination == returnDestination &&
                         strcmp(buses[i].date, returnTravelDate) == 0) {
                         returnBusIndex = i;  // Found the return bus, store its index.
                         break;
@@ -1374,13 +2737,13 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
                 // If the return bus is found, display available seats and allow the user to book them.
                 if (returnBusIndex != -1) {
                     printf("\nAvailable seats for Return Trip:\n");
-                    showSeats(buses[returnBusIndex]);  // Show return trip available seats.
+                    showSeats(&buses[returnBusIndex]);  // Show return trip available seats.
 
                     // Declare an array to store return trip seat selections.
                     int returnSeatNumbers[MAX_SEATS], returnNumSeats;
                     // Call the bookSeat function for the return trip.
                     if (bookSeat(currentUser, &buses[returnBusIndex], returnSeatNumbers, &returnNumSeats) > 0) {
-                        finalizeBooking(currentUser, buses, busCount, busIndex, numSeats, seatNumbers,bookingDate, 1, 2, ticketNumbers, totalFares, busIndices);
+                        finalizeBooking(currentUser, buses, busCount, busIndex, numSeats, seatNumbers,bookingDate, 1, 2, &trips);
                     } else {
                         printf("No seats booked for return trip.\n");
                     }
@@ -1394,34 +2757,25 @@ void bookFrequentBooking(struct user currentUser, struct BusReservation buses[],
     }
 }
 
-void finalizeBooking(struct user currentUser, struct BusReservation buses[], int busCount, int busIndex, int numSeats, int seatNumbers[], char *bookingDate, int tripIndex, int totalTrips, int *ticketNumbers, float *totalFares, int *busIndices) {
+void finalizeBooking(struct user currentUser, struct BusReservation buses[], int busCount, int busIndex, int numSeats, int seatNumbers[], char *bookingDate, int tripIndex, int totalTrips, struct BookingTrips *trips) {
     int ticketNumber = generateTicketNumber(); // Generate a new unique ticket number for this booking
-    float baseFare = numSeats * buses[busIndex].fare; // Calculate the base fare for the selected number of seats
-    float sst = baseFare * SST_RATE;  // Compute the 6% Sales & Service Tax (SST) based on the base fare
-    float finalAmount = baseFare + sst; // Calculate the total amount the user needs to pay (base fare + SST)
+    money_t farePerSeat = seatPrice(&priceTable, busIndex); // The price listed to the user in this command
+    money_t finalAmount = calculateFare(numSeats, farePerSeat); // Total the user needs to pay (fare + 6% SST)
 
     // Store the generated ticket number, final amount, and bus index for this trip
-    ticketNumbers[tripIndex] = ticketNumber;
-    totalFares[tripIndex] = finalAmount;
-    busIndices[tripIndex] = busIndex;  // Store bus index for reference
-
-    // Declare an array to store seat counts for each trip
-    static int seatCounts[2];
-    seatCounts[tripIndex] = numSeats;  // Store the number of seats for this trip
-
-    // Declare and allocate memory for seat numbers for each trip
-    static int *seatNumbersForAllTrips[2];
-    seatNumbersForAllTrips[tripIndex] = (int *)malloc(numSeats * sizeof(int));
-
-    if (seatNumbersForAllTrips[tripIndex] == NULL) {
+    trips->ticketNumbers[tripIndex] = ticketNumber;
+    trips->totalFares[tripIndex] = finalAmount;
+    trips->busIndices[tripIndex] = busIndex;  // Store bus index for reference
+    trips->seatCounts[tripIndex] = numSeats;  // Store the number of seats for this trip
+    trips->seatFares[tripIndex] = farePerSeat; // And the price each seat was sold at
+
+    // Keep the seat numbers for this trip in the request arena; they are dropped with the command
+    trips->seatNumbers[tripIndex] = arenaAlloc(requestArena(), (size_t)numSeats, sizeof(int));
+    if (trips->seatNumbers[tripIndex] == NULL) {
         printf("Memory allocation failed for seat numbers.\n");
         return;
     }
-
-    // Copy the seat numbers to the allocated array
-    for (int i = 0; i < numSeats; i++) {
-        seatNumbersForAllTrips[tripIndex][i] = seatNumbers[i];
-    }
+    memcpy(trips->seatNumbers[tripIndex], seatNumbers, (size_t)numSeats * sizeof(int));
 
     // If this is the last trip (i.e., the final booking in case of round trips)
     if (tripIndex == totalTrips - 1) {
@@ -1429,43 +2783,43 @@ void finalizeBooking(struct user currentUser, struct BusReservation buses[], int
         printf("           BOOKING SUMMARY          \n");
         printf("======================================\n");
 
-        float totalPayment = 0; // Variable to accumulate total fare for all trips
+        char baseText[MONEY_TEXT_LENGTH], sstText[MONEY_TEXT_LENGTH], totalText[MONEY_TEXT_LENGTH];
 
         // Loop through all booked trips and print details
         for (int i = 0; i < totalTrips; i++) {
-            int currentBusIndex = busIndices[i];  // Get the correct bus index for this trip
-            float tripBaseFare = numSeats * buses[currentBusIndex].fare;
-            float tripSST = tripBaseFare * SST_RATE;
+            int currentBusIndex = trips->busIndices[i];  // Get the correct bus index for this trip
+            money_t tripBaseFare = trips->seatCounts[i] * trips->seatFares[i]; // Fare for this trip's own seats, before SST
+            money_t tripSST = trips->totalFares[i] - tripBaseFare; // SST exactly as charged, so the lines always add up
 
             // Display ticket and trip details
-            printf("Ticket Number: %d\n", ticketNumbers[i]);
+            printf("Ticket Number: %d\n", trips->ticketNumbers[i]);
             printf("Bus ID: %d\n", buses[currentBusIndex].busID);
-            printf("Bus Plate: %s\n", buses[currentBusIndex].busNumberPlate);
-            printf("Route: %s → %s\n", buses[currentBusIndex].source, buses[currentBusIndex].destination);
+            printf("Bus Plate: %s\n", stringText(buses[currentBusIndex].busNumberPlate));
+            printf("Route: %s → %s\n", stringText(buses[currentBusIndex].source), stringText(buses[currentBusIndex].destination));
             printf("Booking Date: %s\n", bookingDate);
             printf("--------------------------------------\n");
             printf("Seats: ");
-            for (int j = 0; j < seatCounts[i]; j++) {
-                printf("%d", seatNumbersForAllTrips[i][j]);
-                if (j < seatCounts[i] - 1) printf(" ");
+            for (int j = 0; j < trips->seatCounts[i]; j++) {
+                printf("%d", trips->seatNumbers[i][j]);
+                if (j < trips->seatCounts[i] - 1) printf(" ");
             }
             printf("\n");
             printf("\n--------------------------------------\n");
-            printf("Base Fare:     RM %.2f\n", tripBaseFare);
-            printf("SST (6%%):      RM %.2f\n", tripSST);
-            printf("Total Amount:  RM %.2f\n", totalFares[i]);
+            printf("Base Fare:     RM %s\n", formatMoney(tripBaseFare, baseText));
+            printf("SST (6%%):      RM %s\n", formatMoney(tripSST, sstText));
+            printf("Total Amount:  RM %s\n", formatMoney(trips->totalFares[i], totalText));
             printf("======================================\n");
-
-            // Accumulate total payment for all trips
-            totalPayment += totalFares[i];
         }
 
+        // Total payment for all trips
+        money_t totalPayment = sumMoney(trips->totalFares, totalTrips);
+
         // If the user booked a round trip, display the total amount for both trips
         if (totalTrips > 1) {
             printf("\n======================================\n");
             printf("         FINAL PAYMENT SUMMARY      \n");
             printf("======================================\n");
-            printf("Total Amount for Round Trip: RM %.2f\n", totalPayment);
+            printf("Total Amount for Round Trip: RM %s\n", formatMoney(totalPayment, totalText));
             printf("======================================\n");
         }
 
@@ -1475,41 +2829,52 @@ void finalizeBooking(struct user currentUser, struct BusReservation buses[], int
         printf("\nDo you want to proceed with the payment? (Y/N): ");
         scanf("%c", &proceed);
 
-        if (proceed == 'y' || proceed == 'Y') {
-            // Process payment once at the end of the booking process
-            processPayment(totalPayment);
-
+        // Process payment once at the end of the booking process; cancelling it declines the booking
+        if ((proceed == 'y' || proceed == 'Y') && processPayment(totalPayment)) {
             // Send booking confirmation notifications via email and SMS
             struct notification notif;
 
             // Save reservation data after payment
             for (int i = 0; i < totalTrips; i++) {
-                saveReservation(currentUser, ticketNumbers[i], buses[busIndices[i]].busID, buses[busIndices[i]].busNumberPlate, numSeats, seatNumbersForAllTrips[i], bookingDate, finalAmount);
+                const struct BusReservation *bookedBus = &buses[trips->busIndices[i]];
+                if (saveReservation(currentUser, trips->ticketNumbers[i], bookedBus->busID, stringText(bookedBus->busNumberPlate),
+                                    trips->seatCounts[i], trips->seatNumbers[i], bookingDate, trips->totalFares[i])) {
+                    // A waitlisted customer who has paid for the trip has used that many held seats
+                    takeHold(bookedBus->busID, currentUser.username, trips->seatCounts[i]);
+                }
 
                 // Prepare and send Email Confirmation
                 notif.isEmail = 1;
                 strcpy(notif.recipient.email, currentUser.email);
                 strcpy(notif.type, "email");
                 strcpy(notif.category, "Confirmation");
-                saveNotification(&notif, ticketNumbers[i]);
+                saveNotification(&notif, trips->ticketNumbers[i]);
 
                 // Prepare and send SMS Confirmation
                 notif.isEmail = 0;
                 strcpy(notif.recipient.phone, currentUser.phone);
                 strcpy(notif.type, "sms");
                 strcpy(notif.category, "Confirmation");
-                saveNotification(&notif, ticketNumbers[i]);
+                saveNotification(&notif, trips->ticketNumbers[i]);
             }
 
-            // Save booking data for future reference
-            saveBuses(buses, busCount);   // Save updated bus data
-            saveSeats(buses, busCount);   // Save seat allocation data
-            saveFrequentBooking(currentUser, buses[busIndex].busID, buses[busIndex].busNumberPlate, bookingDate, buses[busIndex].source, buses[busIndex].destination);
-
-            // Free allocated memory after processing all trips
+            // Save booking data for future reference: only the booked buses' seats are written,
+            // unless a template trip was booked for the first time and still needs its line in buses.txt
+            int newTrip = 0;
             for (int i = 0; i < totalTrips; i++) {
-                free(seatNumbersForAllTrips[i]);
+                const struct BusReservation *bookedBus = &buses[trips->busIndices[i]];
+                markBusDirty(trips->busIndices[i]);
+                if (bookedBus->busID >= TEMPLATE_TRIP_ID_BASE && bookedBus->detail->reservedCount == trips->seatCounts[i]) {
+                    newTrip = 1;
+                }
+            }
+            if (newTrip) {
+                saveSchedule(buses, busCount);
+            } else {
+                saveSeatChanges(buses, busCount);
             }
+            saveFrequentBooking(currentUser, buses[busIndex].busID, stringText(buses[busIndex].busNumberPlate), bookingDate,
+                                stringText(buses[busIndex].source), stringText(buses[busIndex].destination));
 
             // Display final success message to the user
             printf("\nBooking successful! Enjoy your trip.\n");
@@ -1518,16 +2883,16 @@ void finalizeBooking(struct user currentUser, struct BusReservation buses[], int
 
             // Rollback the seat reservations
             for (int i = 0; i < totalTrips; i++) {
-                int currentBusIndex = busIndices[i];
+                int currentBusIndex = trips->busIndices[i];
 
                 // For each seat that was temporarily reserved, remove it
-                for (int j = 0; j < seatCounts[i]; j++) {
-                    int seatToRemove = seatNumbersForAllTrips[i][j];
+                for (int j = 0; j < trips->seatCounts[i]; j++) {
+                    int seatToRemove = trips->seatNumbers[i][j];
 
                     // Find and remove the seat from reservedSeats[]
                     int foundIndex = -1;
-                    for (int k = 0; k < buses[currentBusIndex].reservedCount; k++) {
-                        if (buses[currentBusIndex].reservedSeats[k] == seatToRemove) {
+                    for (int k = 0; k < buses[currentBusIndex].detail->reservedCount; k++) {
+                        if (buses[currentBusIndex].detail->reservedSeats[k] == seatToRemove) {
                             foundIndex = k;
                             break;
                         }
@@ -1535,25 +2900,15 @@ void finalizeBooking(struct user currentUser, struct BusReservation buses[], int
 
                     if (foundIndex != -1) {
                         // Shift remaining elements to remove seat
-                        for (int k = foundIndex; k < buses[currentBusIndex].reservedCount - 1; k++) {
-                            buses[currentBusIndex].reservedSeats[k] = buses[currentBusIndex].reservedSeats[k + 1];
+                        for (int k = foundIndex; k < buses[currentBusIndex].detail->reservedCount - 1; k++) {
+                            buses[currentBusIndex].detail->reservedSeats[k] = buses[currentBusIndex].detail->reservedSeats[k + 1];
                         }
-                        buses[currentBusIndex].reservedCount--;
+                        buses[currentBusIndex].detail->reservedCount--;
                     }
                 }
 
                 // Restore availableSeats
-                buses[currentBusIndex].availableSeats += seatCounts[i];
-
-                // Rollback booking count if it was incremented earlier
-                if (buses[currentBusIndex].bookingCount > 0) {
-                    buses[currentBusIndex].bookingCount--;
-                }
-            }
-
-            // Free allocated memory for seat numbers
-            for (int i = 0; i < totalTrips; i++) {
-                free(seatNumbersForAllTrips[i]);
+                buses[currentBusIndex].availableSeats += trips->seatCounts[i];
             }
         }
     }
@@ -1569,86 +2924,95 @@ int generateTicketNumber() {
     return ticketNumber; // Return the unique ticket number
 }
 
-// Function to check if a ticket number is unique by scanning "reservation.txt"
+// Function to check if a ticket number is unique, using the ticket index of "reservation.txt"
+// and the ticket numbers of archived travel months
 bool IsUnique(int ticketNumber) {
-    FILE *file = fopen("reservation.txt", "r"); // Open the reservation file in read mode
-    if (!file) return true; // If the file doesn't exist (i.e., no prior reservations), assume the number is unique
-
-    int existingTicket;
-    char line[256]; // Buffer to store each line from the file
+    syncTicketIndex(); // Pick up any reservations added to the file since the last check
+    return findTicket(&ticketIndex, ticketNumber) == NULL && // Unique if no reservation uses it,
+           !archivedTicketExists(ticketNumber);              // not even one moved to the archive
+}
 
-    // Read each line from the reservation file
-    while (fgets(line, sizeof(line), file)) {
-        sscanf(line, "%*[^,],%d", &existingTicket); // Extract the ticket number from the line (ignoring other data)
-        if (existingTicket == ticketNumber) { // If the ticket number already exists
-            fclose(file); // Close the file
-            return false; // Indicate that the number is not unique
-        }
+// Function to open a journal such as reservation.txt at the first line not read before.
+// Returns 0 if it cannot be opened, 1 to continue after the lines already read, and 2 if it
+// was rewritten (a different inode, or shorter) or never read, so it is read from the start.
+int openJournalTail(struct RecordReader *reader, const char *path, struct JournalReplay *replay) {
+    struct FileFingerprint current;
+    if (!fingerprintFile(path, &current) || !openRecordReader(reader, path)) return 0;
+
+    int rewritten = current.device != replay->source.device || current.inode != replay->source.inode ||
+                    current.size < replay->replayedBytes;
+    replay->source = current;
+    if (rewritten || replay->replayedBytes == 0) {
+        replay->replayedBytes = 0;
+        return 2;
+    }
+    if (!seekRecordReader(reader, replay->replayedBytes)) {
+        closeRecordReader(reader);
+        return 0;
     }
+    return 1;
+}
 
-    fclose(file); // Close the file after reading all entries
-    return true; // If no matching ticket number was found, return true (unique)
+// Function to remember how far a journal was read and close it
+void closeJournalTail(struct RecordReader *reader, struct JournalReplay *replay) {
+    replay->replayedBytes = reader->blockOffset + (long)reader->start;
+    closeRecordReader(reader);
 }
 
-// Function to load ticket numbers from "reservation.txt" into the bus reservation system
-int loadTicketNumbers(struct BusReservation buses[], int busCount) {
-    FILE *file = fopen("reservation.txt", "r"); // Open the reservation file in read mode
-    if (!file) {
-        printf("Warning: No previous reservations found.\n");
-        return 0; // If the file doesn't exist, return 0 (no bookings loaded)
-    }
-
-    char line[256]; // Buffer to store each line from the file
-    int count = 0; // Counter for the number of reservations loaded
-
-    // Read each line from the file to extract reservation details
-    while (fgets(line, sizeof(line), file)) {
-        char username[50], seatNumbers[50];
-        int ticketNumber, busID, numSeats;
-        float totalFare;
-
-        // Parse the reservation details from the formatted file
-        if (sscanf(line, "%49[^,],%d,%d,%d,%49[^,],%f", username, &ticketNumber, &busID, &numSeats, seatNumbers, &totalFare) == 6) {
-            // Find the corresponding bus in the system
-            for (int i = 0; i < busCount; i++) {
-                if (buses[i].busID == busID) { // If the bus ID matches, load ticket data into the system
-                    int bookingIndex = buses[i].bookingCount; // Get current booking count for this bus
-
-                    if (bookingIndex < MAX_BOOKINGS) { // Ensure we do not exceed the booking limit
-                        buses[i].ticketNumbers[bookingIndex] = ticketNumber; // Store the ticket number
-                        buses[i].seatCounts[bookingIndex] = numSeats; // Store the number of seats booked
-
-                        // Parse and store seat numbers (seatNumbers is a space-separated string)
-                        char *token = strtok(seatNumbers, " "); // Tokenize seat numbers
-                        int seatIndex = 0;
-                        while (token != NULL && seatIndex < numSeats) {
-                            buses[i].bookings[bookingIndex][seatIndex++] = atoi(token); // Convert and store seat number
-                            token = strtok(NULL, " "); // Move to the next seat number
-                        }
+// Function to bring the ticket index up to date with "reservation.txt".
+// Only reservations appended since the last call are read; if the file was rewritten
+// behind the index's back, the index is rebuilt from the start. When nothing changed,
+// the file is not even opened. Returns 0 if the file cannot be opened.
+int syncTicketIndex() {
+    struct FileFingerprint current;
+    if (ticketReplay.replayedBytes > 0 && fingerprintFile("reservation.txt", &current) &&
+        sameFingerprint(&current, &ticketReplay.source) && current.size == ticketReplay.replayedBytes) {
+        return 1; // Already current
+    }
 
-                        buses[i].bookingCount++; // Increment the number of bookings for this bus
-                        count++; // Increment the total reservations loaded
-                    }
-                    break; // Exit the loop once the bus is found
-                }
-            }
+    struct RecordReader reader;
+    int opened = openJournalTail(&reader, "reservation.txt", &ticketReplay);
+    if (!opened) return 0;
+    if (opened == 2) {
+        clearTicketIndex(&ticketIndex); // Rebuilt in file order below
+    }
+
+    struct StringView line;            // Current reservation line
+    struct ReservationRecord record;   // Parsed reservation fields
+    int seats[MAX_SEATS];              // Seat numbers of the line
+
+    while (readRecordLine(&reader, &line)) {
+        if (!parseReservationRecord(line, &record)) {
+            continue; // Skip malformed lines
         }
+        // The seat list is space-separated; the first line with a ticket number is the one kept
+        int numSeats = parseSeatList(record.seatList, ' ', seats, MAX_SEATS);
+        addTicket(&ticketIndex, record.ticketNumber, record.busID, record.date, seats, numSeats,
+                  record.amount, reader.lineOffset);
     }
 
-    fclose(file); // Close the reservation file
-    return count; // Return the total number of reservations loaded
+    closeJournalTail(&reader, &ticketReplay); // Remember where the next call picks up
+    return 1;
 }
 
 // Function to save a new reservation to "reservation.txt"
-void saveReservation(struct user currentUser, int ticketNumber, int busID, char *busNumberPlate,
-                     int numSeats, int seatNumbers[], char *bookingDate, float finalAmount) {
+int saveReservation(struct user currentUser, int ticketNumber, int busID, const char *busNumberPlate,
+                    int numSeats, int seatNumbers[], char *bookingDate, money_t finalAmount) {
     FILE *file = fopen("reservation.txt", "a"); // Open the file in append mode to add a new entry
 
     if (!file) { // If the file cannot be opened
         printf("Error: Could not open file for writing!\n");
-        return;
+        return 0;
     }
 
+    // Note where the line starts and whether the ticket index has read everything before it
+    fseek(file, 0, SEEK_END);
+    long offset = ftell(file);
+    struct FileFingerprint before;
+    int haveBefore = fingerprintFile("reservation.txt", &before);
+    int indexCurrent = haveBefore && ticketReplay.replayedBytes > 0 && offset == ticketReplay.replayedBytes &&
+                       sameFingerprint(&before, &ticketReplay.source);
+
     // Write reservation details in a structured format
     fprintf(file, "%s,%d,%d,%s,%s,%d,", currentUser.username, ticketNumber, busID, busNumberPlate, bookingDate, numSeats);
 
@@ -1659,274 +3023,242 @@ void saveReservation(struct user currentUser, int ticketNumber, int busID, char
     }
 
     // Write the total fare and end the line
-    fprintf(file, ",%.2f\n", finalAmount);
-
-    fclose(file); // Close the file after saving the reservation
-}
-
-// Function to retrieve and display ticket details based on user input
-void getTicketDetails(struct BusReservation buses[], int busCount) {
-    int ticketNumber; // Variable to store user-provided ticket number
-    printf("Enter your Ticket Number: ");
-    scanf("%d", &ticketNumber);
+    char amountText[MONEY_TEXT_LENGTH];
+    fprintf(file, ",%s\n", formatMoney(finalAmount, amountText));
 
-    // Open the reservation file to search for the ticket number
-    FILE *file = fopen("reservation.txt", "r");
-    if (!file) { // If file opening fails, display an error and exit the function
-        printf("Error: Could not open reservation file!\n");
-        return;
+    int written = !ferror(file);
+    if (fclose(file) != 0) written = 0; // Close the file after saving the reservation
+    if (!written) {
+        printf("Error: Could not save the reservation of ticket %d!\n", ticketNumber);
+        return 0;
     }
 
-    char line[256]; // Buffer to hold each line read from the file
-    int found = 0;  // Flag to check if the ticket is found
-
-    // Read each reservation entry from the file
-    while (fgets(line, sizeof(line), file)) {
-        char username[50], busNumberPlate[20], bookingDate[20], seatNumbers[100];
-        int fileTicketNumber, busID, numSeats;
-        float totalFare;
-
-        // Parse reservation details from the file using `sscanf`
-        int readCount = sscanf(line, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f",
-                               username, &fileTicketNumber, &busID, busNumberPlate,
-                               bookingDate, &numSeats, seatNumbers, &totalFare);
-
-        // Check if the correct number of values were read and if the ticket number matches
-        if (readCount == 8 && fileTicketNumber == ticketNumber) {
-            found = 1; // Mark ticket as found
-
-            struct BusReservation *bus = NULL;
-
-            // Search for the corresponding bus in the system memory
-            for (int i = 0; i < busCount; i++) {
-                if (buses[i].busID == busID) {
-                    bus = &buses[i];
-                    break;
-                }
-            }
-
-            if (bus) {
-                int alreadyStored = 0; // Flag to check if ticket details are already stored
-
-                // Check if ticket is already stored in memory to avoid duplication
-                for (int i = 0; i < bus->bookingCount; i++) {
-                    if (bus->ticketNumbers[i] == ticketNumber) {
-                        alreadyStored = 1;
-                        break;
-                    }
-                }
+    // Add the booking to the ticket index and the cached histories directly instead of reading
+    // the line back; if the index was behind, the next lookup reads it from the file
+    struct FileFingerprint after;
+    if (!haveBefore || !fingerprintFile("reservation.txt", &after)) return 1;
+    if (indexCurrent) {
+        struct StringView date = { bookingDate, (int)strlen(bookingDate) };
+        addTicket(&ticketIndex, ticketNumber, busID, date, seatNumbers, numSeats, finalAmount, offset);
+        ticketReplay.source = after;
+        ticketReplay.replayedBytes = (long)after.size;
+    }
+    noteBookingAppended(currentUser.username, offset, &before, &after);
+    return 1;
+}
 
-                if (!alreadyStored) {
-                    // Store ticket details in the respective bus struct
-                    bus->ticketNumbers[bus->bookingCount] = ticketNumber;
-                    bus->seatCounts[bus->bookingCount] = numSeats;
-
-                    // Parse and store seat numbers from string format
-                    char *token = strtok(seatNumbers, " ");
-                    int seatIndex = 0;
-                    while (token && seatIndex < numSeats) {
-                        bus->bookings[bus->bookingCount][seatIndex++] = atoi(token);
-                        token = strtok(NULL, " ");
-                    }
+// Function to retrieve and display ticket details based on user input
+void getTicketDetails(const struct BusReservation buses[], int busCount) {
+    int ticketNumber; // Variable to store user-provided ticket number
+    printf("Enter your Ticket Number: ");
+    scanf("%d", &ticketNumber);
 
-                    // Increase booking count after storing ticket details
-                    bus->bookingCount++;
-                }
+    // Look the ticket up in the index; only reservations added since the last lookup are read
+    if (!syncTicketIndex()) { // If the file cannot be opened, display an error and exit the function
+        printf("Error: Could not open reservation file!\n");
+        return;
+    }
 
-                // Call function to display ticket details
-                displayTicketDetails(bus, ticketNumber, bookingDate);
-            } else {
-                printf("Error: Bus ID %d not found in system memory!\n", busID);
-            }
-            break; // Exit the loop once the ticket is found and processed
+    const struct TicketEntry *ticket = findTicket(&ticketIndex, ticketNumber);
+    if (!ticket) {
+        // Bookings of past travel months only remain in the archive
+        struct ReservationRecord archived;
+        if (findArchivedTicket(ticketNumber, &archived)) {
+            displayArchivedTicket(&archived);
+        } else {
+            printf("No booking found for Ticket %d.\n", ticketNumber);
         }
+        return;
     }
 
-    fclose(file); // Close the file after reading
-
-    if (!found) {
-        printf("No booking found for Ticket %d.\n", ticketNumber);
+    // Find the corresponding bus in the system memory
+    int busIndex = findBusIndex(buses, busCount, ticket->busID);
+    if (busIndex == -1) {
+        printf("Error: Bus ID %d not found in system memory!\n", ticket->busID);
+        return;
     }
+
+    displayTicketDetails(&buses[busIndex], ticket); // Call function to display ticket details
 }
 
 // Function to display formatted ticket details
-void displayTicketDetails(struct BusReservation *bus, int ticketNumber, char *bookingDate) {
-    // Loop through bus bookings to find matching ticket
-    for (int i = 0; i < bus->bookingCount; i++) {
-        if (bus->ticketNumbers[i] == ticketNumber) {
-            // Calculate the final amount based on number of seats booked and fare
-            float finalAmount = calculateFare(bus->seatCounts[i], bus->fare);
-
-            // Print ticket receipt in a structured format
-            printf("\n=========================================\n");
-            printf("             BUS TICKET RECEIPT          \n");
-            printf("=========================================\n");
-            printf(" Ticket Number   : %-12d\n", ticketNumber);
-            printf(" Bus ID          : %-12d\n", bus->busID);
-            printf(" Bus Number Plate: %-12s\n", bus->busNumberPlate);
-            printf(" Booking Date    : %-12s\n", bookingDate);
-            printf(" Departure Date  : %-12s\n", bus->date);
-            printf(" Source          : %-12s\n", bus->source);
-            printf(" Destination     : %-12s\n", bus->destination);
-            printf(" Departure Time  : %-12s\n", bus->departureTime);
-            printf(" Arrival Time    : %-12s\n", bus->arrivalTime);
-            printf(" Total Seats     : %-12d\n", bus->totalSeats);
-            printf(" Available Seats : %-12d\n", bus->availableSeats);
-            printf("-----------------------------------------\n");
-
-            // Print booked seats in a formatted manner (5 per row)
-            printf(" Booked Seats    : ");
-            for (int j = 0; j < bus->seatCounts[i]; j++) {
-                printf("%2d ", bus->bookings[i][j]);
-                if ((j + 1) % 5 == 0 && j != bus->seatCounts[i] - 1) {
-                    printf("\n                   "); // Indent continuation rows
-                }
-            }
-            printf("\n-----------------------------------------\n");
-
-            // Print final fare details
-            printf(" Total Fare      : RM %8.2f\n", finalAmount);
-            printf("=========================================\n");
-            printf("     Thank you for choosing us!         \n");
-            printf("=========================================\n\n");
-            return; // Exit function after displaying the ticket
+void displayTicketDetails(const struct BusReservation *bus, const struct TicketEntry *ticket) {
+    const int *seats = ticketSeats(&ticketIndex, ticket);
+
+    // The amount actually paid; prices move with demand, so it is not recomputed from today's fare
+    money_t finalAmount = ticket->amount;
+    char amountText[MONEY_TEXT_LENGTH];
+    char departureTime[TIME_LENGTH], arrivalTime[TIME_LENGTH];
+    formatTime(bus->departureMinute, departureTime);
+    formatTime(bus->arrivalMinute, arrivalTime);
+
+    // Print ticket receipt in a structured format
+    printf("\n=========================================\n");
+    printf("             BUS TICKET RECEIPT          \n");
+    printf("=========================================\n");
+    printf(" Ticket Number   : %-12d\n", ticket->ticketNumber);
+    printf(" Bus ID          : %-12d\n", bus->busID);
+    printf(" Bus Number Plate: %-12s\n", stringText(bus->busNumberPlate));
+    printf(" Booking Date    : %-12s\n", ticket->date);
+    printf(" Departure Date  : %-12s\n", bus->date);
+    printf(" Source          : %-12s\n", stringText(bus->source));
+    printf(" Destination     : %-12s\n", stringText(bus->destination));
+    printf(" Departure Time  : %-12s\n", departureTime);
+    printf(" Arrival Time    : %-12s\n", arrivalTime);
+    printf(" Total Seats     : %-12d\n", bus->totalSeats);
+    printf(" Available Seats : %-12d\n", bus->availableSeats);
+    printf("-----------------------------------------\n");
+
+    // Print booked seats in a formatted manner (5 per row)
+    printf(" Booked Seats    : ");
+    for (int j = 0; j < ticket->numSeats; j++) {
+        printf("%2d ", seats[j]);
+        if ((j + 1) % 5 == 0 && j != ticket->numSeats - 1) {
+            printf("\n                   "); // Indent continuation rows
         }
     }
+    printf("\n-----------------------------------------\n");
+
+    // Print final fare details
+    printf(" Total Fare      : RM %8s\n", formatMoney(finalAmount, amountText));
+    printf("=========================================\n");
+    printf("     Thank you for choosing us!         \n");
+    printf("=========================================\n\n");
+}
 
-    // If ticket is not found within the bus memory
-    printf("Error: Ticket %d not found in system memory!\n", ticketNumber);
+// Function to display a ticket of an archived travel month. Its trip has left and been purged,
+// so only what the booking itself recorded is shown.
+void displayArchivedTicket(const struct ReservationRecord *record) {
+    char amountText[MONEY_TEXT_LENGTH];
+    printf("\n=========================================\n");
+    printf("             BUS TICKET RECEIPT          \n");
+    printf("=========================================\n");
+    printf(" Ticket Number   : %-12d\n", record->ticketNumber);
+    printf(" Bus ID          : %-12d\n", record->busID);
+    printf(" Bus Number Plate: %-12.*s\n", record->busNumberPlate.length, record->busNumberPlate.data);
+    printf(" Booking Date    : %-12.*s\n", record->date.length, record->date.data);
+    printf(" Trip            : Travelled (archived)\n");
+    printf("-----------------------------------------\n");
+    printf(" Booked Seats    : %.*s\n", record->seatList.length, record->seatList.data);
+    printf("-----------------------------------------\n");
+    printf(" Total Fare      : RM %8s\n", formatMoney(record->amount, amountText));
+    printf("=========================================\n\n");
 }
 
 // Function to process refund and display refund details to the user
-void processRefund(float refundAmount) {
+void processRefund(money_t refundAmount) {
+    char amountText[MONEY_TEXT_LENGTH];
     printf("\nRefund Details:\n");
-    printf("Amount Refunded: RM %.2f\n", refundAmount);
+    printf("Amount Refunded: RM %s\n", formatMoney(refundAmount, amountText));
     printf("Refund will be processed within 3-5 business days.\n");
 }
 
-// Function to log a cancellation into "cancellations.txt"
-void logCancellation(char *username, int ticketNumber, int busID, char *busNumberPlate, char *date, int numSeats, int canceledSeats[], float refundAmount) {
-    FILE *file = fopen("cancellations.txt", "a"); // Open file in append mode
-    if (!file) {
-        printf("Error: Could not open cancellations.txt for writing!\n");
-        return;
-    }
-
-    // Write cancellation details to file
-    fprintf(file, "%s,%d,%d,%s,%s,%d,", username, ticketNumber, busID, busNumberPlate, date, numSeats);
+// Function to build the cancellations.txt line of a cancelled booking, with its line ending
+void formatCancellation(char *line, size_t size, const char *username, int ticketNumber, int busID, const char *busNumberPlate,
+                        const char *date, int numSeats, const int canceledSeats[], money_t refundAmount) {
+    // Write cancellation details
+    int length = snprintf(line, size, "%s,%d,%d,%s,%s,%d,", username, ticketNumber, busID, busNumberPlate, date, numSeats);
 
-    // Append all canceled seat numbers
-    for (int i = 0; i < numSeats; i++) {
-        fprintf(file, "%d", canceledSeats[i]);
-        if (i < numSeats - 1) fprintf(file, " "); // Separate seat numbers with a space
+    // Append all canceled seat numbers, separated by spaces
+    for (int i = 0; i < numSeats && length < (int)size; i++) {
+        length += snprintf(line + length, size - (size_t)length, i ? " %d" : "%d", canceledSeats[i]);
     }
 
-    fprintf(file, ",%.2f\n", refundAmount); // Append refund amount
-    fclose(file); // Close file after writing
+    char amountText[MONEY_TEXT_LENGTH];
+    if (length < (int)size) {
+        snprintf(line + length, size - (size_t)length, ",%s\n", formatMoney(refundAmount, amountText)); // Append refund amount
+    }
 }
 
-// Function to update files after a cancellation
-void updateFilesAfterCancellation(struct BusReservation buses[], int busCount, int busID, int numSeats, int ticketNumber, char *username) {
-    // Step 1: Remove canceled reservation from "reservation.txt"
-    FILE *file = fopen("reservation.txt", "r"); // Open the reservation file in read mode to process existing bookings
-    FILE *tempFile = fopen("temp.txt", "w"); // Open a temporary file in write mode to store updated reservations
+// Function to move a cancelled booking from "reservation.txt" to "cancellations.txt". The
+// booking's line is cut out of reservation.txt by copying the bytes around it in blocks, without
+// parsing a single line, and both files are committed together: either the booking is still
+// live with no cancellation row, or it is gone and its row is written. Returns 0 if nothing changed.
+int updateFilesAfterCancellation(int ticketNumber, long lineOffset, long lineLength, const char *cancellationLine) {
+    struct FileFingerprint original;  // reservation.txt before the line is removed
+    struct DurableFile files[2];      // Replacement reservation.txt, then cancellations.txt
+    FILE *source = fopen("reservation.txt", "rb");
 
     // Check if files opened successfully
-    if (!file || !tempFile) {
+    if (!source || !fingerprintFile("reservation.txt", &original)) {
+        if (source) fclose(source);
         printf("Error: Unable to access reservation file.\n");
-        return;
+        return 0;
+    }
+    if (!beginDurableWrite(&files[0], "reservation.txt", 0)) {
+        fclose(source);
+        return 0;
+    }
+    if (!beginDurableAppend(&files[1], "cancellations.txt", 0)) {
+        abortDurableWrite(&files[0]);
+        fclose(source);
+        return 0;
     }
 
-    char line[256];  // Buffer to store each line read from the file
-    int found = 0;   // Flag to track if a reservation has been removed
-
-    // Read each line from the original reservation file
-    while (fgets(line, sizeof(line), file)) {
-        char fileUsername[50];  // Stores username extracted from the line
-        int fileTicketNumber;   // Stores ticket number extracted from the line
+    // Copy what comes before the line, then everything after it; the cancellation row goes at the end
+    int copied = copyFileBytes(source, files[0].file, lineOffset) &&
+                 fseek(source, lineOffset + lineLength, SEEK_SET) == 0 &&
+                 copyFileBytes(source, files[0].file, -1) &&
+                 fputs(cancellationLine, files[1].file) >= 0;
+    fclose(source);
+    if (!copied || ferror(files[0].file) || ferror(files[1].file)) {
+        abortDurableWrite(&files[0]);
+        abortDurableWrite(&files[1]);
+        printf("Error: Unable to update reservation file.\n");
+        return 0;
+    }
 
-        // Extract username and ticket number from the current line
-        // The expected format in reservation.txt: username,ticketNumber,...
-        if (sscanf(line, "%49[^,],%d", fileUsername, &fileTicketNumber) == 2) {
-            // If this line matches the ticket to be canceled, remove it
-            if (fileTicketNumber == ticketNumber && strcmp(fileUsername, username) == 0) {
-                found = 1;  // Set flag to indicate a reservation was found and removed
+    // Replace both originals at once
+    if (!commitDurableWrites(files, 2)) return 0;
+    printf("Reservation canceled successfully.\n");
 
-                // Open cancellations.txt in append mode to store the removed reservation
-                FILE *cancelFile = fopen("cancellations.txt", "a");
-                if (cancelFile) {
-                    fputs(line, cancelFile);  // Save canceled reservation to cancellations file
-                    fclose(cancelFile);       // Close cancellations file after writing
-                }
-                continue;  // Skip writing this reservation to the new file
+    // Follow the removal in the ticket index and the booking histories: drop the line and move
+    // the later lines up. A file not the size worked out leaves them to be rebuilt by the next lookup.
+    struct FileFingerprint rewritten;
+    if (fingerprintFile("reservation.txt", &rewritten) && rewritten.size == original.size - lineLength) {
+        noteBookingRemoved(lineOffset, lineLength, &original, &rewritten);
+        if (ticketReplay.replayedBytes == original.size && sameFingerprint(&ticketReplay.source, &original)) {
+            const struct TicketEntry *ticket = findTicket(&ticketIndex, ticketNumber);
+            if (ticket && ticket->offset == lineOffset) {
+                removeTicket(&ticketIndex, ticketNumber);
             }
+            shiftTicketOffsets(&ticketIndex, lineOffset, -lineLength);
+            ticketReplay.source = rewritten;
+            ticketReplay.replayedBytes = (long)rewritten.size;
+        } else {
+            ticketReplay.replayedBytes = 0;
         }
-        // If this is not the canceled reservation, write it back to the temporary file
-        fputs(line, tempFile);
-    }
-
-    // Close both files after processing
-    fclose(file);
-    fclose(tempFile);
-
-    // Replace the original reservation file with the updated temporary file
-    remove("reservation.txt");      // Delete old reservation file
-    rename("temp.txt", "reservation.txt");  // Rename temp file to reservation.txt
-
-    // Notify the user whether the cancellation was successful or not
-    if (found) {
-        printf("Reservation canceled successfully.\n");
     } else {
-        printf("Error: Reservation not found.\n");
+        ticketReplay.replayedBytes = 0;
     }
+    return 1;
+}
 
-    // Step 2: Update "seats.txt" to reflect newly available seats
-    FILE *seatFile = fopen("seats.txt", "w");
-    for (int i = 0; i < busCount; i++) {
-        fprintf(seatFile, "%d,%d", buses[i].busID, buses[i].reservedCount);
-        for (int j = 0; j < buses[i].reservedCount; j++) {
-            fprintf(seatFile, ",%d", buses[i].reservedSeats[j]); // Write each reserved seat
-        }
-        fprintf(seatFile, "\n");
-    }
-    fclose(seatFile);
-
-    // Step 3: Update "buses.txt" to reflect available seats after cancellation
-    FILE *busFile = fopen("buses.txt", "r");
-    char busLines[MAX_BUSES][256]; // Buffer for storing file lines
-    int busIndex = 0;
-
-    // Read each line of "buses.txt"
-    while (fgets(busLines[busIndex], sizeof(busLines[busIndex]), busFile)) {
-        int fileBusID, totalSeats, availableSeats;
-        char busPlate[50], date[50], source[50], dest[50], depart[10], arrive[10];
-        float fare;
-
-        // Extract bus details from line
-        if (sscanf(busLines[busIndex], "%d,%49[^,],%49[^,],%49[^,],%49[^,],%9[^,],%9[^,],%d,%d,%f",
-                   &fileBusID, busPlate, date, source, dest, depart, arrive, &totalSeats, &availableSeats, &fare) == 10) {
-            // If the current bus ID matches the canceled ticket, update available seats
-            if (fileBusID == busID) {
-                sprintf(busLines[busIndex], "%d,%s,%s,%s,%s,%s,%s,%d,%d,%.2f\n",
-                        fileBusID, busPlate, date, source, dest, depart, arrive, totalSeats, availableSeats + numSeats, fare);
-            }
-        }
+// Function to release seats of a bus. The seats to free are marked in a bitmap (seat numbers
+// stay below 64), so the reserved list is compacted in one pass instead of one search per seat.
+void releaseSeats(struct BusReservation *bus, const int seats[], int count) {
+    unsigned long long released = 0; // Bit n set = seat n is released
+    for (int i = 0; i < count; i++) {
+        if (seats[i] >= 0 && seats[i] < 64) released |= 1ULL << seats[i];
+    }
 
-        if (busIndex < MAX_BUSES) { // Prevent overflow
-            busIndex++;
+    int kept = 0;
+    for (int j = 0; j < bus->detail->reservedCount; j++) {
+        int seat = bus->detail->reservedSeats[j];
+        if (seat >= 0 && seat < 64 && (released & (1ULL << seat))) {
+            continue; // Released, leave it out
         }
+        bus->detail->reservedSeats[kept++] = seat;
     }
-    fclose(busFile); // Close file after reading
+    bus->detail->reservedCount = kept;
 
-    // Write back updated bus information to "buses.txt"
-    busFile = fopen("buses.txt", "w");
-    for (int i = 0; i < busIndex; i++) {
-        fputs(busLines[i], busFile);
-    }
-    fclose(busFile);
+    // Update the available seat count after cancellation
+    bus->availableSeats += count;
 }
 
-// Function to cancel a booking based on the ticket number
+// Function to cancel a booking based on the ticket number.
+// The ticket is found through the ticket index and only its own line is read back, so a
+// cancellation does not scan reservation.txt however many bookings it holds.
 void cancelBooking(struct user currentUser, struct BusReservation buses[], int busCount) {
     int ticketNumber;
 
@@ -1934,48 +3266,38 @@ void cancelBooking(struct user currentUser, struct BusReservation buses[], int b
     printf("Enter your Ticket Number to cancel: ");
     scanf("%d", &ticketNumber);
 
-    // Open the reservation file to search for the booking
-    FILE *file = fopen("reservation.txt", "r");
-    if (!file) {
+    // Bring the ticket index up to date and open the reservation file to read the booking
+    struct RecordReader reader;
+    if (!syncTicketIndex() || !openRecordReader(&reader, "reservation.txt")) {
         printf("Error: No reservations found!\n");
         return;
     }
 
     // Variables to store booking details
     int found = 0, busID = -1, numSeats = 0;
-    float refundAmount = 0.0;
+    money_t refundAmount = 0;
     int canceledSeats[MAX_SEATS];
-    char username[50], busPlate[20], date[20];
-
-    // Iterate through the file to locate the ticket
-    while (!feof(file)) {
-        int fileTicketNumber, fileBusID, fileNumSeats;
-        float totalFare;
-
-        // Read user booking details from file
-        if (fscanf(file, "%49[^,],%d,%d,%19[^,],%19[^,],%d,", username, &fileTicketNumber, &fileBusID, busPlate, date, &fileNumSeats) != 6) {
-            fscanf(file, "%*[^\n]\n");  // Skip the invalid line to prevent an infinite loop
-            continue;
-        }
-
-        // Read seat numbers from file
-        for (int i = 0; i < fileNumSeats; i++) {
-            fscanf(file, "%d", &canceledSeats[i]);
-        }
-
-        // Read the total fare at the end of the line
-        fscanf(file, ",%f\n", &totalFare);
-
-        // If the ticket number and username match, store the relevant details
-        if (fileTicketNumber == ticketNumber && strcmp(username, currentUser.username) == 0) {
-            found = 1;         // Mark booking as found
-            busID = fileBusID; // Store bus ID
-            numSeats = fileNumSeats; // Store number of seats booked
-            refundAmount = totalFare; // Store refund amount
-            break; // Stop searching once the correct ticket is found
-        }
-    }
-    fclose(file); // Close the file after reading
+    char busPlate[20], date[20];
+    long lineOffset = 0, lineLength = 0; // Where the booking's line is in reservation.txt
+    struct StringView line;            // The booking's reservation line
+    struct ReservationRecord record;   // Parsed reservation fields
+
+    // Read the ticket's line at its offset; it must still be this ticket and belong to this user
+    const struct TicketEntry *ticket = findTicket(&ticketIndex, ticketNumber);
+    if (ticket && seekRecordReader(&reader, ticket->offset) && readRecordLine(&reader, &line) &&
+        parseReservationRecord(line, &record) && record.ticketNumber == ticketNumber &&
+        viewEquals(record.username, currentUser.username)) {
+        // Store the relevant details of the matching booking
+        found = 1;                 // Mark booking as found
+        busID = record.busID;      // Store bus ID
+        numSeats = parseSeatList(record.seatList, ' ', canceledSeats, MAX_SEATS); // Store the seats booked
+        refundAmount = record.amount; // Store refund amount
+        copyView(record.busNumberPlate, busPlate, sizeof(busPlate));
+        copyView(record.date, date, sizeof(date));
+        lineOffset = reader.lineOffset;
+        lineLength = reader.blockOffset + (long)reader.start - reader.lineOffset; // Including its line ending
+    }
+    closeRecordReader(&reader); // Close the file after reading
 
     // If no booking is found, notify the user and exit function
     if (!found) {
@@ -1994,6 +3316,25 @@ void cancelBooking(struct user currentUser, struct BusReservation buses[], int b
         return;
     }
 
+    // Move the booking to cancellations.txt first. Until that is on disk the booking stays live,
+    // so its seats are not released, offered or refunded.
+    char cancellationLine[MAX_SEATS * 4 + 256];
+    formatCancellation(cancellationLine, sizeof(cancellationLine), currentUser.username, ticketNumber, busID,
+                       busPlate, date, numSeats, canceledSeats, refundAmount);
+    if (!updateFilesAfterCancellation(ticketNumber, lineOffset, lineLength, cancellationLine)) {
+        printf("Error: Ticket %d was not cancelled. Please try again.\n", ticketNumber);
+        return;
+    }
+
+    // Remove the canceled seats from the bus's reserved seat list and log the bus's newly
+    // available seats; buses.txt and seats.txt catch up at the next checkpoint
+    int busIndex = findBusIndex(buses, busCount, busID);
+    if (busIndex != -1) {
+        releaseSeats(&buses[busIndex], canceledSeats, numSeats);
+        markBusDirty(busIndex);
+        saveSeatChanges(buses, busCount);
+    }
+
     // Create a notification struct for email notification
     struct notification notif;
 
@@ -2014,34 +3355,11 @@ void cancelBooking(struct user currentUser, struct BusReservation buses[], int b
     // Save the SMS notification
     saveNotification(&notif, ticketNumber);
 
-    // Iterate through the buses to locate the bus with the given ID
-    for (int i = 0; i < busCount; i++) {
-        if (buses[i].busID == busID) {
-            // Remove the canceled seats from the bus's reserved seat list
-            for (int j = 0; j < numSeats; j++) {
-                for (int k = 0; k < buses[i].reservedCount; k++) {
-                    if (buses[i].reservedSeats[k] == canceledSeats[j]) {
-                        // Shift the remaining seats to the left after removal
-                        for (int l = k; l < buses[i].reservedCount - 1; l++) {
-                            buses[i].reservedSeats[l] = buses[i].reservedSeats[l + 1];
-                        }
-                        buses[i].reservedCount--; // Reduce the reserved seat count
-                        break; // Move to the next seat to remove
-                    }
-                }
-            }
-            // Update the available seat count after cancellation
-            buses[i].availableSeats += numSeats;
-            break; // Stop once the correct bus is updated
-        }
+    // Offer the freed seats to anyone waiting for this trip
+    if (busIndex != -1) {
+        offerSeatsToWaitlist(&buses[busIndex]);
     }
 
-    // Record the cancellation details in cancellations.txt
-    logCancellation(currentUser.username, ticketNumber, busID, busPlate, date, numSeats, canceledSeats, refundAmount);
-
-    // Remove the booking entry from reservation.txt and update all related files
-    updateFilesAfterCancellation(buses, busCount, busID, numSeats, ticketNumber, currentUser.username);
-
     // Notify the user of successful cancellation and process refund
     printf("Booking canceled successfully! Processing refund...\n");
     processRefund(refundAmount);
@@ -2100,10 +3418,10 @@ void checkAndRemoveUserUpdate(const char *currentUser) {
     char username[USERNAME_LENGTH];  // Buffer to store usernames from the file
     int found = 0;  // Flag to track if the user was found
 
-    // Open a temporary file to store updated user list without the current user
-    FILE *temp = fopen("tempfile.txt", "w");
+    // Write the updated user list without the current user to a replacement file
+    struct DurableFile out;
+    FILE *temp = beginDurableWrite(&out, "temp_updates.txt", 0);
     if (!temp) {
-        perror("Error opening tempfile.txt");
         fclose(file);
         return;
     }
@@ -2121,7 +3439,6 @@ void checkAndRemoveUserUpdate(const char *currentUser) {
     }
 
     fclose(file);
-    fclose(temp);
 
     // If the user had an update, notify them and update the file accordingly
     if (found) {
@@ -2135,18 +3452,11 @@ void checkAndRemoveUserUpdate(const char *currentUser) {
         printf("Thank you for choosing our service!\n");
         printf("==============================================================================\n");
 
-        // Remove the old file since the user was notified
-        if (remove("temp_updates.txt") != 0) {
-            perror("Error removing temp_updates.txt");
-        }
-
-        // Rename the temporary file to replace the old update list
-        if (rename("tempfile.txt", "temp_updates.txt") != 0) {
-            perror("Error renaming tempfile.txt");
-        }
+        // Replace the old update list since the user was notified
+        commitDurableWrite(&out);
     } else {
-        // If no update was found for the user, delete the temporary file
-        remove("tempfile.txt");
+        // If no update was found for the user, drop the replacement
+        abortDurableWrite(&out);
     }
 }
 
@@ -2163,7 +3473,7 @@ void appendUserToTempFile(const char *username) {
     fclose(tempFile);
 }
 
-void notifyUser(const char *username, int ticketNumber) {
+void notifyUser(const char *username, int ticketNumber, const char *category) {
     // Fetch user details from the system
     struct user bookedUser = getUserDetails(username);
     struct notification notif;  // Notification structure
@@ -2173,7 +3483,7 @@ void notifyUser(const char *username, int ticketNumber) {
         notif.isEmail = 1;
         strcpy(notif.recipient.email, bookedUser.email);
         strcpy(notif.type, "email");
-        strcpy(notif.category, "Update");
+        strcpy(notif.category, category);
         saveNotification(&notif, ticketNumber);
     }
 
@@ -2182,34 +3492,131 @@ void notifyUser(const char *username, int ticketNumber) {
         notif.isEmail = 0;
         strcpy(notif.recipient.phone, bookedUser.phone);
         strcpy(notif.type, "sms");
-        strcpy(notif.category, "Update");
+        strcpy(notif.category, category);
         saveNotification(&notif, ticketNumber);
     }
 }
 
-void notifyUsersOfBusUpdate(int busID, const char *oldValue, const char *newValue) {
-    // Open the reservation file to find users who booked the affected bus
-    FILE *file = fopen("reservation.txt", "r");
-    if (!file) {
+// Function to hand a trip's free seats to its waitlist. Each promoted party gets a timed hold
+// and is told by email and SMS, with the waitlist reference in place of a ticket number.
+void offerSeatsToWaitlist(const struct BusReservation *bus) {
+    struct WaitlistPromotion promoted[MAX_SEATS];
+    int count = promoteWaitlist(bus->busID, bus->availableSeats, WAITLIST_POLICY, time(NULL), promoted, MAX_SEATS);
+
+    for (int i = 0; i < count; i++) {
+        notifyUser(promoted[i].username, promoted[i].reference, "Waitlist");
+    }
+}
+
+// Function to offer the seats of waitlist holds that have run out to the next waiting parties,
+// whether or not anyone books or cancels on those trips
+void offerExpiredHolds(const struct BusReservation buses[], int busCount) {
+    int busIDs[64];
+    int count;
+    while ((count = expiredHoldTrips(time(NULL), busIDs, 64)) > 0) {
+        for (int i = 0; i < count; i++) {
+            int slot = findBusIndex(buses, busCount, busIDs[i]);
+            if (slot == -1) {
+                closeWaitlist(busIDs[i]); // The trip no longer runs
+            } else {
+                offerSeatsToWaitlist(&buses[slot]); // Releases the holds, then promotes
+            }
+        }
+    }
+}
+
+// Function to offer a customer a place on the waitlist when a trip has too few seats.
+// Returns 1 if they joined it.
+int askToJoinWaitlist(struct user currentUser, const struct BusReservation *bus, int numSeats) {
+    if (numSeats > bus->totalSeats) return 0; // Could never be seated on this bus
+
+    char join;
+    printf("Join the waitlist for Bus %d? You will be notified when %d seat(s) are held for you. (Y/N): ",
+           bus->busID, numSeats);
+    scanf(" %c", &join);
+    if (join != 'Y' && join != 'y') return 0;
+
+    int reference = joinWaitlist(bus->busID, currentUser.username, numSeats);
+    if (reference == 0) {
+        printf("Error: Could not join the waitlist.\n");
+        return 0;
+    }
+    printf("You are on the waitlist. Reference: %d\n", reference);
+    printf("Seats freed on this trip will be held for you for %d minutes once it is your turn.\n", WAITLIST_HOLD_MINUTES);
+    return 1;
+}
+
+// Function to order bus changes by bus ID, keeping changes to the same bus in the order made
+static int compareChangeRefs(const void *a, const void *b) {
+    const int *left = a, *right = b; // Pairs of (busID, change position)
+    if (left[0] != right[0]) return left[0] < right[0] ? -1 : 1;
+    return (left[1] > right[1]) - (left[1] < right[1]);
+}
+
+// Function to notify passengers of a set of schedule changes in one pass over reservation.txt.
+// Each affected ticket gets its changes logged and a single notification.
+void notifyUsersOfBusChanges(const struct ScheduleChange changes[], int changeCount) {
+    // Open the reservation file to find users who booked the affected buses
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, "reservation.txt")) {
         printf("Error: Could not open reservation file!\n");
         return;
     }
 
-    char username[USERNAME_LENGTH], busNumberPlate[20], bookingDate[20], seatNumbers[100];
-    int ticketNumber, bookedBusID, numSeats;
-    float finalAmount;
+    // Open the update log and the pending-notice list once for the whole pass
+    FILE *updates = fopen("updates.txt", "a");
+    FILE *pending = fopen("temp_updates.txt", "a");
+    if (!updates || !pending) {
+        printf("Error: Could not open updates.txt for writing.\n");
+        if (updates) fclose(updates);
+        if (pending) fclose(pending);
+        closeRecordReader(&reader);
+        return;
+    }
+
+    // Sorted (busID, change) pairs so each reservation is matched with a binary search
+    int (*refs)[2] = malloc((size_t)(changeCount > 0 ? changeCount : 1) * sizeof(*refs));
+    if (!refs) {
+        fclose(updates);
+        fclose(pending);
+        closeRecordReader(&reader);
+        return;
+    }
+    for (int i = 0; i < changeCount; i++) {
+        refs[i][0] = changes[i].busID;
+        refs[i][1] = i;
+    }
+    qsort(refs, (size_t)changeCount, sizeof(*refs), compareChangeRefs);
+
+    char username[USERNAME_LENGTH];    // Username copied out of the matching record
+    struct StringView line;            // Current reservation line
+    struct ReservationRecord record;   // Parsed reservation fields
 
-    // Scan the file for matching bus reservations and notify users
-    while (fscanf(file, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f\n",
-                  username, &ticketNumber, &bookedBusID, busNumberPlate, bookingDate, &numSeats, seatNumbers, &finalAmount) == 8) {
-        if (bookedBusID == busID) {
-            appendUserToTempFile(username);  // Store the user for later updates
-            logBusUpdate(busID, ticketNumber, oldValue, newValue);  // Log the change
-            notifyUser(username, ticketNumber);  // Notify the user about the update
+    // Scan the file once for reservations on any changed bus and notify users
+    while (readRecordLine(&reader, &line)) {
+        if (!parseReservationRecord(line, &record)) continue;
+
+        int low = 0, high = changeCount;
+        while (low < high) {
+            int middle = low + (high - low) / 2;
+            if (refs[middle][0] < record.busID) low = middle + 1;
+            else high = middle;
+        }
+        if (low == changeCount || refs[low][0] != record.busID) continue;
+
+        copyView(record.username, username, sizeof(username));
+        fprintf(pending, "%s\n", username);  // Store the user for later updates
+        for (int i = low; i < changeCount && refs[i][0] == record.busID; i++) {
+            const struct ScheduleChange *change = &changes[refs[i][1]];
+            logBusUpdate(updates, record.busID, record.ticketNumber, change->oldValue, change->newValue);  // Log the change
         }
+        notifyUser(username, record.ticketNumber, "Update");  // Notify the user once about all updates
     }
 
-    fclose(file);
+    free(refs);
+    fclose(updates);
+    fclose(pending);
+    closeRecordReader(&reader);
 }
 
 void viewNotifications(struct user *currentUser) {
@@ -2335,6 +3742,13 @@ void printEmailMessage(const char *category, const char *recipient, int ticketNu
         printf("Any applicable refunds will be processed shortly.\n");
         printf("For further assistance, please contact our customer support.\n\n");
     }
+    else if (strncmp(category, "Waitlist", 8) == 0) {
+        printf("Dear Customer,\n\n");
+        printf("Seats have become available on the trip you are waitlisted for.\n");
+        printf("Waitlist Reference: %d\n\n", ticketNumber);
+        printf("They are held for you for %d minutes. Book the trip to claim them;\n", WAITLIST_HOLD_MINUTES);
+        printf("after that they are released to other customers.\n\n");
+    }
     else if (strncmp(category, "Update", 6) == 0) {
         printf("Dear Customer,\n");
         printf("There has been an update to your bus schedule.\n");
@@ -2396,6 +3810,11 @@ void printSmsMessage(const char *category, const char *recipient, int ticketNumb
         printf("Your booking (Ticket %d) has been cancelled.\n\n", ticketNumber);
         printf("Any applicable refunds will be processed soon.\n\n");
     }
+    else if (strncmp(category, "Waitlist", 8) == 0) {
+        printf("Dear Customer,\n");
+        printf("Seats are held for you (Waitlist Ref %d) for %d minutes.\n\n", ticketNumber, WAITLIST_HOLD_MINUTES);
+        printf("Book the trip now to claim them.\n\n");
+    }
     else if (strncmp(category, "Update", 6) == 0) {
         printf("Your bus schedule (Ticket %d) has been updated.\n", ticketNumber);
 
@@ -2461,177 +3880,227 @@ void generateBusReport(struct BusReservation buses[], int busCount) {
     // Open required files for reading reservation and cancellation data.
     // Also, open "bus_report.txt" in write mode to store the generated report.
 
-    FILE *reservationFile = fopen("reservation.txt", "r");
-    FILE *cancellationFile = fopen("cancellations.txt", "r");
+    struct RecordReader reservationReader, cancellationReader;
+    int reservationsOpen = openRecordReader(&reservationReader, "reservation.txt");
+    int cancellationsOpen = openRecordReader(&cancellationReader, "cancellations.txt");
     FILE *reportFile = fopen("bus_report.txt", "w");
 
     // Check if any file failed to open and handle errors accordingly.
-    if (!reservationFile || !cancellationFile || !reportFile) {
+    if (!reservationsOpen || !cancellationsOpen || !reportFile) {
         printf("Error: Could not open one or more files.\n");
-        if (reservationFile) fclose(reservationFile);
-        if (cancellationFile) fclose(cancellationFile);
+        closeRecordReader(&reservationReader);
+        closeRecordReader(&cancellationReader);
         if (reportFile) fclose(reportFile);
         return;
     }
 
-    // Sort buses by busNumberPlate in alphabetical order.
-    // If two buses have the same busNumberPlate, sort them by date.
-    for (int i = 0; i < busCount - 1; i++) {  // Outer loop iterates through each bus
-        for (int j = i + 1; j < busCount; j++) {  // Inner loop compares the current bus with the remaining buses
-
-            // Compare bus number plates (lexicographical order)
-            if (strcmp(buses[i].busNumberPlate, buses[j].busNumberPlate) > 0 ||
-                // If bus number plates are the same, compare dates (earlier date comes first)
-                (strcmp(buses[i].busNumberPlate, buses[j].busNumberPlate) == 0 &&
-                 strcmp(buses[i].date, buses[j].date) > 0)) {
-
-                // Swap buses[i] and buses[j] if they are out of order
-                struct BusReservation temp = buses[i];
-                buses[i] = buses[j];
-                buses[j] = temp;
-            }
+    // Order the report by busNumberPlate in alphabetical order, and by departure within a plate.
+    // The departure index is already in date order, so a stable insertion sort on the plate
+    // keeps that order without comparing date strings or moving the buses themselves.
+    int order[MAX_BUSES];
+    int rows = 0;
+    for (int i = 0; i < departureIndex.count; i++) {
+        if (departureIndex.entries[i].slot < busCount) {
+            order[rows++] = departureIndex.entries[i].slot;
+        }
+    }
+    for (int i = 1; i < rows; i++) {
+        int slot = order[i];
+        int j = i - 1;
+        while (j >= 0 && compareStrings(buses[order[j]].busNumberPlate, buses[slot].busNumberPlate) > 0) {
+            order[j + 1] = order[j]; // Shift later plates right
+            j--;
         }
+        order[j + 1] = slot;
     }
 
-    // Iterate over each bus in the list to compute its report data
+    // Initialize statistics for every bus before the single pass over each file
     for (int i = 0; i < busCount; i++) {
-        struct BusReservation *bus = &buses[i]; // Pointer to the current bus entry
-
-        // Initialize statistics for the current bus
-        int totalBookings = 0;       // Count of successful bookings for this bus
-        int totalCancellations = 0;  // Count of canceled bookings for this bus
-        int totalBookedSeats = 0;   // Counter for the total number of booked seats
-        int totalCanceledSeats = 0; // Counter for the total number of canceled seats
-        float totalRevenue = 0;      // Total revenue from all bookings (before refunds)
-        float lostRevenue = 0;       // Amount lost due to cancellations (refunds issued)
-        float netRevenue = 0;        // Actual revenue after subtracting lost revenue
-
-        // Read the reservations file and count valid bookings for the current bus.
-        rewind(reservationFile);
-        char line[MAX_LINE];
-
-        // Read each line from the "reservation.txt" file to analyze bookings
-        while (fgets(line, sizeof(line), reservationFile)) {
-            int fileBusID;      // Holds the bus ID from the current reservation entry
-            float amountPaid;   // Stores the fare paid for the ticket
-            int numSeats;       // Number of seats booked for this reservation
-
-            // Extract relevant details from the reservation entry using `sscanf`
-            sscanf(line, "%*[^,],%*d,%d,%*[^,],%*[^,],%d,%*[^,],%f", &fileBusID, &numSeats, &amountPaid);
-            // Check if the extracted bus ID matches the current bus
-            if (fileBusID == bus->busID) {
-                totalBookings++;       // Increment booking count for this bus
-                totalBookedSeats += numSeats;  // Add booked seats to total
-                netRevenue += amountPaid; // Add fare to total net revenue
-            }
-        }
+        buses[i].totalBookings = 0;       // Count of successful bookings for this bus
+        buses[i].totalCancellations = 0;  // Count of canceled bookings for this bus
+        buses[i].totalBookedSeats = 0;    // Counter for the total number of booked seats
+        buses[i].totalCanceledSeats = 0;  // Counter for the total number of canceled seats
+        buses[i].totalRevenue = 0;        // Total revenue from all bookings (before refunds)
+        buses[i].lostRevenue = 0;         // Amount lost due to cancellations (refunds issued)
+        buses[i].netRevenue = 0;          // Actual revenue after subtracting lost revenue
+    }
 
-        // Read the cancellations file and count cancellations for the current bus.
-        rewind(cancellationFile);
+    struct StringView line;            // Current line of the file being read
+    struct ReservationRecord record;   // Parsed fields of the current line
 
-        // Read each line from the "cancellations.txt" file to analyze cancellation
-        while (fgets(line, sizeof(line), cancellationFile)) {
-            int fileBusID;  // Holds the bus ID from the current reservation entry
-            float refund;   // Stores the fare paid for the ticket
-            int numSeatsCanceled; // Number of seats canceled in this cancellation
+    // Read each line from the "reservation.txt" file once and credit it to its bus
+    while (readRecordLine(&reservationReader, &line)) {
+        if (!parseReservationRecord(line, &record)) continue; // Skip malformed lines
 
-            // Extract relevant details from the cancellation entry
-            sscanf(line, "%*[^,],%*d,%d,%*[^,],%*[^,],%d,%*[^,],%f", &fileBusID, &numSeatsCanceled, &refund);
+        for (int i = 0; i < busCount; i++) {
+            // Check if the extracted bus ID matches this bus
+            if (buses[i].busID == record.busID) {
+                buses[i].totalBookings++;                     // Increment booking count for this bus
+                buses[i].totalBookedSeats += record.numSeats; // Add booked seats to total
+                buses[i].netRevenue += record.amount; // Add fare to total net revenue
+                break;
+            }
+        }
+    }
+
+    // Read each line from the "cancellations.txt" file once and credit it to its bus
+    while (readRecordLine(&cancellationReader, &line)) {
+        if (!parseReservationRecord(line, &record)) continue; // Skip malformed lines
 
-            // Check if the extracted bus ID matches the current bus
-            if (fileBusID == bus->busID) {
-                totalCancellations++;       // Increment cancellation count for this bus
-                totalCanceledSeats += numSeatsCanceled;  // Add canceled seats to total
-                lostRevenue += refund;      // Add refund to total lost revenue
+        for (int i = 0; i < busCount; i++) {
+            // Check if the extracted bus ID matches this bus
+            if (buses[i].busID == record.busID) {
+                buses[i].totalCancellations++;                  // Increment cancellation count for this bus
+                buses[i].totalCanceledSeats += record.numSeats; // Add canceled seats to total
+                buses[i].lostRevenue += record.amount; // Add refund to total lost revenue
+                break;
             }
         }
+    }
+
+    // Iterate over each bus in report order to write its report data
+    for (int i = 0; i < rows; i++) {
+        struct BusReservation *bus = &buses[order[i]]; // Pointer to the current bus entry
 
         // Compute total revenue, including both earned and lost revenue.
-        totalRevenue = netRevenue + lostRevenue;
+        bus->totalRevenue = bus->netRevenue + bus->lostRevenue;
 
         // Write bus-specific report data to "bus_report.txt".
-        fprintf(reportFile, "%d,%s,%s,%d,%d,%d,%d,RM %.2f,RM %.2f,RM %.2f\n",
-            bus->busID, bus->busNumberPlate, bus->date, totalBookings, totalCancellations,
-            totalBookedSeats, totalCanceledSeats, totalRevenue, lostRevenue, netRevenue);
+        char totalText[MONEY_TEXT_LENGTH], lostText[MONEY_TEXT_LENGTH], netText[MONEY_TEXT_LENGTH];
+        fprintf(reportFile, "%d,%s,%s,%d,%d,%d,%d,RM %s,RM %s,RM %s\n",
+            bus->busID, stringText(bus->busNumberPlate), bus->date, bus->totalBookings, bus->totalCancellations,
+            bus->totalBookedSeats, bus->totalCanceledSeats, formatMoney(bus->totalRevenue, totalText),
+            formatMoney(bus->lostRevenue, lostText), formatMoney(bus->netRevenue, netText));
     }
 
     // Close all opened files to release resources.
-    fclose(reservationFile);
-    fclose(cancellationFile);
+    closeRecordReader(&reservationReader);
+    closeRecordReader(&cancellationReader);
     fclose(reportFile);
 }
 
-void printReportHeader() {
-    // Print a structured header for displaying the report in tabular format.
-    printf("=====================================================================================================================================================\n");
-    printf("| %-5s | %-12s | %-10s | %-12s | %-12s | %-13s | %-13s | %-13s | %-13s | %-13s |\n",
-           "ID", "Number Plate", "Date", "Bookings", "Cancellations", "Booked Seats", "Canceled Seats", "Total Revenue", "Lost Revenue", "Net Revenue");
-    printf("=====================================================================================================================================================\n");
+void appendReportHeader(struct OutputBuffer *out) {
+    // Add a structured header for displaying the report in tabular format.
+    appendOutput(out, "=====================================================================================================================================================\n");
+    appendOutput(out, "| %-5s | %-12s | %-10s | %-12s | %-12s | %-13s | %-13s | %-13s | %-13s | %-13s |\n",
+                 "ID", "Number Plate", "Date", "Bookings", "Cancellations", "Booked Seats", "Canceled Seats", "Total Revenue", "Lost Revenue", "Net Revenue");
+    appendOutput(out, "=====================================================================================================================================================\n");
+}
+
+// Function to parse one line of bus_report.txt back into a BusReservation structure
+int parseBusReportLine(struct StringView line, struct BusReservation *bus) {
+    struct StringView fields[MAX_RECORD_FIELDS];
+
+    // Format: busID,plate,date,bookings,cancellations,bookedSeats,canceledSeats,RM total,RM lost,RM net
+    if (splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS) != 10) {
+        return 0; // Wrong number of fields, skip the line
+    }
+
+    bus->busNumberPlate = internFieldText(fields[1], PLATE_LENGTH);
+    copyView(fields[2], bus->date, sizeof(bus->date));
+
+    return parseIntView(fields[0], &bus->busID) &&
+           parseIntView(fields[3], &bus->totalBookings) &&
+           parseIntView(fields[4], &bus->totalCancellations) &&
+           parseIntView(fields[5], &bus->totalBookedSeats) &&
+           parseIntView(fields[6], &bus->totalCanceledSeats) &&
+           parseAmountView(fields[7], &bus->totalRevenue) &&
+           parseAmountView(fields[8], &bus->lostRevenue) &&
+           parseAmountView(fields[9], &bus->netRevenue);
+}
+
+// Function to add one bus report row in the table format
+void appendBusReportRow(struct OutputBuffer *out, const struct BusReservation *bus) {
+    char totalText[MONEY_TEXT_LENGTH], lostText[MONEY_TEXT_LENGTH], netText[MONEY_TEXT_LENGTH];
+    appendOutput(out, "| %-5d | %-12s | %-10s | %-12d | %-13d | %-13d | %-14d | RM %-10s | RM %-10s | RM %-10s |\n",
+                 bus->busID, stringText(bus->busNumberPlate), bus->date, bus->totalBookings,
+                 bus->totalCancellations, bus->totalBookedSeats, bus->totalCanceledSeats,
+                 formatMoney(bus->totalRevenue, totalText), formatMoney(bus->lostRevenue, lostText),
+                 formatMoney(bus->netRevenue, netText));
 }
 
 void printBusReport() {
     // Open the bus report file for reading
-    FILE *reportFile = fopen("bus_report.txt", "r");
+    struct RecordReader reader;
 
     // Check if the file was opened successfully
-    if (!reportFile) {
+    if (!openRecordReader(&reader, "bus_report.txt")) {
         printf("Error: Could not open bus_report.txt\n");
         return;
     }
 
-    // Print the report header for tabular display
-    printReportHeader();
+    // Render the report header for tabular display
+    struct OutputBuffer *out = beginFrame();
+    appendReportHeader(out);
 
-    char line[MAX_LINE]; // Buffer to store each line read from the file
+    struct StringView line; // Current line of the report
+    struct RequestArena *arena = requestArena();
+    money_t *totalColumn = arenaAlloc(arena, MAX_BUSES, sizeof(money_t)); // Revenue columns for the totals row
+    money_t *lostColumn = arenaAlloc(arena, MAX_BUSES, sizeof(money_t));
+    money_t *netColumn = arenaAlloc(arena, MAX_BUSES, sizeof(money_t));
+    int rows = 0;
+    int columns = totalColumn && lostColumn && netColumn ? MAX_BUSES : 0; // Rows that fit in the columns
 
     // Read each line from the file and parse it into a BusReservation structure
-    while (fgets(line, sizeof(line), reportFile)) {
+    while (readRecordLine(&reader, &line)) {
         struct BusReservation bus;
 
-        // Extract data from the CSV format line
-        sscanf(line, "%d,%[^,],%[^,],%d,%d,%d,%d,RM %f,RM %f,RM %f",
-               &bus.busID, bus.busNumberPlate, bus.date, &bus.totalBookings,
-               &bus.totalCancellations, &bus.totalBookedSeats, &bus.totalCanceledSeats,
-               &bus.totalRevenue, &bus.lostRevenue, &bus.netRevenue);
+        // Extract data from the CSV format line, skipping malformed lines
+        if (!parseBusReportLine(line, &bus)) continue;
 
-        // Print the extracted data in a formatted table row
-        printf("| %-5d | %-12s | %-10s | %-12d | %-13d | %-13d | %-14d | RM %-10.2f | RM %-10.2f | RM %-10.2f |\n",
-               bus.busID, bus.busNumberPlate, bus.date, bus.totalBookings,
-               bus.totalCancellations, bus.totalBookedSeats, bus.totalCanceledSeats,
-               bus.totalRevenue, bus.lostRevenue, bus.netRevenue);
+        // Add the extracted data as a formatted table row
+        appendBusReportRow(out, &bus);
+
+        // Keep the revenue figures so the totals can be added up exactly
+        if (rows < columns) {
+            totalColumn[rows] = bus.totalRevenue;
+            lostColumn[rows] = bus.lostRevenue;
+            netColumn[rows] = bus.netRevenue;
+            rows++;
+        }
     }
 
-    // Print a closing line for the table
-    printf("=====================================================================================================================================================\n");
+    // Print the revenue totals; they add up to the sen because nothing is stored as a float
+    char totalText[MONEY_TEXT_LENGTH], lostText[MONEY_TEXT_LENGTH], netText[MONEY_TEXT_LENGTH];
+    appendOutput(out, "=====================================================================================================================================================\n");
+    appendOutput(out, "| %-5s | %-12s | %-10s | %-12s | %-13s | %-13s | %-14s | RM %-10s | RM %-10s | RM %-10s |\n",
+                 "TOTAL", "", "", "", "", "", "",
+                 formatMoney(sumMoney(totalColumn, rows), totalText),
+                 formatMoney(sumMoney(lostColumn, rows), lostText),
+                 formatMoney(sumMoney(netColumn, rows), netText));
+
+    // Add a closing line for the table and print the whole report in one write
+    appendOutput(out, "=====================================================================================================================================================\n");
+    emitFrame();
 
     // Close the report file after reading is complete
-    fclose(reportFile);
+    closeRecordReader(&reader);
 }
 
 void filterBusReport(int filterType, char *filterValue, char comparison, float filterNumber) {
+    money_t filterAmount = (money_t)(filterNumber * 100 + (filterNumber >= 0 ? 0.5f : -0.5f)); // Net revenue filter in sen
+
     // Open the bus report file for reading
-    FILE *reportFile = fopen("bus_report.txt", "r");
+    struct RecordReader reader;
 
     // Check if the file was opened successfully
-    if (!reportFile) {
+    if (!openRecordReader(&reader, "bus_report.txt")) {
         printf("Error: Could not open bus_report.txt\n");
         return;
     }
 
-    // Print the report header to maintain table formatting
-    printReportHeader();
+    // Render the report header to maintain table formatting
+    struct OutputBuffer *out = beginFrame();
+    appendReportHeader(out);
 
-    char line[MAX_LINE]; // Buffer to store each line read from the file
+    struct StringView line; // Current line of the report
 
     // Read each line from the file and parse it into a BusReservation structure
-    while (fgets(line, sizeof(line), reportFile)) {
+    while (readRecordLine(&reader, &line)) {
         struct BusReservation bus;
 
         // Extract data from the CSV format line, including new fields for booked and canceled seats
-        sscanf(line, "%d,%[^,],%[^,],%d,%d,%d,%d,RM %f,RM %f,RM %f",
-               &bus.busID, bus.busNumberPlate, bus.date, &bus.totalBookings,
-               &bus.totalCancellations, &bus.totalBookedSeats, &bus.totalCanceledSeats,
-               &bus.totalRevenue, &bus.lostRevenue, &bus.netRevenue);
+        if (!parseBusReportLine(line, &bus)) continue;
 
         // Filter by bus ID (filterType == 1)
         if (filterType == 1 && bus.busID != atoi(filterValue)) {
@@ -2639,7 +4108,7 @@ void filterBusReport(int filterType, char *filterValue, char comparison, float f
         }
 
         // Filter by bus number plate (filterType == 2)
-        if (filterType == 2 && strcmp(bus.busNumberPlate, filterValue) != 0) {
+        if (filterType == 2 && strcmp(stringText(bus.busNumberPlate), filterValue) != 0) {
             continue; // Skip if the number plate does not match
         }
 
@@ -2682,118 +4151,142 @@ void filterBusReport(int filterType, char *filterValue, char comparison, float f
 
         // Filter by net revenue (filterType == 6)
         if (filterType == 8) {
-            if ((comparison == 'M' && bus.netRevenue <= filterNumber) ||
-                (comparison == 'L' && bus.netRevenue >= filterNumber)) {
+            if ((comparison == 'M' && bus.netRevenue <= filterAmount) ||
+                (comparison == 'L' && bus.netRevenue >= filterAmount)) {
                 continue; // Skip if the condition is not met
             }
         }
 
-        // Print the filtered bus reservation data in the table format
-        printf("| %-5d | %-12s | %-10s | %-12d | %-13d | %-13d | %-14d | RM %-10.2f | RM %-10.2f | RM %-10.2f |\n",
-               bus.busID, bus.busNumberPlate, bus.date, bus.totalBookings,
-               bus.totalCancellations, bus.totalBookedSeats, bus.totalCanceledSeats,
-               bus.totalRevenue, bus.lostRevenue, bus.netRevenue);
+        // Add the filtered bus reservation data in the table format
+        appendBusReportRow(out, &bus);
     }
 
-    // Print a closing line for the table
-    printf("=====================================================================================================================================================\n");
+    // Add a closing line for the table and print the table in one write
+    appendOutput(out, "=====================================================================================================================================================\n");
+    emitFrame();
 
     // Close the report file after reading is complete
-    fclose(reportFile);
+    closeRecordReader(&reader);
+}
+
+// Function to find the report row slot of a username in the report's own hash table of
+// USER_REPORT_SLOTS entries (open addressing, -1 = empty). The names are matched as text, so a
+// report adds nothing to the string dictionary. An empty slot is returned for a new name.
+int *userReportRow(struct StringView name, char usernames[][USERNAME_LENGTH], int rows[]) {
+    unsigned int hash = 2166136261u; // FNV-1a
+    for (int i = 0; i < name.length; i++) {
+        hash = (hash ^ (unsigned char)name.data[i]) * 16777619u;
+    }
+    for (unsigned int probe = hash & (USER_REPORT_SLOTS - 1); ; probe = (probe + 1) & (USER_REPORT_SLOTS - 1)) {
+        if (rows[probe] == -1 || viewEquals(name, usernames[rows[probe]])) return &rows[probe];
+    }
 }
 
 void generateUserReport() {
     // Open necessary files for reading reservations and cancellations, and writing the user report
-    FILE *resFile = fopen("reservation.txt", "r");
-    FILE *cancelFile = fopen("cancellations.txt", "r");
+    struct RecordReader resReader, cancelReader;
+    int resOpen = openRecordReader(&resReader, "reservation.txt");
+    int cancelOpen = openRecordReader(&cancelReader, "cancellations.txt");
     FILE *reportFile = fopen("user_report.txt", "w");
 
     // Check if files opened successfully
-    if (!resFile || !cancelFile || !reportFile) {
+    if (!resOpen || !cancelOpen || !reportFile) {
         printf("Error opening files!\n");
+        closeRecordReader(&resReader);
+        closeRecordReader(&cancelReader);
+        if (reportFile) fclose(reportFile);
         return;
     }
 
     // Arrays to store user-related data
-    char usernames[MAX_USERS][50];  // Stores unique usernames
-    float userSpending[MAX_USERS] = {0};  // Total amount spent per user
-    float userRefunds[MAX_USERS] = {0};   // Total refund amount per user
+    char usernames[MAX_USERS][USERNAME_LENGTH];  // Stores unique usernames
+    money_t userSpending[MAX_USERS] = {0};  // Total amount spent per user
+    money_t userRefunds[MAX_USERS] = {0};   // Total refund amount per user
     int userBookings[MAX_USERS] = {0};    // Number of bookings per user
     int userCancellations[MAX_USERS] = {0};  // Number of cancellations per user
     int localUserCount = 0;  // Total number of unique users found
-
-    char username[50];  // Buffer for username extraction
-    float amount;       // Buffer for amount extraction
-
-    char line[MAX_LINE];
-    while (fgets(line, sizeof(line), resFile)) {
-        // Extract username and amount paid from the reservation record
-        sscanf(line, "%49[^,],%*d,%*d,%*[^,],%*[^,],%*d,%*[^,],%f", username, &amount);
-
-        // Skip empty usernames
-        if (strlen(username) == 0) continue;
+    int rowOfName[USER_REPORT_SLOTS];  // Report row of each username, so a record finds its user in one step
+    memset(rowOfName, -1, sizeof(rowOfName));
+
+    struct StringView line;            // Current line of the file being read
+    struct ReservationRecord record;   // Parsed username and amount of the record
+    struct ArchiveScan archive;        // Archived rows, read before the journal they came from
+
+    // Archived reservations are the oldest, so users keep the order of their first booking
+    openArchiveScan(&archive, "reservation.txt", NULL);
+    for (;;) {
+        if (nextArchiveRecord(&archive, &record)) {
+            // Archived row
+        } else if (!readRecordLine(&resReader, &line)) {
+            break;
+        } else if (!parseReservationRecord(line, &record)) {
+            continue; // Skip malformed lines
+        }
 
         // Check if the user is already recorded
-        int userIndex = -1;
-        for (int i = 0; i < localUserCount; i++) {
-            if (strcmp(usernames[i], username) == 0) {
-                userIndex = i;
-                break;
-            }
-        }
+        if (record.username.length >= USERNAME_LENGTH) continue; // Longer than any registered name
+        int *row = userReportRow(record.username, usernames, rowOfName);
+        int userIndex = *row;
 
         // If the user is not found, add them to the list
         if (userIndex == -1) {
+            if (localUserCount >= MAX_USERS) continue; // No room for another user in the report
             userIndex = localUserCount;
-            strcpy(usernames[localUserCount], username);
+            copyView(record.username, usernames[localUserCount], USERNAME_LENGTH);
+            *row = userIndex;
             localUserCount++;
         }
 
         // Increment booking count and add spending amount for the user
         userBookings[userIndex]++;
-        userSpending[userIndex] += amount;
+        userSpending[userIndex] += record.amount;
     }
-    fclose(resFile); // Close reservation file after processing
+    closeArchiveScan(&archive);
+    closeRecordReader(&resReader); // Close reservation file after processing
 
-    while (fgets(line, sizeof(line), cancelFile)) {
-        // Extract username and refund amount from the cancellation record
-        sscanf(line, "%49[^,],%*d,%*d,%*[^,],%*[^,],%*d,%*[^,],%f", username, &amount);
-
-        // Skip empty usernames
-        if (strlen(username) == 0) continue;
+    openArchiveScan(&archive, "cancellations.txt", NULL);
+    for (;;) {
+        // Extract username and refund amount from the archived or current cancellation record
+        if (nextArchiveRecord(&archive, &record)) {
+            // Archived row
+        } else if (!readRecordLine(&cancelReader, &line)) {
+            break;
+        } else if (!parseReservationRecord(line, &record)) {
+            continue;
+        }
 
         // Find the user in the recorded list
-        for (int i = 0; i < localUserCount; i++) {
-            if (strcmp(usernames[i], username) == 0) {
-                // Increment cancellation count and add refund amount for the user
-                userCancellations[i]++;
-                userRefunds[i] += amount;
-                break;
-            }
+        int *row = userReportRow(record.username, usernames, rowOfName);
+        if (*row != -1) {
+            // Increment cancellation count and add refund amount for the user
+            userCancellations[*row]++;
+            userRefunds[*row] += record.amount;
         }
     }
-    fclose(cancelFile); // Close cancellation file after processing
-
+    closeArchiveScan(&archive);
+    closeRecordReader(&cancelReader); // Close cancellation file after processing
 
     for (int i = 0; i < localUserCount; i++) {
         // Skip users who have neither bookings nor cancellations
         if (userBookings[i] == 0 && userCancellations[i] == 0) continue;
 
         // Calculate the average spending per booking (avoid division by zero)
-        float avgSpending = (userBookings[i] > 0) ? (userSpending[i] / userBookings[i]) : 0.0;
+        money_t avgSpending = averageMoney(userSpending[i], userBookings[i]);
 
         // Write the formatted user data to the report file
-        fprintf(reportFile, "%s,%d,%d,RM %.2f,RM %.2f,RM %.2f\n",
+        char spentText[MONEY_TEXT_LENGTH], refundText[MONEY_TEXT_LENGTH], avgText[MONEY_TEXT_LENGTH];
+        fprintf(reportFile, "%s,%d,%d,RM %s,RM %s,RM %s\n",
                 usernames[i], userBookings[i], userCancellations[i],
-                userSpending[i], userRefunds[i], avgSpending);
+                formatMoney(userSpending[i], spentText), formatMoney(userRefunds[i], refundText),
+                formatMoney(avgSpending, avgText));
     }
 
     fclose(reportFile); // Close the report file after writing is complete
 }
 
 void printUserReport() {
-    FILE *reportFile = fopen("user_report.txt", "r");
-    if (!reportFile) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, "user_report.txt")) {
         printf("Error: Could not open user_report.txt\n");
         return;
     }
@@ -2803,151 +4296,283 @@ void printUserReport() {
            "Username", "Bookings", "Cancellations", "Total Spent", "Total Refund", "Avg Spending");
     printf("==============================================================================================\n");
 
-    char username[50];
     int totalBookings, totalCancellations;
-    float totalSpent, totalRefund, avgSpending;
-
-    char line[MAX_LINE];
-    while (fgets(line, sizeof(line), reportFile)) {
-        sscanf(line, "%49[^,],%d,%d,RM %f,RM %f,RM %f",
-               username, &totalBookings, &totalCancellations,
-               &totalSpent, &totalRefund, &avgSpending);
+    money_t totalSpent, totalRefund, avgSpending;
+    char spentText[MONEY_TEXT_LENGTH], refundText[MONEY_TEXT_LENGTH], avgText[MONEY_TEXT_LENGTH];
+
+    struct StringView line;
+    struct StringView fields[MAX_RECORD_FIELDS];
+    while (readRecordLine(&reader, &line)) {
+        // Format: username,bookings,cancellations,RM spent,RM refund,RM average
+        if (splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS) != 6 ||
+            !parseIntView(fields[1], &totalBookings) ||
+            !parseIntView(fields[2], &totalCancellations) ||
+            !parseAmountView(fields[3], &totalSpent) ||
+            !parseAmountView(fields[4], &totalRefund) ||
+            !parseAmountView(fields[5], &avgSpending)) {
+            continue; // Skip malformed lines
+        }
 
-        printf("| %-12s | %-10d | %-14d | RM %-10.2f | RM %-10.2f | RM %-10.2f |\n",
-               username, totalBookings, totalCancellations, totalSpent, totalRefund, avgSpending);
+        printf("| %-12.*s | %-10d | %-14d | RM %-10s | RM %-10s | RM %-10s |\n",
+               fields[0].length, fields[0].data, totalBookings, totalCancellations,
+               formatMoney(totalSpent, spentText), formatMoney(totalRefund, refundText),
+               formatMoney(avgSpending, avgText));
     }
 
     printf("==============================================================================================\n");
 
-    fclose(reportFile);
-}
-
-// Function to print header for both reservations and cancellations
-void printHeader(const char *title) {
-    // Print the title of the report
-    printf("\n%s\n", title);
-    // Print the separator line for visual clarity
-    printf("-------------------------------------------------------------------------------------------------------------------\n");
-    // Print the table headers: username, ticket number, bus ID, bus number plate, date, number of seats, seat numbers, and amount
-    printf("| %-12s | %-12s | %-6s | %-15s | %-12s | %-8s | %-15s | %-10s |\n",
-           "Username", "Ticket No.", "BusID", "Number Plate", "Date", "Seats", "Seat Numbers", "Amount");
-    // Print the separator line for visual clarity
-    printf("-------------------------------------------------------------------------------------------------------------------\n");
+    closeRecordReader(&reader);
 }
 
-// Function to print all reservations
+// Function to print all reservations, one page at a time
 void printReservations() {
-    // Open the reservations file for reading
-    FILE *file = fopen("reservation.txt", "r");
-    if (!file) {
-        // If file doesn't exist or can't be opened, print an error message and return
-        printf("Error: Could not open reservation.txt for reading!\n");
-        return;
+    // The pager reads the journal only; say so when earlier travel months have been archived
+    int archived = countArchivedRows("reservation.txt");
+    if (archived > 0) {
+        printf("Note: This report shows current travel only. %d reservation(s) of earlier travel months are archived;\n", archived);
+        printf("      use Filter Reservations Report to include them.\n");
     }
+    browseRecords("reservation.txt", "Reservations Report");
+}
 
-    // Call the printHeader function to print the report title and column headers
-    printHeader("Reservations Report");
-
-    char line[256], username[50], busNumberPlate[20], bookingDate[20], seatsBuffer[100];
-    int ticketNumber, busID, numSeats;
-    float finalAmount;
+// Function to print all cancellations, one page at a time
+void printCancellations() {
+    int archived = countArchivedRows("cancellations.txt"); // Not paged; see printReservations()
+    if (archived > 0) {
+        printf("Note: This report shows current travel only. %d cancellation(s) of earlier travel months are archived;\n", archived);
+        printf("      use Filter Cancellations Report to include them.\n");
+    }
+    browseRecords("cancellations.txt", "Cancellations Report");
+}
 
-    // Read each line of the reservation file
-    while (fgets(line, sizeof(line), file)) {
-        // Use sscanf to parse the line into respective fields: username, ticket number, bus ID, bus number plate, etc.
-        if (sscanf(line, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f",
-                   username, &ticketNumber, &busID, busNumberPlate, bookingDate, &numSeats, seatsBuffer, &finalAmount) == 8) {
-            // Print the parsed data into a formatted table
-            printf("| %-12s | %-12d | %-6d | %-15s | %-12s | %-8d | %-15s | RM%-8.2f |\n",
-                   username, ticketNumber, busID, busNumberPlate, bookingDate, numSeats, seatsBuffer, finalAmount);
+// Function to check a parsed record against every filter criterion
+int recordMatchesCriteria(const struct ReservationRecord *record, const struct IndexCriterion criteria[], int criteriaCount) {
+    for (int i = 0; i < criteriaCount; i++) {
+        const char *value = criteria[i].value;
+        if ((criteria[i].type == INDEX_USERNAME && !viewEquals(record->username, value)) ||       // Filter by username
+            (criteria[i].type == INDEX_BUS_ID && record->busID != atoi(value)) ||                 // Filter by bus ID
+            (criteria[i].type == INDEX_PLATE && !viewEquals(record->busNumberPlate, value)) ||    // Filter by bus number plate
+            (criteria[i].type == INDEX_DATE && !viewContains(record->date, value))) {             // Filter by date (substring match)
+            return 0;
         }
     }
-
-    // Print the separator line after all data has been printed
-    printf("-------------------------------------------------------------------------------------------------------------------\n");
-    // Close the file after reading
-    fclose(file);
+    return 1;
 }
 
-// Function to print all cancellations
-void printCancellations() {
-    // Open the cancellations file for reading
-    FILE *file = fopen("cancellations.txt", "r");
-    if (!file) {
-        // If file doesn't exist or can't be opened, print an error message and return
-        printf("Error: Could not open cancellations.txt for reading!\n");
+// Function to filter reservations or cancellations on one or more criteria.
+// When every criterion is indexed, only the matching lines are read (posting lists from
+// <file>.idx are intersected); otherwise the whole file is scanned as before.
+void filterRecordsByCriteria(const char *filename, const struct IndexCriterion criteria[], int criteriaCount) {
+    // Open the file (either reservation.txt or cancellations.txt) for reading
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, filename)) {
+        // If file can't be opened, print an error message and return
+        printf("Error: Could not open %s for reading!\n", filename);
         return;
     }
 
-    // Call the printHeader function to print the report title and column headers
-    printHeader("Cancellations Report");
+    // Use the index only if it can answer every criterion exactly
+    int indexed = criteriaCount > 0;
+    for (int i = 0; i < criteriaCount; i++) {
+        indexed = indexed && canIndexCriterion(&criteria[i]);
+    }
+
+    long *offsets = NULL;  // File offsets of the matching lines, in file order
+    int matchCount = -1;   // Stays -1 when the file has to be scanned
+    if (indexed) {
+        struct RecordIndex *index = getRecordIndex(filename);
+        if (index) {
+            matchCount = queryRecordIndex(index, criteria, criteriaCount, &offsets);
+        }
+    }
+
+    // Render the header for the filtered report (filtered reservations or cancellations)
+    struct OutputBuffer *out = beginFrame();
+    appendRecordHeader(out, strcmp(filename, "reservation.txt") == 0 ? "Filtered Reservations" : "Filtered Cancellations");
+
+    struct StringView line;            // Current line of the file
+    struct ReservationRecord record;   // Parsed fields of the line
 
-    char line[256], username[50], busNumberPlate[20], cancellationDate[20], seatsBuffer[100];
-    int ticketNumber, busID, numSeats;
-    float refundAmount;
+    // Archived travel months come first; partitions and blocks whose zone maps rule out
+    // a match are skipped without being read
+    struct ArchivePredicate predicate;
+    struct ArchiveScan archive;
+    archivePredicateFromCriteria(&predicate, criteria, criteriaCount);
+    openArchiveScan(&archive, filename, &predicate);
+    while (nextArchiveRecord(&archive, &record)) {
+        if (recordMatchesCriteria(&record, criteria, criteriaCount)) {
+            appendRecordRow(out, &record);
+        }
+        if (out->length >= OUTPUT_BUFFER_SIZE) emitFrame(); // Long results go out in large blocks
+    }
+    closeArchiveScan(&archive);
 
-    // Read each line of the cancellations file
-    while (fgets(line, sizeof(line), file)) {
-        // Use sscanf to parse the line into respective fields: username, ticket number, bus ID, bus number plate, etc.
-        if (sscanf(line, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f",
-                   username, &ticketNumber, &busID, busNumberPlate, cancellationDate, &numSeats, seatsBuffer, &refundAmount) == 8) {
-            // Print the parsed data into a formatted table
-            printf("| %-12s | %-12d | %-6d | %-15s | %-12s | %-8d | %-15s | RM%-8.2f |\n",
-                   username, ticketNumber, busID, busNumberPlate, cancellationDate, numSeats, seatsBuffer, refundAmount);
+    if (matchCount >= 0) {
+        // Jump straight to each match; the record is checked again in case the line changed
+        for (int i = 0; i < matchCount; i++) {
+            if (seekRecordReader(&reader, offsets[i]) && readRecordLine(&reader, &line) &&
+                parseReservationRecord(line, &record) && recordMatchesCriteria(&record, criteria, criteriaCount)) {
+                appendRecordRow(out, &record);
+            }
+            if (out->length >= OUTPUT_BUFFER_SIZE) emitFrame(); // Long results go out in large blocks
+        }
+    } else {
+        // Read each line of the file
+        while (readRecordLine(&reader, &line)) {
+            // Parse each line and print it if it meets every filter condition
+            if (parseReservationRecord(line, &record) && recordMatchesCriteria(&record, criteria, criteriaCount)) {
+                appendRecordRow(out, &record);
+            }
+            if (out->length >= OUTPUT_BUFFER_SIZE) emitFrame(); // Long results go out in large blocks
         }
     }
 
-    // Print the separator line after all data has been printed
-    printf("-------------------------------------------------------------------------------------------------------------------\n");
+    // Add the separator line after the filtered data and print what is left
+    appendOutput(out, "-------------------------------------------------------------------------------------------------------------------\n");
+    emitFrame();
+    free(offsets);
     // Close the file after reading
-    fclose(file);
+    closeRecordReader(&reader);
 }
 
 // Function to filter reservations and cancellations based on different criteria
 void filterRecords(const char *filename, int filterType, const char *filterValue) {
-    // Open the file (either reservation.txt or cancellations.txt) for reading
-    FILE *file = fopen(filename, "r");
-    if (!file) {
-        // If file can't be opened, print an error message and return
-        printf("Error: Could not open %s for reading!\n", filename);
-        return;
+    static const char filterTypes[] = { INDEX_USERNAME, INDEX_BUS_ID, INDEX_PLATE, INDEX_DATE };
+    struct IndexCriterion criterion;
+    int criteriaCount = 0; // An unknown filter type matches every record
+
+    if (filterType >= 1 && filterType <= 4) {
+        criterion.type = filterTypes[filterType - 1];
+        if (criterion.type == INDEX_BUS_ID) {
+            snprintf(criterion.value, sizeof(criterion.value), "%d", atoi(filterValue)); // "007" is bus 7
+        } else {
+            snprintf(criterion.value, sizeof(criterion.value), "%s", filterValue);
+        }
+        criteriaCount = 1;
+    }
+    filterRecordsByCriteria(filename, &criterion, criteriaCount);
+}
+
+// Function to ask for several filter values at once; '-' skips a field
+int readFilterCriteria(struct IndexCriterion criteria[]) {
+    static const char filterTypes[] = { INDEX_USERNAME, INDEX_BUS_ID, INDEX_PLATE, INDEX_DATE };
+    static const char *prompts[] = { "Username", "Bus ID", "Bus Number Plate", "Date" };
+    int criteriaCount = 0;
+    char value[50];
+
+    for (int i = 0; i < MAX_INDEX_CRITERIA; i++) {
+        printf("%s ('-' for any): ", prompts[i]);
+        if (scanf("%49s", value) != 1 || strcmp(value, "-") == 0) {
+            continue;
+        }
+        criteria[criteriaCount].type = filterTypes[i];
+        if (filterTypes[i] == INDEX_BUS_ID) {
+            snprintf(criteria[criteriaCount].value, sizeof(criteria[criteriaCount].value), "%d", atoi(value));
+        } else {
+            snprintf(criteria[criteriaCount].value, sizeof(criteria[criteriaCount].value), "%s", value);
+        }
+        criteriaCount++;
     }
+    return criteriaCount;
+}
 
-    // Print the header for the filtered report (filtered reservations or cancellations)
-    printHeader(strcmp(filename, "reservation.txt") == 0 ? "Filtered Reservations" : "Filtered Cancellations");
-
-    char line[256], username[50], busNumberPlate[20], date[20], seatsBuffer[100];
-    int ticketNumber, busID, numSeats;
-    float amount;
-
-    // Read each line of the file
-    while (fgets(line, sizeof(line), file)) {
-        // Parse each line into respective fields: username, ticket number, bus ID, bus number plate, etc.
-        if (sscanf(line, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f",
-                   username, &ticketNumber, &busID, busNumberPlate, date, &numSeats, seatsBuffer, &amount) == 8) {
-            // Apply the filter condition based on the filter type
-            if ((filterType == 1 && strcmp(username, filterValue) != 0) ||  // Filter by username
-                (filterType == 2 && busID != atoi(filterValue)) ||         // Filter by bus ID
-                (filterType == 3 && strcmp(busNumberPlate, filterValue) != 0) ||  // Filter by bus number plate
-                (filterType == 4 && strstr(date, filterValue) == NULL)) {   // Filter by date (substring match)
-                continue;  // Skip the record if the filter doesn't match
+// Function to add the departed trips kept in bus_history.txt to the cube's trip list, so the
+// bookings of purged and archived trips are counted under their routes.
+// Returns the new trip count, or -1 if memory ran out.
+int appendHistoryTrips(struct OccupancyTrip **trips, int tripCount, int *capacity) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, "bus_history.txt")) return tripCount; // Nothing purged yet
+
+    struct StringView line;
+    struct BusRecord record;
+    while (readRecordLine(&reader, &line)) {
+        int day, minute;
+        if (!parseBusRecord(line, &record) || !parseDateView(record.date, &day) ||
+            !parseTimeView(record.departureTime, &minute)) {
+            continue; // Skip malformed lines
+        }
+        if (tripCount == *capacity) {
+            *capacity = *capacity ? *capacity * 2 : 64;
+            struct OccupancyTrip *grown = realloc(*trips, (size_t)*capacity * sizeof(**trips));
+            if (!grown) {
+                closeRecordReader(&reader);
+                return -1;
             }
-            // If the filter condition is met, print the filtered record
-            printf("| %-12s | %-12d | %-6d | %-15s | %-12s | %-8d | %-15s | RM%-8.2f |\n",
-                   username, ticketNumber, busID, busNumberPlate, date, numSeats, seatsBuffer, amount);
+            *trips = grown;
         }
+
+        // The route becomes a series key, so it is interned like the routes of the trips in memory
+        struct OccupancyTrip *trip = &(*trips)[tripCount++];
+        trip->busID = record.busID;
+        trip->busNumberPlate = internFieldText(record.busNumberPlate, PLATE_LENGTH);
+        trip->source = internFieldText(record.source, CITY_LENGTH);
+        trip->destination = internFieldText(record.destination, CITY_LENGTH);
+        trip->departureDay = day;
+        trip->departureHour = minute / 60;
+        trip->totalSeats = record.totalSeats;
+        trip->bookedSeats = record.totalSeats - record.availableSeats;
+    }
+    closeRecordReader(&reader);
+    return tripCount;
+}
+
+// Function to show the occupancy cube: for every route, departure hour and day, the seats sold,
+// cancelled and booked, the load factor and revenue, with rolling 7- and 30-day load factors.
+// Departed trips from bus_history.txt are included, with their journal and archived rows.
+void showOccupancyAnalytics(const struct BusReservation buses[], int busCount) {
+    int capacity = busCount > 0 ? busCount : 1;
+    struct OccupancyTrip *trips = malloc((size_t)capacity * sizeof(*trips));
+    if (!trips) {
+        printf("Error: Not enough memory for the analytics.\n");
+        return;
     }
 
-    // Print the separator line after the filtered data has been printed
-    printf("-------------------------------------------------------------------------------------------------------------------\n");
-    // Close the file after reading
-    fclose(file);
+    int tripCount = 0;
+    for (int i = 0; i < busCount; i++) {
+        const struct BusReservation *bus = &buses[i];
+        if (isFreeBusSlot(bus)) continue;
+        trips[tripCount].busID = bus->busID;
+        trips[tripCount].busNumberPlate = bus->busNumberPlate;
+        trips[tripCount].source = bus->source;
+        trips[tripCount].destination = bus->destination;
+        trips[tripCount].departureDay = bus->departureDay;
+        trips[tripCount].departureHour = bus->departureMinute / 60;
+        trips[tripCount].totalSeats = bus->totalSeats;
+        trips[tripCount].bookedSeats = bus->totalSeats - bus->availableSeats;
+        tripCount++;
+    }
+
+    tripCount = appendHistoryTrips(&trips, tripCount, &capacity);
+    if (tripCount < 0) {
+        free(trips);
+        printf("Error: Not enough memory for the analytics.\n");
+        return;
+    }
+
+    struct OccupancyCube cube;
+    int built = buildOccupancyCube(&cube, trips, tripCount, "reservation.txt", "cancellations.txt");
+    free(trips);
+    if (!built) {
+        printf("Error: Could not build the occupancy analytics.\n");
+        return;
+    }
+
+    struct OutputBuffer *out = beginFrame();
+    appendOutput(out, "\nOccupancy by Route, Departure Hour and Day\n");
+    appendOccupancyReport(out, &cube);
+    if (cube.seriesCount == 0) {
+        appendOutput(out, "No trips scheduled.\n");
+    }
+    emitFrame();
+    freeOccupancyCube(&cube);
 }
 
 // Function to display report options and handle user selection
-void viewReport() {
+void viewReport(const struct BusReservation buses[], int busCount) {
     int option;
     do {
+        resetArena(requestArena()); // Each report is its own request; nothing outlives it
+
         // Print the menu options for viewing reports
         printf("\nView Report:\n");
         printf("1. Full Bus Report\n");
@@ -2957,7 +4582,8 @@ void viewReport() {
         printf("5. Filter Reservations Report\n");
         printf("6. Cancellations Report\n");
         printf("7. Filter Cancellations Report\n");
-        printf("8. Back to Admin Menu\n");
+        printf("8. Occupancy Analytics\n");
+        printf("9. Back to Admin Menu\n");
         printf("Enter your choice: ");
 
         // Read user input for menu selection
@@ -3036,6 +4662,7 @@ void viewReport() {
             printf("2. Filter by Bus ID\n");
             printf("3. Filter by Bus Number Plate\n");
             printf("4. Filter by Date\n");
+            printf("5. Filter by Multiple Criteria\n");
             printf("Enter filter option: ");
             if (scanf("%d", &filterType) != 1) {
                 printf("Invalid input! Please enter a number.\n");
@@ -3043,6 +4670,14 @@ void viewReport() {
                 continue;
             }
 
+            if (filterType == 5) {
+                // Combine several fields, e.g. one user's bookings on one bus in one month
+                struct IndexCriterion criteria[MAX_INDEX_CRITERIA];
+                int criteriaCount = readFilterCriteria(criteria);
+                filterRecordsByCriteria("reservation.txt", criteria, criteriaCount); // Filter and display reservations
+                continue;
+            }
+
             // Read the value to filter by
             printf("Enter value to filter by: ");
             scanf("%s", filterValue);
@@ -3058,6 +4693,7 @@ void viewReport() {
             printf("2. Filter by Bus ID\n");
             printf("3. Filter by Bus Number Plate\n");
             printf("4. Filter by Date\n");
+            printf("5. Filter by Multiple Criteria\n");
             printf("Enter filter option: ");
             if (scanf("%d", &filterType) != 1) {
                 printf("Invalid input! Please enter a number.\n");
@@ -3065,24 +4701,55 @@ void viewReport() {
                 continue;
             }
 
+            if (filterType == 5) {
+                // Combine several fields, e.g. one user's bookings on one bus in one month
+                struct IndexCriterion criteria[MAX_INDEX_CRITERIA];
+                int criteriaCount = readFilterCriteria(criteria);
+                filterRecordsByCriteria("cancellations.txt", criteria, criteriaCount); // Filter and display cancellations
+                continue;
+            }
+
             // Read the value to filter by
             printf("Enter value to filter by: ");
             scanf("%s", filterValue);
             filterRecords("cancellations.txt", filterType, filterValue); // Filter and display cancellations
-        } else if (option != 8) {
+        } else if (option == 8) {
+            showOccupancyAnalytics(buses, busCount); // Seats sold and load factor by route and day
+        } else if (option != 9) {
             // If an invalid option is entered, prompt the user to try again
             printf("Invalid option! Please try again.\n");
         }
-    } while (option != 8); // Exit the loop when the user selects the "Back to Admin Menu" option
+    } while (option != 9); // Exit the loop when the user selects the "Back to Admin Menu" option
 }
 
 int main() {
     srand(time(NULL)); // Seed random number generator for unique ticket numbers
+    // Finish or drop saves that were interrupted by a crash before anything is loaded
+    const char *savedFiles[] = { "buses.txt", "seats.txt", "user.txt", "reservation.txt", "cancellations.txt", "temp_updates.txt", SEAT_CHANGES_FILE, STATE_SNAPSHOT_FILE, WAITLIST_FILE, ARCHIVE_MANIFEST_FILE };
+    recoverDurableFiles(savedFiles, sizeof(savedFiles) / sizeof(savedFiles[0]));
 
     struct BusReservation buses[MAX_BUSES]; // Array to store bus schedules
-    int busCount = loadBuses(buses, MAX_BUSES); // Load bus data from file
-    int resCount = loadSeats(buses, MAX_BUSES); // Load seat reservation data
-    loadUsers(); // Load registered users into memory
+    attachBusBookings(buses, MAX_BUSES); // Booking detail lives beside the schedules, one per slot
+    if (!reservePriceTable(&priceTable, MAX_BUSES) || // Every slot is priced before it can be sold
+        !reserveStrings()) { // Plates, cities and usernames are interned as they are loaded
+        printf("Error: Not enough memory to start.\n");
+        return 1;
+    }
+    int busCount = 0;
+    int resCount = 0;
+    int fromSnapshot = loadStateSnapshot(buses, &busCount); // Map the last snapshot if the text files have not changed since
+    if (!fromSnapshot) {
+        busCount = loadBuses(buses, MAX_BUSES); // Load bus data from file
+        resCount = loadSeats(buses, busCount); // Load seat reservation data
+        pendingSeatChanges = loadSeatChanges(buses, busCount); // Seats booked since the last checkpoint
+    }
+    rebuildDepartureIndex(buses, busCount); // Order schedules by departure time
+    templateCount = loadScheduleTemplates(templates, MAX_TEMPLATES); // Load recurring timetables
+    loadWaitlist(); // Parties waiting for sold-out trips and the seats held for them
+    loadPricingTiers(&pricingTiers, PRICING_FILE); // Without tiers every trip sells at its base fare
+    if (!fromSnapshot) {
+        loadUsers(); // Load registered users into memory
+    }
 
     struct user currentUser; // Stores the currently logged-in user
     int choice; // Stores menu choice input
@@ -3116,6 +4783,8 @@ int main() {
                 registerUser();
                 break;
             case 4: // Exit program
+                checkpointSeatChanges(buses, busCount); // Leave buses.txt and seats.txt complete
+                saveStateSnapshot(buses, busCount); // Next start maps this instead of parsing the files
                 printf("Exiting the system...\n");
                 return 0;
             default: // Handle invalid input
@@ -3132,10 +4801,18 @@ int main() {
             printf("4. Update Bus Schedule\n");
             printf("5. Delete Bus Schedule\n");
             printf("6. View Report\n");
-            printf("7. Logout\n");
+            printf("7. Add Recurring Schedule\n");
+            printf("8. Import Bus Schedules (CSV)\n");
+            printf("9. Purge Past Trips\n");
+            printf("10. Bulk Update Schedules (CSV)\n");
+            printf("11. Logout\n");
             printf("Enter your choice: ");
 
             scanf("%d", &choice); // Get admin menu choice
+            resetArena(requestArena()); // Drop the scratch memory of the previous command
+            releaseIdleTemplateTrips(buses, busCount); // Template trips left unbooked by the previous command
+            offerExpiredHolds(buses, busCount); // Held seats nobody paid for go to the next in line
+            refreshSeatPrices(buses, busCount); // Prices hold still for the whole command
 
             switch (choice) {
                 case 1:
@@ -3155,11 +4832,25 @@ int main() {
                     break;
                 case 6:
                     generateReports(buses, busCount); // Generate reports before viewing
-                    viewReport(); // View various reports
+                    viewReport(buses, busCount); // View various reports
                     break;
                 case 7:
+                    addRecurringSchedule();
+                    break;
+                case 8:
+                    importBusSchedules(buses, &busCount);
+                    break;
+                case 9:
+                    purgePastTrips(buses, &busCount);
+                    break;
+                case 10:
+                    bulkUpdateBusSchedules(buses, &busCount);
+                    break;
+                case 11:
                     printf("Logging out...\n");
                     loggedInAsAdmin = 0; // Exit admin menu
+                    checkpointSeatChanges(buses, busCount);
+                    saveStateSnapshot(buses, busCount); // Checkpoint, so a crash later still starts fast
                     break;
                 default:
                     printf("Invalid choice! Please try again.\n");
@@ -3178,10 +4869,15 @@ int main() {
             printf("7. Cancel Booking\n");
             printf("8. Update User Information\n");
             printf("9. View Booking History\n");
-            printf("10. Logout\n");
+            printf("10. Next Departures\n");
+            printf("11. Logout\n");
             printf("Enter your choice: ");
 
             scanf("%d", &choice); // Get user menu choice
+            resetArena(requestArena()); // Drop the scratch memory of the previous command
+            releaseIdleTemplateTrips(buses, busCount); // Template trips left unbooked by the previous command
+            offerExpiredHolds(buses, busCount); // Held seats nobody paid for go to the next in line
+            refreshSeatPrices(buses, busCount); // Prices hold still for the whole command
 
             switch (choice) {
                 case 1:
@@ -3199,11 +4895,9 @@ int main() {
                 case 5:
                     viewNotifications(&currentUser);
                     break;
-                case 6: { // View ticket details
-                    int ticketCount = loadTicketNumbers(buses, busCount); // Load ticket data
+                case 6: // View ticket details
                     getTicketDetails(buses, busCount); // Retrieve ticket info
                     break;
-                }
                 case 7:
                     cancelBooking(currentUser, buses, busCount);
                     break;
@@ -3211,11 +4905,16 @@ int main() {
                     updateUser();
                     break;
                 case 9:
-                    viewBookingHistory(currentUser);
+                    viewBookingHistory(currentUser, buses, busCount);
                     break;
                 case 10:
+                    showNextDepartures(buses, busCount);
+                    break;
+                case 11:
                     printf("Logging out...\n");
                     loggedInAsUser = 0; // Exit user menu
+                    checkpointSeatChanges(buses, busCount);
+                    saveStateSnapshot(buses, busCount); // Checkpoint, so a crash later still starts fast
                     break;
                 default:
                     printf("Invalid choice! Please try again.\n");
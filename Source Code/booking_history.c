@@ -0,0 +1,131 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+static struct BookingHistory histories[MAX_CACHED_HISTORIES]; // Recently viewed users, least recently used evicted
+static unsigned long historyClock = 0;                       // Ticks on every lookup, for the LRU order
+
+// Function to add an offset to the end of a history
+static int appendHistory(struct BookingHistory *history, long offset) {
+    if (history->count == history->capacity) {
+        int capacity = history->capacity ? history->capacity * 2 : 64;
+        long *offsets = realloc(history->offsets, (size_t)capacity * sizeof(long));
+        if (!offsets) return 0;
+        history->offsets = offsets;
+        history->capacity = capacity;
+    }
+    history->offsets[history->count++] = offset;
+    return 1;
+}
+
+// Function to collect a user's bookings by reading the whole journal, when no index is available
+static int scanHistory(struct BookingHistory *history) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, "reservation.txt")) return 0;
+
+    struct StringView line;
+    struct ReservationRecord record;
+    int ok = 1;
+    while (ok && readRecordLine(&reader, &line)) {
+        if (parseReservationRecord(line, &record) && viewEquals(record.username, history->username)) {
+            ok = appendHistory(history, reader.lineOffset);
+        }
+    }
+    closeRecordReader(&reader);
+    return ok;
+}
+
+// Function to load a user's bookings from the username postings of the reservation index
+static int loadHistory(struct BookingHistory *history) {
+    history->count = 0;
+    if (!fingerprintFile("reservation.txt", &history->source)) return 0;
+
+    struct IndexCriterion criterion;
+    criterion.type = INDEX_USERNAME;
+    snprintf(criterion.value, sizeof(criterion.value), "%s", history->username);
+
+    struct RecordIndex *index = canIndexCriterion(&criterion) ? getRecordIndex("reservation.txt") : NULL;
+    long *offsets;
+    int found = index ? queryRecordIndex(index, &criterion, 1, &offsets) : -1;
+    if (found < 0) return scanHistory(history);
+
+    // Postings are in file order, so the history comes out oldest first
+    int ok = 1;
+    for (int i = 0; ok && i < found; i++) {
+        ok = appendHistory(history, offsets[i]);
+    }
+    free(offsets);
+    return ok;
+}
+
+// Function to get a user's bookings as reservation.txt offsets, oldest first.
+// A user seen recently is answered from the cache without touching the file; otherwise the
+// least recently used entry is reloaded for this user. Returns NULL if nothing can be read.
+struct BookingHistory *getBookingHistory(const char *username) {
+    struct FileFingerprint current;
+    if (!fingerprintFile("reservation.txt", &current)) return NULL;
+
+    struct BookingHistory *history = NULL;
+    struct BookingHistory *oldest = &histories[0];
+    for (int i = 0; i < MAX_CACHED_HISTORIES; i++) {
+        if (histories[i].valid && strcmp(histories[i].username, username) == 0) {
+            history = &histories[i];
+            break;
+        }
+        if (!histories[i].valid || (oldest->valid && histories[i].lastUsed < oldest->lastUsed)) {
+            oldest = &histories[i];
+        }
+    }
+
+    // Offsets are only usable for the version of the file they were taken from
+    if (history && !sameFingerprint(&history->source, &current)) {
+        history->valid = 0;
+        oldest = history; // Reload in place
+        history = NULL;
+    }
+
+    if (!history) {
+        history = oldest;
+        snprintf(history->username, sizeof(history->username), "%s", username);
+        history->valid = loadHistory(history);
+        if (!history->valid) return NULL;
+    }
+
+    history->lastUsed = ++historyClock;
+    return history;
+}
+
+// Function to follow a booking appended to reservation.txt. Every cached history that was current
+// before the append stays current; the booking user's history gains the new line.
+void noteBookingAppended(const char *username, long offset, const struct FileFingerprint *before,
+                         const struct FileFingerprint *after) {
+    for (int i = 0; i < MAX_CACHED_HISTORIES; i++) {
+        struct BookingHistory *history = &histories[i];
+        if (!history->valid || !sameFingerprint(&history->source, before)) continue;
+
+        if (strcmp(history->username, username) == 0 && !appendHistory(history, offset)) {
+            history->valid = 0; // Out of memory; reloaded on the next view
+            continue;
+        }
+        history->source = *after;
+    }
+}
+
+// Function to follow the removal of one line from reservation.txt: the line leaves its user's
+// history, and every line after it moves up by its length
+void noteBookingRemoved(long offset, long length, const struct FileFingerprint *before,
+                        const struct FileFingerprint *after) {
+    for (int i = 0; i < MAX_CACHED_HISTORIES; i++) {
+        struct BookingHistory *history = &histories[i];
+        if (!history->valid || !sameFingerprint(&history->source, before)) continue;
+
+        int kept = 0;
+        for (int j = 0; j < history->count; j++) {
+            if (history->offsets[j] == offset) continue;
+            history->offsets[kept++] = history->offsets[j] > offset ? history->offsets[j] - length : history->offsets[j];
+        }
+        history->count = kept;
+        history->source = *after;
+    }
+}
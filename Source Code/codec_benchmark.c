@@ -0,0 +1,460 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bus_reservation.h"
+
+// Microbenchmark of every record codec, run on in-memory buffers (fmemopen) so that disk
+// speed does not hide CPU cost. For each format the line layout used by the program is
+// encoded and decoded with the implementation the program uses and with an alternative:
+//
+//   buses.txt        saveBuses (fprintf)                 loadBuses (record reader) vs fscanf
+//   seats.txt        saveSeats (fprintf per seat)        loadSeats (record reader) vs sscanf
+//   user.txt         saveUsers (fprintf)                 loadUsers (fscanf) vs record reader
+//   reservations     saveReservation / logCancellation   record reader vs the fgets/sscanf format
+//                    (same line layout)                  once used by loadTicketNumbers,
+//                                                        filterRecords and generateUserReport
+//
+// Encoders are compared against a direct formatter that appends text without printf.
+// Every pair must produce the same bytes or the same checksum, or the row says MISMATCH.
+//
+// Build: gcc -O2 -I"Text File" "Source Code/codec_benchmark.c" "Source Code/record_parser.c" "Source Code/money.c" -o codec_benchmark
+// Usage: ./codec_benchmark [records]
+
+#define DEFAULT_CODEC_RECORDS 1000000 // Records encoded and decoded per format
+#define CODEC_LINE_BYTES 512          // Upper bound for one encoded line of any format
+
+// Sample records, filled once and shared by both implementations
+struct SampleBus {
+    int busID;
+    char plate[20], date[11], source[50], destination[50], departure[20], arrival[20];
+    int totalSeats, availableSeats;
+    money_t fare;
+};
+
+struct SampleSeats {
+    int busID;
+    int reservedCount;
+    int seats[MAX_SEATS];
+};
+
+struct SampleUser {
+    char username[50], password[50], email[100], phone[20], address[200];
+};
+
+struct SampleReservation {
+    char username[50];
+    int ticketNumber, busID;
+    char plate[20], date[11];
+    int numSeats;
+    int seats[4];
+    money_t amount;
+};
+
+// Function to read a monotonic clock in seconds
+static double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// --- Direct formatter: appends text and numbers without going through printf ---
+
+static char *appendText(char *out, const char *text) {
+    while (*text) *out++ = *text++;
+    return out;
+}
+
+static char *appendNumber(char *out, long long value) {
+    char digits[24];
+    int count = 0;
+    if (value < 0) {
+        *out++ = '-';
+        value = -value;
+    }
+    do {
+        digits[count++] = (char)('0' + value % 10);
+        value /= 10;
+    } while (value);
+    while (count) *out++ = digits[--count];
+    return out;
+}
+
+static char *appendMoney(char *out, money_t amount) {
+    if (amount < 0) {
+        *out++ = '-';
+        amount = -amount;
+    }
+    out = appendNumber(out, amount / 100);
+    *out++ = '.';
+    *out++ = (char)('0' + amount / 10 % 10);
+    *out++ = (char)('0' + amount % 10);
+    return out;
+}
+
+// --- Sample data ---
+
+static void fillSamples(struct SampleBus *buses, struct SampleSeats *seats, struct SampleUser *users,
+                        struct SampleReservation *reservations, int count) {
+    static const char *cities[] = { "KualaLumpur", "Penang", "JohorBahru", "Ipoh", "Kuantan", "Melaka" };
+    for (int i = 0; i < count; i++) {
+        struct SampleBus *bus = &buses[i];
+        bus->busID = 1001 + i;
+        sprintf(bus->plate, "BUS%d", 1001 + i % 500);
+        sprintf(bus->date, "2025-%02d-%02d", 1 + i % 12, 1 + i % 28);
+        strcpy(bus->source, cities[i % 6]);
+        strcpy(bus->destination, cities[(i + 1) % 6]);
+        sprintf(bus->departure, "%02d:%02dAM", 1 + i % 12, i % 2 * 30);
+        sprintf(bus->arrival, "%02d:%02dPM", 1 + i % 12, i % 2 * 30);
+        bus->totalSeats = 40;
+        bus->availableSeats = i % 41;
+        bus->fare = 2000 + i % 50 * 100 + i % 100;
+
+        seats[i].busID = bus->busID;
+        seats[i].reservedCount = i % 12;
+        for (int j = 0; j < seats[i].reservedCount; j++) seats[i].seats[j] = 1 + (i + j * 7) % 40;
+
+        struct SampleUser *user = &users[i];
+        sprintf(user->username, "User%d", i);
+        strcpy(user->password, "1234");
+        sprintf(user->email, "user%d@example.com", i);
+        sprintf(user->phone, "601%08d", i);
+        sprintf(user->address, "No %d, Jalan %s, %s", i % 200, cities[i % 6], cities[(i + 3) % 6]);
+
+        struct SampleReservation *reservation = &reservations[i];
+        sprintf(reservation->username, "User%d", i % 500);
+        reservation->ticketNumber = 100000 + i % 900000;
+        reservation->busID = 1001 + i % 100;
+        strcpy(reservation->plate, bus->plate);
+        strcpy(reservation->date, bus->date);
+        reservation->numSeats = 1 + i % 4;
+        for (int j = 0; j < reservation->numSeats; j++) reservation->seats[j] = 1 + (i + j) % 40;
+        reservation->amount = 3180 * reservation->numSeats + i % 7;
+    }
+}
+
+// --- Encoders: the program's fprintf calls, writing to an in-memory stream ---
+
+static void fprintfBuses(FILE *file, const struct SampleBus *buses, int count) {
+    char fareText[MONEY_TEXT_LENGTH];
+    for (int i = 0; i < count; i++) {
+        const struct SampleBus *bus = &buses[i];
+        fprintf(file, "%d,%s,%s,%s,%s,%s,%s,%d,%d,%s\n", bus->busID, bus->plate, bus->date, bus->source,
+                bus->destination, bus->departure, bus->arrival, bus->totalSeats, bus->availableSeats,
+                formatMoney(bus->fare, fareText));
+    }
+}
+
+static void fprintfSeats(FILE *file, const struct SampleSeats *seats, int count) {
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%d,%d", seats[i].busID, seats[i].reservedCount);
+        for (int j = 0; j < seats[i].reservedCount; j++) fprintf(file, ",%d", seats[i].seats[j]);
+        fprintf(file, "\n");
+    }
+}
+
+static void fprintfUsers(FILE *file, const struct SampleUser *users, int count) {
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "%s %s %s %s %s\n", users[i].username, users[i].password, users[i].email,
+                users[i].phone, users[i].address);
+    }
+}
+
+static void fprintfReservations(FILE *file, const struct SampleReservation *reservations, int count) {
+    char amountText[MONEY_TEXT_LENGTH];
+    for (int i = 0; i < count; i++) {
+        const struct SampleReservation *r = &reservations[i];
+        fprintf(file, "%s,%d,%d,%s,%s,%d,", r->username, r->ticketNumber, r->busID, r->plate, r->date, r->numSeats);
+        for (int j = 0; j < r->numSeats; j++) {
+            fprintf(file, "%d", r->seats[j]);
+            if (j < r->numSeats - 1) fprintf(file, " ");
+        }
+        fprintf(file, ",%s\n", formatMoney(r->amount, amountText));
+    }
+}
+
+// --- Encoders: the same lines built with the direct formatter ---
+
+static size_t directBuses(char *out, const struct SampleBus *buses, int count) {
+    char *start = out;
+    for (int i = 0; i < count; i++) {
+        const struct SampleBus *bus = &buses[i];
+        out = appendNumber(out, bus->busID);
+        *out++ = ','; out = appendText(out, bus->plate);
+        *out++ = ','; out = appendText(out, bus->date);
+        *out++ = ','; out = appendText(out, bus->source);
+        *out++ = ','; out = appendText(out, bus->destination);
+        *out++ = ','; out = appendText(out, bus->departure);
+        *out++ = ','; out = appendText(out, bus->arrival);
+        *out++ = ','; out = appendNumber(out, bus->totalSeats);
+        *out++ = ','; out = appendNumber(out, bus->availableSeats);
+        *out++ = ','; out = appendMoney(out, bus->fare);
+        *out++ = '\n';
+    }
+    return (size_t)(out - start);
+}
+
+static size_t directSeats(char *out, const struct SampleSeats *seats, int count) {
+    char *start = out;
+    for (int i = 0; i < count; i++) {
+        out = appendNumber(out, seats[i].busID);
+        *out++ = ','; out = appendNumber(out, seats[i].reservedCount);
+        for (int j = 0; j < seats[i].reservedCount; j++) {
+            *out++ = ','; out = appendNumber(out, seats[i].seats[j]);
+        }
+        *out++ = '\n';
+    }
+    return (size_t)(out - start);
+}
+
+static size_t directUsers(char *out, const struct SampleUser *users, int count) {
+    char *start = out;
+    for (int i = 0; i < count; i++) {
+        out = appendText(out, users[i].username);
+        *out++ = ' '; out = appendText(out, users[i].password);
+        *out++ = ' '; out = appendText(out, users[i].email);
+        *out++ = ' '; out = appendText(out, users[i].phone);
+        *out++ = ' '; out = appendText(out, users[i].address);
+        *out++ = '\n';
+    }
+    return (size_t)(out - start);
+}
+
+static size_t directReservations(char *out, const struct SampleReservation *reservations, int count) {
+    char *start = out;
+    for (int i = 0; i < count; i++) {
+        const struct SampleReservation *r = &reservations[i];
+        out = appendText(out, r->username);
+        *out++ = ','; out = appendNumber(out, r->ticketNumber);
+        *out++ = ','; out = appendNumber(out, r->busID);
+        *out++ = ','; out = appendText(out, r->plate);
+        *out++ = ','; out = appendText(out, r->date);
+        *out++ = ','; out = appendNumber(out, r->numSeats);
+        *out++ = ',';
+        for (int j = 0; j < r->numSeats; j++) {
+            if (j) *out++ = ' ';
+            out = appendNumber(out, r->seats[j]);
+        }
+        *out++ = ','; out = appendMoney(out, r->amount);
+        *out++ = '\n';
+    }
+    return (size_t)(out - start);
+}
+
+// --- Decoders: the scanf formats ---
+
+static long long scanfBuses(FILE *file) {
+    char plate[20], date[11], source[50], destination[50], departure[20], arrival[20];
+    int busID, totalSeats, availableSeats;
+    float fare;
+    long long checksum = 0;
+    while (fscanf(file, "%d,%19[^,],%10[^,],%49[^,],%49[^,],%19[^,],%19[^,],%d,%d,%f",
+                  &busID, plate, date, source, destination, departure, arrival,
+                  &totalSeats, &availableSeats, &fare) == 10) {
+        checksum += busID + availableSeats + plate[3];
+    }
+    return checksum;
+}
+
+static long long scanfSeats(FILE *file) {
+    char line[CODEC_LINE_BYTES];
+    long long checksum = 0;
+    while (fgets(line, sizeof(line), file)) {
+        int busID, reservedCount, used, seat;
+        if (sscanf(line, "%d,%d%n", &busID, &reservedCount, &used) != 2) continue;
+        checksum += busID + reservedCount;
+        const char *cursor = line + used;
+        for (int j = 0; j < reservedCount && sscanf(cursor, ",%d%n", &seat, &used) == 1; j++) {
+            checksum += seat;
+            cursor += used;
+        }
+    }
+    return checksum;
+}
+
+static long long scanfUsers(FILE *file) {
+    char username[50], password[50], email[100], phone[20], address[200];
+    long long checksum = 0;
+    while (fscanf(file, "%s %s %s %s %[^\n]", username, password, email, phone, address) == 5) {
+        checksum += (long long)strlen(username) + (long long)strlen(address) + email[4];
+    }
+    return checksum;
+}
+
+static long long scanfReservations(FILE *file) {
+    char line[CODEC_LINE_BYTES], username[50], plate[20], date[20], seats[100];
+    int ticketNumber, busID, numSeats;
+    float amount;
+    long long checksum = 0;
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f",
+                   username, &ticketNumber, &busID, plate, date, &numSeats, seats, &amount) == 8) {
+            checksum += ticketNumber + busID + numSeats;
+        }
+    }
+    return checksum;
+}
+
+// --- Decoders: the record reader ---
+
+static long long readerBuses(FILE *file) {
+    struct RecordReader reader;
+    struct StringView line;
+    struct BusRecord record;
+    long long checksum = 0;
+    attachRecordReader(&reader, file);
+    while (readRecordLine(&reader, &line)) {
+        if (parseBusRecord(line, &record)) {
+            checksum += record.busID + record.availableSeats + record.busNumberPlate.data[3];
+        }
+    }
+    return checksum;
+}
+
+static long long readerSeats(FILE *file) {
+    struct RecordReader reader;
+    struct StringView line;
+    struct SeatRecord record;
+    int seats[MAX_SEATS];
+    long long checksum = 0;
+    attachRecordReader(&reader, file);
+    while (readRecordLine(&reader, &line)) {
+        if (parseSeatRecord(line, &record, seats, MAX_SEATS)) {
+            checksum += record.busID + record.reservedCount;
+            for (int j = 0; j < record.reservedCount; j++) checksum += seats[j];
+        }
+    }
+    return checksum;
+}
+
+// Candidate replacement for loadUsers' fscanf: four space-separated fields, then the address
+static long long readerUsers(FILE *file) {
+    struct RecordReader reader;
+    struct StringView line, fields[5];
+    long long checksum = 0;
+    attachRecordReader(&reader, file);
+    while (readRecordLine(&reader, &line)) {
+        int field = 0, start = 0;
+        for (int i = 0; i < line.length && field < 4; i++) {
+            if (line.data[i] == ' ') {
+                fields[field].data = line.data + start;
+                fields[field++].length = i - start;
+                start = i + 1;
+            }
+        }
+        if (field < 4) continue; // Malformed line
+        fields[4].data = line.data + start;
+        fields[4].length = line.length - start;
+        checksum += fields[0].length + fields[4].length + fields[2].data[4];
+    }
+    return checksum;
+}
+
+static long long readerReservations(FILE *file) {
+    struct RecordReader reader;
+    struct StringView line;
+    struct ReservationRecord record;
+    long long checksum = 0;
+    attachRecordReader(&reader, file);
+    while (readRecordLine(&reader, &line)) {
+        if (parseReservationRecord(line, &record)) {
+            checksum += record.ticketNumber + record.busID + record.numSeats;
+        }
+    }
+    return checksum;
+}
+
+// --- Harness ---
+
+// Function to print one row of the results table
+static void printRow(const char *codec, const char *operation, const char *implementation,
+                     int records, size_t bytes, double seconds, const char *check) {
+    printf("| %-12s | %-6s | %-25s | %12.0f | %9.1f | %-8s |\n", codec, operation, implementation,
+           records / seconds, bytes / seconds / 1e6, check);
+}
+
+// Function to time the two encoders of one format and check they wrote the same bytes.
+// The fprintf output is left in buffer for the decoders; the length is returned.
+#define BENCH_ENCODE(codec, program, samples, fprintfEncoder, directEncoder) do {                 \
+    FILE *stream = fmemopen(buffer, capacity, "w");                                               \
+    double start = nowSeconds();                                                                  \
+    fprintfEncoder(stream, samples, records);                                                     \
+    fflush(stream);                                                                               \
+    length = (size_t)ftell(stream);                                                               \
+    double fprintfTime = nowSeconds() - start;                                                    \
+    fclose(stream);                                                                               \
+    start = nowSeconds();                                                                         \
+    size_t directLength = directEncoder(second, samples, records);                                \
+    double directTime = nowSeconds() - start;                                                     \
+    const char *check = directLength == length && memcmp(buffer, second, length) == 0 ? "match" : "MISMATCH"; \
+    printRow(codec, "encode", program " (fprintf)", records, length, fprintfTime, check);          \
+    printRow(codec, "encode", "direct formatter", records, directLength, directTime, check);       \
+} while (0)
+
+// Function to time the two decoders of one format on the encoded buffer
+static void benchDecode(const char *codec, char *buffer, size_t length, int records,
+                        const char *firstName, long long (*first)(FILE *),
+                        const char *secondName, long long (*second)(FILE *)) {
+    FILE *stream = fmemopen(buffer, length, "r");
+    double start = nowSeconds();
+    long long firstSum = first(stream);
+    double firstTime = nowSeconds() - start;
+    fclose(stream);
+
+    stream = fmemopen(buffer, length, "r");
+    start = nowSeconds();
+    long long secondSum = second(stream);
+    double secondTime = nowSeconds() - start;
+    fclose(stream);
+
+    const char *check = firstSum == secondSum ? "match" : "MISMATCH";
+    printRow(codec, "decode", firstName, records, length, firstTime, check);
+    printRow(codec, "decode", secondName, records, length, secondTime, check);
+}
+
+int main(int argc, char *argv[]) {
+    int records = argc > 1 ? atoi(argv[1]) : DEFAULT_CODEC_RECORDS;
+    if (records < 1) {
+        printf("Usage: %s [records]\n", argv[0]);
+        return 1;
+    }
+
+    struct SampleBus *buses = malloc((size_t)records * sizeof(*buses));
+    struct SampleSeats *seats = malloc((size_t)records * sizeof(*seats));
+    struct SampleUser *users = malloc((size_t)records * sizeof(*users));
+    struct SampleReservation *reservations = malloc((size_t)records * sizeof(*reservations));
+    size_t capacity = (size_t)records * CODEC_LINE_BYTES;
+    char *buffer = malloc(capacity), *second = malloc(capacity);
+    if (!buses || !seats || !users || !reservations || !buffer || !second) {
+        printf("Error: Not enough memory for %d records.\n", records);
+        return 1;
+    }
+    fillSamples(buses, seats, users, reservations, records);
+    size_t length;
+
+    printf("======================================================================================================\n");
+    printf("| %-12s | %-6s | %-25s | %12s | %9s | %-8s |\n", "Format", "Op", "Implementation", "records/s", "MB/s", "Check");
+    printf("======================================================================================================\n");
+
+    BENCH_ENCODE("buses.txt", "saveBuses", buses, fprintfBuses, directBuses);
+    benchDecode("buses.txt", buffer, length, records, "loadBuses (reader)", readerBuses, "fscanf", scanfBuses);
+
+    BENCH_ENCODE("seats.txt", "saveSeats", seats, fprintfSeats, directSeats);
+    benchDecode("seats.txt", buffer, length, records, "loadSeats (reader)", readerSeats, "fgets + sscanf", scanfSeats);
+
+    BENCH_ENCODE("user.txt", "saveUsers", users, fprintfUsers, directUsers);
+    benchDecode("user.txt", buffer, length, records, "loadUsers (fscanf)", scanfUsers, "record reader", readerUsers);
+
+    BENCH_ENCODE("reservation", "saveReservation", reservations, fprintfReservations, directReservations);
+    benchDecode("reservation", buffer, length, records, "record reader", readerReservations, "fgets + sscanf (old)", scanfReservations);
+
+    printf("======================================================================================================\n");
+
+    free(buses);
+    free(seats);
+    free(users);
+    free(reservations);
+    free(buffer);
+    free(second);
+    return 0;
+}
@@ -0,0 +1,313 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <sys/stat.h>
+#include "bus_reservation.h"
+
+// Generator of realistic data files for load and performance testing. It writes buses.txt,
+// seats.txt, user.txt, reservation.txt, cancellations.txt, email.txt and sms.txt into a folder.
+// Routes, buses and users are drawn from Zipf distributions, so a few routes and passengers
+// carry most of the bookings, as in the real depot logs.
+//
+// The program keeps buses and users in fixed tables (MAX_BUSES and MAX_USERS in assignment.c),
+// so those two files are capped; the reservation and cancellation journals scale freely.
+//
+// Build: gcc -O2 -I"Text File" "Source Code/data_generator.c" "Source Code/money.c" "Source Code/schedule_time.c" "Source Code/record_parser.c" -lm -o data_generator
+// Usage: ./data_generator <folder> [reservations] [buses] [users] [zipf exponent] [seed]
+
+#define DEFAULT_RESERVATIONS 100000   // Reservation lines written when no count is given
+#define MAX_GENERATED_USERS 100       // Size of the users[] table in assignment.c (MAX_USERS)
+#define DEFAULT_ZIPF_EXPONENT 1.0     // s in P(rank k) ~ 1 / k^s
+#define CANCEL_PERCENT 12             // Share of bookings that end up cancelled
+#define SCHEDULE_DAYS 30              // Trips are spread over this many days
+#define FIRST_TRAVEL_DAY "2025-05-01" // First travel date of the generated schedule
+
+static const char *cities[] = {
+    "KualaLumpur", "Penang", "JohorBahru", "Ipoh", "Kuantan", "Melaka",
+    "KotaKinabalu", "Sandakan", "Kuching", "Sibu", "AlorSetar", "KotaBharu"
+};
+#define CITY_COUNT (int)(sizeof(cities) / sizeof(cities[0]))
+#define ROUTE_COUNT (CITY_COUNT * (CITY_COUNT - 1))
+
+static const int seatCapacities[] = { 30, 36, 40, 44, 45, 50 };
+
+// One generated trip, kept to build seats.txt after the journals
+struct GeneratedBus {
+    int busID;
+    int route;                    // Index into the route list
+    int totalSeats;
+    money_t fare;
+    char date[11];
+    unsigned char taken[MAX_SEATS]; // Seats held by a booking that was not cancelled
+    int reservedCount;
+};
+
+// Cumulative distribution of a Zipf law over n ranks
+struct ZipfTable {
+    double *cdf;
+    int count;
+};
+
+static unsigned long long rngState = 88172645463325252ULL; // xorshift64* state
+
+// Function to get the next pseudo-random number; the same seed always gives the same files
+static unsigned long long nextRandom() {
+    rngState ^= rngState >> 12;
+    rngState ^= rngState << 25;
+    rngState ^= rngState >> 27;
+    return rngState * 2685821657736338717ULL;
+}
+
+// Function to draw a uniform number in [0, 1)
+static double nextUniform() {
+    return (nextRandom() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Function to draw a uniform integer in [0, n)
+static int nextBelow(int n) {
+    return (int)(nextRandom() % (unsigned long long)n);
+}
+
+// Function to build the cumulative Zipf distribution over count ranks
+static void buildZipfTable(struct ZipfTable *table, int count, double exponent) {
+    table->count = count;
+    table->cdf = malloc((size_t)count * sizeof(double));
+    if (!table->cdf) {
+        printf("Error: Not enough memory.\n");
+        exit(1);
+    }
+    double total = 0;
+    for (int i = 0; i < count; i++) {
+        total += 1.0 / pow(i + 1, exponent);
+        table->cdf[i] = total;
+    }
+    for (int i = 0; i < count; i++) {
+        table->cdf[i] /= total;
+    }
+}
+
+// Function to draw a rank (0 is the most popular) by binary search on the distribution
+static int drawZipf(const struct ZipfTable *table) {
+    double u = nextUniform();
+    int low = 0, high = table->count - 1;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (table->cdf[middle] < u) low = middle + 1; else high = middle;
+    }
+    return low;
+}
+
+// Function to open a file in the output folder for writing
+static FILE *openOutput(const char *folder, const char *name) {
+    char path[MAX_IMPORT_PATH];
+    snprintf(path, sizeof(path), "%s/%s", folder, name);
+    FILE *file = fopen(path, "w");
+    if (!file) {
+        printf("Error: Could not create %s\n", path);
+        exit(1);
+    }
+    return file;
+}
+
+// Function to write user.txt: User1 is the most active passenger, User2 the next and so on
+static void writeUsers(const char *folder, int userCount) {
+    FILE *file = openOutput(folder, "user.txt");
+    for (int i = 1; i <= userCount; i++) {
+        fprintf(file, "User%d 1234 user%d@example.com 601%08d No %d, Jalan %s, %s\n",
+                i, i, 10000000 + i * 7919 % 90000000, i, cities[i % CITY_COUNT], cities[(i * 5) % CITY_COUNT]);
+    }
+    fclose(file);
+}
+
+// Function to create the trips; popular routes get more of them
+static void generateBuses(struct GeneratedBus buses[], int busCount, const struct ZipfTable *routes, const int routeOrder[]) {
+    int firstDay;
+    struct StringView firstDate = { FIRST_TRAVEL_DAY, (int)strlen(FIRST_TRAVEL_DAY) };
+    parseDateView(firstDate, &firstDay);
+
+    for (int i = 0; i < busCount; i++) {
+        struct GeneratedBus *bus = &buses[i];
+        memset(bus, 0, sizeof(*bus));
+        bus->busID = 1001 + i;
+        bus->route = routeOrder[drawZipf(routes)];
+        bus->totalSeats = seatCapacities[nextBelow((int)(sizeof(seatCapacities) / sizeof(seatCapacities[0])))];
+        bus->fare = (20 + bus->route % 7 * 5) * 100; // RM 20.00 to RM 50.00 by route
+        formatDate(firstDay + nextBelow(SCHEDULE_DAYS), bus->date);
+    }
+}
+
+// Function to write buses.txt and seats.txt once every booking has claimed its seats
+static void writeSchedule(const char *folder, const struct GeneratedBus buses[], int busCount) {
+    FILE *busFile = openOutput(folder, "buses.txt");
+    FILE *seatFile = openOutput(folder, "seats.txt");
+
+    for (int i = 0; i < busCount; i++) {
+        const struct GeneratedBus *bus = &buses[i];
+        int source = bus->route / (CITY_COUNT - 1);
+        int destination = bus->route % (CITY_COUNT - 1);
+        if (destination >= source) destination++; // Never the source itself
+
+        int departure = 6 * 60 + (bus->busID * 37 % 33) * 30; // 06:00AM to 10:00PM
+        int duration = 120 + (source * 7 + destination * 3) % 9 * 30; // 2 to 6 hours
+        char departureText[8], arrivalText[8], fareText[MONEY_TEXT_LENGTH];
+        formatTime(departure, departureText);
+        formatTime((departure + duration) % MINUTES_PER_DAY, arrivalText);
+
+        fprintf(busFile, "%d,BUS%d,%s,%s,%s,%s,%s,%d,%d,%s\n",
+                bus->busID, 2001 + i / 2, bus->date, cities[source], cities[destination],
+                departureText, arrivalText, bus->totalSeats, bus->totalSeats - bus->reservedCount,
+                formatMoney(bus->fare, fareText));
+
+        fprintf(seatFile, "%d,%d", bus->busID, bus->reservedCount);
+        for (int seat = 1; seat <= bus->totalSeats; seat++) {
+            if (bus->taken[seat - 1]) fprintf(seatFile, ",%d", seat);
+        }
+        fprintf(seatFile, "\n");
+    }
+
+    fclose(busFile);
+    fclose(seatFile);
+}
+
+// Function to pick the seats of one booking. Seats of bookings that stay are claimed on the
+// bus while it has room (one seat is always left free); later bookings are past trips' history.
+static int pickSeats(struct GeneratedBus *bus, int numSeats, int claim, int seats[]) {
+    int free = bus->totalSeats - bus->reservedCount - 1;
+    if (claim && free >= numSeats) {
+        for (int n = 0; n < numSeats; n++) {
+            int seat = nextBelow(bus->totalSeats);
+            while (bus->taken[seat]) seat = (seat + 1) % bus->totalSeats;
+            bus->taken[seat] = 1;
+            bus->reservedCount++;
+            seats[n] = seat + 1;
+        }
+        return numSeats;
+    }
+
+    for (int n = 0; n < numSeats; n++) {
+        seats[n] = 1 + nextBelow(bus->totalSeats);
+        for (int m = 0; m < n; m++) {
+            if (seats[m] == seats[n]) { // Seats within one booking are distinct
+                seats[n] = seats[n] % bus->totalSeats + 1;
+                m = -1;
+            }
+        }
+    }
+    return numSeats;
+}
+
+// Function to write the reservation and cancellation journals and their notifications
+static void writeJournals(const char *folder, struct GeneratedBus buses[], long reservations, const struct ZipfTable *users, const struct ZipfTable *busRanks,
+                          const int busOrder[], long *cancelled) {
+    FILE *reservationFile = openOutput(folder, "reservation.txt");
+    FILE *cancellationFile = openOutput(folder, "cancellations.txt");
+    FILE *emailFile = openOutput(folder, "email.txt");
+    FILE *smsFile = openOutput(folder, "sms.txt");
+    *cancelled = 0;
+
+    for (long i = 0; i < reservations; i++) {
+        int user = 1 + drawZipf(users);
+        struct GeneratedBus *bus = &buses[busOrder[drawZipf(busRanks)]];
+        int isCancelled = nextBelow(100) < CANCEL_PERCENT;
+        int numSeats = 1 + (nextBelow(10) < 6 ? 0 : nextBelow(4)); // Mostly single seats
+
+        int seats[4];
+        pickSeats(bus, numSeats, !isCancelled, seats);
+        char seatList[20];
+        int length = 0;
+        for (int n = 0; n < numSeats; n++) {
+            length += sprintf(seatList + length, n ? " %d" : "%d", seats[n]);
+        }
+
+        // Booked up to two weeks before the trip
+        int travelDay, bookingDay;
+        struct StringView travelDate = { bus->date, 10 };
+        parseDateView(travelDate, &travelDay);
+        char bookingDate[11], amountText[MONEY_TEXT_LENGTH];
+        bookingDay = travelDay - nextBelow(14);
+        formatDate(bookingDay, bookingDate);
+
+        money_t base = bus->fare * numSeats;
+        long ticketNumber = 100000 + i; // Unique, and six digits up to 900,000 bookings
+        FILE *journal = isCancelled ? cancellationFile : reservationFile;
+        fprintf(journal, "User%d,%ld,%d,BUS%d,%s,%d,%s,%s\n", user, ticketNumber, bus->busID,
+                2001 + (bus->busID - 1001) / 2, bookingDate, numSeats, seatList,
+                formatMoney(base + calculateSST(base), amountText));
+
+        int phone = 10000000 + user * 7919 % 90000000;
+        fprintf(emailFile, "user%d@example.com, email - Confirmation - %ld\n", user, ticketNumber);
+        fprintf(smsFile, "601%08d, sms - Confirmation - %ld\n", phone, ticketNumber);
+        if (isCancelled) {
+            fprintf(emailFile, "user%d@example.com, email - Cancellation - %ld\n", user, ticketNumber);
+            fprintf(smsFile, "601%08d, sms - Cancellation - %ld\n", phone, ticketNumber);
+            (*cancelled)++;
+        }
+    }
+
+    fclose(reservationFile);
+    fclose(cancellationFile);
+    fclose(emailFile);
+    fclose(smsFile);
+}
+
+// Function to shuffle 0..count-1 so popularity is not tied to bus ID or route order
+static void shuffledOrder(int order[], int count) {
+    for (int i = 0; i < count; i++) order[i] = i;
+    for (int i = count - 1; i > 0; i--) {
+        int j = nextBelow(i + 1);
+        int swap = order[i];
+        order[i] = order[j];
+        order[j] = swap;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        printf("Usage: %s <folder> [reservations] [buses] [users] [zipf exponent] [seed]\n", argv[0]);
+        return 1;
+    }
+    const char *folder = argv[1];
+    long reservations = argc > 2 ? atol(argv[2]) : DEFAULT_RESERVATIONS;
+    int busCount = argc > 3 ? atoi(argv[3]) : MAX_BUSES;
+    int userCount = argc > 4 ? atoi(argv[4]) : MAX_GENERATED_USERS;
+    double exponent = argc > 5 ? atof(argv[5]) : DEFAULT_ZIPF_EXPONENT;
+    if (argc > 6) rngState = strtoull(argv[6], NULL, 10) | 1; // Never zero
+
+    if (reservations < 0 || busCount < 1 || busCount > MAX_BUSES || userCount < 1 || userCount > MAX_GENERATED_USERS) {
+        printf("Error: Need 1-%d buses, 1-%d users and a non-negative reservation count.\n", MAX_BUSES, MAX_GENERATED_USERS);
+        return 1;
+    }
+    if (mkdir(folder, 0755) != 0 && errno != EEXIST) {
+        printf("Error: Could not create %s\n", folder);
+        return 1;
+    }
+
+    struct ZipfTable routes, busRanks, users;
+    buildZipfTable(&routes, ROUTE_COUNT, exponent);
+    buildZipfTable(&busRanks, busCount, exponent);
+    buildZipfTable(&users, userCount, exponent);
+
+    int routeOrder[ROUTE_COUNT], busOrder[MAX_BUSES];
+    shuffledOrder(routeOrder, ROUTE_COUNT);
+    shuffledOrder(busOrder, busCount);
+
+    static struct GeneratedBus buses[MAX_BUSES];
+    long cancelled;
+    generateBuses(buses, busCount, &routes, routeOrder);
+    writeUsers(folder, userCount);
+    writeJournals(folder, buses, reservations, &users, &busRanks, busOrder, &cancelled);
+    writeSchedule(folder, buses, busCount);
+    fclose(openOutput(folder, "frequent_bookings.txt")); // Empty files the program expects to find
+    fclose(openOutput(folder, "updates.txt"));
+    fclose(openOutput(folder, "temp_updates.txt"));
+
+    printf("Wrote %d buses, %d users, %ld reservations and %ld cancellations to %s\n",
+           busCount, userCount, reservations - cancelled, cancelled, folder);
+
+    free(routes.cdf);
+    free(busRanks.cdf);
+    free(users.cdf);
+    return 0;
+}
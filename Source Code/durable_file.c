@@ -0,0 +1,282 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bus_reservation.h"
+
+static int failedWrites = 0; // Saves that did not reach the disk, so memory may be ahead of the files
+
+// Function to hash a file's contents with 64-bit FNV-1a; returns 0 if it cannot be read
+static int hashFile(const char *path, long *size, unsigned long long *hash) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return 0;
+
+    unsigned char buffer[RECORD_BLOCK_SIZE];
+    unsigned long long value = 14695981039346656037ULL;
+    long total = 0;
+    size_t got;
+    while ((got = fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            value ^= buffer[i];
+            value *= 1099511628211ULL;
+        }
+        total += (long)got;
+    }
+    int ok = !ferror(file);
+    fclose(file);
+
+    *size = total;
+    *hash = value;
+    return ok;
+}
+
+// Function to read the checksums kept in <path>.sum: the current version and the one before it
+static int readChecksums(const char *path, long sizes[2], unsigned long long hashes[2]) {
+    char sumPath[MAX_IMPORT_PATH + 8];
+    snprintf(sumPath, sizeof(sumPath), "%s.sum", path);
+
+    FILE *file = fopen(sumPath, "r");
+    if (!file) return 0;
+    int ok = fscanf(file, "current %ld %llx previous %ld %llx", &sizes[0], &hashes[0], &sizes[1], &hashes[1]) == 4;
+    fclose(file);
+    return ok;
+}
+
+// Function to make renames in the working directory durable
+int syncDirectory() {
+    int fd = open(".", O_RDONLY);
+    if (fd < 0) return 0;
+    int ok = fsync(fd) == 0;
+    close(fd);
+    return ok;
+}
+
+// Function to flush a file to disk and close it
+int syncAndCloseFile(FILE *file) {
+    int ok = fflush(file) == 0 && fsync(fileno(file)) == 0;
+    return fclose(file) == 0 && ok;
+}
+
+// Function to copy bytes from one file to another in large blocks, from wherever each file is
+// positioned; a count of -1 copies to the end of the source
+int copyFileBytes(FILE *from, FILE *to, long count) {
+    static char block[RECORD_BLOCK_SIZE];
+    while (count != 0) {
+        size_t wanted = count < 0 || count > (long)sizeof(block) ? sizeof(block) : (size_t)count;
+        size_t bytesRead = fread(block, 1, wanted, from);
+        if (bytesRead == 0) return count < 0 && !ferror(from); // Only copying to the end may stop early
+        if (fwrite(block, 1, bytesRead, to) != bytesRead) return 0;
+        if (count > 0) count -= (long)bytesRead;
+    }
+    return 1;
+}
+
+// Function to start replacing a file: the new contents go to <path>.tmp until they are committed.
+// With withChecksum set, <path>.sum records the checksum of every committed version for startup checks.
+FILE *beginDurableWrite(struct DurableFile *out, const char *path, int withChecksum) {
+    snprintf(out->path, sizeof(out->path), "%s", path);
+    snprintf(out->tempPath, sizeof(out->tempPath), "%s.tmp", path);
+    out->withChecksum = withChecksum;
+
+    out->file = fopen(out->tempPath, "w");
+    if (!out->file) {
+        printf("Error: Could not open %s for writing.\n", out->tempPath);
+        failedWrites++;
+    }
+    return out->file;
+}
+
+// Function to start replacing a file with a copy of itself, so lines added to the copy can be
+// committed together with other files. A missing file starts out empty.
+FILE *beginDurableAppend(struct DurableFile *out, const char *path, int withChecksum) {
+    if (!beginDurableWrite(out, path, withChecksum)) return NULL;
+    FILE *original = fopen(path, "rb");
+    if (original) {
+        int copied = copyFileBytes(original, out->file, -1);
+        fclose(original);
+        if (!copied) {
+            abortDurableWrite(out);
+            printf("Error: Could not copy %s.\n", path);
+            failedWrites++;
+            return NULL;
+        }
+    }
+    return out->file;
+}
+
+// Function to drop an uncommitted replacement, leaving the original untouched
+void abortDurableWrite(struct DurableFile *out) {
+    if (out->file) fclose(out->file);
+    out->file = NULL;
+    remove(out->tempPath);
+}
+
+// Function to put the temp file on disk and, if asked, write <path>.sum.tmp next to it
+static int prepareDurableWrite(struct DurableFile *out) {
+    int ok = syncAndCloseFile(out->file);
+    out->file = NULL;
+    if (!ok) return 0;
+    if (!out->withChecksum) return 1;
+
+    long sizes[2] = {0, 0};
+    unsigned long long hashes[2] = {0, 0};
+    if (!readChecksums(out->path, sizes, hashes)) {
+        hashFile(out->path, &sizes[0], &hashes[0]); // First checksummed save of this file
+    }
+    long size;
+    unsigned long long hash;
+    if (!hashFile(out->tempPath, &size, &hash)) return 0;
+
+    // The previous version is kept so a crash between the two renames is told apart from damage
+    char sumTemp[MAX_IMPORT_PATH + 16];
+    snprintf(sumTemp, sizeof(sumTemp), "%s.sum.tmp", out->path);
+    FILE *sum = fopen(sumTemp, "w");
+    if (!sum) return 0;
+    fprintf(sum, "current %ld %016llx\nprevious %ld %016llx\n", size, hash, sizes[0], hashes[0]);
+    return syncAndCloseFile(sum);
+}
+
+// Function to replace the original with the temp file: fsync, rename over it, fsync the directory.
+// A crash at any point leaves either the complete old file or the complete new one.
+int commitDurableWrite(struct DurableFile *out) {
+    if (!prepareDurableWrite(out)) {
+        abortDurableWrite(out);
+        printf("Error: Could not save %s.\n", out->path);
+        failedWrites++;
+        return 0;
+    }
+
+    if (out->withChecksum) {
+        char sumTemp[MAX_IMPORT_PATH + 16], sumPath[MAX_IMPORT_PATH + 8];
+        snprintf(sumTemp, sizeof(sumTemp), "%s.sum.tmp", out->path);
+        snprintf(sumPath, sizeof(sumPath), "%s.sum", out->path);
+        rename(sumTemp, sumPath); // Checksum first; its "previous" entry still matches the old file
+    }
+    if (rename(out->tempPath, out->path) != 0) {
+        remove(out->tempPath);
+        printf("Error: Could not replace %s.\n", out->path);
+        failedWrites++;
+        return 0;
+    }
+    syncDirectory();
+    return 1;
+}
+
+// Function to commit several replacements so readers see all of the new files or none of them
+int commitDurableWrites(struct DurableFile files[], int count) {
+    const char *tempFiles[2 * MAX_DURABLE_GROUP];
+    const char *finalFiles[2 * MAX_DURABLE_GROUP];
+    char sumTemps[MAX_DURABLE_GROUP][MAX_IMPORT_PATH + 16], sumPaths[MAX_DURABLE_GROUP][MAX_IMPORT_PATH + 8];
+    int renames = 0, ok = count <= MAX_DURABLE_GROUP;
+
+    for (int i = 0; i < count; i++) {
+        if (ok && prepareDurableWrite(&files[i])) {
+            tempFiles[renames] = files[i].tempPath;
+            finalFiles[renames++] = files[i].path;
+            if (files[i].withChecksum) {
+                snprintf(sumTemps[i], sizeof(sumTemps[i]), "%s.sum.tmp", files[i].path);
+                snprintf(sumPaths[i], sizeof(sumPaths[i]), "%s.sum", files[i].path);
+                tempFiles[renames] = sumTemps[i];
+                finalFiles[renames++] = sumPaths[i];
+            }
+        } else {
+            ok = 0;
+        }
+    }
+
+    if (!ok || !replaceFilesTogether(tempFiles, finalFiles, renames)) {
+        for (int i = 0; i < count; i++) {
+            char sumTemp[MAX_IMPORT_PATH + 16];
+            snprintf(sumTemp, sizeof(sumTemp), "%s.sum.tmp", files[i].path);
+            remove(sumTemp);
+            abortDurableWrite(&files[i]);
+        }
+        printf("Error: Could not save %s and the files saved with it.\n", files[0].path);
+        failedWrites++;
+        return 0;
+    }
+    return 1;
+}
+
+// Function to replace several files so that readers see all of the new files or none of them.
+// The new contents must already be complete in the temp files. A marker listing the renames is
+// written first, so a crash part-way is finished by recoverFileReplacement() on the next start.
+int replaceFilesTogether(const char *tempFiles[], const char *finalFiles[], int count) {
+    FILE *marker = fopen(REPLACE_MARKER_FILE, "w");
+    if (!marker) {
+        printf("Error: Could not create %s\n", REPLACE_MARKER_FILE);
+        return 0;
+    }
+    for (int i = 0; i < count; i++) {
+        fprintf(marker, "%s %s\n", tempFiles[i], finalFiles[i]);
+    }
+    if (!syncAndCloseFile(marker)) {
+        remove(REPLACE_MARKER_FILE);
+        printf("Error: Could not write %s\n", REPLACE_MARKER_FILE);
+        return 0;
+    }
+
+    // From here on the replacement is decided; finish it now or on the next start
+    recoverFileReplacement();
+    return 1;
+}
+
+// Function to finish a replacement interrupted by a crash, or drop temp files that were never committed
+void recoverFileReplacement() {
+    FILE *marker = fopen(REPLACE_MARKER_FILE, "r");
+    if (!marker) return; // Nothing was in progress
+
+    char tempFile[MAX_IMPORT_PATH + 16], finalFile[MAX_IMPORT_PATH + 8];
+    while (fscanf(marker, "%271s %263s", tempFile, finalFile) == 2) {
+        FILE *check = fopen(tempFile, "r");
+        if (check) {
+            fclose(check);
+            rename(tempFile, finalFile); // Missing temp files were renamed before the crash
+        }
+    }
+    fclose(marker);
+    syncDirectory(); // The renames must be on disk before the marker goes
+    remove(REPLACE_MARKER_FILE);
+}
+
+// Function to check the saved files on startup after a possible crash.
+// Interrupted group replacements are finished, uncommitted temp files are dropped and
+// every checksummed file is compared with its <file>.sum.
+void recoverDurableFiles(const char *paths[], int count) {
+    recoverFileReplacement();
+
+    for (int i = 0; i < count; i++) {
+        char tempPath[MAX_IMPORT_PATH + 16];
+        snprintf(tempPath, sizeof(tempPath), "%s.tmp", paths[i]);
+        remove(tempPath); // Never renamed, so never committed
+        snprintf(tempPath, sizeof(tempPath), "%s.sum.tmp", paths[i]);
+        remove(tempPath);
+
+        long sizes[2], size;
+        unsigned long long hashes[2], hash;
+        if (!readChecksums(paths[i], sizes, hashes)) continue; // Not checksummed, so never read here
+        if (!hashFile(paths[i], &size, &hash)) continue; // No file yet
+
+        if (size == sizes[0] && hash == hashes[0]) continue; // Intact
+
+        if (!(size == sizes[1] && hash == hashes[1])) {
+            // Neither the last committed version nor the one before: changed outside the program or damaged
+            printf("Warning: %s does not match its checksum; it may have been edited or damaged.\n", paths[i]);
+        }
+
+        // Record what is on disk now, so the check starts from the file as it is
+        char sumPath[MAX_IMPORT_PATH + 8];
+        snprintf(sumPath, sizeof(sumPath), "%s.sum", paths[i]);
+        FILE *sum = fopen(sumPath, "w");
+        if (sum) {
+            fprintf(sum, "current %ld %016llx\nprevious %ld %016llx\n", size, hash, size, hash);
+            syncAndCloseFile(sum);
+        }
+    }
+}
+
+// Function to tell whether any save failed since startup; a snapshot of memory is then not taken
+int durableWriteFailureCount() {
+    return failedWrites;
+}
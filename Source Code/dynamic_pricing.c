@@ -0,0 +1,151 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+#define PRICE_BATCH 1024   // Trips priced per pass, so the scratch columns stay in cache
+
+// Function to order tiers by the value they start at
+static int compareTiers(const void *a, const void *b) {
+    const struct PriceTier *left = a, *right = b;
+    return (left->from > right->from) - (left->from < right->from);
+}
+
+// Function to load the tier tables. Format, one tier per line:
+// LOAD,occupancyPercent,multiplierPercent and DAYS,daysBeforeDeparture,multiplierPercent.
+// A tier applies from its value up to the next tier's; below the first tier the base fare is used.
+// Lines starting with # are comments. Without the file, or with every tier commented out, there
+// are no tiers and every trip sells at its base fare.
+int loadPricingTiers(struct PricingTiers *tiers, const char *filename) {
+    memset(tiers, 0, sizeof(*tiers));
+
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, filename)) return 0; // Static fares
+
+    struct StringView line;
+    struct StringView fields[4];
+    while (readRecordLine(&reader, &line)) {
+        int from, percent;
+        if (line.length > 0 && line.data[0] == '#') continue; // Comment
+        if (splitRecordFields(line, ',', fields, 4) != 3 || !parseIntView(fields[1], &from) ||
+            !parseIntView(fields[2], &percent) || from < 0 || percent <= 0) {
+            continue; // Not a tier
+        }
+        struct PriceTier tier = { from, percent };
+        if (viewEquals(fields[0], "LOAD") && tiers->loadCount < MAX_PRICE_TIERS) {
+            tiers->load[tiers->loadCount++] = tier;
+        } else if (viewEquals(fields[0], "DAYS") && tiers->dayCount < MAX_PRICE_TIERS) {
+            tiers->days[tiers->dayCount++] = tier;
+        }
+    }
+    closeRecordReader(&reader);
+
+    qsort(tiers->load, (size_t)tiers->loadCount, sizeof(struct PriceTier), compareTiers);
+    qsort(tiers->days, (size_t)tiers->dayCount, sizeof(struct PriceTier), compareTiers);
+    return tiers->loadCount + tiers->dayCount;
+}
+
+// Function to price a batch of trips. Inputs and outputs are separate arrays, and each step is a
+// branch-free pass over one batch, so the compiler can vectorise the passes. Batches end at any
+// trip, which the cheap -O2 cost model will not vectorise, so the full one is asked for here.
+// Prices are per seat, before SST, rounded to the sen.
+__attribute__((optimize("tree-vectorize", "vect-cost-model=dynamic")))
+void priceTrips(const struct PricingTiers *tiers, const money_t fares[], const int availableSeats[],
+                const int totalSeats[], const int departureDays[], int today, int count, money_t prices[]) {
+    int occupancy[PRICE_BATCH], daysAhead[PRICE_BATCH];
+    int loadPercent[PRICE_BATCH], dayPercent[PRICE_BATCH];
+
+    for (int start = 0; start < count; start += PRICE_BATCH) {
+        int n = count - start < PRICE_BATCH ? count - start : PRICE_BATCH;
+
+        // Load factor as a whole percentage of seats sold, and whole days left before departure
+        for (int i = 0; i < n; i++) {
+            int total = totalSeats[start + i] > 0 ? totalSeats[start + i] : 1;
+            int sold = total - availableSeats[start + i];
+            occupancy[i] = sold * 100 / total; // Integer division, as the tiers compare whole percentages
+            int days = departureDays[start + i] - today;
+            daysAhead[i] = days > 0 ? days : 0; // Trips already gone are priced as leaving today
+            loadPercent[i] = 100;
+            dayPercent[i] = 100;
+        }
+
+        // Tiers are in ascending order, so the last one reached wins
+        for (int t = 0; t < tiers->loadCount; t++) {
+            int from = tiers->load[t].from, percent = tiers->load[t].percent;
+            for (int i = 0; i < n; i++) {
+                loadPercent[i] = occupancy[i] >= from ? percent : loadPercent[i];
+            }
+        }
+        for (int t = 0; t < tiers->dayCount; t++) {
+            int from = tiers->days[t].from, percent = tiers->days[t].percent;
+            for (int i = 0; i < n; i++) {
+                dayPercent[i] = daysAhead[i] >= from ? percent : dayPercent[i];
+            }
+        }
+
+        for (int i = 0; i < n; i++) {
+            money_t scaled = fares[start + i] * (loadPercent[i] * dayPercent[i]);
+            prices[start + i] = (scaled + 5000) / 10000; // Both multipliers are percentages
+        }
+    }
+}
+
+// Function to size the price table for a number of bus slots; called once before any price is read
+int reservePriceTable(struct PriceTable *table, int slots) {
+    memset(table, 0, sizeof(*table));
+    table->buffers[0] = calloc((size_t)slots, sizeof(money_t));
+    table->buffers[1] = calloc((size_t)slots, sizeof(money_t));
+    table->stale = calloc((size_t)slots, 1);
+    table->staleSlots = malloc((size_t)slots * sizeof(int));
+    if (!table->buffers[0] || !table->buffers[1] || !table->stale || !table->staleSlots) return 0;
+
+    table->published = table->buffers[0];
+    table->capacity = slots;
+    table->pricedDay = NO_PRICED_DAY;
+    return 1;
+}
+
+// Function to remember that a slot's occupancy, fare or date changed
+void markPriceStale(struct PriceTable *table, int slot) {
+    if (slot < 0 || slot >= table->capacity || table->stale[slot]) return;
+    table->stale[slot] = 1;
+    table->staleSlots[table->staleCount++] = slot;
+}
+
+// Function to make the next refresh reprice every slot
+void invalidatePrices(struct PriceTable *table) {
+    table->pricedDay = NO_PRICED_DAY;
+}
+
+// Function to read the published per-seat price of a slot. The table is replaced by swapping one
+// pointer and single prices are updated with one store, so readers never wait on a writer.
+money_t seatPrice(const struct PriceTable *table, int slot) {
+    const money_t *prices = __atomic_load_n(&table->published, __ATOMIC_ACQUIRE);
+    if (!prices || slot < 0 || slot >= table->capacity) return 0;
+    return __atomic_load_n(&prices[slot], __ATOMIC_RELAXED);
+}
+
+// Function to get the buffer a full repricing is written into; it is not visible until published
+money_t *beginRepricing(struct PriceTable *table) {
+    return table->published == table->buffers[0] ? table->buffers[1] : table->buffers[0];
+}
+
+// Function to publish a full repricing made for a given day; every slot is current afterwards
+void publishPrices(struct PriceTable *table, money_t *prices, int today) {
+    __atomic_store_n(&table->published, prices, __ATOMIC_RELEASE);
+    table->pricedDay = today;
+    clearStalePrices(table);
+}
+
+// Function to update one published price in place
+void setSeatPrice(struct PriceTable *table, int slot, money_t price) {
+    __atomic_store_n(&table->published[slot], price, __ATOMIC_RELAXED);
+}
+
+// Function to forget the stale slots once they have been repriced
+void clearStalePrices(struct PriceTable *table) {
+    for (int i = 0; i < table->staleCount; i++) {
+        table->stale[table->staleSlots[i]] = 0;
+    }
+    table->staleCount = 0;
+}
@@ -0,0 +1,48 @@
+#include <stdio.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+// Function to calculate the SST on a base fare, rounded half up to the nearest sen
+money_t calculateSST(money_t baseFare) {
+    return (baseFare * SST_RATE_PERCENT + 50) / 100;
+}
+
+// Function to format an amount as ringgit with two decimals (e.g. 6360 -> "63.60")
+const char *formatMoney(money_t amount, char *buffer) {
+    const char *sign = amount < 0 ? "-" : "";
+    if (amount < 0) amount = -amount;
+
+    snprintf(buffer, MONEY_TEXT_LENGTH, "%s%lld.%02lld", sign, amount / 100, amount % 100);
+    return buffer; // Returned so the call can be used directly as a printf argument
+}
+
+// Function to parse an amount typed by the user or read from a file
+int parseMoneyText(const char *text, money_t *amount) {
+    struct StringView field = { text, (int)strlen(text) };
+    return parseAmountView(field, amount);
+}
+
+// Function to add up many amounts exactly.
+// Four independent accumulators let the compiler keep the loop in vector registers.
+money_t sumMoney(const money_t amounts[], int count) {
+    money_t sum0 = 0, sum1 = 0, sum2 = 0, sum3 = 0;
+    int i = 0;
+
+    for (; i + 4 <= count; i += 4) {
+        sum0 += amounts[i];
+        sum1 += amounts[i + 1];
+        sum2 += amounts[i + 2];
+        sum3 += amounts[i + 3];
+    }
+    for (; i < count; i++) {
+        sum0 += amounts[i]; // Leftover amounts
+    }
+
+    return sum0 + sum1 + sum2 + sum3;
+}
+
+// Function to average a total over a count, rounded half up to the nearest sen
+money_t averageMoney(money_t total, int count) {
+    if (count <= 0) return 0; // Avoid division by zero
+    return (total * 2 + count) / (count * 2);
+}
@@ -0,0 +1,404 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "bus_reservation.h"
+
+// Identity of a trip and its position in the trip list, sorted by bus ID, then departure day, for
+// lookups from the journals. A bus ID can be reused once its trip is purged, so the plate and day
+// tell its trips apart.
+struct TripLookup {
+    int busID;
+    int departureDay;
+    string_id busNumberPlate;
+    int trip;
+};
+
+// A series' sort keys beside its ID, so the report can be ordered without shared state
+struct SeriesOrder {
+    string_id source;
+    string_id destination;
+    int hour;
+    int series;
+};
+
+// Work handed to one journal thread: a run of whole lines, and totals per trip
+struct JournalChunk {
+    const char *start;                  // First byte of the chunk (start of a line)
+    const char *end;                    // One past the last byte
+    const struct TripLookup *lookup;    // Shared, read only
+    int lookupCount;
+    int *seats;                         // Seats per trip in this chunk
+    money_t *amounts;                   // Amounts per trip in this chunk
+    int unplaced;                       // Seats of lines whose trip is not on record
+};
+
+// Function to find the trip a journal row belongs to from the row's own bus ID, plate and date,
+// or -1 if no trip with that bus ID is on record. Among the trips of a bus ID, one on the row's plate
+// comes first, then the first one departing on or after the row's date (a booking precedes its trip).
+static int lookupTrip(const struct TripLookup lookup[], int count, const struct ReservationRecord *record) {
+    int low = 0, high = count;
+    while (low < high) { // First entry of the bus ID
+        int middle = (low + high) / 2;
+        if (lookup[middle].busID < record->busID) low = middle + 1;
+        else high = middle;
+    }
+
+    int rowDay;
+    if (!parseDateView(record->date, &rowDay)) rowDay = INT_MIN;
+    int best = -1, bestScore = -1;
+    for (int i = low; i < count && lookup[i].busID == record->busID; i++) {
+        int score = 2 * viewEquals(record->busNumberPlate, stringText(lookup[i].busNumberPlate)) +
+                    (lookup[i].departureDay >= rowDay);
+        // Days ascend, so keep the first trip after the row's date, or else the last one before it
+        if (score > bestScore || (score == bestScore && !(score & 1))) {
+            best = lookup[i].trip;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+// Function to order the lookup by bus ID, then departure day
+static int compareTripLookups(const void *a, const void *b) {
+    const struct TripLookup *left = a, *right = b;
+    if (left->busID != right->busID) return (left->busID > right->busID) - (left->busID < right->busID);
+    return (left->departureDay > right->departureDay) - (left->departureDay < right->departureDay);
+}
+
+// Thread body: total the seats and amounts of every line of one chunk by trip
+static void *sumJournalChunk(void *argument) {
+    struct JournalChunk *chunk = argument;
+    const char *cursor = chunk->start;
+    struct ReservationRecord record;
+
+    while (cursor < chunk->end) {
+        const char *newline = memchr(cursor, '\n', (size_t)(chunk->end - cursor));
+        const char *lineEnd = newline ? newline : chunk->end;
+        struct StringView line = { cursor, (int)(lineEnd - cursor) };
+        cursor = newline ? newline + 1 : chunk->end;
+
+        if (line.length > 0 && line.data[line.length - 1] == '\r') line.length--; // Windows line endings
+        if (!parseReservationRecord(line, &record)) continue; // Skip malformed lines
+
+        int trip = lookupTrip(chunk->lookup, chunk->lookupCount, &record);
+        if (trip == -1) {
+            chunk->unplaced += record.numSeats; // No route to count it under, but it is not lost
+            continue;
+        }
+        chunk->seats[trip] += record.numSeats;
+        chunk->amounts[trip] += record.amount;
+    }
+    return NULL;
+}
+
+// Function to total a reservation-format journal by trip, parsing chunks of it in parallel.
+// Rows already moved to the archive are totalled too, after the journal.
+static int sumJournal(const char *filename, const struct TripLookup lookup[], int tripCount,
+                      int seats[], money_t amounts[], int *unplaced) {
+    struct ArchiveScan archive;
+    struct ReservationRecord record;
+    openArchiveScan(&archive, filename, NULL);
+    while (nextArchiveRecord(&archive, &record)) {
+        int trip = lookupTrip(lookup, tripCount, &record);
+        if (trip == -1) {
+            *unplaced += record.numSeats;
+            continue;
+        }
+        seats[trip] += record.numSeats;
+        amounts[trip] += record.amount;
+    }
+    closeArchiveScan(&archive);
+
+    FILE *file = fopen(filename, "rb");
+    if (!file) return 1; // No journal yet, nothing to count
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *data = malloc(size > 0 ? (size_t)size : 1);
+    if (!data || (size > 0 && fread(data, 1, (size_t)size, file) != (size_t)size)) {
+        fclose(file);
+        free(data);
+        return 0;
+    }
+    fclose(file);
+
+    // One chunk per processor, each ending on a line boundary
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int chunkCount = processors < 1 ? 1 : processors > MAX_ANALYTICS_THREADS ? MAX_ANALYTICS_THREADS : (int)processors;
+    if (size < ANALYTICS_MIN_CHUNK_BYTES * (long)chunkCount) {
+        chunkCount = 1; // Small journals are not worth the threads
+    }
+
+    struct JournalChunk chunks[MAX_ANALYTICS_THREADS];
+    pthread_t threads[MAX_ANALYTICS_THREADS];
+    int started[MAX_ANALYTICS_THREADS] = {0};
+    const char *end = data + size;
+    const char *chunkStart = data;
+    int ok = 1;
+    for (int i = 0; i < chunkCount; i++) {
+        const char *chunkEnd = (i == chunkCount - 1) ? end : data + size / chunkCount * (i + 1);
+        if (chunkEnd < chunkStart) chunkEnd = chunkStart;
+        if (chunkEnd < end) {
+            const char *newline = memchr(chunkEnd, '\n', (size_t)(end - chunkEnd));
+            chunkEnd = newline ? newline + 1 : end; // Never split a line
+        }
+        chunks[i].start = chunkStart;
+        chunks[i].end = chunkEnd;
+        chunks[i].lookup = lookup;
+        chunks[i].lookupCount = tripCount;
+        chunks[i].seats = calloc((size_t)tripCount + 1, sizeof(int));
+        chunks[i].amounts = calloc((size_t)tripCount + 1, sizeof(money_t));
+        chunks[i].unplaced = 0;
+        ok = ok && chunks[i].seats && chunks[i].amounts;
+        chunkStart = chunkEnd;
+    }
+
+    // Total the chunks side by side
+    if (ok) {
+        for (int i = 1; i < chunkCount; i++) {
+            started[i] = pthread_create(&threads[i], NULL, sumJournalChunk, &chunks[i]) == 0;
+            if (!started[i]) {
+                sumJournalChunk(&chunks[i]); // Fall back to this thread
+            }
+        }
+        sumJournalChunk(&chunks[0]);
+        for (int i = 1; i < chunkCount; i++) {
+            if (started[i]) pthread_join(threads[i], NULL);
+        }
+    }
+
+    // Add the chunks' totals together
+    for (int i = 0; i < chunkCount; i++) {
+        for (int t = 0; ok && t < tripCount; t++) {
+            seats[t] += chunks[i].seats[t];
+            amounts[t] += chunks[i].amounts[t];
+        }
+        *unplaced += chunks[i].unplaced;
+        free(chunks[i].seats);
+        free(chunks[i].amounts);
+    }
+    free(data);
+    return ok;
+}
+
+// Function to hash a route and departure hour for interning; the cities are already interned,
+// so only their IDs are mixed in
+static unsigned int hashSeries(string_id source, string_id destination, int hour) {
+    unsigned int hash = 2166136261u; // 32-bit FNV-1a over the three values
+    hash = (hash ^ source) * 16777619u;
+    hash = (hash ^ destination) * 16777619u;
+    return (hash ^ (unsigned int)hour) * 16777619u;
+}
+
+// Function to give every distinct route and departure hour a dense series ID.
+// Fills seriesOfTrip[] and returns the number of series, or -1 if memory ran out.
+static int internSeries(struct OccupancyCube *cube, const struct OccupancyTrip trips[], int tripCount, int seriesOfTrip[]) {
+    int slotCount = 1;
+    while (slotCount < tripCount * 2) slotCount *= 2;
+    int *slots = malloc((size_t)slotCount * sizeof(int));
+    cube->series = malloc((size_t)(tripCount > 0 ? tripCount : 1) * sizeof(struct OccupancySeries));
+    if (!slots || !cube->series) {
+        free(slots);
+        return -1;
+    }
+    for (int i = 0; i < slotCount; i++) slots[i] = -1;
+
+    int count = 0;
+    for (int t = 0; t < tripCount; t++) {
+        const struct OccupancyTrip *trip = &trips[t];
+        unsigned int slot = hashSeries(trip->source, trip->destination, trip->departureHour) & (unsigned int)(slotCount - 1);
+        for (;; slot = (slot + 1) & (unsigned int)(slotCount - 1)) {
+            int id = slots[slot];
+            if (id == -1) {
+                // First trip of this series
+                struct OccupancySeries *series = &cube->series[count];
+                series->source = trip->source;
+                series->destination = trip->destination;
+                series->hour = trip->departureHour;
+                slots[slot] = count;
+                seriesOfTrip[t] = count++;
+                break;
+            }
+            const struct OccupancySeries *series = &cube->series[id];
+            if (series->hour == trip->departureHour && series->source == trip->source &&
+                series->destination == trip->destination) {
+                seriesOfTrip[t] = id;
+                break;
+            }
+        }
+    }
+    free(slots);
+    return count;
+}
+
+// Function to build the occupancy cube: one cell per route and departure hour per day, holding the
+// trips' seats and booked seats from the seat state, and seats sold, cancelled, revenue and refunds
+// from the two journals and their archived rows. Each row is matched to its trip by the row's own
+// bus ID, plate and date, so the trips may include departed ones read back from the trip history;
+// rows with no trip on record are counted in unplacedSold and unplacedCancelled.
+// Returns 0 if memory ran out or the trips span more days than the cube may hold.
+int buildOccupancyCube(struct OccupancyCube *cube, const struct OccupancyTrip trips[], int tripCount,
+                       const char *reservationFile, const char *cancellationFile) {
+    memset(cube, 0, sizeof(*cube));
+    if (tripCount == 0) return 1;
+
+    int firstDay = trips[0].departureDay, lastDay = trips[0].departureDay;
+    for (int t = 1; t < tripCount; t++) {
+        if (trips[t].departureDay < firstDay) firstDay = trips[t].departureDay;
+        if (trips[t].departureDay > lastDay) lastDay = trips[t].departureDay;
+    }
+
+    int *seriesOfTrip = malloc((size_t)tripCount * sizeof(int));
+    struct TripLookup *lookup = malloc((size_t)tripCount * sizeof(struct TripLookup));
+    int *sold = calloc((size_t)tripCount, sizeof(int));
+    int *cancelled = calloc((size_t)tripCount, sizeof(int));
+    money_t *revenue = calloc((size_t)tripCount, sizeof(money_t));
+    money_t *refunded = calloc((size_t)tripCount, sizeof(money_t));
+    int ok = seriesOfTrip && lookup && sold && cancelled && revenue && refunded;
+
+    if (ok) {
+        cube->seriesCount = internSeries(cube, trips, tripCount, seriesOfTrip);
+        cube->firstDay = firstDay;
+        cube->dayCount = lastDay - firstDay + 1;
+        ok = cube->seriesCount > 0 && (long long)cube->seriesCount * cube->dayCount <= MAX_OCCUPANCY_CELLS;
+    }
+    if (ok) {
+        size_t cellCount = (size_t)cube->seriesCount * (size_t)cube->dayCount;
+        size_t prefixCount = (size_t)cube->seriesCount * (size_t)(cube->dayCount + 1);
+        cube->cells = calloc(cellCount, sizeof(struct OccupancyCell));
+        cube->bookedPrefix = malloc(prefixCount * sizeof(long long));
+        cube->seatPrefix = malloc(prefixCount * sizeof(long long));
+        ok = cube->cells && cube->bookedPrefix && cube->seatPrefix;
+    }
+
+    // Journal totals per trip
+    if (ok) {
+        for (int t = 0; t < tripCount; t++) {
+            lookup[t].busID = trips[t].busID;
+            lookup[t].departureDay = trips[t].departureDay;
+            lookup[t].busNumberPlate = trips[t].busNumberPlate;
+            lookup[t].trip = t;
+        }
+        qsort(lookup, (size_t)tripCount, sizeof(struct TripLookup), compareTripLookups);
+        ok = sumJournal(reservationFile, lookup, tripCount, sold, revenue, &cube->unplacedSold) &&
+             sumJournal(cancellationFile, lookup, tripCount, cancelled, refunded, &cube->unplacedCancelled);
+    }
+
+    // Fold the trips into their cells
+    if (ok) {
+        for (int t = 0; t < tripCount; t++) {
+            struct OccupancyCell *cell = occupancyCell(cube, seriesOfTrip[t], trips[t].departureDay);
+            cell->trips++;
+            cell->seats += trips[t].totalSeats;
+            cell->booked += trips[t].bookedSeats;
+            cell->sold += sold[t];
+            cell->cancelled += cancelled[t];
+            cell->revenue += revenue[t];
+            cell->refunded += refunded[t];
+        }
+
+        // Running totals along each series' days, so any window is two subtractions
+        for (int s = 0; s < cube->seriesCount; s++) {
+            long long *booked = cube->bookedPrefix + (size_t)s * (cube->dayCount + 1);
+            long long *seats = cube->seatPrefix + (size_t)s * (cube->dayCount + 1);
+            const struct OccupancyCell *cells = cube->cells + (size_t)s * cube->dayCount;
+            booked[0] = seats[0] = 0;
+            for (int d = 0; d < cube->dayCount; d++) {
+                booked[d + 1] = booked[d] + cells[d].booked;
+                seats[d + 1] = seats[d] + cells[d].seats;
+            }
+        }
+    }
+
+    free(seriesOfTrip);
+    free(lookup);
+    free(sold);
+    free(cancelled);
+    free(revenue);
+    free(refunded);
+    if (!ok) freeOccupancyCube(cube);
+    return ok;
+}
+
+// Function to release the cube's memory
+void freeOccupancyCube(struct OccupancyCube *cube) {
+    free(cube->series);
+    free(cube->cells);
+    free(cube->bookedPrefix);
+    free(cube->seatPrefix);
+    memset(cube, 0, sizeof(*cube));
+}
+
+// Function to get the cell of a series on an epoch day (which must be inside the cube)
+struct OccupancyCell *occupancyCell(const struct OccupancyCube *cube, int series, int epochDay) {
+    return &cube->cells[(size_t)series * cube->dayCount + (size_t)(epochDay - cube->firstDay)];
+}
+
+// Function to get the load factor of a series over the days up to and including an epoch day,
+// as a whole percentage, or -1 if no seats were scheduled in that window
+int rollingLoadPercent(const struct OccupancyCube *cube, int series, int epochDay, int window) {
+    int last = epochDay - cube->firstDay + 1; // Prefix index just after the day
+    int first = last - window < 0 ? 0 : last - window;
+    const long long *booked = cube->bookedPrefix + (size_t)series * (cube->dayCount + 1);
+    const long long *seats = cube->seatPrefix + (size_t)series * (cube->dayCount + 1);
+    long long seatTotal = seats[last] - seats[first];
+    if (seatTotal == 0) return -1;
+    return (int)((booked[last] - booked[first]) * 100 / seatTotal);
+}
+
+// Function to order series by route, then departure hour
+static int compareSeries(const void *a, const void *b) {
+    const struct SeriesOrder *left = a, *right = b;
+    int order = compareStrings(left->source, right->source);
+    if (order == 0) order = compareStrings(left->destination, right->destination);
+    return order != 0 ? order : left->hour - right->hour;
+}
+
+// Function to render the cube as a table: every route, departure hour and day with trips, with
+// the rolling load factors of the week and month ending on that day
+void appendOccupancyReport(struct OutputBuffer *out, const struct OccupancyCube *cube) {
+    appendOutput(out, "==========================================================================================================================================\n");
+    appendOutput(out, "| %-10s | %-15s | %-15s | %-5s | %-5s | %-5s | %-6s | %-5s | %-9s | %-6s | %-10s | %-8s | %-8s |\n",
+                 "Date", "Source", "Destination", "Hour", "Trips", "Seats", "Booked", "Sold", "Cancelled", "Load", "Revenue", "7-day", "30-day");
+    appendOutput(out, "==========================================================================================================================================\n");
+
+    struct SeriesOrder *order = malloc((size_t)(cube->seriesCount > 0 ? cube->seriesCount : 1) * sizeof(*order));
+    if (!order) return;
+    for (int s = 0; s < cube->seriesCount; s++) {
+        order[s].source = cube->series[s].source;
+        order[s].destination = cube->series[s].destination;
+        order[s].hour = cube->series[s].hour;
+        order[s].series = s;
+    }
+    qsort(order, (size_t)cube->seriesCount, sizeof(*order), compareSeries);
+
+    for (int i = 0; i < cube->seriesCount; i++) {
+        int s = order[i].series;
+        const struct OccupancySeries *series = &cube->series[s];
+        for (int day = cube->firstDay; day < cube->firstDay + cube->dayCount; day++) {
+            const struct OccupancyCell *cell = occupancyCell(cube, s, day);
+            if (cell->trips == 0) continue;
+
+            char date[11], revenueText[MONEY_TEXT_LENGTH], weekText[8], monthText[8];
+            formatDate(day, date);
+            int week = rollingLoadPercent(cube, s, day, OCCUPANCY_SHORT_WINDOW);
+            int month = rollingLoadPercent(cube, s, day, OCCUPANCY_LONG_WINDOW);
+            snprintf(weekText, sizeof(weekText), "%d%%", week);
+            snprintf(monthText, sizeof(monthText), "%d%%", month);
+            appendOutput(out, "| %-10s | %-15s | %-15s | %02d:00 | %-5d | %-5d | %-6d | %-5d | %-9d | %5d%% | %10s | %8s | %8s |\n",
+                         date, stringText(series->source), stringText(series->destination), series->hour, cell->trips, cell->seats,
+                         cell->booked, cell->sold, cell->cancelled, cell->seats ? cell->booked * 100 / cell->seats : 0,
+                         formatMoney(cell->revenue, revenueText), weekText, monthText);
+        }
+    }
+    appendOutput(out, "==========================================================================================================================================\n");
+    if (cube->unplacedSold > 0 || cube->unplacedCancelled > 0) {
+        appendOutput(out, "Not shown by route: %d seat(s) sold and %d cancelled on trips that are no longer on record.\n",
+                     cube->unplacedSold, cube->unplacedCancelled);
+    }
+    free(order);
+}
@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "bus_reservation.h"
+
+// Benchmark comparing the fgets/sscanf parsing used before the record reader
+// with the shared block tokenizer, on the reservation and bus record formats.
+//
+// Build: gcc -O2 -I"Text File" "Source Code/parse_benchmark.c" "Source Code/record_parser.c" -o parse_benchmark
+// Usage: ./parse_benchmark [lines]
+
+#define DEFAULT_BENCHMARK_LINES 1000000 // Lines written to each benchmark file
+
+// Function to read a monotonic clock in seconds
+static double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to write a synthetic reservation.txt style file
+static void writeReservationFile(const char *filename, int lines) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Error: Could not create %s\n", filename);
+        exit(1);
+    }
+    for (int i = 0; i < lines; i++) {
+        fprintf(file, "User%d,%d,%d,BUS%d,2025-04-%02d,3,%d %d %d,%d.%02d\n",
+                i % 500, 100000 + i % 900000, 1001 + i % 100, 1001 + i % 20, 1 + i % 28,
+                1 + i % 40, 2 + i % 40, 3 + i % 40, 30 + i % 200, i % 100);
+    }
+    fclose(file);
+}
+
+// Function to write a synthetic buses.txt style file
+static void writeBusFile(const char *filename, int lines) {
+    FILE *file = fopen(filename, "w");
+    if (!file) {
+        printf("Error: Could not create %s\n", filename);
+        exit(1);
+    }
+    for (int i = 0; i < lines; i++) {
+        fprintf(file, "%d,BUS%d,2025-04-%02d,KualaLumpur,Penang,08:00AM,12:30PM,40,%d,%d.00\n",
+                1001 + i, 1001 + i % 20, 1 + i % 28, i % 40, 30 + i % 50);
+    }
+    fclose(file);
+}
+
+// Function to parse reservation lines the way the loaders did before the record reader
+static double sscanfReservations(const char *filename, long long *checksum) {
+    double start = nowSeconds();
+    FILE *file = fopen(filename, "r");
+    char line[256], username[50], busNumberPlate[20], date[20], seats[100];
+    int ticketNumber, busID, numSeats;
+    float amount;
+
+    while (fgets(line, sizeof(line), file)) {
+        if (sscanf(line, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f",
+                   username, &ticketNumber, &busID, busNumberPlate, date, &numSeats, seats, &amount) == 8) {
+            *checksum += ticketNumber + busID + numSeats;
+        }
+    }
+    fclose(file);
+    return nowSeconds() - start;
+}
+
+// Function to parse reservation lines with the record reader
+static double tokenizerReservations(const char *filename, long long *checksum) {
+    double start = nowSeconds();
+    struct RecordReader reader;
+    struct StringView line;
+    struct ReservationRecord record;
+
+    openRecordReader(&reader, filename);
+    while (readRecordLine(&reader, &line)) {
+        if (parseReservationRecord(line, &record)) {
+            *checksum += record.ticketNumber + record.busID + record.numSeats;
+        }
+    }
+    closeRecordReader(&reader);
+    return nowSeconds() - start;
+}
+
+// Function to parse bus lines the way loadBuses did before the record reader
+static double sscanfBuses(const char *filename, long long *checksum) {
+    double start = nowSeconds();
+    FILE *file = fopen(filename, "r");
+    char plate[20], date[11], source[50], destination[50], departure[20], arrival[20];
+    int busID, totalSeats, availableSeats;
+    float fare;
+
+    while (fscanf(file, "%d,%19[^,],%10[^,],%49[^,],%49[^,],%19[^,],%19[^,],%d,%d,%f",
+                  &busID, plate, date, source, destination, departure, arrival,
+                  &totalSeats, &availableSeats, &fare) == 10) {
+        *checksum += busID + availableSeats;
+    }
+    fclose(file);
+    return nowSeconds() - start;
+}
+
+// Function to parse bus lines with the record reader
+static double tokenizerBuses(const char *filename, long long *checksum) {
+    double start = nowSeconds();
+    struct RecordReader reader;
+    struct StringView line;
+    struct BusRecord record;
+
+    openRecordReader(&reader, filename);
+    while (readRecordLine(&reader, &line)) {
+        if (parseBusRecord(line, &record)) {
+            *checksum += record.busID + record.availableSeats;
+        }
+    }
+    closeRecordReader(&reader);
+    return nowSeconds() - start;
+}
+
+// Function to print one comparison row
+static void printResult(const char *format, int lines, double sscanfTime, double tokenizerTime,
+                        long long sscanfSum, long long tokenizerSum) {
+    printf("| %-12s | %12.0f | %12.0f | %7.1fx | %-8s |\n", format,
+           lines / sscanfTime, lines / tokenizerTime, sscanfTime / tokenizerTime,
+           sscanfSum == tokenizerSum ? "match" : "MISMATCH");
+}
+
+int main(int argc, char *argv[]) {
+    int lines = argc > 1 ? atoi(argv[1]) : DEFAULT_BENCHMARK_LINES;
+    long long sscanfSum = 0, tokenizerSum = 0;
+
+    writeReservationFile("bench_reservation.txt", lines);
+    writeBusFile("bench_buses.txt", lines);
+
+    printf("=============================================================\n");
+    printf("| %-12s | %12s | %12s | %8s | %-8s |\n", "Format", "sscanf l/s", "reader l/s", "Speedup", "Results");
+    printf("=============================================================\n");
+
+    double sscanfTime = sscanfReservations("bench_reservation.txt", &sscanfSum);
+    double tokenizerTime = tokenizerReservations("bench_reservation.txt", &tokenizerSum);
+    printResult("Reservation", lines, sscanfTime, tokenizerTime, sscanfSum, tokenizerSum);
+
+    sscanfSum = tokenizerSum = 0;
+    sscanfTime = sscanfBuses("bench_buses.txt", &sscanfSum);
+    tokenizerTime = tokenizerBuses("bench_buses.txt", &tokenizerSum);
+    printResult("Bus", lines, sscanfTime, tokenizerTime, sscanfSum, tokenizerSum);
+
+    printf("=============================================================\n");
+
+    remove("bench_reservation.txt");
+    remove("bench_buses.txt");
+    return 0;
+}
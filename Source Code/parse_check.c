@@ -0,0 +1,199 @@
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+// Check that the record reader gives the same results as the fgets/sscanf parsing it replaced.
+// Every line of the sample reservation, cancellation, bus and seat files is parsed both ways and
+// compared field by field; any difference is printed and the program exits with status 1.
+//
+// Build: gcc -O2 -I"Text File" "Source Code/parse_check.c" "Source Code/record_parser.c" -lm -o parse_check
+// Usage: ./parse_check [data folder]   (defaults to "Text File")
+
+#define CHECK_LINE_LENGTH 1024 // Longest sample line read by the sscanf path
+#define CHECK_MAX_SEATS 64     // Seats compared per seats.txt line
+
+static int mismatches = 0; // Differences found so far
+
+// Function to report one field that differs between the two parsers
+static void reportMismatch(const char *filename, int lineNumber, const char *field, const char *oldValue, const char *newValue) {
+    printf("MISMATCH %s:%d %s: sscanf \"%s\", reader \"%s\"\n", filename, lineNumber, field, oldValue, newValue);
+    mismatches++;
+}
+
+// Function to compare a text field
+static void compareText(const char *filename, int lineNumber, const char *field, const char *oldValue, struct StringView newField, size_t size) {
+    char newValue[CHECK_LINE_LENGTH];
+    copyView(newField, newValue, size < sizeof(newValue) ? size : sizeof(newValue)); // Same width limit as the old format
+    if (strcmp(oldValue, newValue) != 0) reportMismatch(filename, lineNumber, field, oldValue, newValue);
+}
+
+// Function to compare an integer field
+static void compareInt(const char *filename, int lineNumber, const char *field, int oldValue, int newValue) {
+    if (oldValue != newValue) {
+        char oldText[16], newText[16];
+        snprintf(oldText, sizeof(oldText), "%d", oldValue);
+        snprintf(newText, sizeof(newText), "%d", newValue);
+        reportMismatch(filename, lineNumber, field, oldText, newText);
+    }
+}
+
+// Function to compare an amount read as a float with one read in sen
+static void compareAmount(const char *filename, int lineNumber, const char *field, float oldValue, money_t newValue) {
+    long long oldSen = llround((double)oldValue * 100);
+    if (oldSen != (long long)newValue) {
+        char oldText[32], newText[32];
+        snprintf(oldText, sizeof(oldText), "%lld sen", oldSen);
+        snprintf(newText, sizeof(newText), "%lld sen", (long long)newValue);
+        reportMismatch(filename, lineNumber, field, oldText, newText);
+    }
+}
+
+// Function to compare whether a line was accepted at all; returns 1 if both parsed it
+static int compareAccepted(const char *filename, int lineNumber, int oldParsed, int newParsed) {
+    if (oldParsed != newParsed) {
+        reportMismatch(filename, lineNumber, "line", oldParsed ? "parsed" : "rejected", newParsed ? "parsed" : "rejected");
+    }
+    return oldParsed && newParsed;
+}
+
+// Function to open the same sample file for both parsers
+static int openBoth(const char *folder, const char *name, char *path, size_t size, FILE **file, struct RecordReader *reader) {
+    snprintf(path, size, "%s/%s", folder, name);
+    *file = fopen(path, "r");
+    if (!*file || !openRecordReader(reader, path)) {
+        if (*file) fclose(*file);
+        printf("Error: Could not open %s\n", path);
+        mismatches++;
+        return 0;
+    }
+    return 1;
+}
+
+// Function to check a reservation.txt / cancellations.txt style file; returns the lines checked
+static int checkReservations(const char *folder, const char *name) {
+    char path[MAX_IMPORT_PATH], line[CHECK_LINE_LENGTH];
+    FILE *file;
+    struct RecordReader reader;
+    if (!openBoth(folder, name, path, sizeof(path), &file, &reader)) return 0;
+
+    int lineNumber = 0;
+    struct StringView view;
+    while (fgets(line, sizeof(line), file) && readRecordLine(&reader, &view)) {
+        char username[50], busNumberPlate[20], date[20], seats[100];
+        int ticketNumber, busID, numSeats;
+        float amount;
+        struct ReservationRecord record;
+        lineNumber++;
+
+        // The format the loaders used before the record reader
+        int oldParsed = sscanf(line, "%49[^,],%d,%d,%19[^,],%19[^,],%d,%99[^,],%f",
+                               username, &ticketNumber, &busID, busNumberPlate, date, &numSeats, seats, &amount) == 8;
+        int newParsed = parseReservationRecord(view, &record);
+        if (!compareAccepted(path, lineNumber, oldParsed, newParsed)) continue;
+
+        compareText(path, lineNumber, "username", username, record.username, sizeof(username));
+        compareInt(path, lineNumber, "ticket number", ticketNumber, record.ticketNumber);
+        compareInt(path, lineNumber, "bus ID", busID, record.busID);
+        compareText(path, lineNumber, "bus number plate", busNumberPlate, record.busNumberPlate, sizeof(busNumberPlate));
+        compareText(path, lineNumber, "date", date, record.date, sizeof(date));
+        compareInt(path, lineNumber, "seat count", numSeats, record.numSeats);
+        compareText(path, lineNumber, "seats", seats, record.seatList, sizeof(seats));
+        compareAmount(path, lineNumber, "amount", amount, record.amount);
+    }
+    fclose(file);
+    closeRecordReader(&reader);
+    return lineNumber;
+}
+
+// Function to check buses.txt; returns the lines checked
+static int checkBuses(const char *folder) {
+    char path[MAX_IMPORT_PATH], line[CHECK_LINE_LENGTH];
+    FILE *file;
+    struct RecordReader reader;
+    if (!openBoth(folder, "buses.txt", path, sizeof(path), &file, &reader)) return 0;
+
+    int lineNumber = 0;
+    struct StringView view;
+    while (fgets(line, sizeof(line), file) && readRecordLine(&reader, &view)) {
+        char plate[20], date[11], source[50], destination[50], departure[20], arrival[20];
+        int busID, totalSeats, availableSeats;
+        float fare;
+        struct BusRecord record;
+        lineNumber++;
+
+        // The format loadBuses used before the record reader
+        int oldParsed = sscanf(line, "%d,%19[^,],%10[^,],%49[^,],%49[^,],%19[^,],%19[^,],%d,%d,%f",
+                               &busID, plate, date, source, destination, departure, arrival,
+                               &totalSeats, &availableSeats, &fare) == 10;
+        int newParsed = parseBusRecord(view, &record);
+        if (!compareAccepted(path, lineNumber, oldParsed, newParsed)) continue;
+
+        compareInt(path, lineNumber, "bus ID", busID, record.busID);
+        compareText(path, lineNumber, "bus number plate", plate, record.busNumberPlate, sizeof(plate));
+        compareText(path, lineNumber, "date", date, record.date, sizeof(date));
+        compareText(path, lineNumber, "source", source, record.source, sizeof(source));
+        compareText(path, lineNumber, "destination", destination, record.destination, sizeof(destination));
+        compareText(path, lineNumber, "departure time", departure, record.departureTime, sizeof(departure));
+        compareText(path, lineNumber, "arrival time", arrival, record.arrivalTime, sizeof(arrival));
+        compareInt(path, lineNumber, "total seats", totalSeats, record.totalSeats);
+        compareInt(path, lineNumber, "available seats", availableSeats, record.availableSeats);
+        compareAmount(path, lineNumber, "fare", fare, record.fare);
+    }
+    fclose(file);
+    closeRecordReader(&reader);
+    return lineNumber;
+}
+
+// Function to check seats.txt; returns the lines checked
+static int checkSeats(const char *folder) {
+    char path[MAX_IMPORT_PATH], line[CHECK_LINE_LENGTH];
+    FILE *file;
+    struct RecordReader reader;
+    if (!openBoth(folder, "seats.txt", path, sizeof(path), &file, &reader)) return 0;
+
+    int lineNumber = 0;
+    struct StringView view;
+    while (fgets(line, sizeof(line), file) && readRecordLine(&reader, &view)) {
+        int busID, reservedCount, used, oldSeats[CHECK_MAX_SEATS], newSeats[CHECK_MAX_SEATS];
+        struct SeatRecord record;
+        lineNumber++;
+
+        // loadSeats read "busID,count" and then ",seat" once per reserved seat
+        int oldParsed = sscanf(line, "%d,%d%n", &busID, &reservedCount, &used) == 2 &&
+                        reservedCount >= 0 && reservedCount <= CHECK_MAX_SEATS;
+        for (int i = 0; oldParsed && i < reservedCount; i++) {
+            int advanced;
+            oldParsed = sscanf(line + used, ",%d%n", &oldSeats[i], &advanced) == 1;
+            used += advanced;
+        }
+        int newParsed = parseSeatRecord(view, &record, newSeats, CHECK_MAX_SEATS);
+        if (!compareAccepted(path, lineNumber, oldParsed, newParsed)) continue;
+
+        compareInt(path, lineNumber, "bus ID", busID, record.busID);
+        compareInt(path, lineNumber, "reserved count", reservedCount, record.reservedCount);
+        for (int i = 0; i < reservedCount && i < record.reservedCount; i++) {
+            compareInt(path, lineNumber, "seat", oldSeats[i], newSeats[i]);
+        }
+    }
+    fclose(file);
+    closeRecordReader(&reader);
+    return lineNumber;
+}
+
+int main(int argc, char *argv[]) {
+    const char *folder = argc > 1 ? argv[1] : "Text File";
+
+    int lines = checkReservations(folder, "reservation.txt");
+    lines += checkReservations(folder, "cancellations.txt");
+    lines += checkBuses(folder);
+    lines += checkSeats(folder);
+
+    if (mismatches > 0) {
+        printf("%d mismatch(es) in %d lines.\n", mismatches, lines);
+        return 1;
+    }
+    printf("Results match (%d lines).\n", lines);
+    return 0;
+}
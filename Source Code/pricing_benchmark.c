@@ -0,0 +1,109 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bus_reservation.h"
+
+// Microbenchmark of a full repricing. The same synthetic fleet is priced by priceTrips, the batch
+// used by the program, and by a trip-at-a-time version that walks the tier tables with branches.
+// Both must produce the same prices or the result says MISMATCH.
+//
+// Build: gcc -O2 -I"Text File" "Source Code/pricing_benchmark.c" "Source Code/dynamic_pricing.c" "Source Code/record_parser.c" -o pricing_benchmark
+// Usage: ./pricing_benchmark [trips] [pricing file]
+
+#define DEFAULT_PRICED_TRIPS 1000000 // Trips repriced per run
+#define PRICING_ROUNDS 5             // Runs of each implementation; the fastest counts
+
+// Tiers priced with when the file has none; the shipped pricing.txt has its examples commented out
+static const struct PriceTier sampleLoadTiers[] = { { 0, 90 }, { 30, 100 }, { 70, 115 }, { 90, 130 } };
+static const struct PriceTier sampleDayTiers[] = { { 0, 120 }, { 3, 110 }, { 14, 100 } };
+
+// Function to read a monotonic clock in seconds
+static double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to find the multiplier of the last tier a value has reached
+static int tierPercent(const struct PriceTier tiers[], int count, int value) {
+    int percent = 100;
+    for (int t = 0; t < count && value >= tiers[t].from; t++) {
+        percent = tiers[t].percent;
+    }
+    return percent;
+}
+
+// Function to price trips one at a time, as a loop over the bus array would
+static void priceTripsOneByOne(const struct PricingTiers *tiers, const money_t fares[], const int availableSeats[],
+                               const int totalSeats[], const int departureDays[], int today, int count, money_t prices[]) {
+    for (int i = 0; i < count; i++) {
+        int total = totalSeats[i] > 0 ? totalSeats[i] : 1;
+        int occupancy = (total - availableSeats[i]) * 100 / total;
+        int days = departureDays[i] > today ? departureDays[i] - today : 0;
+        money_t scaled = fares[i] * (tierPercent(tiers->load, tiers->loadCount, occupancy) *
+                                     tierPercent(tiers->days, tiers->dayCount, days));
+        prices[i] = (scaled + 5000) / 10000;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int count = argc > 1 ? atoi(argv[1]) : DEFAULT_PRICED_TRIPS;
+    const char *pricingFile = argc > 2 ? argv[2] : "Text File/" PRICING_FILE;
+    if (count <= 0) count = DEFAULT_PRICED_TRIPS;
+
+    struct PricingTiers tiers;
+    if (!loadPricingTiers(&tiers, pricingFile)) {
+        printf("No tiers in %s; pricing with the sample tiers instead.\n", pricingFile);
+        tiers.loadCount = (int)(sizeof(sampleLoadTiers) / sizeof(sampleLoadTiers[0]));
+        tiers.dayCount = (int)(sizeof(sampleDayTiers) / sizeof(sampleDayTiers[0]));
+        memcpy(tiers.load, sampleLoadTiers, sizeof(sampleLoadTiers));
+        memcpy(tiers.days, sampleDayTiers, sizeof(sampleDayTiers));
+    }
+
+    money_t *fares = malloc((size_t)count * sizeof(money_t));
+    int *available = malloc((size_t)count * sizeof(int));
+    int *total = malloc((size_t)count * sizeof(int));
+    int *departureDays = malloc((size_t)count * sizeof(int));
+    money_t *batchPrices = malloc((size_t)count * sizeof(money_t));
+    money_t *singlePrices = malloc((size_t)count * sizeof(money_t));
+    if (!fares || !available || !total || !departureDays || !batchPrices || !singlePrices) {
+        printf("Not enough memory for %d trips.\n", count);
+        return 1;
+    }
+
+    // A fleet spread over the next two months with every load factor
+    int today = 20000;
+    srand(42);
+    for (int i = 0; i < count; i++) {
+        total[i] = 30 + rand() % (MAX_SEATS - 29);
+        available[i] = rand() % (total[i] + 1);
+        fares[i] = 2000 + rand() % 4000;
+        departureDays[i] = today - 1 + rand() % 62;
+    }
+
+    double batchBest = 1e9, singleBest = 1e9;
+    for (int round = 0; round < PRICING_ROUNDS; round++) {
+        double start = nowSeconds();
+        priceTrips(&tiers, fares, available, total, departureDays, today, count, batchPrices);
+        double middle = nowSeconds();
+        priceTripsOneByOne(&tiers, fares, available, total, departureDays, today, count, singlePrices);
+        double end = nowSeconds();
+        if (middle - start < batchBest) batchBest = middle - start;
+        if (end - middle < singleBest) singleBest = end - middle;
+    }
+
+    int same = memcmp(batchPrices, singlePrices, (size_t)count * sizeof(money_t)) == 0;
+    printf("%-14s %10s %14s\n", "Implementation", "ms", "trips/s");
+    printf("%-14s %10.2f %14.0f\n", "batch", batchBest * 1000, count / batchBest);
+    printf("%-14s %10.2f %14.0f\n", "one by one", singleBest * 1000, count / singleBest);
+    printf("%s\n", same ? "Prices match." : "MISMATCH");
+
+    free(fares);
+    free(available);
+    free(total);
+    free(departureDays);
+    free(batchPrices);
+    free(singlePrices);
+    return same ? 0 : 1;
+}
@@ -1,10 +1,15 @@
 #include <stdio.h>
 #include "bus_reservation.h"
 
-void printBusHeader() {
-    printf("============================================================================================================================\n");
-    printf("| %-5s | %-12s | %-10s | %-15s | %-15s | %-10s | %-10s | %-5s | %-5s | %-6s |\n",
-           "ID", "Number Plate", "Date", "Source", "Destination", "Depart", "Arrive", "Seats", "Avail", "Fare");
-    printf("============================================================================================================================\n");
+#define BUS_TABLE_RULE "============================================================================================================================\n"
+
+void appendBusHeader(struct OutputBuffer *out) {
+    appendOutput(out, BUS_TABLE_RULE);
+    appendOutput(out, "| %-5s | %-12s | %-10s | %-15s | %-15s | %-10s | %-10s | %-5s | %-5s | %-6s |\n",
+                 "ID", "Number Plate", "Date", "Source", "Destination", "Depart", "Arrive", "Seats", "Avail", "Fare");
+    appendOutput(out, BUS_TABLE_RULE);
 }
 
+void appendBusTableEnd(struct OutputBuffer *out) {
+    appendOutput(out, BUS_TABLE_RULE);
+}
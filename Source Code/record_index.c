@@ -0,0 +1,540 @@
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+#define INDEX_MAGIC 0x58495242u       // "BRIX", stored little-endian like every other field
+#define INDEX_VERSION 2               // Bumped whenever the .idx layout changes (2: fixed-width little-endian fields)
+#define FINGERPRINT_BYTES 256         // Bytes hashed at the start and at the end of the indexed part
+#define MAX_CACHED_INDEXES 4          // Journals whose index is kept in memory between queries
+
+// Posting list of one key: record IDs in increasing order, delta-encoded as varints
+struct PostingList {
+    char *key;                // Index type character followed by the value, e.g. "uUser1"
+    unsigned char *bytes;     // Varint-encoded gaps between record IDs
+    int length;               // Bytes used
+    int capacity;             // Bytes allocated
+    int count;                // Number of record IDs in the list
+    int lastRecord;           // Last record ID added, the base for the next gap
+};
+
+// Secondary indexes over one reservation/cancellation journal
+struct RecordIndex {
+    char journal[MAX_IMPORT_PATH];     // File the index covers
+    long coveredBytes;                       // Bytes of the journal already indexed (whole lines)
+    unsigned long long headFingerprint;      // Hash of the first bytes of the journal
+    unsigned long long tailFingerprint;      // Hash of the bytes just before coveredBytes
+    long *offsets;                           // File offset of every record, by record ID
+    int recordCount;                         // Records indexed
+    int offsetCapacity;                      // Offsets allocated
+    struct PostingList *terms;               // Open-addressing hash table of posting lists
+    int termCount;                           // Keys in use
+    int termCapacity;                        // Table size (a power of two)
+};
+
+static struct RecordIndex *cachedIndexes[MAX_CACHED_INDEXES]; // Indexes loaded this session
+
+// Function to hash bytes with 64-bit FNV-1a
+static unsigned long long hashBytes(const void *data, size_t length, unsigned long long hash) {
+    const unsigned char *bytes = data;
+    for (size_t i = 0; i < length; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Function to hash a range of a file, used to detect journals that were rewritten
+static unsigned long long fingerprintRange(FILE *file, long start, long length) {
+    unsigned char buffer[FINGERPRINT_BYTES];
+    if (start < 0) {
+        length += start;
+        start = 0;
+    }
+    if (length <= 0) return 0;
+
+    fseek(file, start, SEEK_SET);
+    size_t got = fread(buffer, 1, (size_t)length, file);
+    return hashBytes(buffer, got, 14695981039346656037ULL);
+}
+
+// Function to release every buffer of an index
+static void freeRecordIndex(struct RecordIndex *index) {
+    for (int i = 0; i < index->termCapacity; i++) {
+        free(index->terms[i].key);
+        free(index->terms[i].bytes);
+    }
+    free(index->terms);
+    free(index->offsets);
+    free(index);
+}
+
+// Function to create an empty index for a journal
+static struct RecordIndex *newRecordIndex(const char *journal) {
+    struct RecordIndex *index = calloc(1, sizeof(*index));
+    if (!index) return NULL;
+
+    snprintf(index->journal, sizeof(index->journal), "%s", journal);
+    index->termCapacity = 64;
+    index->terms = calloc((size_t)index->termCapacity, sizeof(*index->terms));
+    if (!index->terms) {
+        free(index);
+        return NULL;
+    }
+    return index;
+}
+
+// Function to find the slot of a key, or the empty slot where it belongs
+static struct PostingList *findTerm(struct RecordIndex *index, const char *key, int keyLength) {
+    unsigned long long hash = hashBytes(key, (size_t)keyLength, 14695981039346656037ULL);
+    int mask = index->termCapacity - 1;
+
+    for (int slot = (int)(hash & (unsigned long long)mask);; slot = (slot + 1) & mask) {
+        struct PostingList *term = &index->terms[slot];
+        if (!term->key || ((int)strlen(term->key) == keyLength && memcmp(term->key, key, (size_t)keyLength) == 0)) {
+            return term;
+        }
+    }
+}
+
+// Function to double the hash table once it is half full
+static int growTerms(struct RecordIndex *index) {
+    struct PostingList *old = index->terms;
+    int oldCapacity = index->termCapacity;
+
+    index->terms = calloc((size_t)oldCapacity * 2, sizeof(*index->terms));
+    if (!index->terms) {
+        index->terms = old;
+        return 0;
+    }
+    index->termCapacity = oldCapacity * 2;
+
+    for (int i = 0; i < oldCapacity; i++) {
+        if (old[i].key) {
+            *findTerm(index, old[i].key, (int)strlen(old[i].key)) = old[i]; // Move, buffers are kept
+        }
+    }
+    free(old);
+    return 1;
+}
+
+// Function to append a varint to a posting list
+static int appendVarint(struct PostingList *term, unsigned int value) {
+    if (term->length + 5 > term->capacity) {
+        int capacity = term->capacity ? term->capacity * 2 : 16;
+        unsigned char *bytes = realloc(term->bytes, (size_t)capacity);
+        if (!bytes) return 0;
+        term->bytes = bytes;
+        term->capacity = capacity;
+    }
+    while (value >= 0x80) {
+        term->bytes[term->length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    term->bytes[term->length++] = (unsigned char)value;
+    return 1;
+}
+
+// Function to add a record ID to the posting list of a key
+static int addPosting(struct RecordIndex *index, char type, struct StringView value, int recordID) {
+    char key[MAX_INDEX_KEY + 1];
+    if (value.length <= 0 || value.length >= MAX_INDEX_KEY) return 1; // Not indexable, found by scanning
+
+    key[0] = type;
+    memcpy(key + 1, value.data, (size_t)value.length);
+    key[value.length + 1] = '\0';
+
+    if ((index->termCount + 1) * 2 > index->termCapacity && !growTerms(index)) return 0;
+
+    struct PostingList *term = findTerm(index, key, value.length + 1);
+    if (!term->key) {
+        term->key = malloc((size_t)value.length + 2);
+        if (!term->key) return 0;
+        memcpy(term->key, key, (size_t)value.length + 2);
+        term->lastRecord = -1; // The first gap is measured from -1, so it is never zero
+        index->termCount++;
+    }
+
+    if (!appendVarint(term, (unsigned int)(recordID - term->lastRecord))) return 0;
+    term->lastRecord = recordID;
+    term->count++;
+    return 1;
+}
+
+// Function to index one parsed record under all of its keys
+static int indexRecord(struct RecordIndex *index, const struct ReservationRecord *record, long offset) {
+    if (index->recordCount == index->offsetCapacity) {
+        int capacity = index->offsetCapacity ? index->offsetCapacity * 2 : 1024;
+        long *offsets = realloc(index->offsets, (size_t)capacity * sizeof(long));
+        if (!offsets) return 0;
+        index->offsets = offsets;
+        index->offsetCapacity = capacity;
+    }
+
+    int recordID = index->recordCount++;
+    index->offsets[recordID] = offset;
+
+    char busIDText[16];
+    struct StringView busID = { busIDText, snprintf(busIDText, sizeof(busIDText), "%d", record->busID) };
+    struct StringView year = { record->date.data, record->date.length >= 4 ? 4 : 0 };
+    struct StringView month = { record->date.data, record->date.length >= 7 ? 7 : 0 };
+
+    // The date is indexed by year, by month and by day so that "2025", "2025-04" and "2025-04-29" are lookups
+    return addPosting(index, INDEX_USERNAME, record->username, recordID) &&
+           addPosting(index, INDEX_BUS_ID, busID, recordID) &&
+           addPosting(index, INDEX_PLATE, record->busNumberPlate, recordID) &&
+           addPosting(index, INDEX_DATE, year, recordID) &&
+           addPosting(index, INDEX_DATE, month, recordID) &&
+           (record->date.length <= 7 || addPosting(index, INDEX_DATE, record->date, recordID));
+}
+
+// Function to index the journal from coveredBytes to its last complete line
+static int extendRecordIndex(struct RecordIndex *index) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, index->journal)) return 0;
+
+    fseek(reader.file, 0, SEEK_END);
+    long fileSize = ftell(reader.file);
+    long indexEnd = fileSize;
+
+    // A last line without its newline may still be being written; leave it for the next refresh
+    if (fileSize > index->coveredBytes) {
+        fseek(reader.file, fileSize - 1, SEEK_SET);
+        if (fgetc(reader.file) != '\n') {
+            indexEnd = -1; // Set to the start of the last line below
+        }
+    }
+
+    seekRecordReader(&reader, index->coveredBytes);
+
+    struct StringView line;
+    struct ReservationRecord record;
+    long lastLineStart = index->coveredBytes;
+    int ok = 1;
+    while (ok && readRecordLine(&reader, &line)) {
+        lastLineStart = reader.lineOffset;
+        if (indexEnd == -1 && reader.eof && reader.start == reader.end) {
+            break; // This is the unfinished last line
+        }
+        if (parseReservationRecord(line, &record)) {
+            ok = indexRecord(index, &record, reader.lineOffset);
+        }
+    }
+
+    if (ok) {
+        index->coveredBytes = indexEnd == -1 ? lastLineStart : fileSize;
+        index->headFingerprint = fingerprintRange(reader.file, 0, FINGERPRINT_BYTES);
+        index->tailFingerprint = fingerprintRange(reader.file, index->coveredBytes - FINGERPRINT_BYTES, FINGERPRINT_BYTES);
+    }
+    closeRecordReader(&reader);
+    return ok;
+}
+
+// Function to write a 32-bit value as 4 little-endian bytes
+static int writeInt32(FILE *file, int32_t value) {
+    unsigned char bytes[4];
+    for (int i = 0; i < 4; i++) {
+        bytes[i] = (unsigned char)((uint32_t)value >> (8 * i));
+    }
+    return fwrite(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+}
+
+// Function to write a 64-bit value as 8 little-endian bytes
+static int writeInt64(FILE *file, int64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; i++) {
+        bytes[i] = (unsigned char)((uint64_t)value >> (8 * i));
+    }
+    return fwrite(bytes, 1, sizeof(bytes), file) == sizeof(bytes);
+}
+
+// Function to read 4 little-endian bytes back into a 32-bit value
+static int readInt32(FILE *file, int32_t *value) {
+    unsigned char bytes[4];
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return 0;
+    uint32_t result = 0;
+    for (int i = 3; i >= 0; i--) {
+        result = (result << 8) | bytes[i];
+    }
+    *value = (int32_t)result;
+    return 1;
+}
+
+// Function to read 8 little-endian bytes back into a 64-bit value
+static int readInt64(FILE *file, int64_t *value) {
+    unsigned char bytes[8];
+    if (fread(bytes, 1, sizeof(bytes), file) != sizeof(bytes)) return 0;
+    uint64_t result = 0;
+    for (int i = 7; i >= 0; i--) {
+        result = (result << 8) | bytes[i];
+    }
+    *value = (int64_t)result;
+    return 1;
+}
+
+// Function to write the index next to its journal as <journal>.idx.
+// Every field has a fixed width and byte order, so an index written on one machine reads
+// the same on any other; the file is replaced through a temp file and never left half written.
+static void saveRecordIndex(const struct RecordIndex *index) {
+    char path[MAX_IMPORT_PATH + 8];
+    snprintf(path, sizeof(path), "%s.idx", index->journal);
+
+    struct DurableFile out;
+    FILE *file = beginDurableWrite(&out, path, 0);
+    if (!file) return; // The index is rebuilt next time; nothing is lost
+
+    int ok = writeInt32(file, (int32_t)INDEX_MAGIC) && writeInt32(file, INDEX_VERSION) &&
+             writeInt64(file, index->coveredBytes) &&
+             writeInt64(file, (int64_t)index->headFingerprint) &&
+             writeInt64(file, (int64_t)index->tailFingerprint) &&
+             writeInt32(file, index->recordCount) && writeInt32(file, index->termCount);
+    for (int i = 0; ok && i < index->recordCount; i++) {
+        ok = writeInt64(file, index->offsets[i]);
+    }
+
+    for (int i = 0; ok && i < index->termCapacity; i++) {
+        const struct PostingList *term = &index->terms[i];
+        if (!term->key) continue;
+        int keyLength = (int)strlen(term->key);
+        ok = writeInt32(file, keyLength) && fwrite(term->key, 1, (size_t)keyLength, file) == (size_t)keyLength &&
+             writeInt32(file, term->count) && writeInt32(file, term->lastRecord) && writeInt32(file, term->length) &&
+             (term->length == 0 || fwrite(term->bytes, 1, (size_t)term->length, file) == (size_t)term->length);
+    }
+
+    if (!ok || ferror(file)) {
+        abortDurableWrite(&out); // The old index, if any, stays in place
+        return;
+    }
+    commitDurableWrite(&out);
+}
+
+// Function to read <journal>.idx back into memory; returns NULL if it is missing, damaged,
+// or written by another version (including the old native-width layout), so it is rebuilt
+static struct RecordIndex *loadRecordIndex(const char *journal) {
+    char path[MAX_IMPORT_PATH + 8];
+    snprintf(path, sizeof(path), "%s.idx", journal);
+
+    FILE *file = fopen(path, "rb");
+    if (!file) return NULL;
+
+    struct RecordIndex *index = newRecordIndex(journal);
+    int32_t magic = 0, version = 0, recordCount = 0, termCount = 0;
+    int64_t coveredBytes = 0, headFingerprint = 0, tailFingerprint = 0;
+    int ok = index != NULL;
+
+    ok = ok && readInt32(file, &magic) && (uint32_t)magic == INDEX_MAGIC &&
+         readInt32(file, &version) && version == INDEX_VERSION;
+    ok = ok && readInt64(file, &coveredBytes) && coveredBytes >= 0 && coveredBytes <= LONG_MAX;
+    ok = ok && readInt64(file, &headFingerprint) && readInt64(file, &tailFingerprint);
+    ok = ok && readInt32(file, &recordCount) && recordCount >= 0;
+    ok = ok && readInt32(file, &termCount) && termCount >= 0;
+
+    if (ok) {
+        index->coveredBytes = (long)coveredBytes;
+        index->headFingerprint = (unsigned long long)headFingerprint;
+        index->tailFingerprint = (unsigned long long)tailFingerprint;
+        index->offsetCapacity = recordCount > 0 ? recordCount : 1;
+        index->offsets = malloc((size_t)index->offsetCapacity * sizeof(long));
+        ok = index->offsets != NULL;
+    }
+    for (int i = 0; ok && i < recordCount; i++) {
+        int64_t offset;
+        ok = readInt64(file, &offset) && offset >= 0 && offset < coveredBytes;
+        if (ok) index->offsets[i] = (long)offset;
+    }
+    if (ok) index->recordCount = recordCount;
+
+    for (int i = 0; ok && i < termCount; i++) {
+        int32_t keyLength, count, lastRecord, length;
+        char key[MAX_INDEX_KEY + 1];
+        struct PostingList loaded = {0};
+
+        ok = readInt32(file, &keyLength) && keyLength > 0 && keyLength <= MAX_INDEX_KEY &&
+             fread(key, 1, (size_t)keyLength, file) == (size_t)keyLength &&
+             readInt32(file, &count) && count >= 0 &&
+             readInt32(file, &lastRecord) && lastRecord < recordCount &&
+             readInt32(file, &length) && length >= 0;
+        if (!ok) break;
+        loaded.count = count;
+        loaded.lastRecord = lastRecord;
+        loaded.length = length;
+
+        loaded.capacity = loaded.length > 0 ? loaded.length : 1;
+        loaded.bytes = malloc((size_t)loaded.capacity);
+        loaded.key = malloc((size_t)keyLength + 1);
+        ok = loaded.bytes && loaded.key && fread(loaded.bytes, 1, (size_t)loaded.length, file) == (size_t)loaded.length;
+        if (!ok || ((index->termCount + 1) * 2 > index->termCapacity && !growTerms(index))) {
+            free(loaded.bytes);
+            free(loaded.key);
+            ok = 0;
+            break;
+        }
+        memcpy(loaded.key, key, (size_t)keyLength);
+        loaded.key[keyLength] = '\0';
+        *findTerm(index, key, keyLength) = loaded;
+        index->termCount++;
+    }
+    fclose(file);
+
+    if (!ok) {
+        if (index) freeRecordIndex(index);
+        return NULL; // Damaged or from another version; it is rebuilt
+    }
+    return index;
+}
+
+// Function to check that the indexed part of the journal is still what was indexed
+static int indexMatchesJournal(const struct RecordIndex *index) {
+    FILE *file = fopen(index->journal, "rb");
+    if (!file) return 0;
+
+    fseek(file, 0, SEEK_END);
+    long fileSize = ftell(file);
+    int same = fileSize >= index->coveredBytes &&
+               fingerprintRange(file, 0, FINGERPRINT_BYTES) == index->headFingerprint &&
+               fingerprintRange(file, index->coveredBytes - FINGERPRINT_BYTES, FINGERPRINT_BYTES) == index->tailFingerprint;
+    fclose(file);
+    return same;
+}
+
+// Function to get an up-to-date index of a journal.
+// Appended lines are indexed incrementally; a journal rewritten in place (e.g. after a
+// cancellation removes a line) no longer matches its fingerprints and is indexed again.
+struct RecordIndex *getRecordIndex(const char *journal) {
+    int cacheSlot = -1;
+    struct RecordIndex *index = NULL;
+
+    for (int i = 0; i < MAX_CACHED_INDEXES; i++) {
+        if (cachedIndexes[i] && strcmp(cachedIndexes[i]->journal, journal) == 0) {
+            cacheSlot = i;
+            index = cachedIndexes[i];
+            break;
+        }
+        if (!cachedIndexes[i] && cacheSlot == -1) cacheSlot = i;
+    }
+    if (cacheSlot == -1) cacheSlot = 0; // Evict the first journal if every slot is taken
+
+    if (!index) index = loadRecordIndex(journal);
+    if (index && !indexMatchesJournal(index)) {
+        freeRecordIndex(index); // The journal was rewritten, start over
+        index = NULL;
+    }
+
+    long coveredBefore = index ? index->coveredBytes : -1;
+    if (!index) index = newRecordIndex(journal);
+    if (!index || !extendRecordIndex(index)) {
+        if (index) freeRecordIndex(index);
+        if (cachedIndexes[cacheSlot] && cachedIndexes[cacheSlot] != index) freeRecordIndex(cachedIndexes[cacheSlot]);
+        cachedIndexes[cacheSlot] = NULL;
+        return NULL; // Callers fall back to scanning the journal
+    }
+
+    if (index->coveredBytes != coveredBefore) {
+        saveRecordIndex(index); // Only rewritten when something new was indexed
+    }
+    if (cachedIndexes[cacheSlot] && cachedIndexes[cacheSlot] != index) {
+        freeRecordIndex(cachedIndexes[cacheSlot]);
+    }
+    cachedIndexes[cacheSlot] = index;
+    return index;
+}
+
+// Function to check whether a criterion can be answered exactly by an index lookup
+int canIndexCriterion(const struct IndexCriterion *criterion) {
+    const char *value = criterion->value;
+    size_t length = strlen(value);
+
+    if (length == 0 || length >= MAX_INDEX_KEY) return 0;
+    if (criterion->type != INDEX_DATE) return 1;
+
+    // Date filters are substring matches; only whole years, months and days are indexed
+    if (length != 4 && length != 7 && length != 10) return 0;
+    for (size_t i = 0; i < length; i++) {
+        int dash = (i == 4 || i == 7);
+        if (dash ? value[i] != '-' : (value[i] < '0' || value[i] > '9')) return 0;
+    }
+    return 1;
+}
+
+// Function to decode a posting list into record IDs
+static int *decodePostings(const struct PostingList *term) {
+    int *records = malloc((size_t)(term->count > 0 ? term->count : 1) * sizeof(int));
+    if (!records) return NULL;
+
+    int record = -1, count = 0;
+    for (int i = 0; i < term->length && count < term->count;) {
+        unsigned int gap = 0;
+        int shift = 0;
+        while (i < term->length) {
+            unsigned char byte = term->bytes[i++];
+            gap |= (unsigned int)(byte & 0x7F) << shift;
+            shift += 7;
+            if (!(byte & 0x80)) break;
+        }
+        record += (int)gap;
+        records[count++] = record;
+    }
+    return records;
+}
+
+// Function to find the journal offsets of the records matching every criterion.
+// Returns the number of matches and a malloc'd array of offsets in file order, or -1 on failure.
+int queryRecordIndex(struct RecordIndex *index, const struct IndexCriterion criteria[], int criteriaCount, long **offsets) {
+    const struct PostingList *lists[MAX_INDEX_CRITERIA];
+    *offsets = NULL;
+
+    if (criteriaCount < 1 || criteriaCount > MAX_INDEX_CRITERIA) return -1;
+
+    // Look up every key; a key that was never seen means no record can match
+    for (int i = 0; i < criteriaCount; i++) {
+        char key[MAX_INDEX_KEY + 1];
+        int keyLength = snprintf(key, sizeof(key), "%c%s", criteria[i].type, criteria[i].value);
+        const struct PostingList *term = findTerm(index, key, keyLength);
+        if (!term->key) {
+            *offsets = malloc(sizeof(long));
+            return *offsets ? 0 : -1;
+        }
+        lists[i] = term;
+    }
+
+    // Intersect starting from the shortest list, so the working set only shrinks
+    for (int i = 1; i < criteriaCount; i++) {
+        for (int j = i; j > 0 && lists[j]->count < lists[j - 1]->count; j--) {
+            const struct PostingList *swap = lists[j];
+            lists[j] = lists[j - 1];
+            lists[j - 1] = swap;
+        }
+    }
+
+    int *result = decodePostings(lists[0]);
+    int resultCount = lists[0]->count;
+    for (int i = 1; result && i < criteriaCount && resultCount > 0; i++) {
+        int *other = decodePostings(lists[i]);
+        if (!other) {
+            free(result);
+            return -1;
+        }
+        int kept = 0;
+        for (int a = 0, b = 0; a < resultCount && b < lists[i]->count;) {
+            if (result[a] < other[b]) a++;
+            else if (result[a] > other[b]) b++;
+            else { result[kept++] = result[a]; a++; b++; }
+        }
+        resultCount = kept;
+        free(other);
+    }
+    if (!result) return -1;
+
+    *offsets = malloc((size_t)(resultCount > 0 ? resultCount : 1) * sizeof(long));
+    if (!*offsets) {
+        free(result);
+        return -1;
+    }
+    for (int i = 0; i < resultCount; i++) {
+        (*offsets)[i] = index->offsets[result[i]];
+    }
+    free(result);
+    return resultCount;
+}
@@ -0,0 +1,395 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <limits.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+// Function to open a file for block-wise line reading
+int openRecordReader(struct RecordReader *reader, const char *filename) {
+    FILE *file = fopen(filename, "r"); // Open the file in read mode
+    if (!file) {
+        reader->file = NULL;
+        return 0; // Caller decides how to report a missing file
+    }
+    return attachRecordReader(reader, file);
+}
+
+// Function to start reading lines from a stream that is already open (a file or an in-memory buffer)
+int attachRecordReader(struct RecordReader *reader, FILE *file) {
+    reader->file = file;
+    reader->start = 0;       // Block is empty until the first read
+    reader->end = 0;
+    reader->blockOffset = 0; // The first block starts at the beginning of the file
+    reader->lineOffset = 0;
+    reader->eof = 0;
+    return 1;
+}
+
+// Function to close the file held by a record reader
+void closeRecordReader(struct RecordReader *reader) {
+    if (reader->file) {
+        fclose(reader->file);
+        reader->file = NULL;
+    }
+}
+
+// Function to move a reader to a line starting at the given file offset.
+// Offsets inside the current block are reached without touching the file, so
+// reading a sorted list of offsets only refills the block when it has to.
+int seekRecordReader(struct RecordReader *reader, long offset) {
+    if (offset >= reader->blockOffset && offset < reader->blockOffset + (long)reader->end) {
+        reader->start = (size_t)(offset - reader->blockOffset);
+        return 1;
+    }
+    if (fseek(reader->file, offset, SEEK_SET) != 0) {
+        return 0;
+    }
+    reader->start = 0;            // Empty the block, the next read refills it from the offset
+    reader->end = 0;
+    reader->blockOffset = offset;
+    reader->eof = 0;
+    return 1;
+}
+
+// Function to return the next line of the file as a view into the block buffer.
+// The view stays valid until the next call, so callers copy only what they keep.
+int readRecordLine(struct RecordReader *reader, struct StringView *line) {
+    while (1) {
+        char *begin = reader->block + reader->start;      // First unread byte
+        size_t available = reader->end - reader->start;   // Unread bytes in the block
+        char *newline = available ? memchr(begin, '\n', available) : NULL; // Vectorised scan in libc
+
+        if (newline || (reader->eof && available > 0) || available == RECORD_BLOCK_SIZE) {
+            // A complete line, the last line without a newline, or a line longer than the block
+            size_t length = newline ? (size_t)(newline - begin) : available;
+
+            reader->lineOffset = reader->blockOffset + (long)reader->start; // Remember where the line starts
+            reader->start += newline ? length + 1 : length;                  // Consume the line and its newline
+
+            if (length > 0 && begin[length - 1] == '\r') {
+                length--; // Ignore Windows line endings
+            }
+
+            line->data = begin;
+            line->length = (int)length;
+            return 1;
+        }
+
+        if (reader->eof) {
+            return 0; // Nothing left to hand out
+        }
+
+        // Move the partial line to the front of the block and read more after it
+        if (reader->start > 0) {
+            memmove(reader->block, begin, available);
+            reader->blockOffset += (long)reader->start;
+            reader->start = 0;
+            reader->end = available;
+        }
+
+        size_t bytesRead = fread(reader->block + reader->end, 1, RECORD_BLOCK_SIZE - reader->end, reader->file);
+        if (bytesRead == 0) {
+            reader->eof = 1; // No more data, the remaining bytes form the last line
+        }
+        reader->end += bytesRead;
+    }
+}
+
+// Function to split a line into field views at every delimiter.
+// Fields are only a few bytes long, so instead of one memchr call per field the
+// line is scanned eight bytes at a time (SWAR) and every delimiter in a word is
+// picked out with count-trailing-zeros.
+int splitRecordFields(struct StringView line, char delimiter, struct StringView fields[], int maxFields) {
+    const char *cursor = line.data;
+    const char *end = line.data + line.length;
+    const char *fieldStart = cursor;
+    int count = 0;
+
+#if defined(__GNUC__) && defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    const uint64_t ones = 0x0101010101010101ULL;
+    const uint64_t lows = 0x7F7F7F7F7F7F7F7FULL;
+    const uint64_t pattern = ones * (unsigned char)delimiter;
+
+    for (; end - cursor >= 8; cursor += 8) {
+        uint64_t word;
+        memcpy(&word, cursor, sizeof(word));  // Unaligned load of the next eight bytes
+        uint64_t x = word ^ pattern;          // Delimiter bytes become zero
+        uint64_t hits = ~(((x & lows) + lows) | x | lows); // High bit set exactly on zero bytes
+
+        while (hits) {
+            const char *delimiterAt = cursor + (__builtin_ctzll(hits) >> 3);
+            if (count == maxFields) {
+                return count + 1; // More fields than requested, report an overflow to the caller
+            }
+            fields[count].data = fieldStart;
+            fields[count].length = (int)(delimiterAt - fieldStart);
+            count++;
+            fieldStart = delimiterAt + 1;
+            hits &= hits - 1; // Clear the lowest delimiter
+        }
+    }
+#endif
+
+    // Remaining tail bytes (or the whole line on other compilers)
+    for (; cursor < end; cursor++) {
+        if (*cursor == delimiter) {
+            if (count == maxFields) {
+                return count + 1;
+            }
+            fields[count].data = fieldStart;
+            fields[count].length = (int)(cursor - fieldStart);
+            count++;
+            fieldStart = cursor + 1;
+        }
+    }
+
+    if (count == maxFields) {
+        return count + 1;
+    }
+    fields[count].data = fieldStart; // Last field runs to the end of the line
+    fields[count].length = (int)(end - fieldStart);
+    return count + 1;
+}
+
+// Function to parse a decimal integer field, ignoring surrounding spaces. Values outside the range
+// of an int are rejected rather than wrapped.
+int parseIntView(struct StringView field, int *value) {
+    const char *cursor = field.data;
+    const char *end = field.data + field.length;
+    int negative = 0;
+    unsigned int result = 0;
+
+    while (cursor < end && *cursor == ' ') cursor++;   // Skip leading spaces
+    while (end > cursor && end[-1] == ' ') end--;      // Skip trailing spaces
+
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+        negative = (*cursor == '-');
+        cursor++;
+    }
+
+    if (cursor == end) {
+        return 0; // Empty field or a lone sign
+    }
+
+    unsigned int limit = negative ? (unsigned int)INT_MAX + 1 : (unsigned int)INT_MAX;
+    for (; cursor < end; cursor++) {
+        unsigned int digit = (unsigned int)(*cursor - '0'); // Non-digits wrap to a large value
+        if (digit > 9) {
+            return 0; // Not a number
+        }
+        if (result > (limit - digit) / 10) {
+            return 0; // Too large for an int
+        }
+        result = result * 10 + digit;
+    }
+
+    *value = negative ? (int)(0U - result) : (int)result;
+    return 1;
+}
+
+// Function to parse a decimal field too large for an int, such as a time() value, ignoring
+// surrounding spaces. Values outside the range of a long long are rejected.
+int parseLongView(struct StringView field, long long *value) {
+    const char *cursor = field.data;
+    const char *end = field.data + field.length;
+    int negative = 0;
+    unsigned long long result = 0;
+
+    while (cursor < end && *cursor == ' ') cursor++;   // Skip leading spaces
+    while (end > cursor && end[-1] == ' ') end--;      // Skip trailing spaces
+
+    if (cursor < end && (*cursor == '-' || *cursor == '+')) {
+        negative = (*cursor == '-');
+        cursor++;
+    }
+
+    if (cursor == end) {
+        return 0; // Empty field or a lone sign
+    }
+
+    unsigned long long limit = negative ? (unsigned long long)LLONG_MAX + 1 : (unsigned long long)LLONG_MAX;
+    for (; cursor < end; cursor++) {
+        unsigned int digit = (unsigned int)(*cursor - '0'); // Non-digits wrap to a large value
+        if (digit > 9) {
+            return 0; // Not a number
+        }
+        if (result > (limit - digit) / 10) {
+            return 0; // Too large for a long long
+        }
+        result = result * 10 + digit;
+    }
+
+    *value = negative ? (long long)(0ULL - result) : (long long)result;
+    return 1;
+}
+
+// Function to parse a fixed-point amount such as "63.60" or "RM 477.00" into sen
+int parseAmountView(struct StringView field, money_t *amount) {
+    const char *cursor = field.data;
+    const char *end = field.data + field.length;
+    long long whole = 0;
+    int fraction = 0, fractionDigits = 0, digits = 0, negative = 0;
+
+    while (cursor < end && *cursor == ' ') cursor++;   // Skip leading spaces
+    if (end - cursor >= 2 && cursor[0] == 'R' && cursor[1] == 'M') {
+        cursor += 2;                                   // Skip the currency prefix used in reports
+        while (cursor < end && *cursor == ' ') cursor++;
+    }
+    while (end > cursor && end[-1] == ' ') end--;      // Skip trailing spaces
+
+    if (cursor < end && *cursor == '-') {
+        negative = 1;
+        cursor++;
+    }
+
+    // Whole ringgit part
+    for (; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++, digits++) {
+        whole = whole * 10 + (*cursor - '0');
+    }
+
+    // Sen part, rounded half up after the second digit
+    if (cursor < end && *cursor == '.') {
+        for (cursor++; cursor < end && *cursor >= '0' && *cursor <= '9'; cursor++, digits++) {
+            if (fractionDigits < 2) {
+                fraction = fraction * 10 + (*cursor - '0');
+            } else if (fractionDigits == 2 && *cursor >= '5') {
+                fraction++; // Round the third decimal
+            }
+            fractionDigits++;
+        }
+    }
+
+    if (digits == 0 || cursor != end) {
+        return 0; // No digits, or trailing garbage
+    }
+
+    if (fractionDigits == 1) {
+        fraction *= 10; // "30.5" means 30.50
+    }
+
+    *amount = whole * 100 + fraction;
+    if (negative) *amount = -*amount;
+    return 1;
+}
+
+// Function to parse a list of seat numbers separated by the given delimiter
+int parseSeatList(struct StringView field, char delimiter, int seats[], int maxSeats) {
+    struct StringView seatFields[MAX_RECORD_FIELDS * 4];
+    int fieldCount = splitRecordFields(field, delimiter, seatFields, MAX_RECORD_FIELDS * 4);
+    int count = 0;
+
+    if (fieldCount > MAX_RECORD_FIELDS * 4) {
+        fieldCount = MAX_RECORD_FIELDS * 4; // Ignore anything beyond the largest possible booking
+    }
+
+    for (int i = 0; i < fieldCount && count < maxSeats; i++) {
+        if (seatFields[i].length == 0) continue; // Tolerate doubled separators
+        if (parseIntView(seatFields[i], &seats[count])) {
+            count++;
+        }
+    }
+
+    return count; // Number of seats stored
+}
+
+// Function to copy a field view into a null-terminated buffer, truncating if needed
+void copyView(struct StringView field, char *destination, size_t size) {
+    size_t length = (size_t)field.length;
+    if (length >= size) {
+        length = size - 1;
+    }
+    memcpy(destination, field.data, length);
+    destination[length] = '\0';
+}
+
+// Function to compare a field view with a C string
+int viewEquals(struct StringView field, const char *text) {
+    size_t length = strlen(text);
+    return (size_t)field.length == length && memcmp(field.data, text, length) == 0;
+}
+
+// Function to check whether a field view contains a substring
+int viewContains(struct StringView field, const char *text) {
+    size_t length = strlen(text);
+    if (length == 0) return 1;
+
+    const char *cursor = field.data;
+    const char *end = field.data + field.length;
+
+    // Jump between candidate first characters with memchr and confirm with memcmp
+    while ((size_t)(end - cursor) >= length) {
+        const char *candidate = memchr(cursor, text[0], (size_t)(end - cursor) - length + 1);
+        if (!candidate) return 0;
+        if (memcmp(candidate, text, length) == 0) return 1;
+        cursor = candidate + 1;
+    }
+    return 0;
+}
+
+// Function to parse a reservation.txt or cancellations.txt line
+int parseReservationRecord(struct StringView line, struct ReservationRecord *record) {
+    struct StringView fields[MAX_RECORD_FIELDS];
+
+    if (splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS) != 8) {
+        return 0; // Wrong number of fields, skip the line
+    }
+
+    record->username = fields[0];
+    record->busNumberPlate = fields[3];
+    record->date = fields[4];
+    record->seatList = fields[6];
+
+    return record->username.length > 0 &&
+           parseIntView(fields[1], &record->ticketNumber) &&
+           parseIntView(fields[2], &record->busID) &&
+           parseIntView(fields[5], &record->numSeats) &&
+           parseAmountView(fields[7], &record->amount);
+}
+
+// Function to parse a buses.txt line
+int parseBusRecord(struct StringView line, struct BusRecord *record) {
+    struct StringView fields[MAX_RECORD_FIELDS];
+
+    if (splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS) != 10) {
+        return 0; // Wrong number of fields, skip the line
+    }
+
+    record->busNumberPlate = fields[1];
+    record->date = fields[2];
+    record->source = fields[3];
+    record->destination = fields[4];
+    record->departureTime = fields[5];
+    record->arrivalTime = fields[6];
+
+    return parseIntView(fields[0], &record->busID) &&
+           parseIntView(fields[7], &record->totalSeats) &&
+           parseIntView(fields[8], &record->availableSeats) &&
+           parseAmountView(fields[9], &record->fare);
+}
+
+// Function to parse a seats.txt line, storing the seat numbers in seats[]
+int parseSeatRecord(struct StringView line, struct SeatRecord *record, int seats[], int maxSeats) {
+    const char *comma = memchr(line.data, ',', (size_t)line.length);
+    if (!comma) return 0;
+
+    struct StringView idField = { line.data, (int)(comma - line.data) };
+    struct StringView rest = { comma + 1, line.length - idField.length - 1 };
+    const char *nextComma = memchr(rest.data, ',', (size_t)rest.length);
+    struct StringView countField = { rest.data, nextComma ? (int)(nextComma - rest.data) : rest.length };
+
+    if (!parseIntView(idField, &record->busID) || !parseIntView(countField, &record->reservedCount)) {
+        return 0;
+    }
+    if (record->reservedCount < 0 || record->reservedCount > maxSeats) {
+        return 0; // Corrupt count
+    }
+
+    // The remaining fields are the seat numbers themselves
+    int stored = 0;
+    if (nextComma) {
+        struct StringView seatField = { nextComma + 1, rest.length - countField.length - 1 };
+        stored = parseSeatList(seatField, ',', seats, record->reservedCount);
+    }
+
+    return stored == record->reservedCount;
+}
@@ -0,0 +1,229 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <ctype.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "bus_reservation.h"
+
+#define REPORT_SEPARATOR "-------------------------------------------------------------------------------------------------------------------\n"
+
+static int reportPageSize = REPORT_PAGE_SIZE; // Rows per page, changed from the pager for the session
+
+// Function to append formatted text to an output buffer, growing it when needed
+int appendOutput(struct OutputBuffer *out, const char *format, ...) {
+    va_list args;
+    while (1) {
+        size_t room = out->capacity - out->length;
+        va_start(args, format);
+        int written = vsnprintf(out->data ? out->data + out->length : NULL, room, format, args);
+        va_end(args);
+        if (written < 0) return 0;
+
+        if ((size_t)written < room) {
+            out->length += (size_t)written;
+            return 1;
+        }
+
+        // Not enough room: grow to fit and format again
+        size_t capacity = out->capacity ? out->capacity * 2 : OUTPUT_BUFFER_SIZE;
+        while (capacity - out->length <= (size_t)written) capacity *= 2;
+        char *data = realloc(out->data, capacity);
+        if (!data) return 0;
+        out->data = data;
+        out->capacity = capacity;
+    }
+}
+
+// Function to write the whole buffer with as few write calls as possible and empty it
+int flushOutput(struct OutputBuffer *out, int fd) {
+    size_t done = 0;
+    while (done < out->length) {
+        ssize_t written = write(fd, out->data + done, out->length - done);
+        if (written <= 0) return 0;
+        done += (size_t)written;
+    }
+    out->length = 0; // Keep the memory for the next page
+    return 1;
+}
+
+// Function to release an output buffer
+void freeOutput(struct OutputBuffer *out) {
+    free(out->data);
+    out->data = NULL;
+    out->length = out->capacity = 0;
+}
+
+// Function to add the title and column headers of a reservation/cancellation report
+void appendRecordHeader(struct OutputBuffer *out, const char *title) {
+    appendOutput(out, "\n%s\n" REPORT_SEPARATOR, title);
+    appendOutput(out, "| %-12s | %-12s | %-6s | %-15s | %-12s | %-8s | %-15s | %-10s |\n" REPORT_SEPARATOR,
+                 "Username", "Ticket No.", "BusID", "Number Plate", "Date", "Seats", "Seat Numbers", "Amount");
+}
+
+// Function to add one reservation/cancellation row
+void appendRecordRow(struct OutputBuffer *out, const struct ReservationRecord *record) {
+    char amountText[MONEY_TEXT_LENGTH]; // Formatted amount
+    appendOutput(out, "| %-12.*s | %-12d | %-6d | %-15.*s | %-12.*s | %-8d | %-15.*s | RM%-8s |\n",
+                 record->username.length, record->username.data, record->ticketNumber, record->busID,
+                 record->busNumberPlate.length, record->busNumberPlate.data, record->date.length, record->date.data,
+                 record->numSeats, record->seatList.length, record->seatList.data, formatMoney(record->amount, amountText));
+}
+
+// Function to render one page of records starting at the cursor (a line's file offset).
+// Returns the number of rows rendered; *nextCursor is the offset of the following page, or -1 after the last page.
+int readRecordPage(struct RecordReader *reader, long cursor, int pageSize, struct OutputBuffer *out, long *nextCursor) {
+    struct StringView line;
+    struct ReservationRecord record;
+    int rows = 0;
+
+    *nextCursor = -1;
+    if (!seekRecordReader(reader, cursor)) return 0;
+
+    while (readRecordLine(reader, &line)) {
+        if (!parseReservationRecord(line, &record)) {
+            continue; // Skip malformed lines
+        }
+        if (rows == pageSize) {
+            *nextCursor = reader->lineOffset; // First row of the next page
+            break;
+        }
+        appendRecordRow(out, &record);
+        rows++;
+    }
+    return rows;
+}
+
+// Function to write every record of a file to another file, one write per full buffer.
+// Returns the number of rows exported, or -1 if a file could not be opened or written.
+int exportRecords(const char *filename, const char *title, const char *exportPath) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, filename)) return -1;
+
+    int fd = open(exportPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        closeRecordReader(&reader);
+        return -1;
+    }
+
+    struct OutputBuffer out = {0};
+    struct StringView line;
+    struct ReservationRecord record;
+    int rows = 0, ok = 1;
+
+    appendRecordHeader(&out, title);
+    while (ok && readRecordLine(&reader, &line)) {
+        if (parseReservationRecord(line, &record)) {
+            appendRecordRow(&out, &record);
+            rows++;
+        }
+        if (out.length >= OUTPUT_BUFFER_SIZE) {
+            ok = flushOutput(&out, fd); // Write in large blocks instead of per row
+        }
+    }
+    appendOutput(&out, REPORT_SEPARATOR);
+    ok = ok && flushOutput(&out, fd);
+
+    ok = (close(fd) == 0) && ok;
+    freeOutput(&out);
+    closeRecordReader(&reader);
+    return ok ? rows : -1;
+}
+
+// Function to show a reservation/cancellation file one page at a time.
+// Only the rows of the current page are read, so the first page appears at once
+// however long the history is; earlier pages are reached through saved cursors.
+void browseRecords(const char *filename, const char *title) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, filename)) {
+        // If file doesn't exist or can't be opened, print an error message and return
+        printf("Error: Could not open %s for reading!\n", filename);
+        return;
+    }
+
+    struct OutputBuffer out = {0};  // Reused for every page
+    long *pageStarts = NULL;        // Cursor of every page seen so far, for going back
+    int pageCapacity = 0;
+    int page = 0;                   // Current page, counted from 0
+    long cursor = 0;                // File offset of the current page's first row
+    char command = 'N';
+
+    while (command != 'Q') {
+        if (page == pageCapacity) {
+            pageCapacity = pageCapacity ? pageCapacity * 2 : 16;
+            long *grown = realloc(pageStarts, (size_t)pageCapacity * sizeof(long));
+            if (!grown) break;
+            pageStarts = grown;
+        }
+        pageStarts[page] = cursor;
+
+        // Render the whole page, then hand it to the terminal in one write
+        long nextCursor;
+        char pageTitle[128];
+        snprintf(pageTitle, sizeof(pageTitle), "%s (page %d, %d rows per page)", title, page + 1, reportPageSize);
+        appendRecordHeader(&out, pageTitle);
+        int rows = readRecordPage(&reader, cursor, reportPageSize, &out, &nextCursor);
+        appendOutput(&out, REPORT_SEPARATOR);
+        if (rows == 0) {
+            appendOutput(&out, "No records.\n");
+        }
+        fflush(stdout); // Anything printf'd before must come out first
+        flushOutput(&out, STDOUT_FILENO);
+
+        // Ask what to do next until the answer moves to another page or quits
+        int moved = 0;
+        while (!moved) {
+            printf("[N]ext page, [P]revious page, [S]et page size, [E]xport all to file, [Q]uit: ");
+            if (scanf(" %c", &command) != 1) {
+                command = 'Q'; // End of input
+            }
+            command = (char)toupper((unsigned char)command);
+
+            if (command == 'N') {
+                if (nextCursor < 0) {
+                    printf("Already on the last page.\n");
+                    continue;
+                }
+                cursor = nextCursor;
+                page++;
+                moved = 1;
+            } else if (command == 'P') {
+                if (page == 0) {
+                    printf("Already on the first page.\n");
+                    continue;
+                }
+                cursor = pageStarts[--page];
+                moved = 1;
+            } else if (command == 'S') {
+                int size;
+                printf("Enter rows per page (1-%d): ", MAX_REPORT_PAGE_SIZE);
+                if (scanf("%d", &size) != 1 || size < 1 || size > MAX_REPORT_PAGE_SIZE) {
+                    printf("Invalid page size!\n");
+                    while (getchar() != '\n'); // Clear input buffer
+                    continue;
+                }
+                reportPageSize = size;
+                moved = 1; // Show the current page again with the new size
+            } else if (command == 'E') {
+                char exportPath[MAX_IMPORT_PATH];
+                printf("Enter file name to export to: ");
+                if (scanf("%255s", exportPath) != 1) continue;
+                int exported = exportRecords(filename, title, exportPath);
+                if (exported < 0) {
+                    printf("Error: Could not export to %s.\n", exportPath);
+                } else {
+                    printf("Exported %d rows to %s.\n", exported, exportPath);
+                }
+            } else if (command == 'Q') {
+                moved = 1;
+            } else {
+                printf("Invalid option! Please try again.\n");
+            }
+        }
+    }
+
+    free(pageStarts);
+    freeOutput(&out);
+    closeRecordReader(&reader);
+}
@@ -0,0 +1,93 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "bus_reservation.h"
+
+#define ARENA_BLOCK_SIZE 65536   // Bytes per block; one block holds the scratch of most commands
+#define ARENA_ALIGNMENT 16       // Every allocation starts on this boundary, enough for any type
+
+// One block of arena memory; blocks are chained and kept for the next request
+struct ArenaBlock {
+    struct ArenaBlock *next;     // Block used after this one fills, or NULL
+    size_t size;                 // Bytes in data
+    size_t used;                 // Bytes handed out in this request
+    _Alignas(ARENA_ALIGNMENT) unsigned char data[];
+};
+
+// Per thread so that a worker thread can use an arena without touching the main thread's.
+// The booking flow itself only runs on the main thread; the state it updates is not locked.
+static __thread struct RequestArena threadArena;
+static pthread_key_t arenaKey;                   // Frees a thread's blocks when the thread ends
+static pthread_once_t arenaKeyOnce = PTHREAD_ONCE_INIT;
+
+// Function to free every block of an arena; run for each thread that used one as it exits
+static void releaseArena(void *data) {
+    struct RequestArena *arena = data;
+    struct ArenaBlock *block = arena->first;
+    while (block) {
+        struct ArenaBlock *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->first = arena->current = NULL;
+}
+
+// Function to create the key whose destructor releases the arenas of finished threads
+static void createArenaKey() {
+    pthread_key_create(&arenaKey, releaseArena);
+}
+
+// Function to get the arena of the calling thread
+struct RequestArena *requestArena() {
+    if (!threadArena.first) { // First use in this thread: release the arena with the thread
+        pthread_once(&arenaKeyOnce, createArenaKey);
+        pthread_setspecific(arenaKey, &threadArena);
+    }
+    return &threadArena;
+}
+
+// Function to hand out memory for count elements of size bytes that lives until the arena is reset.
+// The memory is not cleared. Blocks are only allocated while the arena grows past the largest
+// request seen so far; returns NULL when out of memory.
+void *arenaAlloc(struct RequestArena *arena, size_t count, size_t size) {
+    if (size != 0 && count > (SIZE_MAX - ARENA_ALIGNMENT) / size) return NULL;
+    size_t bytes = (count * size + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+
+    // Try the current block, then the blocks left over from earlier requests
+    struct ArenaBlock *block = arena->current;
+    while (block) {
+        if (block->size - block->used >= bytes) {
+            void *memory = block->data + block->used;
+            block->used += bytes;
+            arena->current = block;
+            return memory;
+        }
+        if (!block->next) break;
+        block = block->next;
+        block->used = 0; // Anything in it was from an earlier request
+    }
+
+    size_t blockSize = bytes > ARENA_BLOCK_SIZE ? bytes : ARENA_BLOCK_SIZE;
+    struct ArenaBlock *grown = malloc(sizeof(struct ArenaBlock) + blockSize);
+    if (!grown) return NULL;
+    grown->next = NULL;
+    grown->size = blockSize;
+    grown->used = bytes;
+    if (block) {
+        block->next = grown;
+    } else {
+        arena->first = grown;
+    }
+    arena->current = grown;
+    return grown->data;
+}
+
+// Function to free everything handed out since the last reset. Only the first block is touched;
+// later blocks are emptied as the next request reaches them, so this takes the same time however
+// much was allocated.
+void resetArena(struct RequestArena *arena) {
+    arena->current = arena->first;
+    if (arena->first) arena->first->used = 0;
+}
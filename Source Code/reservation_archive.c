@@ -0,0 +1,1106 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include "bus_reservation.h"
+
+#define ARCHIVE_MAGIC "BRARCH1"       // First bytes of every partition file
+#define BUS_HISTORY_FILE "bus_history.txt" // Purged trips, where the travel dates of old bookings are found
+
+// Columns of a block, stored one after another so each is read in one pass
+#define COLUMN_USERNAME 0             // Dictionary code
+#define COLUMN_TICKET 1               // Change from the previous row's ticket number
+#define COLUMN_BUS_ID 2               // Change from the previous row's bus ID
+#define COLUMN_PLATE 3                // Dictionary code
+#define COLUMN_DAY 4                  // Change from the previous row's booking day
+#define COLUMN_SEAT_COUNT 5           // Seats booked
+#define COLUMN_SEATS 6                // Number of listed seats, then the seat numbers
+#define COLUMN_AMOUNT 7               // Amount in sen
+#define ARCHIVE_COLUMNS 8
+
+// Fixed part at the start of a partition file, followed by the username and plate
+// dictionaries, the block table and the blocks
+struct ArchiveFileHeader {
+    char magic[8];                    // ARCHIVE_MAGIC
+    unsigned int rowCount;            // Rows in the partition
+    unsigned int blockCount;          // Entries in the block table
+    unsigned int usernameCount;       // Names in the username dictionary
+    unsigned int plateCount;          // Names in the plate dictionary
+    unsigned int dictionaryBytes;     // Both dictionaries; each name is a length byte and its text
+};
+
+// One entry of the block table
+struct ArchiveBlockEntry {
+    struct ArchiveZone zone;                    // Rows and value ranges of the block
+    unsigned long long offset;                  // Byte offset of the block from the start of the file
+    unsigned int size;                          // Encoded bytes
+    unsigned int columnStart[ARCHIVE_COLUMNS];  // Where each column starts within the block
+};
+
+// One decoded row
+struct ArchiveRow {
+    int username;                     // Username dictionary code
+    int plate;                        // Plate dictionary code
+    int ticketNumber;
+    int busID;
+    int day;                          // Booking date, days since 1970-01-01
+    int numSeats;
+    int seatCount;                    // Seat numbers listed
+    int firstSeat;                    // Position of the first one in the seat pool
+    money_t amount;
+};
+
+// Growing byte array that blocks are encoded into
+struct ByteBuffer {
+    unsigned char *data;
+    size_t length;
+    size_t capacity;
+};
+
+// Names of one dictionary in code order, with a hash table over them
+struct ArchiveDictionary {
+    char **names;
+    int count, capacity;
+    int *slots;                       // Code + 1 of the name in each slot, 0 when empty
+    int slotCount;                    // Power of two
+};
+
+// A partition being written: its rows, seats and dictionaries
+struct PartitionBuild {
+    int journal;                      // Index into the journals being archived
+    char month[8];                    // Travel month, YYYY-MM
+    struct ArchiveDictionary usernames, plates;
+    struct ArchiveRow *rows;
+    int rowCount, rowCapacity;
+    int *seats;
+    int seatCount, seatCapacity;
+    struct DurableFile out;
+};
+
+// An open partition file and the block decoded from it
+struct ArchivePartitionReader {
+    FILE *file;
+    struct ArchiveFileHeader header;
+    char *dictionary;                 // Both dictionaries as read from the file
+    struct StringView *names;         // Usernames, then plates
+    struct ArchiveBlockEntry *blocks;
+    int nextBlock;                    // Next entry of the block table
+    int usernameCode, plateCode;      // Codes the predicate asks for, or -1 for any
+    unsigned char *encoded;           // Block as read from the file
+    size_t encodedCapacity;
+    struct ArchiveRow rows[ARCHIVE_BLOCK_ROWS];
+    int seats[ARCHIVE_BLOCK_ROWS * MAX_SEATS];
+    int rowCount, nextRow;
+};
+
+// Travel date of a purged trip
+struct TravelDay {
+    int busID;
+    int day;
+};
+
+// Function to grow an array to hold at least one more element; returns 0 when out of memory
+static int reserveOne(void **items, int *capacity, int count, size_t size) {
+    if (count < *capacity) return 1;
+    int grown = *capacity ? *capacity * 2 : 64;
+    void *moved = realloc(*items, (size_t)grown * size);
+    if (!moved) return 0;
+    *items = moved;
+    *capacity = grown;
+    return 1;
+}
+
+// Function to map a signed value to an unsigned one so small changes either way stay small
+static unsigned long long zigzag(long long value) {
+    return ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63);
+}
+
+// Function to undo zigzag()
+static long long unzigzag(unsigned long long value) {
+    return (long long)(value >> 1) ^ -(long long)(value & 1);
+}
+
+// Function to append a value seven bits at a time, low bits first
+static int putVarint(struct ByteBuffer *buffer, unsigned long long value) {
+    if (buffer->capacity - buffer->length < 10) {
+        size_t grown = buffer->capacity ? buffer->capacity * 2 : 65536;
+        unsigned char *moved = realloc(buffer->data, grown);
+        if (!moved) return 0;
+        buffer->data = moved;
+        buffer->capacity = grown;
+    }
+    while (value >= 0x80) {
+        buffer->data[buffer->length++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    buffer->data[buffer->length++] = (unsigned char)value;
+    return 1;
+}
+
+// Function to read a value written by putVarint(); returns 0 at the end of the column
+static int getVarint(const unsigned char **cursor, const unsigned char *end, unsigned long long *value) {
+    unsigned long long result = 0;
+    for (int shift = 0; *cursor < end && shift < 64; shift += 7) {
+        unsigned char byte = *(*cursor)++;
+        result |= (unsigned long long)(byte & 0x7F) << shift;
+        if (!(byte & 0x80)) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Function to hash a name with 64-bit FNV-1a
+static unsigned long long hashName(const char *data, int length) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int i = 0; i < length; i++) {
+        hash ^= (unsigned char)data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Function to find the code of a name, adding it to the dictionary if it is new; -1 when out of memory
+static int internName(struct ArchiveDictionary *dictionary, struct StringView name) {
+    if (name.length > ARCHIVE_NAME_LENGTH) name.length = ARCHIVE_NAME_LENGTH;
+
+    // Keep the table at most half full
+    if (2 * (dictionary->count + 1) > dictionary->slotCount) {
+        int slotCount = dictionary->slotCount ? dictionary->slotCount * 2 : 256;
+        int *slots = calloc((size_t)slotCount, sizeof(int));
+        if (!slots) return -1;
+        for (int code = 0; code < dictionary->count; code++) {
+            const char *text = dictionary->names[code];
+            size_t slot = hashName(text, (int)strlen(text)) & (size_t)(slotCount - 1);
+            while (slots[slot]) slot = (slot + 1) & (size_t)(slotCount - 1);
+            slots[slot] = code + 1;
+        }
+        free(dictionary->slots);
+        dictionary->slots = slots;
+        dictionary->slotCount = slotCount;
+    }
+
+    size_t slot = hashName(name.data, name.length) & (size_t)(dictionary->slotCount - 1);
+    while (dictionary->slots[slot]) {
+        int code = dictionary->slots[slot] - 1;
+        if (viewEquals(name, dictionary->names[code])) return code;
+        slot = (slot + 1) & (size_t)(dictionary->slotCount - 1);
+    }
+
+    if (!reserveOne((void **)&dictionary->names, &dictionary->capacity, dictionary->count, sizeof(char *))) return -1;
+    char *text = malloc((size_t)name.length + 1);
+    if (!text) return -1;
+    memcpy(text, name.data, (size_t)name.length);
+    text[name.length] = '\0';
+    dictionary->names[dictionary->count] = text;
+    dictionary->slots[slot] = dictionary->count + 1;
+    return dictionary->count++;
+}
+
+// Function to release a dictionary
+static void freeDictionary(struct ArchiveDictionary *dictionary) {
+    for (int i = 0; i < dictionary->count; i++) {
+        free(dictionary->names[i]);
+    }
+    free(dictionary->names);
+    free(dictionary->slots);
+}
+
+// Function to name the file of a partition: reservation.txt and 2025-04 give reservation_2025-04.arc
+static void partitionPath(const char *journal, const char *month, char *path, size_t size) {
+    const char *dot = strrchr(journal, '.');
+    int stem = dot ? (int)(dot - journal) : (int)strlen(journal);
+    snprintf(path, size, "%.*s_%s.arc", stem, journal, month);
+}
+
+// Function to tell whether a zone can hold a row the predicate matches
+static int zoneMayMatch(const struct ArchiveZone *zone, const struct ArchivePredicate *predicate) {
+    return zone->rows > 0 &&
+           zone->maxBusID >= predicate->minBusID && zone->minBusID <= predicate->maxBusID &&
+           zone->maxDay >= predicate->minDay && zone->minDay <= predicate->maxDay;
+}
+
+// Function to widen a zone to take in one row
+static void extendZone(struct ArchiveZone *zone, int busID, int day) {
+    if (zone->rows == 0 || busID < zone->minBusID) zone->minBusID = busID;
+    if (zone->rows == 0 || busID > zone->maxBusID) zone->maxBusID = busID;
+    if (zone->rows == 0 || day < zone->minDay) zone->minDay = day;
+    if (zone->rows == 0 || day > zone->maxDay) zone->maxDay = day;
+    zone->rows++;
+}
+
+// Function to order partitions by travel month, then journal
+static int comparePartitions(const void *a, const void *b) {
+    const struct ArchivePartition *left = a, *right = b;
+    int order = strcmp(left->month, right->month);
+    return order ? order : strcmp(left->journal, right->journal);
+}
+
+// Function to read the manifest. Format, one partition per line:
+// journal,YYYY-MM,rows,minBusID,maxBusID,minDate,maxDate
+// The caller frees *partitions; without a manifest nothing has been archived.
+int loadArchiveManifest(struct ArchivePartition **partitions) {
+    *partitions = NULL;
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, ARCHIVE_MANIFEST_FILE)) return 0;
+
+    int count = 0, capacity = 0;
+    struct StringView line;
+    struct StringView fields[8];
+    while (readRecordLine(&reader, &line)) {
+        struct ArchivePartition partition;
+        memset(&partition, 0, sizeof(partition));
+        if (splitRecordFields(line, ',', fields, 8) != 7 ||
+            fields[1].length != 7 ||
+            !parseIntView(fields[2], &partition.zone.rows) ||
+            !parseIntView(fields[3], &partition.zone.minBusID) ||
+            !parseIntView(fields[4], &partition.zone.maxBusID) ||
+            !parseDateView(fields[5], &partition.zone.minDay) ||
+            !parseDateView(fields[6], &partition.zone.maxDay) ||
+            !reserveOne((void **)partitions, &capacity, count, sizeof(struct ArchivePartition))) {
+            continue; // Skip malformed lines
+        }
+        copyView(fields[0], partition.journal, sizeof(partition.journal));
+        copyView(fields[1], partition.month, sizeof(partition.month));
+        (*partitions)[count++] = partition;
+    }
+    closeRecordReader(&reader);
+    return count;
+}
+
+// Function to write the manifest in partition order
+static int writeArchiveManifest(FILE *file, struct ArchivePartition partitions[], int count) {
+    qsort(partitions, (size_t)count, sizeof(struct ArchivePartition), comparePartitions);
+    for (int i = 0; i < count; i++) {
+        char minDate[11], maxDate[11];
+        formatDate(partitions[i].zone.minDay, minDate);
+        formatDate(partitions[i].zone.maxDay, maxDate);
+        fprintf(file, "%s,%s,%d,%d,%d,%s,%s\n", partitions[i].journal, partitions[i].month, partitions[i].zone.rows,
+                partitions[i].zone.minBusID, partitions[i].zone.maxBusID, minDate, maxDate);
+    }
+    return !ferror(file);
+}
+
+// Function to release a partition reader
+static void closePartitionReader(struct ArchivePartitionReader *reader) {
+    if (!reader) return;
+    if (reader->file) fclose(reader->file);
+    free(reader->dictionary);
+    free(reader->names);
+    free(reader->blocks);
+    free(reader->encoded);
+    free(reader);
+}
+
+// Function to open a partition file and read its dictionaries and block table; NULL if it is unreadable
+static struct ArchivePartitionReader *openPartitionReader(const char *path) {
+    struct ArchivePartitionReader *reader = calloc(1, sizeof(*reader));
+    if (!reader) return NULL;
+    reader->usernameCode = reader->plateCode = -1;
+
+    reader->file = fopen(path, "rb");
+    struct ArchiveFileHeader *header = &reader->header;
+    if (!reader->file || fread(header, sizeof(*header), 1, reader->file) != 1 ||
+        memcmp(header->magic, ARCHIVE_MAGIC, sizeof(header->magic)) != 0) {
+        closePartitionReader(reader);
+        return NULL;
+    }
+
+    int nameCount = (int)(header->usernameCount + header->plateCount);
+    reader->dictionary = malloc(header->dictionaryBytes + 1);
+    reader->names = malloc((size_t)(nameCount + 1) * sizeof(struct StringView));
+    reader->blocks = malloc((size_t)(header->blockCount + 1) * sizeof(struct ArchiveBlockEntry));
+    if (!reader->dictionary || !reader->names || !reader->blocks ||
+        fread(reader->dictionary, 1, header->dictionaryBytes, reader->file) != header->dictionaryBytes ||
+        fread(reader->blocks, sizeof(struct ArchiveBlockEntry), header->blockCount, reader->file) != header->blockCount) {
+        closePartitionReader(reader);
+        return NULL;
+    }
+
+    // Each name is a length byte followed by its text
+    const char *cursor = reader->dictionary;
+    const char *end = reader->dictionary + header->dictionaryBytes;
+    for (int i = 0; i < nameCount; i++) {
+        int length = cursor < end ? (unsigned char)*cursor : 0;
+        if (cursor >= end || end - cursor - 1 < length) {
+            closePartitionReader(reader);
+            return NULL;
+        }
+        reader->names[i].data = cursor + 1;
+        reader->names[i].length = length;
+        cursor += 1 + length;
+    }
+    return reader;
+}
+
+// Function to find the dictionary code of a name, or -1 if the partition does not hold it
+static int findNameCode(const struct StringView names[], int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        if (viewEquals(names[i], name)) return i;
+    }
+    return -1;
+}
+
+// Function to read one block and decode it a column at a time; returns 0 if the block is damaged
+static int decodeBlock(struct ArchivePartitionReader *reader, const struct ArchiveBlockEntry *entry) {
+    int count = entry->zone.rows;
+    reader->rowCount = reader->nextRow = 0;
+    if (count <= 0 || count > ARCHIVE_BLOCK_ROWS) return 0;
+
+    if (entry->size > reader->encodedCapacity) {
+        unsigned char *grown = realloc(reader->encoded, entry->size);
+        if (!grown) return 0;
+        reader->encoded = grown;
+        reader->encodedCapacity = entry->size;
+    }
+    if (fseek(reader->file, (long)entry->offset, SEEK_SET) != 0 ||
+        fread(reader->encoded, 1, entry->size, reader->file) != entry->size) {
+        return 0;
+    }
+
+    const unsigned char *columns[ARCHIVE_COLUMNS + 1];
+    for (int c = 0; c < ARCHIVE_COLUMNS; c++) {
+        if (entry->columnStart[c] > entry->size) return 0;
+        columns[c] = reader->encoded + entry->columnStart[c];
+    }
+    columns[ARCHIVE_COLUMNS] = reader->encoded + entry->size;
+
+    struct ArchiveRow *rows = reader->rows;
+    unsigned long long value;
+    long long ticket = 0, busID = 0, day = 0;
+    int seatTotal = 0;
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_USERNAME], columns[COLUMN_USERNAME + 1], &value) ||
+            value >= reader->header.usernameCount) return 0;
+        rows[i].username = (int)value;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_TICKET], columns[COLUMN_TICKET + 1], &value)) return 0;
+        ticket += unzigzag(value);
+        rows[i].ticketNumber = (int)ticket;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_BUS_ID], columns[COLUMN_BUS_ID + 1], &value)) return 0;
+        busID += unzigzag(value);
+        rows[i].busID = (int)busID;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_PLATE], columns[COLUMN_PLATE + 1], &value) ||
+            value >= reader->header.plateCount) return 0;
+        rows[i].plate = (int)value;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_DAY], columns[COLUMN_DAY + 1], &value)) return 0;
+        day += unzigzag(value);
+        rows[i].day = (int)day;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_SEAT_COUNT], columns[COLUMN_SEAT_COUNT + 1], &value)) return 0;
+        rows[i].numSeats = (int)value;
+    }
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_SEATS], columns[COLUMN_SEATS + 1], &value) || value > MAX_SEATS) return 0;
+        rows[i].seatCount = (int)value;
+        rows[i].firstSeat = seatTotal;
+        for (int s = 0; s < rows[i].seatCount; s++) {
+            if (!getVarint(&columns[COLUMN_SEATS], columns[COLUMN_SEATS + 1], &value)) return 0;
+            reader->seats[seatTotal++] = (int)value;
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        if (!getVarint(&columns[COLUMN_AMOUNT], columns[COLUMN_AMOUNT + 1], &value)) return 0;
+        rows[i].amount = (money_t)unzigzag(value);
+    }
+
+    reader->rowCount = count;
+    return 1;
+}
+
+// Function to work out the ranges a set of filter criteria allows. A date criterion is a substring
+// match, so only a whole year, month or day (2025, 2025-04, 2025-04-29) narrows the dates.
+void archivePredicateFromCriteria(struct ArchivePredicate *predicate, const struct IndexCriterion criteria[], int count) {
+    memset(predicate, 0, sizeof(*predicate));
+    predicate->minBusID = predicate->minDay = INT_MIN;
+    predicate->maxBusID = predicate->maxDay = INT_MAX;
+
+    for (int i = 0; i < count; i++) {
+        const char *value = criteria[i].value;
+        if (criteria[i].type == INDEX_USERNAME) {
+            snprintf(predicate->username, sizeof(predicate->username), "%s", value);
+        } else if (criteria[i].type == INDEX_PLATE) {
+            snprintf(predicate->plate, sizeof(predicate->plate), "%s", value);
+        } else if (criteria[i].type == INDEX_BUS_ID) {
+            int busID = atoi(value);
+            if (busID > predicate->minBusID) predicate->minBusID = busID;
+            if (busID < predicate->maxBusID) predicate->maxBusID = busID;
+        } else if (criteria[i].type == INDEX_DATE) {
+            // First day of the period and first day after it; parseDateView() rejects anything else
+            char first[32], after[32];
+            int year, month, length = (int)strlen(value);
+            if (length == 4 && sscanf(value, "%4d", &year) == 1) {
+                snprintf(first, sizeof(first), "%.4s-01-01", value);
+                snprintf(after, sizeof(after), "%04d-01-01", year + 1);
+            } else if (length == 7 && sscanf(value, "%4d-%2d", &year, &month) == 2) {
+                snprintf(first, sizeof(first), "%.7s-01", value);
+                snprintf(after, sizeof(after), "%04d-%02d-01", month == 12 ? year + 1 : year, month % 12 + 1);
+            } else if (length == 10) {
+                snprintf(first, sizeof(first), "%.10s", value);
+                snprintf(after, sizeof(after), "%.10s", value);
+            } else {
+                continue; // Part of a date; any row may hold it
+            }
+
+            int firstDay, afterDay;
+            struct StringView firstView = { first, (int)strlen(first) }, afterView = { after, (int)strlen(after) };
+            if (!parseDateView(firstView, &firstDay) || !parseDateView(afterView, &afterDay)) continue;
+            if (length == 10) afterDay++;
+            if (firstDay > predicate->minDay) predicate->minDay = firstDay;
+            if (afterDay - 1 < predicate->maxDay) predicate->maxDay = afterDay - 1;
+        }
+    }
+}
+
+// Function to start a scan over the archived rows of one journal. Only the partitions and
+// blocks whose zone maps overlap the predicate are read.
+int openArchiveScan(struct ArchiveScan *scan, const char *journal, const struct ArchivePredicate *predicate) {
+    memset(scan, 0, sizeof(*scan));
+    if (predicate) {
+        scan->predicate = *predicate;
+    } else {
+        archivePredicateFromCriteria(&scan->predicate, NULL, 0); // Everything
+    }
+
+    // Keep the journal's partitions, already in travel month order
+    int count = loadArchiveManifest(&scan->partitions);
+    for (int i = 0; i < count; i++) {
+        if (strcmp(scan->partitions[i].journal, journal) == 0) {
+            scan->partitions[scan->partitionCount++] = scan->partitions[i];
+        }
+    }
+    return scan->partitionCount > 0;
+}
+
+// Function to get the next archived row that may match the predicate. The views in the record
+// stay valid until the next call; the caller still checks the record against its criteria.
+int nextArchiveRecord(struct ArchiveScan *scan, struct ReservationRecord *record) {
+    for (;;) {
+        struct ArchivePartitionReader *reader = scan->reader;
+
+        if (reader && reader->nextRow < reader->rowCount) {
+            const struct ArchiveRow *row = &reader->rows[reader->nextRow++];
+            if ((reader->usernameCode >= 0 && row->username != reader->usernameCode) ||
+                (reader->plateCode >= 0 && row->plate != reader->plateCode)) {
+                continue;
+            }
+
+            record->username = reader->names[row->username];
+            record->busNumberPlate = reader->names[reader->header.usernameCount + row->plate];
+            record->ticketNumber = row->ticketNumber;
+            record->busID = row->busID;
+            record->numSeats = row->numSeats;
+            record->amount = row->amount;
+
+            formatDate(row->day, scan->dateText);
+            record->date.data = scan->dateText;
+            record->date.length = (int)strlen(scan->dateText);
+
+            int length = 0;
+            for (int s = 0; s < row->seatCount; s++) {
+                length += snprintf(scan->seatText + length, sizeof(scan->seatText) - (size_t)length,
+                                   s ? " %d" : "%d", reader->seats[row->firstSeat + s]);
+                if (length >= (int)sizeof(scan->seatText)) length = (int)sizeof(scan->seatText) - 1;
+            }
+            scan->seatText[length] = '\0';
+            record->seatList.data = scan->seatText;
+            record->seatList.length = length;
+            return 1;
+        }
+
+        if (reader && reader->nextBlock < (int)reader->header.blockCount) {
+            const struct ArchiveBlockEntry *entry = &reader->blocks[reader->nextBlock++];
+            if (!zoneMayMatch(&entry->zone, &scan->predicate)) {
+                scan->blocksSkipped++;
+            } else if (decodeBlock(reader, entry)) {
+                scan->blocksRead++;
+            } else {
+                printf("Warning: An archived block of %s could not be read.\n", scan->partitions[scan->nextPartition - 1].month);
+            }
+            continue;
+        }
+
+        // The partition is done; move to the next one that may hold a match
+        closePartitionReader(reader);
+        scan->reader = NULL;
+        if (scan->nextPartition >= scan->partitionCount) return 0;
+
+        const struct ArchivePartition *partition = &scan->partitions[scan->nextPartition++];
+        if (!zoneMayMatch(&partition->zone, &scan->predicate)) {
+            scan->partitionsSkipped++;
+            continue;
+        }
+
+        char path[MAX_IMPORT_PATH];
+        partitionPath(partition->journal, partition->month, path, sizeof(path));
+        reader = openPartitionReader(path);
+        if (!reader) {
+            printf("Warning: Could not read archive partition %s.\n", path);
+            continue;
+        }
+
+        // A name missing from a dictionary means no row of the partition can match
+        int usernames = (int)reader->header.usernameCount;
+        if (scan->predicate.username[0]) {
+            reader->usernameCode = findNameCode(reader->names, usernames, scan->predicate.username);
+        }
+        if (scan->predicate.plate[0]) {
+            reader->plateCode = findNameCode(reader->names + usernames, (int)reader->header.plateCount, scan->predicate.plate);
+        }
+        if ((scan->predicate.username[0] && reader->usernameCode < 0) ||
+            (scan->predicate.plate[0] && reader->plateCode < 0)) {
+            closePartitionReader(reader);
+            scan->partitionsSkipped++;
+            continue;
+        }
+        scan->reader = reader;
+        scan->partitionsRead++;
+    }
+}
+
+// Function to release a scan
+void closeArchiveScan(struct ArchiveScan *scan) {
+    closePartitionReader(scan->reader);
+    free(scan->partitions);
+    memset(scan, 0, sizeof(*scan));
+}
+
+// Function to add one row to a partition being built; its names go through the dictionaries
+static int addBuildRow(struct PartitionBuild *build, struct StringView username, struct StringView plate,
+                       int ticketNumber, int busID, int day, int numSeats, const int seats[], int seatCount, money_t amount) {
+    if (!reserveOne((void **)&build->rows, &build->rowCapacity, build->rowCount, sizeof(struct ArchiveRow))) return 0;
+    while (build->seatCapacity - build->seatCount < seatCount) {
+        if (!reserveOne((void **)&build->seats, &build->seatCapacity, build->seatCapacity, sizeof(int))) return 0;
+    }
+
+    struct ArchiveRow *row = &build->rows[build->rowCount];
+    row->username = internName(&build->usernames, username);
+    row->plate = internName(&build->plates, plate);
+    if (row->username < 0 || row->plate < 0) return 0;
+    row->ticketNumber = ticketNumber;
+    row->busID = busID;
+    row->day = day;
+    row->numSeats = numSeats;
+    row->seatCount = seatCount;
+    row->firstSeat = build->seatCount;
+    row->amount = amount;
+    memcpy(build->seats + build->seatCount, seats, (size_t)seatCount * sizeof(int));
+    build->seatCount += seatCount;
+    build->rowCount++;
+    return 1;
+}
+
+// Function to read back an existing partition so the rows archived now are added after its rows
+static int loadBuildRows(struct PartitionBuild *build, const char *path) {
+    struct ArchivePartitionReader *reader = openPartitionReader(path);
+    if (!reader) return 0;
+
+    int ok = 1;
+    for (int b = 0; ok && b < (int)reader->header.blockCount; b++) {
+        ok = decodeBlock(reader, &reader->blocks[b]);
+        for (int i = 0; ok && i < reader->rowCount; i++) {
+            const struct ArchiveRow *row = &reader->rows[i];
+            ok = addBuildRow(build, reader->names[row->username], reader->names[reader->header.usernameCount + row->plate],
+                             row->ticketNumber, row->busID, row->day, row->numSeats,
+                             reader->seats + row->firstSeat, row->seatCount, row->amount);
+        }
+    }
+    closePartitionReader(reader);
+    return ok;
+}
+
+// Function to encode rows [first, first + count) as one block appended to the payload
+static int encodeBlock(const struct PartitionBuild *build, int first, int count,
+                       struct ByteBuffer *payload, struct ArchiveBlockEntry *entry) {
+    const struct ArchiveRow *rows = build->rows + first;
+    size_t blockStart = payload->length;
+    int ok = 1;
+
+    memset(entry, 0, sizeof(*entry));
+    for (int i = 0; i < count; i++) {
+        extendZone(&entry->zone, rows[i].busID, rows[i].day);
+    }
+
+    entry->columnStart[COLUMN_USERNAME] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) ok = ok && putVarint(payload, (unsigned long long)rows[i].username);
+
+    entry->columnStart[COLUMN_TICKET] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) {
+        long long previous = i ? rows[i - 1].ticketNumber : 0;
+        ok = ok && putVarint(payload, zigzag(rows[i].ticketNumber - previous));
+    }
+
+    entry->columnStart[COLUMN_BUS_ID] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) {
+        long long previous = i ? rows[i - 1].busID : 0;
+        ok = ok && putVarint(payload, zigzag(rows[i].busID - previous));
+    }
+
+    entry->columnStart[COLUMN_PLATE] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) ok = ok && putVarint(payload, (unsigned long long)rows[i].plate);
+
+    entry->columnStart[COLUMN_DAY] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) {
+        long long previous = i ? rows[i - 1].day : 0;
+        ok = ok && putVarint(payload, zigzag(rows[i].day - previous));
+    }
+
+    entry->columnStart[COLUMN_SEAT_COUNT] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) ok = ok && putVarint(payload, (unsigned long long)rows[i].numSeats);
+
+    entry->columnStart[COLUMN_SEATS] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) {
+        ok = ok && putVarint(payload, (unsigned long long)rows[i].seatCount);
+        for (int s = 0; s < rows[i].seatCount; s++) {
+            ok = ok && putVarint(payload, (unsigned long long)build->seats[rows[i].firstSeat + s]);
+        }
+    }
+
+    entry->columnStart[COLUMN_AMOUNT] = (unsigned int)(payload->length - blockStart);
+    for (int i = 0; i < count; i++) ok = ok && putVarint(payload, zigzag(rows[i].amount));
+
+    entry->offset = blockStart;
+    entry->size = (unsigned int)(payload->length - blockStart);
+    return ok;
+}
+
+// Function to write a partition: header, dictionaries, block table, then the encoded blocks
+static int writePartition(FILE *file, const struct PartitionBuild *build, struct ArchiveZone *zone) {
+    int blockCount = (build->rowCount + ARCHIVE_BLOCK_ROWS - 1) / ARCHIVE_BLOCK_ROWS;
+    struct ArchiveBlockEntry *blocks = calloc((size_t)blockCount + 1, sizeof(struct ArchiveBlockEntry));
+    struct ByteBuffer payload = { NULL, 0, 0 };
+    int ok = blocks != NULL;
+
+    memset(zone, 0, sizeof(*zone));
+    for (int b = 0; ok && b < blockCount; b++) {
+        int first = b * ARCHIVE_BLOCK_ROWS;
+        int count = build->rowCount - first < ARCHIVE_BLOCK_ROWS ? build->rowCount - first : ARCHIVE_BLOCK_ROWS;
+        ok = encodeBlock(build, first, count, &payload, &blocks[b]);
+        for (int i = first; i < first + count; i++) {
+            extendZone(zone, build->rows[i].busID, build->rows[i].day);
+        }
+    }
+
+    struct ArchiveFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARCHIVE_MAGIC, sizeof(header.magic));
+    header.rowCount = (unsigned int)build->rowCount;
+    header.blockCount = (unsigned int)blockCount;
+    header.usernameCount = (unsigned int)build->usernames.count;
+    header.plateCount = (unsigned int)build->plates.count;
+    for (int i = 0; i < build->usernames.count; i++) header.dictionaryBytes += 1 + (unsigned int)strlen(build->usernames.names[i]);
+    for (int i = 0; i < build->plates.count; i++) header.dictionaryBytes += 1 + (unsigned int)strlen(build->plates.names[i]);
+
+    // Block offsets are counted from the start of the file
+    unsigned long long dataStart = sizeof(header) + header.dictionaryBytes + (unsigned long long)blockCount * sizeof(struct ArchiveBlockEntry);
+    for (int b = 0; ok && b < blockCount; b++) {
+        blocks[b].offset += dataStart;
+    }
+
+    ok = ok && fwrite(&header, sizeof(header), 1, file) == 1;
+    const struct ArchiveDictionary *dictionaries[2] = { &build->usernames, &build->plates };
+    for (int d = 0; ok && d < 2; d++) {
+        for (int i = 0; i < dictionaries[d]->count; i++) {
+            unsigned char length = (unsigned char)strlen(dictionaries[d]->names[i]);
+            fputc(length, file);
+            fwrite(dictionaries[d]->names[i], 1, length, file);
+        }
+    }
+    ok = ok && fwrite(blocks, sizeof(struct ArchiveBlockEntry), (size_t)blockCount, file) == (size_t)blockCount;
+    ok = ok && fwrite(payload.data, 1, payload.length, file) == payload.length && !ferror(file);
+
+    free(blocks);
+    free(payload.data);
+    return ok;
+}
+
+// Function to order travel days by bus ID, then date
+static int compareTravelDays(const void *a, const void *b) {
+    const struct TravelDay *left = a, *right = b;
+    if (left->busID != right->busID) return (left->busID > right->busID) - (left->busID < right->busID);
+    return (left->day > right->day) - (left->day < right->day);
+}
+
+// Function to order ints such as bus IDs and ticket numbers
+static int compareInts(const void *a, const void *b) {
+    int left = *(const int *)a, right = *(const int *)b;
+    return (left > right) - (left < right);
+}
+
+// Function to read the travel dates of purged trips as (bus ID, travel date) pairs, sorted. A bus ID
+// reused for later trips has one pair per trip, so each row can be matched to the trip it was for.
+static int loadTravelDays(struct TravelDay **days) {
+    *days = NULL;
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, BUS_HISTORY_FILE)) return 0;
+
+    int count = 0, capacity = 0;
+    struct StringView line;
+    struct StringView fields[MAX_RECORD_FIELDS];
+    while (readRecordLine(&reader, &line)) {
+        struct TravelDay travel;
+        if (splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS) < 3 || !parseIntView(fields[0], &travel.busID) ||
+            !parseDateView(fields[2], &travel.day) || !reserveOne((void **)days, &capacity, count, sizeof(struct TravelDay))) {
+            continue; // Skip malformed lines
+        }
+        (*days)[count++] = travel;
+    }
+    closeRecordReader(&reader);
+
+    // Sort, dropping pairs written twice
+    qsort(*days, (size_t)count, sizeof(struct TravelDay), compareTravelDays);
+    int kept = 0;
+    for (int i = 0; i < count; i++) {
+        if (kept > 0 && compareTravelDays(&(*days)[kept - 1], &(*days)[i]) == 0) continue;
+        (*days)[kept++] = (*days)[i];
+    }
+    return kept;
+}
+
+// Function to find the travel date of the purged trip a row belongs to: the first trip of its bus ID
+// leaving on or after the row's booking date, since a booking is made before its trip leaves.
+// Returns 0 if no purged trip of that bus ID fits.
+static int findTravelDay(const struct TravelDay days[], int count, int busID, int bookingDay, int *day) {
+    struct TravelDay key = { busID, bookingDay };
+    int low = 0, high = count;
+    while (low < high) { // First pair at or after (busID, bookingDay)
+        int middle = (low + high) / 2;
+        if (compareTravelDays(&days[middle], &key) < 0) low = middle + 1;
+        else high = middle;
+    }
+    if (low == count || days[low].busID != busID) return 0;
+    *day = days[low].day;
+    return 1;
+}
+
+// Function to find the partition a row goes to, starting it (and reading back any partition
+// already archived for that month) the first time it is needed; NULL on failure
+static struct PartitionBuild *findBuild(struct PartitionBuild **builds, int *buildCount, int *buildCapacity,
+                                        int journal, const char *journalName, const char *month,
+                                        const struct ArchivePartition manifest[], int manifestCount) {
+    for (int i = *buildCount - 1; i >= 0; i--) {
+        if ((*builds)[i].journal == journal && strcmp((*builds)[i].month, month) == 0) return &(*builds)[i];
+    }
+    if (!reserveOne((void **)builds, buildCapacity, *buildCount, sizeof(struct PartitionBuild))) return NULL;
+
+    struct PartitionBuild *build = &(*builds)[(*buildCount)++];
+    memset(build, 0, sizeof(*build));
+    build->journal = journal;
+    snprintf(build->month, sizeof(build->month), "%s", month);
+
+    for (int i = 0; i < manifestCount; i++) {
+        if (strcmp(manifest[i].journal, journalName) == 0 && strcmp(manifest[i].month, month) == 0) {
+            char path[MAX_IMPORT_PATH];
+            partitionPath(journalName, month, path, sizeof(path));
+            if (!loadBuildRows(build, path)) {
+                printf("Error: Could not read archive partition %s.\n", path);
+                return NULL; // Rewriting it would lose the rows already there
+            }
+        }
+    }
+    return build;
+}
+
+// Function to move the rows of trips that left in an earlier month out of the journals and into
+// the archive, one partition per journal and travel month. The travel date of a row is that of
+// its trip in bus_history.txt; rows of trips still scheduled, or never purged, stay in the journal.
+// Every journal, partition and the manifest are replaced together, so a crash leaves each row
+// either in its journal or in the archive. Returns the rows archived, or -1 on error.
+int archiveTravelMonths(const char *journals[], int journalCount, const int scheduledIDs[], int scheduledCount,
+                        int today, int *partitionCount) {
+    *partitionCount = 0;
+    char thisMonth[11];
+    formatDate(today, thisMonth);
+    thisMonth[7] = '\0';
+
+    struct TravelDay *travel;
+    int travelCount = loadTravelDays(&travel);
+    if (travelCount == 0) {
+        free(travel);
+        return 0; // No trip has been purged yet
+    }
+
+    int *scheduled = malloc((size_t)(scheduledCount + 1) * sizeof(int));
+    struct DurableFile *journalOut = calloc((size_t)journalCount, sizeof(struct DurableFile));
+    struct ArchivePartition *manifest;
+    int manifestCount = loadArchiveManifest(&manifest);
+    struct PartitionBuild *builds = NULL;
+    int buildCount = 0, buildCapacity = 0;
+    int archived = 0, ok = scheduled && journalOut;
+
+    if (ok) {
+        memcpy(scheduled, scheduledIDs, (size_t)scheduledCount * sizeof(int));
+        qsort(scheduled, (size_t)scheduledCount, sizeof(int), compareInts);
+    }
+
+    for (int j = 0; ok && j < journalCount; j++) {
+        struct RecordReader reader;
+        if (!openRecordReader(&reader, journals[j])) continue; // Nothing written to it yet
+        if (!beginDurableWrite(&journalOut[j], journals[j], 0)) {
+            closeRecordReader(&reader);
+            ok = 0;
+            break;
+        }
+
+        struct StringView line;
+        struct ReservationRecord record;
+        while (ok && readRecordLine(&reader, &line)) {
+            int travelDay, bookingDay, seats[MAX_SEATS], seatCount;
+            char month[11] = "";
+            if (parseReservationRecord(line, &record) && parseDateView(record.date, &bookingDay) &&
+                !bsearch(&record.busID, scheduled, (size_t)scheduledCount, sizeof(int), compareInts) &&
+                findTravelDay(travel, travelCount, record.busID, bookingDay, &travelDay)) {
+                formatDate(travelDay, month);
+                month[7] = '\0';
+            }
+
+            // Rows of closed months that can be encoded go to the archive; everything else stays
+            if (month[0] && strcmp(month, thisMonth) < 0 &&
+                (seatCount = parseSeatList(record.seatList, ' ', seats, MAX_SEATS)) >= 0) {
+                struct PartitionBuild *build = findBuild(&builds, &buildCount, &buildCapacity, j, journals[j],
+                                                         month, manifest, manifestCount);
+                ok = build && addBuildRow(build, record.username, record.busNumberPlate, record.ticketNumber,
+                                          record.busID, bookingDay, record.numSeats, seats, seatCount, record.amount);
+                archived++;
+            } else {
+                fwrite(line.data, 1, (size_t)line.length, journalOut[j].file);
+                fputc('\n', journalOut[j].file);
+            }
+        }
+        closeRecordReader(&reader);
+        ok = ok && !ferror(journalOut[j].file);
+    }
+
+    // Write each partition and record it in the manifest
+    struct DurableFile manifestOut;
+    memset(&manifestOut, 0, sizeof(manifestOut));
+    for (int b = 0; ok && archived > 0 && b < buildCount; b++) {
+        struct PartitionBuild *build = &builds[b];
+        char path[MAX_IMPORT_PATH];
+        partitionPath(journals[build->journal], build->month, path, sizeof(path));
+
+        struct ArchiveZone zone;
+        ok = beginDurableWrite(&build->out, path, 0) && writePartition(build->out.file, build, &zone);
+
+        int entry = -1;
+        for (int i = 0; i < manifestCount; i++) {
+            if (strcmp(manifest[i].journal, journals[build->journal]) == 0 && strcmp(manifest[i].month, build->month) == 0) entry = i;
+        }
+        if (ok && entry < 0) {
+            int capacity = manifestCount;
+            ok = reserveOne((void **)&manifest, &capacity, manifestCount, sizeof(struct ArchivePartition));
+            entry = manifestCount++;
+        }
+        if (ok) {
+            snprintf(manifest[entry].journal, sizeof(manifest[entry].journal), "%s", journals[build->journal]);
+            snprintf(manifest[entry].month, sizeof(manifest[entry].month), "%s", build->month);
+            manifest[entry].zone = zone;
+        }
+    }
+    if (ok && archived > 0) {
+        ok = beginDurableWrite(&manifestOut, ARCHIVE_MANIFEST_FILE, 0) &&
+             writeArchiveManifest(manifestOut.file, manifest, manifestCount);
+    }
+
+    // Put every new file on disk, then swap them all in together
+    const char **tempFiles = malloc((size_t)(journalCount + buildCount + 1) * sizeof(char *));
+    const char **finalFiles = malloc((size_t)(journalCount + buildCount + 1) * sizeof(char *));
+    int renames = 0;
+    ok = ok && archived > 0 && tempFiles && finalFiles;
+    for (int j = 0; j < journalCount && journalOut; j++) {
+        if (!journalOut[j].file) continue;
+        int synced = ok && syncAndCloseFile(journalOut[j].file);
+        if (ok) journalOut[j].file = NULL; // Closed either way
+        if (synced) {
+            tempFiles[renames] = journalOut[j].tempPath;
+            finalFiles[renames++] = journalOut[j].path;
+        } else {
+            ok = 0;
+        }
+    }
+    for (int b = 0; b < buildCount; b++) {
+        if (!builds[b].out.file) continue;
+        int synced = ok && syncAndCloseFile(builds[b].out.file);
+        if (ok) builds[b].out.file = NULL;
+        if (synced) {
+            tempFiles[renames] = builds[b].out.tempPath;
+            finalFiles[renames++] = builds[b].out.path;
+        } else {
+            ok = 0;
+        }
+    }
+    if (manifestOut.file) {
+        int synced = ok && syncAndCloseFile(manifestOut.file);
+        if (ok) manifestOut.file = NULL;
+        if (synced) {
+            tempFiles[renames] = manifestOut.tempPath;
+            finalFiles[renames++] = manifestOut.path;
+        } else {
+            ok = 0;
+        }
+    }
+    if (ok) {
+        ok = replaceFilesTogether(tempFiles, finalFiles, renames);
+    }
+    if (!ok) {
+        // Drop whatever was written; the journals and the archive stay as they were
+        for (int j = 0; journalOut && j < journalCount; j++) {
+            if (journalOut[j].tempPath[0]) abortDurableWrite(&journalOut[j]);
+        }
+        for (int b = 0; b < buildCount; b++) {
+            if (builds[b].out.tempPath[0]) abortDurableWrite(&builds[b].out);
+        }
+        if (manifestOut.tempPath[0]) abortDurableWrite(&manifestOut);
+        if (archived > 0) printf("Error: Could not archive past bookings; the journals are unchanged.\n");
+    }
+
+    if (ok) *partitionCount = buildCount;
+    for (int b = 0; b < buildCount; b++) {
+        freeDictionary(&builds[b].usernames);
+        freeDictionary(&builds[b].plates);
+        free(builds[b].rows);
+        free(builds[b].seats);
+    }
+    free(builds);
+    free(tempFiles);
+    free(finalFiles);
+    free(manifest);
+    free(journalOut);
+    free(scheduled);
+    free(travel);
+    return ok ? archived : (archived > 0 ? -1 : 0);
+}
+
+// Function to count the archived rows of one journal, for listings that show only the journal itself
+int countArchivedRows(const char *journal) {
+    struct ArchivePartition *partitions;
+    int count = loadArchiveManifest(&partitions);
+    int rows = 0;
+    for (int i = 0; i < count; i++) {
+        if (strcmp(partitions[i].journal, journal) == 0) rows += partitions[i].zone.rows;
+    }
+    free(partitions);
+    return rows;
+}
+
+// Function to copy a field into the request arena, so it outlives the scan it came from
+static int keepView(struct StringView *view) {
+    char *copy = arenaAlloc(requestArena(), (size_t)view->length + 1, 1);
+    if (!copy) return 0;
+    memcpy(copy, view->data, (size_t)view->length);
+    copy[view->length] = '\0';
+    view->data = copy;
+    return 1;
+}
+
+// Function to copy an archived row's text into the request arena; returns 0 when out of memory
+static int keepArchivedRecord(struct ReservationRecord *record) {
+    return keepView(&record->username) && keepView(&record->busNumberPlate) &&
+           keepView(&record->date) && keepView(&record->seatList);
+}
+
+// Function to collect a user's archived bookings, oldest travel month first. The records live in
+// the request arena until it is next reset. Returns how many there are, or -1 when out of memory.
+int loadArchivedBookings(const char *username, struct ReservationRecord **records) {
+    struct IndexCriterion criterion;
+    criterion.type = INDEX_USERNAME;
+    snprintf(criterion.value, sizeof(criterion.value), "%s", username);
+
+    struct ArchivePredicate predicate;
+    struct ArchiveScan scan;
+    archivePredicateFromCriteria(&predicate, &criterion, 1);
+    openArchiveScan(&scan, "reservation.txt", &predicate);
+
+    *records = NULL;
+    int count = 0, capacity = 0;
+    struct ReservationRecord record;
+    while (nextArchiveRecord(&scan, &record)) {
+        if (!viewEquals(record.username, username)) continue;
+        if (count == capacity) {
+            // The arena cannot grow in place; the old array is dropped with the rest of the request
+            int grown = capacity ? capacity * 2 : 16;
+            struct ReservationRecord *moved = arenaAlloc(requestArena(), (size_t)grown, sizeof(*moved));
+            if (!moved) {
+                count = -1;
+                break;
+            }
+            if (count) memcpy(moved, *records, (size_t)count * sizeof(*moved));
+            *records = moved;
+            capacity = grown;
+        }
+        if (!keepArchivedRecord(&record)) {
+            count = -1;
+            break;
+        }
+        (*records)[count++] = record;
+    }
+    closeArchiveScan(&scan);
+    return count;
+}
+
+static int *archivedTickets = NULL;                // Ticket numbers of archived reservations, sorted
+static int archivedTicketCount = 0;
+static struct FileFingerprint archivedTicketSource; // Manifest the numbers were read under
+static int archivedTicketsLoaded = 0;
+
+// Function to read the ticket numbers of every archived reservation, if the manifest changed since
+// they were last read. Without a manifest nothing is archived.
+static void syncArchivedTickets() {
+    struct FileFingerprint current;
+    if (!fingerprintFile(ARCHIVE_MANIFEST_FILE, &current)) {
+        archivedTicketCount = 0;
+        archivedTicketsLoaded = 0;
+        return;
+    }
+    if (archivedTicketsLoaded && sameFingerprint(&archivedTicketSource, &current)) return;
+
+    struct ArchiveScan scan;
+    struct ReservationRecord record;
+    int capacity = 0;
+    archivedTicketCount = 0;
+    archivedTicketsLoaded = 1;
+    openArchiveScan(&scan, "reservation.txt", NULL);
+    while (nextArchiveRecord(&scan, &record)) {
+        if (!reserveOne((void **)&archivedTickets, &capacity, archivedTicketCount, sizeof(int))) {
+            archivedTicketsLoaded = 0; // Out of memory; read again on the next check
+            break;
+        }
+        archivedTickets[archivedTicketCount++] = record.ticketNumber;
+    }
+    closeArchiveScan(&scan);
+    qsort(archivedTickets, (size_t)archivedTicketCount, sizeof(int), compareInts);
+    archivedTicketSource = current;
+}
+
+// Function to check whether an archived reservation uses a ticket number. The numbers are kept in
+// memory and read again only when the archive changes, so each check is a binary search.
+int archivedTicketExists(int ticketNumber) {
+    syncArchivedTickets();
+    return archivedTicketCount > 0 &&
+           bsearch(&ticketNumber, archivedTickets, (size_t)archivedTicketCount, sizeof(int), compareInts) != NULL;
+}
+
+// Function to find an archived reservation by ticket number. The record lives in the request arena
+// until it is next reset. Returns 0 if no archived reservation has the number.
+int findArchivedTicket(int ticketNumber, struct ReservationRecord *record) {
+    if (!archivedTicketExists(ticketNumber)) return 0; // Most lookups end here, without a scan
+
+    struct ArchiveScan scan;
+    int found = 0;
+    openArchiveScan(&scan, "reservation.txt", NULL);
+    while (!found && nextArchiveRecord(&scan, record)) {
+        found = record->ticketNumber == ticketNumber;
+    }
+    if (found) found = keepArchivedRecord(record);
+    closeArchiveScan(&scan);
+    return found;
+}
@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "bus_reservation.h"
+
+// Work handed to one parsing thread: a run of whole lines in the file buffer
+struct ImportChunk {
+    const char *start;                  // First byte of the chunk (start of a line)
+    const char *end;                    // One past the last byte (just after a newline or end of file)
+    struct ImportedTrip *trips;         // Parsed trips, in file order
+    int tripCount;                      // Number of trips parsed
+    int lineCount;                      // Lines in the chunk, used to number lines across chunks
+    int errorCount;                     // Invalid lines in the chunk
+    int errorLines[MAX_IMPORT_ERRORS];  // Chunk-relative line numbers of the first errors
+    const char *errorReasons[MAX_IMPORT_ERRORS]; // Why each of those lines was rejected
+};
+
+// Function to remember an invalid line, keeping only the first few for the report
+void addImportError(struct ScheduleImport *import, int lineNumber, const char *reason) {
+    if (import->errorCount < MAX_IMPORT_ERRORS) {
+        import->errorLines[import->errorCount] = lineNumber;
+        import->errorReasons[import->errorCount] = reason;
+    }
+    import->errorCount++;
+}
+
+// Function to record an invalid line found by a parsing thread
+static void addChunkError(struct ImportChunk *chunk, int lineNumber, const char *reason) {
+    if (chunk->errorCount < MAX_IMPORT_ERRORS) {
+        chunk->errorLines[chunk->errorCount] = lineNumber;
+        chunk->errorReasons[chunk->errorCount] = reason;
+    }
+    chunk->errorCount++;
+}
+
+// Function to parse and validate one line of an import file.
+// Format: busID,plate,date,source,destination,departure,arrival,totalSeats,fare
+static const char *parseImportLine(struct StringView line, struct ImportedTrip *trip) {
+    struct StringView fields[MAX_RECORD_FIELDS];
+
+    if (splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS) != 9) return "expected 9 fields";
+    if (!parseIntView(fields[0], &trip->busID)) return "invalid bus ID";
+    if (trip->busID < 1 || trip->busID >= TEMPLATE_TRIP_ID_BASE) return "bus ID out of range";
+    if (fields[1].length == 0 || fields[1].length >= 20) return "invalid number plate";
+    if (!parseDateView(fields[2], &trip->departureDay)) return "invalid date";
+    if (fields[3].length == 0 || fields[3].length >= 50) return "invalid source";
+    if (fields[4].length == 0 || fields[4].length >= 50) return "invalid destination";
+    if (!parseTimeView(fields[5], &trip->departureMinute)) return "invalid departure time";
+    if (!parseTimeView(fields[6], &trip->arrivalMinute)) return "invalid arrival time";
+    if (!parseIntView(fields[7], &trip->totalSeats)) return "invalid seat count";
+    if (trip->totalSeats < 1 || trip->totalSeats > MAX_SEATS) return "seat count out of range";
+    if (!parseAmountView(fields[8], &trip->fare) || trip->fare < 0) return "invalid fare";
+
+    // Text fields stay as views into the file buffer until the trips are merged
+    trip->busNumberPlate = fields[1];
+    trip->source = fields[3];
+    trip->destination = fields[4];
+    return NULL;
+}
+
+// Thread body: parse every line of one chunk
+static void *parseImportChunk(void *argument) {
+    struct ImportChunk *chunk = argument;
+    const char *cursor = chunk->start;
+
+    while (cursor < chunk->end) {
+        const char *newline = memchr(cursor, '\n', (size_t)(chunk->end - cursor));
+        const char *lineEnd = newline ? newline : chunk->end;
+        struct StringView line = { cursor, (int)(lineEnd - cursor) };
+        cursor = newline ? newline + 1 : chunk->end;
+        chunk->lineCount++;
+
+        if (line.length > 0 && line.data[line.length - 1] == '\r') line.length--; // Windows line endings
+        if (line.length == 0) continue; // Blank lines are allowed
+
+        const char *reason = parseImportLine(line, &chunk->trips[chunk->tripCount]);
+        if (reason) {
+            addChunkError(chunk, chunk->lineCount, reason);
+        } else {
+            chunk->trips[chunk->tripCount].lineNumber = chunk->lineCount; // Made absolute after the join
+            chunk->tripCount++;
+        }
+    }
+    return NULL;
+}
+
+// Function to order trips by bus ID so duplicates end up next to each other
+static int compareImportedTrips(const void *a, const void *b) {
+    const struct ImportedTrip *left = *(const struct ImportedTrip *const *)a;
+    const struct ImportedTrip *right = *(const struct ImportedTrip *const *)b;
+    if (left->busID != right->busID) return left->busID < right->busID ? -1 : 1;
+    return left->lineNumber - right->lineNumber;
+}
+
+// Function to read a CSV of trips and parse it in parallel chunks.
+// Every line is validated and duplicate bus IDs within the file are reported; nothing is merged here.
+int loadScheduleImport(const char *filename, struct ScheduleImport *import) {
+    memset(import, 0, sizeof(*import));
+
+    FILE *file = fopen(filename, "rb");
+    if (!file) {
+        printf("Error: Could not open %s\n", filename);
+        return 0;
+    }
+
+    // Read the whole file once; the parsed trips point into this buffer
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    import->data = malloc(size > 0 ? (size_t)size : 1);
+    if (!import->data || (size > 0 && fread(import->data, 1, (size_t)size, file) != (size_t)size)) {
+        printf("Error: Could not read %s\n", filename);
+        fclose(file);
+        freeScheduleImport(import);
+        return 0;
+    }
+    fclose(file);
+    import->size = (size_t)size;
+
+    // Skip an optional header line such as "busID,plate,..."
+    const char *begin = import->data;
+    const char *end = import->data + import->size;
+    int headerLines = 0;
+    if (begin < end && (*begin < '0' || *begin > '9')) {
+        const char *newline = memchr(begin, '\n', (size_t)(end - begin));
+        begin = newline ? newline + 1 : end;
+        headerLines = 1;
+    }
+
+    // One chunk per processor, each ending on a line boundary
+    long processors = sysconf(_SC_NPROCESSORS_ONLN);
+    int chunkCount = processors < 1 ? 1 : processors > MAX_IMPORT_THREADS ? MAX_IMPORT_THREADS : (int)processors;
+    if ((size_t)(end - begin) < IMPORT_MIN_CHUNK_BYTES * (size_t)chunkCount) {
+        chunkCount = 1; // Small files are not worth the threads
+    }
+
+    struct ImportChunk chunks[MAX_IMPORT_THREADS];
+    pthread_t threads[MAX_IMPORT_THREADS];
+    const char *chunkStart = begin;
+    for (int i = 0; i < chunkCount; i++) {
+        const char *chunkEnd = (i == chunkCount - 1) ? end : begin + (end - begin) / chunkCount * (i + 1);
+        if (chunkEnd < chunkStart) chunkEnd = chunkStart;
+        if (chunkEnd < end) {
+            const char *newline = memchr(chunkEnd, '\n', (size_t)(end - chunkEnd));
+            chunkEnd = newline ? newline + 1 : end; // Never split a line
+        }
+
+        memset(&chunks[i], 0, sizeof(chunks[i]));
+        chunks[i].start = chunkStart;
+        chunks[i].end = chunkEnd;
+        // A line needs at least 18 bytes ("1,P,YYYY-MM-DD,..."), which bounds the trips in the chunk
+        chunks[i].trips = malloc(((size_t)(chunkEnd - chunkStart) / 18 + 1) * sizeof(struct ImportedTrip));
+        if (!chunks[i].trips) {
+            printf("Error: Not enough memory to import %s\n", filename);
+            for (int j = 0; j < i; j++) free(chunks[j].trips);
+            freeScheduleImport(import);
+            return 0;
+        }
+        chunkStart = chunkEnd;
+    }
+
+    // Parse the chunks side by side
+    int started[MAX_IMPORT_THREADS] = {0};
+    for (int i = 1; i < chunkCount; i++) {
+        started[i] = pthread_create(&threads[i], NULL, parseImportChunk, &chunks[i]) == 0;
+        if (!started[i]) {
+            parseImportChunk(&chunks[i]); // Fall back to parsing it on this thread
+        }
+    }
+    parseImportChunk(&chunks[0]);
+    for (int i = 1; i < chunkCount; i++) {
+        if (started[i]) pthread_join(threads[i], NULL);
+    }
+
+    // Join the chunks in file order, turning chunk line numbers into file line numbers
+    int total = 0;
+    for (int i = 0; i < chunkCount; i++) total += chunks[i].tripCount;
+    import->trips = malloc((size_t)(total > 0 ? total : 1) * sizeof(struct ImportedTrip));
+
+    int lineBase = headerLines;
+    for (int i = 0; i < chunkCount; i++) {
+        for (int j = 0; j < chunks[i].tripCount; j++) {
+            chunks[i].trips[j].lineNumber += lineBase;
+            if (import->trips) import->trips[import->tripCount++] = chunks[i].trips[j];
+        }
+        for (int j = 0; j < chunks[i].errorCount && j < MAX_IMPORT_ERRORS; j++) {
+            addImportError(import, chunks[i].errorLines[j] + lineBase, chunks[i].errorReasons[j]);
+        }
+        import->errorCount += chunks[i].errorCount > MAX_IMPORT_ERRORS ? chunks[i].errorCount - MAX_IMPORT_ERRORS : 0;
+        lineBase += chunks[i].lineCount;
+        free(chunks[i].trips);
+    }
+
+    if (!import->trips) {
+        printf("Error: Not enough memory to import %s\n", filename);
+        freeScheduleImport(import);
+        return 0;
+    }
+
+    // Duplicate bus IDs inside the file: sort pointers by ID and compare neighbours
+    struct ImportedTrip **byID = malloc((size_t)(import->tripCount > 0 ? import->tripCount : 1) * sizeof(*byID));
+    if (byID) {
+        for (int i = 0; i < import->tripCount; i++) byID[i] = &import->trips[i];
+        qsort(byID, (size_t)import->tripCount, sizeof(*byID), compareImportedTrips);
+        for (int i = 1; i < import->tripCount; i++) {
+            if (byID[i]->busID == byID[i - 1]->busID) {
+                addImportError(import, byID[i]->lineNumber, "duplicate bus ID in file");
+            }
+        }
+        free(byID);
+    }
+
+    return 1;
+}
+
+// Function to report bus IDs in the import that already exist in the schedule.
+// existingIDs must be sorted in ascending order.
+void checkImportAgainstExisting(struct ScheduleImport *import, const int existingIDs[], int existingCount) {
+    for (int i = 0; i < import->tripCount; i++) {
+        int low = 0, high = existingCount; // Binary search for the trip's bus ID
+        while (low < high) {
+            int middle = low + (high - low) / 2;
+            if (existingIDs[middle] < import->trips[i].busID) low = middle + 1; else high = middle;
+        }
+        if (low < existingCount && existingIDs[low] == import->trips[i].busID) {
+            addImportError(import, import->trips[i].lineNumber, "bus ID already exists");
+        }
+    }
+}
+
+// Function to release the buffers held by an import
+void freeScheduleImport(struct ScheduleImport *import) {
+    free(import->trips);
+    free(import->data);
+    import->trips = NULL;
+    import->data = NULL;
+    import->tripCount = 0;
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+// Function to parse a days-of-week field such as "1111100" or "MTWTF--" (Monday first)
+static int parseDaysOfWeek(struct StringView field, int *daysOfWeek) {
+    int mask = 0;
+    if (field.length != 7) return 0;
+
+    for (int i = 0; i < 7; i++) {
+        if (field.data[i] != '-' && field.data[i] != '0') {
+            mask |= 1 << i; // Any other character marks a running day
+        }
+    }
+    *daysOfWeek = mask;
+    return mask != 0; // A template that never runs is a mistake
+}
+
+// Function to parse a templates.txt line
+// Format: templateID,plate,source,destination,days,departure,arrival,totalSeats,fare,validFrom,validTo
+int parseScheduleTemplate(struct StringView line, struct ScheduleTemplate *tpl) {
+    struct StringView fields[MAX_RECORD_FIELDS];
+
+    if (splitRecordFields(line, ',', fields, MAX_RECORD_FIELDS) != 11) {
+        return 0; // Wrong number of fields, skip the line
+    }
+
+    copyView(fields[1], tpl->busNumberPlate, sizeof(tpl->busNumberPlate));
+    copyView(fields[2], tpl->source, sizeof(tpl->source));
+    copyView(fields[3], tpl->destination, sizeof(tpl->destination));
+
+    return parseIntView(fields[0], &tpl->templateID) &&
+           parseDaysOfWeek(fields[4], &tpl->daysOfWeek) &&
+           parseTimeView(fields[5], &tpl->departureMinute) &&
+           parseTimeView(fields[6], &tpl->arrivalMinute) &&
+           parseIntView(fields[7], &tpl->totalSeats) &&
+           parseAmountView(fields[8], &tpl->fare) &&
+           parseDateView(fields[9], &tpl->validFromDay) &&
+           parseDateView(fields[10], &tpl->validToDay) &&
+           validateScheduleTemplate(tpl);
+}
+
+// Function to check the limits that keep template trip IDs unique
+int validateScheduleTemplate(const struct ScheduleTemplate *tpl) {
+    return tpl->templateID >= 1 && tpl->templateID <= MAX_TEMPLATE_ID &&
+           tpl->totalSeats >= 1 && tpl->totalSeats <= MAX_TEMPLATE_SEATS &&
+           tpl->fare >= 0 &&
+           tpl->validToDay >= tpl->validFromDay &&
+           tpl->validToDay - tpl->validFromDay < MAX_TEMPLATE_DAYS;
+}
+
+// Function to load all recurring schedule templates
+int loadScheduleTemplates(struct ScheduleTemplate templates[], int maxTemplates) {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, "templates.txt")) return 0; // No templates yet
+
+    int count = 0;
+    struct StringView line;
+    while (count < maxTemplates && readRecordLine(&reader, &line)) {
+        if (parseScheduleTemplate(line, &templates[count])) {
+            count++; // Skip malformed lines
+        }
+    }
+
+    closeRecordReader(&reader);
+    return count;
+}
+
+// Function to append one template to templates.txt
+int appendScheduleTemplate(const struct ScheduleTemplate *tpl) {
+    FILE *file = fopen("templates.txt", "a");
+    if (!file) {
+        printf("Error: Could not open templates.txt for writing.\n");
+        return 0;
+    }
+
+    char days[8], departure[8], arrival[8], fareText[MONEY_TEXT_LENGTH], validFrom[11], validTo[11];
+    for (int i = 0; i < 7; i++) {
+        days[i] = (tpl->daysOfWeek >> i) & 1 ? '1' : '0';
+    }
+    days[7] = '\0';
+    formatTime(tpl->departureMinute, departure);
+    formatTime(tpl->arrivalMinute, arrival);
+    formatDate(tpl->validFromDay, validFrom);
+    formatDate(tpl->validToDay, validTo);
+
+    fprintf(file, "%d,%s,%s,%s,%s,%s,%s,%d,%s,%s,%s\n",
+            tpl->templateID, tpl->busNumberPlate, tpl->source, tpl->destination, days,
+            departure, arrival, tpl->totalSeats, formatMoney(tpl->fare, fareText), validFrom, validTo);
+    fclose(file);
+    return 1;
+}
+
+// Function to check whether a template has a trip on the given day
+int templateRunsOn(const struct ScheduleTemplate *tpl, int epochDay) {
+    if (epochDay < tpl->validFromDay || epochDay > tpl->validToDay) return 0;
+    int weekday = (epochDay + 3) % 7; // 1970-01-01 was a Thursday; 0 is Monday
+    return (tpl->daysOfWeek >> weekday) & 1;
+}
+
+// Function to get the bus ID of a template's trip on a day, so the same trip always gets the same ID
+int templateTripID(const struct ScheduleTemplate *tpl, int epochDay) {
+    return TEMPLATE_TRIP_ID_BASE + tpl->templateID * MAX_TEMPLATE_DAYS + (epochDay - tpl->validFromDay);
+}
+
+// Function to find the template and day a template trip ID stands for
+int findTemplateTrip(const struct ScheduleTemplate templates[], int templateCount, int busID, int *epochDay) {
+    if (busID < TEMPLATE_TRIP_ID_BASE) return -1; // Entered by hand, not from a template
+
+    int templateID = (busID - TEMPLATE_TRIP_ID_BASE) / MAX_TEMPLATE_DAYS;
+    int dayOffset = (busID - TEMPLATE_TRIP_ID_BASE) % MAX_TEMPLATE_DAYS;
+
+    for (int i = 0; i < templateCount; i++) {
+        if (templates[i].templateID == templateID) {
+            int day = templates[i].validFromDay + dayOffset;
+            if (!templateRunsOn(&templates[i], day)) return -1; // No trip that day
+            *epochDay = day;
+            return i;
+        }
+    }
+    return -1;
+}
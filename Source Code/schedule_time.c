@@ -0,0 +1,180 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "bus_reservation.h"
+
+// Function to count the days from 1970-01-01 to a calendar date (proleptic Gregorian)
+static int daysFromCivil(int year, int month, int day) {
+    year -= month <= 2;                                  // Treat January and February as months 13 and 14
+    int era = (year >= 0 ? year : year - 399) / 400;     // 400-year cycle the year falls in
+    int yearOfEra = year - era * 400;                    // [0, 399]
+    int dayOfYear = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; // [0, 365], counted from March
+    int dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear; // [0, 146096]
+    return era * 146097 + dayOfEra - 719468;
+}
+
+// Function to check whether a year is a leap year
+static int isLeapYear(int year) {
+    return (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+}
+
+// Function to read exactly 'count' digits from text into a number
+static int readDigits(const char *text, int count, int *value) {
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        if (text[i] < '0' || text[i] > '9') return 0;
+        result = result * 10 + (text[i] - '0');
+    }
+    *value = result;
+    return 1;
+}
+
+// Function to parse a YYYY-MM-DD date into days since 1970-01-01, rejecting impossible dates
+int parseDateView(struct StringView field, int *epochDay) {
+    static const int daysInMonth[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    int year, month, day;
+
+    if (field.length != 10 || field.data[4] != '-' || field.data[7] != '-') {
+        return 0; // Only the exact YYYY-MM-DD layout is accepted
+    }
+    if (!readDigits(field.data, 4, &year) || !readDigits(field.data + 5, 2, &month) ||
+        !readDigits(field.data + 8, 2, &day)) {
+        return 0;
+    }
+    if (year < 1970 || month < 1 || month > 12 || day < 1) {
+        return 0;
+    }
+    if (day > daysInMonth[month - 1] + (month == 2 && isLeapYear(year))) {
+        return 0; // e.g. 2025-02-29 or 2025-04-31
+    }
+
+    *epochDay = daysFromCivil(year, month, day);
+    return 1;
+}
+
+// Function to parse a time of day such as "08:00AM", "2:30 pm" or "14:30" into minutes after midnight
+int parseTimeView(struct StringView field, int *minutes) {
+    const char *cursor = field.data;
+    const char *end = field.data + field.length;
+    int hour = 0, minute, hourDigits = 0;
+
+    while (cursor < end && *cursor == ' ') cursor++;   // Skip leading spaces
+    while (end > cursor && end[-1] == ' ') end--;      // Skip trailing spaces
+
+    // One or two hour digits, a colon, then exactly two minute digits
+    for (; cursor < end && *cursor >= '0' && *cursor <= '9' && hourDigits < 2; cursor++, hourDigits++) {
+        hour = hour * 10 + (*cursor - '0');
+    }
+    if (hourDigits == 0 || end - cursor < 3 || *cursor != ':' || !readDigits(cursor + 1, 2, &minute)) {
+        return 0;
+    }
+    cursor += 3;
+    if (minute > 59) return 0;
+
+    while (cursor < end && *cursor == ' ') cursor++;   // Allow "08:00 AM"
+
+    if (cursor == end) {
+        if (hour > 23) return 0; // 24-hour clock
+    } else {
+        // 12-hour clock with an AM/PM suffix in either case
+        if (end - cursor != 2 || (cursor[1] != 'M' && cursor[1] != 'm')) return 0;
+        int pm = (cursor[0] == 'P' || cursor[0] == 'p');
+        if (!pm && cursor[0] != 'A' && cursor[0] != 'a') return 0;
+        if (hour < 1 || hour > 12) return 0;
+        hour = hour % 12 + (pm ? 12 : 0); // 12AM is midnight, 12PM is noon
+    }
+
+    *minutes = hour * 60 + minute;
+    return 1;
+}
+
+// Function to format days since 1970-01-01 as YYYY-MM-DD (buffer of at least 11 characters)
+void formatDate(int epochDay, char *buffer) {
+    int shifted = epochDay + 719468;                     // Days since 0000-03-01
+    int era = (shifted >= 0 ? shifted : shifted - 146096) / 146097;
+    int dayOfEra = shifted - era * 146097;
+    int yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int monthIndex = (5 * dayOfYear + 2) / 153;          // 0 is March
+    int day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    int month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    int year = yearOfEra + era * 400 + (month <= 2);
+
+    snprintf(buffer, 11, "%04u-%02u-%02u", (unsigned)year % 10000u, (unsigned)month % 100u, (unsigned)day % 100u);
+}
+
+// Function to format minutes after midnight the way schedules are stored, e.g. "02:30PM"
+void formatTime(int minutes, char *buffer) {
+    unsigned hour = (unsigned)minutes / 60 % 24;
+    unsigned displayHour = hour % 12 == 0 ? 12 : hour % 12;
+    snprintf(buffer, 8, "%02u:%02u%cM", displayHour, (unsigned)minutes % 60, hour < 12 ? 'A' : 'P');
+}
+
+// Function to get the departure key (minutes since 1970-01-01) of the current local time
+int currentDepartureKey() {
+    time_t now = time(NULL);
+    struct tm *local = localtime(&now);
+    int today = daysFromCivil(local->tm_year + 1900, local->tm_mon + 1, local->tm_mday);
+    return today * MINUTES_PER_DAY + local->tm_hour * 60 + local->tm_min;
+}
+
+// Function to order index entries by departure key, then by slot so equal keys stay in file order
+static int compareDepartureEntries(const void *a, const void *b) {
+    const struct DepartureEntry *left = a, *right = b;
+    if (left->key != right->key) return left->key < right->key ? -1 : 1;
+    return (left->slot > right->slot) - (left->slot < right->slot);
+}
+
+// Function to build the departure index from one key per schedule slot; negative keys mark empty slots
+void buildDepartureIndex(struct DepartureIndex *index, const int keys[], int count) {
+    if (count > MAX_BUSES) count = MAX_BUSES;
+
+    index->count = 0;
+    for (int i = 0; i < count; i++) {
+        if (keys[i] < 0) continue; // Free slot, nothing departs
+        index->entries[index->count].key = keys[i];
+        index->entries[index->count].slot = i;
+        index->count++;
+    }
+
+    qsort(index->entries, (size_t)index->count, sizeof(index->entries[0]), compareDepartureEntries);
+}
+
+// Function to find the position of the first departure at or after the given key (binary search)
+int findFirstDeparture(const struct DepartureIndex *index, int key) {
+    int low = 0, high = index->count;
+    while (low < high) {
+        int middle = low + (high - low) / 2;
+        if (index->entries[middle].key < key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+// Function to add one schedule to the index, keeping it sorted
+void insertDepartureEntry(struct DepartureIndex *index, int key, int slot) {
+    if (index->count >= MAX_BUSES) return;
+
+    int position = findFirstDeparture(index, key + 1); // After every entry with the same key
+    memmove(&index->entries[position + 1], &index->entries[position],
+            (size_t)(index->count - position) * sizeof(index->entries[0]));
+    index->entries[position].key = key;
+    index->entries[position].slot = slot;
+    index->count++;
+}
+
+// Function to remove one schedule from the index, keeping it sorted
+void removeDepartureEntry(struct DepartureIndex *index, int key, int slot) {
+    for (int position = findFirstDeparture(index, key); position < index->count && index->entries[position].key == key; position++) {
+        if (index->entries[position].slot == slot) {
+            memmove(&index->entries[position], &index->entries[position + 1],
+                    (size_t)(index->count - position - 1) * sizeof(index->entries[0]));
+            index->count--;
+            return;
+        }
+    }
+}
@@ -0,0 +1,209 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "bus_reservation.h"
+
+#define SNAPSHOT_MAGIC "BRSNAP1"      // First bytes of every snapshot image
+#define SNAPSHOT_ALIGNMENT 16         // Sections start on this boundary so they can be read in place
+
+// Fixed part at the start of a snapshot image, followed by the source fingerprints,
+// the section table and the section data
+struct SnapshotHeader {
+    char magic[8];                    // SNAPSHOT_MAGIC
+    unsigned int sourceCount;         // Fingerprints of the text files the image was taken from
+    unsigned int sectionCount;        // Entries in the section table
+    unsigned long long imageSize;     // Total bytes, to reject a truncated image
+    unsigned long long checksum;      // hashBytes() of everything after the header
+};
+
+// Where one section lives in the image
+struct SnapshotSectionEntry {
+    unsigned int elementSize;         // sizeof one element when the image was written
+    unsigned int count;               // Number of elements
+    unsigned long long offset;        // Byte offset of the first element from the start of the image
+};
+
+// Function to continue a 64-bit FNV-1a style hash over a run of bytes. The image is megabytes
+// of mostly binary data, so it is mixed in eight bytes at a time rather than byte by byte.
+static unsigned long long hashBytes(unsigned long long hash, const void *data, size_t size) {
+    const unsigned char *bytes = data;
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        unsigned long long word;
+        memcpy(&word, bytes + i, sizeof(word)); // Unaligned-safe load
+        hash ^= word;
+        hash *= 1099511628211ULL;
+        hash ^= hash >> 32;
+    }
+    for (; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Function to round an offset up to the section alignment
+static unsigned long long alignSnapshotOffset(unsigned long long offset) {
+    return (offset + SNAPSHOT_ALIGNMENT - 1) / SNAPSHOT_ALIGNMENT * SNAPSHOT_ALIGNMENT;
+}
+
+// Function to identify the current version of a file without reading it.
+// A durable save renames a new file into place, so the inode changes with every save;
+// the size and modification time catch appends and edits made in place.
+int fingerprintFile(const char *path, struct FileFingerprint *print) {
+    struct stat info;
+    memset(print, 0, sizeof(*print));
+    if (stat(path, &info) != 0) return 0;
+
+    print->device = (long long)info.st_dev;
+    print->inode = (long long)info.st_ino;
+    print->size = (long long)info.st_size;
+    print->modifiedSeconds = (long long)info.st_mtim.tv_sec;
+    print->modifiedNanoseconds = (long long)info.st_mtim.tv_nsec;
+    return 1;
+}
+
+// Function to check whether two fingerprints describe the same version of a file
+int sameFingerprint(const struct FileFingerprint *a, const struct FileFingerprint *b) {
+    return a->device == b->device && a->inode == b->inode && a->size == b->size &&
+           a->modifiedSeconds == b->modifiedSeconds && a->modifiedNanoseconds == b->modifiedNanoseconds;
+}
+
+// Function to write a snapshot image: the fingerprints of the files it was built from, then each
+// section as raw memory. The image replaces the old one through a durable write, so a reader
+// sees either the previous complete image or the new one.
+int writeSnapshot(const char *path, const struct FileFingerprint sources[], int sourceCount,
+                  const struct SnapshotSection sections[], int sectionCount) {
+    if (sourceCount > MAX_SNAPSHOT_SOURCES || sectionCount > MAX_SNAPSHOT_SECTIONS) return 0;
+
+    // Lay the sections out after the header and tables
+    struct SnapshotSectionEntry entries[MAX_SNAPSHOT_SECTIONS];
+    unsigned long long offset = sizeof(struct SnapshotHeader) + sourceCount * sizeof(struct FileFingerprint) +
+                                sectionCount * sizeof(struct SnapshotSectionEntry);
+    for (int i = 0; i < sectionCount; i++) {
+        offset = alignSnapshotOffset(offset);
+        entries[i].elementSize = (unsigned int)sections[i].elementSize;
+        entries[i].count = (unsigned int)sections[i].count;
+        entries[i].offset = offset;
+        offset += (unsigned long long)sections[i].elementSize * sections[i].count;
+    }
+
+    struct SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    header.sourceCount = (unsigned int)sourceCount;
+    header.sectionCount = (unsigned int)sectionCount;
+    header.imageSize = offset;
+
+    // The checksum covers the same bytes in the same order as they are written below. It must
+    // come out as mapSnapshot()'s single pass over the image does, which mixes whole eight-byte
+    // words, so a section's last few bytes are held back and hashed with the padding after it.
+    static const char padding[SNAPSHOT_ALIGNMENT];
+    unsigned char pending[8 + SNAPSHOT_ALIGNMENT]; // Tail of the last section, then padding
+    size_t pendingLength = 0;
+    unsigned long long hash = 14695981039346656037ULL;
+    unsigned long long position = sizeof(header) + sourceCount * sizeof(struct FileFingerprint) +
+                                  sectionCount * sizeof(struct SnapshotSectionEntry);
+    hash = hashBytes(hash, sources, sourceCount * sizeof(struct FileFingerprint));
+    hash = hashBytes(hash, entries, sectionCount * sizeof(struct SnapshotSectionEntry));
+    for (int i = 0; i < sectionCount; i++) {
+        size_t gap = (size_t)(entries[i].offset - position);
+        memset(pending + pendingLength, 0, gap);
+        hash = hashBytes(hash, pending, pendingLength + gap); // Ends on the aligned section start
+
+        size_t size = (size_t)sections[i].elementSize * sections[i].count;
+        size_t whole = size & ~(size_t)7;
+        hash = hashBytes(hash, sections[i].data, whole);
+        pendingLength = size - whole;
+        if (pendingLength) memcpy(pending, (const unsigned char *)sections[i].data + whole, pendingLength);
+        position = entries[i].offset + size;
+    }
+    header.checksum = hashBytes(hash, pending, pendingLength);
+
+    struct DurableFile out;
+    FILE *file = beginDurableWrite(&out, path, 0);
+    if (!file) return 0;
+
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(sources, sizeof(struct FileFingerprint), (size_t)sourceCount, file);
+    fwrite(entries, sizeof(struct SnapshotSectionEntry), (size_t)sectionCount, file);
+    position = sizeof(header) + sourceCount * sizeof(struct FileFingerprint) +
+               sectionCount * sizeof(struct SnapshotSectionEntry);
+    for (int i = 0; i < sectionCount; i++) {
+        fwrite(padding, 1, (size_t)(entries[i].offset - position), file);
+        fwrite(sections[i].data, (size_t)sections[i].elementSize, (size_t)sections[i].count, file);
+        position = entries[i].offset + (unsigned long long)sections[i].elementSize * sections[i].count;
+    }
+    if (ferror(file)) {
+        abortDurableWrite(&out);
+        return 0;
+    }
+    return commitDurableWrite(&out);
+}
+
+// Function to map a snapshot image read-only and check it is complete and undamaged.
+// Section data is used straight from the mapping; nothing is parsed or copied here.
+int mapSnapshot(const char *path, struct MappedSnapshot *snapshot) {
+    memset(snapshot, 0, sizeof(*snapshot));
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return 0; // No snapshot yet
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(struct SnapshotHeader)) {
+        close(fd);
+        return 0;
+    }
+    void *base = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd); // The mapping stays valid without the descriptor
+    if (base == MAP_FAILED) return 0;
+
+    snapshot->base = base;
+    snapshot->size = (size_t)info.st_size;
+
+    const struct SnapshotHeader *header = base;
+    size_t tableEnd = sizeof(*header) + (size_t)header->sourceCount * sizeof(struct FileFingerprint) +
+                      (size_t)header->sectionCount * sizeof(struct SnapshotSectionEntry);
+    if (memcmp(header->magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0 ||
+        header->imageSize != snapshot->size ||
+        header->sourceCount > MAX_SNAPSHOT_SOURCES || header->sectionCount > MAX_SNAPSHOT_SECTIONS ||
+        tableEnd > snapshot->size) {
+        unmapSnapshot(snapshot);
+        return 0;
+    }
+
+    const char *bytes = base;
+    if (hashBytes(14695981039346656037ULL, bytes + sizeof(*header), snapshot->size - sizeof(*header)) != header->checksum) {
+        unmapSnapshot(snapshot);
+        return 0; // Damaged; the caller falls back to the text files
+    }
+
+    snapshot->sources = (const struct FileFingerprint *)(bytes + sizeof(*header));
+    snapshot->sourceCount = (int)header->sourceCount;
+    const struct SnapshotSectionEntry *entries =
+        (const struct SnapshotSectionEntry *)(snapshot->sources + header->sourceCount);
+    for (unsigned int i = 0; i < header->sectionCount; i++) {
+        unsigned long long end = entries[i].offset + (unsigned long long)entries[i].elementSize * entries[i].count;
+        if (entries[i].offset < tableEnd || end > snapshot->size) {
+            unmapSnapshot(snapshot);
+            return 0;
+        }
+        snapshot->sections[i].data = bytes + entries[i].offset;
+        snapshot->sections[i].elementSize = (int)entries[i].elementSize;
+        snapshot->sections[i].count = (int)entries[i].count;
+    }
+    snapshot->sectionCount = (int)header->sectionCount;
+    return 1;
+}
+
+// Function to release a mapped snapshot; pointers into its sections are invalid afterwards
+void unmapSnapshot(struct MappedSnapshot *snapshot) {
+    if (snapshot->base) munmap(snapshot->base, snapshot->size);
+    snapshot->base = NULL;
+    snapshot->size = 0;
+    snapshot->sectionCount = 0;
+    snapshot->sourceCount = 0;
+}
@@ -0,0 +1,217 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include "bus_reservation.h"
+
+#define STRING_CHUNK_SIZE 65536   // Bytes of text stored per chunk; chunks never move, so texts stay put
+
+// One interned string
+struct InternedString {
+    const char *text;             // Null-terminated, in a text chunk
+    int length;
+    string_id folded;             // First string interned that is equal ignoring case
+};
+
+// The dictionary: strings by ID, and two hash tables over them (exact and case-folded)
+static struct InternedString *strings = NULL;  // Index 0 is the empty string (NO_STRING)
+static int stringCount = 0, stringCapacity = 0;
+static string_id *exactSlots = NULL;           // ID of the string in each slot, 0 when empty
+static string_id *foldedSlots = NULL;          // ID of the first spelling of each case-folded string
+static int slotCount = 0;                      // Power of two, kept at least twice stringCount
+static char *chunk = NULL;                     // Text chunk being filled
+static size_t chunkUsed = STRING_CHUNK_SIZE;
+
+// Function to hash a string with 64-bit FNV-1a, optionally ignoring case
+static unsigned long long hashString(const char *text, int length, int fold) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for (int i = 0; i < length; i++) {
+        hash ^= fold ? (unsigned char)tolower((unsigned char)text[i]) : (unsigned char)text[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Function to compare two strings of the same length ignoring case
+static int equalIgnoringCase(const char *a, const char *b, int length) {
+    for (int i = 0; i < length; i++) {
+        if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) return 0;
+    }
+    return 1;
+}
+
+// Function to find the slot of a string in one of the tables: the slot holding it, or the empty
+// slot where it would go
+static size_t findSlot(const string_id slots[], const char *text, int length, int fold) {
+    size_t mask = (size_t)slotCount - 1;
+    size_t slot = hashString(text, length, fold) & mask;
+    while (slots[slot]) {
+        const struct InternedString *entry = &strings[slots[slot]];
+        if (entry->length == length &&
+            (fold ? equalIgnoringCase(entry->text, text, length) : memcmp(entry->text, text, (size_t)length) == 0)) {
+            break;
+        }
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+// Function to double both hash tables and put every string back in
+static int growSlots() {
+    int grown = slotCount ? slotCount * 2 : 1024;
+    string_id *exact = calloc((size_t)grown, sizeof(string_id));
+    string_id *folded = calloc((size_t)grown, sizeof(string_id));
+    if (!exact || !folded) {
+        free(exact);
+        free(folded);
+        return 0;
+    }
+    free(exactSlots);
+    free(foldedSlots);
+    exactSlots = exact;
+    foldedSlots = folded;
+    slotCount = grown;
+
+    for (string_id id = 1; id < (string_id)stringCount; id++) {
+        const struct InternedString *entry = &strings[id];
+        exactSlots[findSlot(exactSlots, entry->text, entry->length, 0)] = id;
+        if (entry->folded == id) {
+            foldedSlots[findSlot(foldedSlots, entry->text, entry->length, 1)] = id;
+        }
+    }
+    return 1;
+}
+
+// Function to copy a string's text into the current chunk, starting a new one when it is full
+static const char *storeText(const char *text, int length) {
+    if (chunkUsed + (size_t)length + 1 > STRING_CHUNK_SIZE) {
+        size_t size = (size_t)length + 1 > STRING_CHUNK_SIZE ? (size_t)length + 1 : STRING_CHUNK_SIZE;
+        chunk = malloc(size); // Kept for the life of the program
+        if (!chunk) return NULL;
+        chunkUsed = 0;
+    }
+    char *stored = chunk + chunkUsed;
+    memcpy(stored, text, (size_t)length);
+    stored[length] = '\0';
+    chunkUsed += (size_t)length + 1;
+    return stored;
+}
+
+// Function to get the ID of a string, adding it to the dictionary on first use.
+// Equal strings always get the same ID; NO_STRING is the empty string.
+string_id internStringView(struct StringView text) {
+    if (text.length <= 0) return NO_STRING;
+    if (stringCount == 0) {
+        // ID 0 is reserved for the empty string, so a cleared field never equals a real one
+        if (!reserveStrings()) return NO_STRING;
+    }
+    if (2 * (stringCount + 1) > slotCount && !growSlots()) return NO_STRING;
+
+    size_t slot = findSlot(exactSlots, text.data, text.length, 0);
+    if (exactSlots[slot]) return exactSlots[slot];
+
+    if (stringCount == stringCapacity) {
+        int grown = stringCapacity * 2;
+        struct InternedString *moved = realloc(strings, (size_t)grown * sizeof(*strings));
+        if (!moved) return NO_STRING;
+        strings = moved;
+        stringCapacity = grown;
+    }
+    const char *stored = storeText(text.data, text.length);
+    if (!stored) return NO_STRING;
+
+    string_id id = (string_id)stringCount++;
+    strings[id].text = stored;
+    strings[id].length = text.length;
+    exactSlots[slot] = id;
+
+    // The first spelling of a case-folded string stands for all of them
+    size_t foldedSlot = findSlot(foldedSlots, text.data, text.length, 1);
+    if (!foldedSlots[foldedSlot]) foldedSlots[foldedSlot] = id;
+    strings[id].folded = foldedSlots[foldedSlot];
+    return id;
+}
+
+// Function to get the ID of a null-terminated string, adding it on first use
+string_id internString(const char *text) {
+    struct StringView view = { text, (int)strlen(text) };
+    return internStringView(view);
+}
+
+// Function to look up a string without adding it, for text typed by a user: a search for a city
+// nobody travels to must not stay in the dictionary and every snapshot. Ignoring case, the ID
+// returned is the one foldedString() gives every spelling. Returns NO_STRING for unknown text.
+string_id findString(const char *text, int ignoreCase) {
+    int length = (int)strlen(text);
+    if (length == 0 || slotCount == 0) return NO_STRING;
+    string_id *slots = ignoreCase ? foldedSlots : exactSlots;
+    return slots[findSlot(slots, text, length, ignoreCase)];
+}
+
+// Function to set up the dictionary with the empty string as ID 0; returns 0 when out of memory
+int reserveStrings() {
+    if (stringCount > 0) return 1;
+    strings = malloc(256 * sizeof(*strings));
+    if (!strings) return 0;
+    stringCapacity = 256;
+    strings[NO_STRING].text = "";
+    strings[NO_STRING].length = 0;
+    strings[NO_STRING].folded = NO_STRING;
+    stringCount = 1;
+    return 1;
+}
+
+// Function to get the text of an ID. The pointer stays valid for the life of the program.
+const char *stringText(string_id id) {
+    return id < (string_id)stringCount ? strings[id].text : "";
+}
+
+// Function to get the ID every spelling of a string shares when case is ignored;
+// foldedString(a) == foldedString(b) is the same test as strcasecmp(a, b) == 0
+string_id foldedString(string_id id) {
+    return id < (string_id)stringCount ? strings[id].folded : NO_STRING;
+}
+
+// Function to order two IDs as strcmp() orders their texts; equal IDs are not looked at
+int compareStrings(string_id a, string_id b) {
+    return a == b ? 0 : strcmp(stringText(a), stringText(b));
+}
+
+// Function to count the IDs handed out so far, including NO_STRING
+int internedStringCount() {
+    return stringCount;
+}
+
+// Function to copy every interned string, in ID order and each followed by a null byte, into one
+// buffer for the snapshot image. The caller frees *pool; returns the bytes used or -1.
+long exportInternedStrings(char **pool) {
+    long size = 0;
+    for (int id = 1; id < stringCount; id++) {
+        size += strings[id].length + 1;
+    }
+    *pool = malloc((size_t)size + 1);
+    if (!*pool) return -1;
+
+    long used = 0;
+    for (int id = 1; id < stringCount; id++) {
+        memcpy(*pool + used, strings[id].text, (size_t)strings[id].length + 1);
+        used += strings[id].length + 1;
+    }
+    return used;
+}
+
+// Function to intern the strings of an exported pool so each gets back the ID it had.
+// Only possible while nothing else has been interned; returns 0 if the IDs would differ.
+int importInternedStrings(const char *pool, long size) {
+    if (stringCount > 1 || (size > 0 && pool[size - 1] != '\0')) return 0;
+
+    string_id expected = 1;
+    for (long start = 0; start < size; expected++) {
+        const char *text = pool + start;
+        int length = (int)strlen(text);
+        struct StringView view = { text, length };
+        if (length == 0 || internStringView(view) != expected) return 0; // Duplicate or damaged pool
+        start += length + 1;
+    }
+    return 1;
+}
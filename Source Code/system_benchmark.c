@@ -0,0 +1,291 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include "bus_reservation.h"
+
+// End-to-end benchmark of the reservation system at several data sizes. For each size it
+// generates a data folder with data_generator, then runs the real program on scripted input
+// for every scenario (startup, login, search, booking, cancellation, notifications, history
+// and the reports), each time on a fresh copy of the data. Results are printed as JSON so
+// runs can be compared to catch performance regressions.
+//
+// Build: gcc -O2 -I"Text File" "Source Code/system_benchmark.c" "Source Code/record_parser.c" "Source Code/money.c" -o system_benchmark
+// Usage: ./system_benchmark <bus_reservation> <data_generator> [runs] [reservations...] > results.json
+
+#define DEFAULT_BENCHMARK_RUNS 3     // Runs per scenario; the median is reported
+#define MAX_BENCHMARK_RUNS 25        // Largest run count accepted
+#define BENCHMARK_TIMEOUT 120        // Seconds before a stuck run is stopped
+#define BENCHMARK_FOLDER "benchmark_data" // Generated data and scratch copies go here
+#define BENCHMARK_USER "User1"       // The generator makes User1 the busiest passenger
+#define BENCHMARK_PASSWORD "1234"
+
+static const long defaultScales[] = { 1000, 10000, 100000, 1000000 };
+
+// One scripted session; %d/%s placeholders are filled from the generated data
+struct Scenario {
+    const char *name;
+    const char *script;
+};
+
+// Values from the generated data that the scripts need
+struct ScenarioData {
+    int bookingBusID;        // A bus with at least one free seat
+    int bookingSeat;         // One of its free seats
+    int cancelTicket;        // A ticket of the benchmark user in reservation.txt
+    char source[50];         // Route of the booking bus, used by the search
+    char destination[50];
+};
+
+// Every session ends by logging out (11) and leaving the program (4), so a run never waits for input
+static const struct Scenario scenarios[] = {
+    { "startup",       "4\n" },
+    { "login",         "2\n" BENCHMARK_USER "\n" BENCHMARK_PASSWORD "\n11\n4\n" },
+    { "check_status",  "2\n" BENCHMARK_USER "\n" BENCHMARK_PASSWORD "\n1\n11\n4\n" },
+    { "search",        "2\n" BENCHMARK_USER "\n" BENCHMARK_PASSWORD "\n2\n2\n%s\n%s\n11\n4\n" },
+    { "booking",       "2\n" BENCHMARK_USER "\n" BENCHMARK_PASSWORD "\n4\n1\n%d\n1\n%d\nY\n1\n1234567812345678\n11\n4\n" },
+    { "cancellation",  "2\n" BENCHMARK_USER "\n" BENCHMARK_PASSWORD "\n7\n%d\nY\n11\n4\n" },
+    { "notifications", "2\n" BENCHMARK_USER "\n" BENCHMARK_PASSWORD "\n5\n1\n0\n11\n4\n" },
+    { "history",       "2\n" BENCHMARK_USER "\n" BENCHMARK_PASSWORD "\n9\n11\n4\n" },
+    { "bus_report",    "1\nManeet\n1234\n6\n1\n8\n11\n4\n" },
+    { "user_report",   "1\nManeet\n1234\n6\n3\n8\n11\n4\n" },
+    { "reservations_report", "1\nManeet\n1234\n6\n4\nQ\n8\n11\n4\n" },
+};
+#define SCENARIO_COUNT (int)(sizeof(scenarios) / sizeof(scenarios[0]))
+
+// Function to read a monotonic clock in seconds
+static double nowSeconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Function to run a program with its input from a file and its output discarded.
+// Returns the exit status, or -1 if it could not be started or was stopped by the timeout.
+static int runProgram(char *const argv[], const char *folder, const char *inputPath) {
+    pid_t pid = fork();
+    if (pid < 0) return -1;
+
+    if (pid == 0) {
+        int input = inputPath ? open(inputPath, O_RDONLY) : open("/dev/null", O_RDONLY);
+        int output = open("/dev/null", O_WRONLY);
+        if (input < 0 || output < 0 || (folder && chdir(folder) != 0)) _exit(127);
+        dup2(input, STDIN_FILENO);
+        dup2(output, STDOUT_FILENO);
+        dup2(output, STDERR_FILENO);
+        alarm(BENCHMARK_TIMEOUT); // Survives exec, so a run stuck on input is killed
+        execv(argv[0], argv);
+        _exit(127);
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) return -1;
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+// Function to copy every regular file of one folder into another, replacing what is there
+static int copyFolder(const char *from, const char *to) {
+    DIR *dir = opendir(from);
+    if (!dir) return 0;
+    mkdir(to, 0755);
+
+    static char buffer[RECORD_BLOCK_SIZE];
+    struct dirent *entry;
+    int ok = 1;
+    while (ok && (entry = readdir(dir))) {
+        char source[PATH_MAX], target[PATH_MAX];
+        struct stat info;
+        snprintf(source, sizeof(source), "%s/%s", from, entry->d_name);
+        snprintf(target, sizeof(target), "%s/%s", to, entry->d_name);
+        if (stat(source, &info) != 0 || !S_ISREG(info.st_mode)) continue;
+
+        int in = open(source, O_RDONLY);
+        int out = open(target, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        ssize_t got;
+        ok = in >= 0 && out >= 0;
+        while (ok && (got = read(in, buffer, sizeof(buffer))) > 0) {
+            ok = write(out, buffer, (size_t)got) == got;
+        }
+        if (in >= 0) close(in);
+        if (out >= 0) close(out);
+    }
+    closedir(dir);
+    return ok;
+}
+
+// Function to remove the files a run left in a scratch folder (the folder itself is kept)
+static void clearFolder(const char *folder) {
+    DIR *dir = opendir(folder);
+    if (!dir) return;
+    struct dirent *entry;
+    while ((entry = readdir(dir))) {
+        char path[PATH_MAX];
+        snprintf(path, sizeof(path), "%s/%s", folder, entry->d_name);
+        struct stat info;
+        if (stat(path, &info) == 0 && S_ISREG(info.st_mode)) remove(path);
+    }
+    closedir(dir);
+}
+
+// Function to find the values the scripts need in a generated data folder
+static int findScenarioData(const char *folder, struct ScenarioData *data) {
+    char busPath[MAX_IMPORT_PATH], seatPath[MAX_IMPORT_PATH], reservationPath[MAX_IMPORT_PATH];
+    snprintf(busPath, sizeof(busPath), "%s/buses.txt", folder);
+    snprintf(seatPath, sizeof(seatPath), "%s/seats.txt", folder);
+    snprintf(reservationPath, sizeof(reservationPath), "%s/reservation.txt", folder);
+
+    struct RecordReader busReader, seatReader, reservationReader;
+    struct StringView busLine, seatLine, line;
+    struct BusRecord bus;
+    struct SeatRecord seatRecord;
+    struct ReservationRecord record;
+    int seats[MAX_SEATS];
+
+    // seats.txt lines follow buses.txt lines, so both are read side by side
+    data->bookingBusID = 0;
+    if (!openRecordReader(&busReader, busPath) || !openRecordReader(&seatReader, seatPath)) return 0;
+    while (!data->bookingBusID && readRecordLine(&busReader, &busLine) && readRecordLine(&seatReader, &seatLine)) {
+        if (!parseBusRecord(busLine, &bus) || !parseSeatRecord(seatLine, &seatRecord, seats, MAX_SEATS)) continue;
+        if (seatRecord.reservedCount >= bus.totalSeats) continue;
+
+        for (int seat = 1; seat <= bus.totalSeats && !data->bookingBusID; seat++) {
+            int taken = 0;
+            for (int i = 0; i < seatRecord.reservedCount; i++) taken |= seats[i] == seat;
+            if (!taken) {
+                data->bookingBusID = bus.busID;
+                data->bookingSeat = seat;
+                copyView(bus.source, data->source, sizeof(data->source));
+                copyView(bus.destination, data->destination, sizeof(data->destination));
+            }
+        }
+    }
+    closeRecordReader(&busReader);
+    closeRecordReader(&seatReader);
+
+    data->cancelTicket = 0;
+    if (!openRecordReader(&reservationReader, reservationPath)) return 0;
+    while (!data->cancelTicket && readRecordLine(&reservationReader, &line)) {
+        if (parseReservationRecord(line, &record) && viewEquals(record.username, BENCHMARK_USER)) {
+            data->cancelTicket = record.ticketNumber;
+        }
+    }
+    closeRecordReader(&reservationReader);
+    return data->bookingBusID && data->cancelTicket;
+}
+
+// Function to write a scenario's input with the placeholders filled in
+static int writeScript(const struct Scenario *scenario, const struct ScenarioData *data, const char *path) {
+    FILE *file = fopen(path, "w");
+    if (!file) return 0;
+    if (strcmp(scenario->name, "search") == 0) {
+        fprintf(file, scenario->script, data->source, data->destination);
+    } else if (strcmp(scenario->name, "booking") == 0) {
+        fprintf(file, scenario->script, data->bookingBusID, data->bookingSeat);
+    } else if (strcmp(scenario->name, "cancellation") == 0) {
+        fprintf(file, scenario->script, data->cancelTicket);
+    } else {
+        fputs(scenario->script, file);
+    }
+    return fclose(file) == 0;
+}
+
+// Function to order run times for the median
+static int compareTimes(const void *a, const void *b) {
+    double left = *(const double *)a, right = *(const double *)b;
+    return (left > right) - (left < right);
+}
+
+// Function to time one scenario several times on fresh copies of the data and print its JSON entry
+static void benchmarkScenario(char *program, const char *dataFolder, const char *workFolder,
+                              const struct Scenario *scenario, const struct ScenarioData *data, int runs, int last) {
+    char scriptPath[MAX_IMPORT_PATH];
+    snprintf(scriptPath, sizeof(scriptPath), "%s/%s.in", BENCHMARK_FOLDER, scenario->name);
+    double times[MAX_BENCHMARK_RUNS];
+    int ok = writeScript(scenario, data, scriptPath);
+
+    for (int run = 0; ok && run < runs; run++) {
+        clearFolder(workFolder);
+        ok = copyFolder(dataFolder, workFolder);
+
+        char *argv[] = { program, NULL };
+        double start = nowSeconds();
+        ok = ok && runProgram(argv, workFolder, scriptPath) == 0;
+        times[run] = nowSeconds() - start;
+    }
+
+    printf("        \"%s\": ", scenario->name);
+    if (!ok) {
+        printf("{ \"ok\": false }%s\n", last ? "" : ",");
+        fprintf(stderr, "  %s: failed\n", scenario->name);
+        return;
+    }
+    qsort(times, (size_t)runs, sizeof(double), compareTimes);
+    printf("{ \"ok\": true, \"median_ms\": %.3f, \"min_ms\": %.3f, \"max_ms\": %.3f }%s\n",
+           times[runs / 2] * 1000, times[0] * 1000, times[runs - 1] * 1000, last ? "" : ",");
+    fprintf(stderr, "  %s: %.3f ms\n", scenario->name, times[runs / 2] * 1000);
+}
+
+int main(int argc, char *argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <bus_reservation> <data_generator> [runs] [reservations...]\n", argv[0]);
+        return 1;
+    }
+
+    // The program is run from inside the data folders, so it needs absolute paths
+    char program[PATH_MAX], generator[PATH_MAX];
+    if (!realpath(argv[1], program) || !realpath(argv[2], generator)) {
+        fprintf(stderr, "Error: Could not find %s or %s\n", argv[1], argv[2]);
+        return 1;
+    }
+    int runs = argc > 3 ? atoi(argv[3]) : DEFAULT_BENCHMARK_RUNS;
+    if (runs < 1 || runs > MAX_BENCHMARK_RUNS) {
+        fprintf(stderr, "Error: Runs must be between 1 and %d.\n", MAX_BENCHMARK_RUNS);
+        return 1;
+    }
+    int scaleCount = argc > 4 ? argc - 4 : (int)(sizeof(defaultScales) / sizeof(defaultScales[0]));
+
+    mkdir(BENCHMARK_FOLDER, 0755);
+    printf("{\n  \"benchmark\": \"system\",\n  \"runs\": %d,\n  \"scales\": [\n", runs);
+
+    for (int s = 0; s < scaleCount; s++) {
+        long reservations = argc > 4 ? atol(argv[4 + s]) : defaultScales[s];
+        char dataFolder[MAX_IMPORT_PATH], workFolder[MAX_IMPORT_PATH], count[32];
+        snprintf(dataFolder, sizeof(dataFolder), BENCHMARK_FOLDER "/data_%ld", reservations);
+        snprintf(workFolder, sizeof(workFolder), BENCHMARK_FOLDER "/work");
+        snprintf(count, sizeof(count), "%ld", reservations);
+        fprintf(stderr, "Scale %ld reservations\n", reservations);
+
+        // Generate the data once per scale; every run starts from a copy of it
+        char *generatorArgs[] = { generator, dataFolder, count, NULL };
+        double start = nowSeconds();
+        int generated = runProgram(generatorArgs, NULL, NULL) == 0;
+        double generateTime = nowSeconds() - start;
+
+        struct ScenarioData data;
+        printf("    {\n      \"reservations\": %ld,\n", reservations);
+        if (!generated || !findScenarioData(dataFolder, &data)) {
+            printf("      \"ok\": false\n    }%s\n", s == scaleCount - 1 ? "" : ",");
+            fprintf(stderr, "  Could not generate usable data in %s\n", dataFolder);
+            continue;
+        }
+        printf("      \"generate_ms\": %.3f,\n      \"scenarios\": {\n", generateTime * 1000);
+
+        for (int i = 0; i < SCENARIO_COUNT; i++) {
+            benchmarkScenario(program, dataFolder, workFolder, &scenarios[i], &data, runs, i == SCENARIO_COUNT - 1);
+        }
+        printf("      }\n    }%s\n", s == scaleCount - 1 ? "" : ",");
+        fflush(stdout);
+    }
+
+    printf("  ]\n}\n");
+    return 0;
+}
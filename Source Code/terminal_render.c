@@ -0,0 +1,83 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "bus_reservation.h"
+
+#define SEAT_RESERVED_COLOR "\033[0;31m"  // Red
+#define SEAT_AVAILABLE_COLOR "\033[0;32m" // Green
+#define SEAT_COLOR_DIGIT 5                // Index of the digit that tells the two colors apart
+
+// Skeleton of a seat map with every seat available, built once per seat count
+struct SeatMapSkeleton {
+    char *text;                         // Whole map, ready to copy into a frame
+    size_t length;                      // Bytes in text
+    int colorOffsets[MAX_SEATS];        // Position of each seat's color digit in text
+};
+
+static struct OutputBuffer frame;                           // Reused for every frame
+static struct SeatMapSkeleton seatMaps[MAX_SEATS + 1];      // Indexed by total seats
+
+// Function to start a new frame; everything for one screen is appended to the returned buffer
+struct OutputBuffer *beginFrame() {
+    frame.length = 0;
+    return &frame;
+}
+
+// Function to send the frame built so far to the terminal in one write and empty it.
+// Long tables may call it part-way to keep the buffer small.
+void emitFrame() {
+    fflush(stdout); // Anything printf'd before must come out first
+    flushOutput(&frame, STDOUT_FILENO);
+}
+
+// Function to build the seat map of a bus with the given number of seats, all shown as available
+static int buildSeatMapSkeleton(struct SeatMapSkeleton *map, int totalSeats) {
+    struct OutputBuffer text = {0};
+    appendOutput(&text, "\nSeats Layout (Available in Green, Reserved in Red):\n");
+
+    for (int i = 0; i < totalSeats; i++) {
+        map->colorOffsets[i] = (int)text.length + SEAT_COLOR_DIGIT;
+        appendOutput(&text, SEAT_AVAILABLE_COLOR "[%2d]\033[0m ", i + 1);
+
+        // Extra spacing to visually separate seat sections
+        if ((i + 1) % (SEATS_PER_ROW / 2) == 0) {
+            appendOutput(&text, "   ");
+        }
+
+        // Move to the next line after every SEATS_PER_ROW seats
+        if ((i + 1) % SEATS_PER_ROW == 0) {
+            appendOutput(&text, "\n");
+        }
+    }
+    if (!appendOutput(&text, "\n")) {
+        freeOutput(&text);
+        return 0;
+    }
+
+    map->text = text.data;
+    map->length = text.length;
+    return 1;
+}
+
+// Function to add a bus's seat map to a frame. The layout only depends on the seat count,
+// so it is built once per count and only the colors of the reserved seats are changed.
+void appendSeatMap(struct OutputBuffer *out, int totalSeats, const int reservedSeats[], int reservedCount) {
+    if (totalSeats < 0) totalSeats = 0;
+    if (totalSeats > MAX_SEATS) totalSeats = MAX_SEATS;
+
+    struct SeatMapSkeleton *map = &seatMaps[totalSeats];
+    if (!map->text && !buildSeatMapSkeleton(map, totalSeats)) return;
+
+    size_t start = out->length;
+    if (!appendOutput(out, "%.*s", (int)map->length, map->text)) return;
+
+    // Turn the reserved seats red in the copy
+    char reservedDigit = SEAT_RESERVED_COLOR[SEAT_COLOR_DIGIT];
+    for (int i = 0; i < reservedCount; i++) {
+        int seat = reservedSeats[i];
+        if (seat >= 1 && seat <= totalSeats) {
+            out->data[start + map->colorOffsets[seat - 1]] = reservedDigit;
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+#define EMPTY_TICKET_SLOT -1       // Hash slot that holds no entry
+#define FIRST_TICKET_SLOTS 1024    // Hash table size before the first growth
+
+// Function to find a ticket's home slot; ticket numbers are close together, so they are mixed first
+static int ticketHome(const struct TicketIndex *index, int ticketNumber) {
+    unsigned int hash = (unsigned int)ticketNumber * 2654435761u; // Knuth's multiplicative hash
+    return (int)(hash & (unsigned int)(index->slotCapacity - 1));
+}
+
+// Function to find the slot holding a ticket, or the empty slot where it belongs
+static int findTicketSlot(const struct TicketIndex *index, int ticketNumber) {
+    int mask = index->slotCapacity - 1;
+    for (int slot = ticketHome(index, ticketNumber);; slot = (slot + 1) & mask) {
+        int position = index->slots[slot];
+        if (position == EMPTY_TICKET_SLOT || index->entries[position].ticketNumber == ticketNumber) {
+            return slot;
+        }
+    }
+}
+
+// Function to double the hash table once it is half full (or create it)
+static int growTicketSlots(struct TicketIndex *index) {
+    int capacity = index->slotCapacity ? index->slotCapacity * 2 : FIRST_TICKET_SLOTS;
+    int *slots = malloc((size_t)capacity * sizeof(*slots));
+    if (!slots) return 0;
+
+    free(index->slots);
+    index->slots = slots;
+    index->slotCapacity = capacity;
+    for (int i = 0; i < capacity; i++) slots[i] = EMPTY_TICKET_SLOT;
+    for (int i = 0; i < index->count; i++) {
+        slots[findTicketSlot(index, index->entries[i].ticketNumber)] = i;
+    }
+    return 1;
+}
+
+// Function to make room for more entries or seat numbers in one of the packed arrays
+static int reserveTicketArray(void **array, int *capacity, int needed, size_t elementSize) {
+    if (needed <= *capacity) return 1;
+    int grown = *capacity ? *capacity : 256;
+    while (grown < needed) grown *= 2;
+    void *larger = realloc(*array, (size_t)grown * elementSize);
+    if (!larger) return 0;
+    *array = larger;
+    *capacity = grown;
+    return 1;
+}
+
+// Function to look up a reservation by ticket number without touching the file
+const struct TicketEntry *findTicket(const struct TicketIndex *index, int ticketNumber) {
+    if (index->count == 0) return NULL;
+    int position = index->slots[findTicketSlot(index, ticketNumber)];
+    return position == EMPTY_TICKET_SLOT ? NULL : &index->entries[position];
+}
+
+// Function to get the seat numbers of an entry
+const int *ticketSeats(const struct TicketIndex *index, const struct TicketEntry *entry) {
+    return index->seats + entry->firstSeat;
+}
+
+// Function to add a reservation. The first line with a ticket number wins, as in a file scan,
+// so a repeated number is ignored. Returns 0 if the ticket was already indexed or memory ran out.
+int addTicket(struct TicketIndex *index, int ticketNumber, int busID, struct StringView date,
+              const int seats[], int numSeats, money_t amount, long offset) {
+    if ((index->count + 1) * 2 > index->slotCapacity && !growTicketSlots(index)) return 0;
+
+    int slot = findTicketSlot(index, ticketNumber);
+    if (index->slots[slot] != EMPTY_TICKET_SLOT) return 0;
+
+    if (!reserveTicketArray((void **)&index->entries, &index->capacity, index->count + 1, sizeof(struct TicketEntry)) ||
+        !reserveTicketArray((void **)&index->seats, &index->seatCapacity, index->seatCount + numSeats, sizeof(int))) {
+        return 0;
+    }
+
+    struct TicketEntry *entry = &index->entries[index->count];
+    entry->ticketNumber = ticketNumber;
+    entry->busID = busID;
+    entry->offset = offset;
+    entry->amount = amount;
+    entry->firstSeat = index->seatCount;
+    entry->numSeats = numSeats;
+    copyView(date, entry->date, sizeof(entry->date));
+    memcpy(index->seats + index->seatCount, seats, (size_t)numSeats * sizeof(int));
+    index->seatCount += numSeats;
+
+    index->slots[slot] = index->count++;
+    return 1;
+}
+
+// Function to remove a reservation. Later entries in the probe run are shifted back so lookups
+// never stop early, and the last packed entry moves into the gap. Its seat numbers stay in the
+// pool until the index is rebuilt.
+int removeTicket(struct TicketIndex *index, int ticketNumber) {
+    if (index->count == 0) return 0;
+    int slot = findTicketSlot(index, ticketNumber);
+    int position = index->slots[slot];
+    if (position == EMPTY_TICKET_SLOT) return 0;
+
+    // Backward-shift deletion for linear probing
+    int mask = index->slotCapacity - 1;
+    for (int next = (slot + 1) & mask; index->slots[next] != EMPTY_TICKET_SLOT; next = (next + 1) & mask) {
+        int home = ticketHome(index, index->entries[index->slots[next]].ticketNumber);
+        // Leave the entry if its home lies cyclically after the gap, up to where it is now
+        int stays = slot <= next ? (home > slot && home <= next) : (home > slot || home <= next);
+        if (!stays) {
+            index->slots[slot] = index->slots[next];
+            slot = next;
+        }
+    }
+    index->slots[slot] = EMPTY_TICKET_SLOT;
+
+    // Keep the entries packed
+    int last = --index->count;
+    if (position != last) {
+        index->entries[position] = index->entries[last];
+        index->slots[findTicketSlot(index, index->entries[position].ticketNumber)] = position;
+    }
+    return 1;
+}
+
+// Function to move the file offsets of every line after a removed one
+void shiftTicketOffsets(struct TicketIndex *index, long after, long delta) {
+    for (int i = 0; i < index->count; i++) {
+        if (index->entries[i].offset > after) index->entries[i].offset += delta;
+    }
+}
+
+// Function to empty the index, keeping its memory for the rebuild that follows
+void clearTicketIndex(struct TicketIndex *index) {
+    index->count = 0;
+    index->seatCount = 0;
+    for (int i = 0; i < index->slotCapacity; i++) index->slots[i] = EMPTY_TICKET_SLOT;
+}
+
+// Function to fill the index from packed entries and seat numbers, such as those kept in a
+// snapshot. The arrays are copied as they are and only the hash table is rebuilt over them.
+// Returns 0 when out of memory, leaving the index empty.
+int restoreTicketIndex(struct TicketIndex *index, const struct TicketEntry entries[], int count,
+                       const int seats[], int seatCount) {
+    clearTicketIndex(index);
+    if (!reserveTicketArray((void **)&index->entries, &index->capacity, count, sizeof(struct TicketEntry)) ||
+        !reserveTicketArray((void **)&index->seats, &index->seatCapacity, seatCount, sizeof(int))) {
+        return 0;
+    }
+    if (count > 0) memcpy(index->entries, entries, (size_t)count * sizeof(struct TicketEntry));
+    if (seatCount > 0) memcpy(index->seats, seats, (size_t)seatCount * sizeof(int));
+    index->count = count;
+    index->seatCount = seatCount;
+
+    // Growing the table places every entry; a table already large enough is filled here
+    int grown = 0;
+    while (index->count * 2 > index->slotCapacity) {
+        if (!growTicketSlots(index)) {
+            clearTicketIndex(index);
+            return 0;
+        }
+        grown = 1;
+    }
+    for (int i = 0; !grown && i < index->count; i++) {
+        index->slots[findTicketSlot(index, index->entries[i].ticketNumber)] = i;
+    }
+    return 1;
+}
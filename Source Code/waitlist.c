@@ -0,0 +1,488 @@
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bus_reservation.h"
+
+#define NO_PARTY -1                 // End of a queue or hold list
+#define PARTY_WAITING 0             // In its trip's queue
+#define PARTY_HOLDING 1             // Promoted, seats held until holdUntil
+#define PARTY_DONE 2                // Hold used or expired
+
+// One party waiting for seats on a trip, or holding seats after being promoted
+struct WaitlistParty {
+    int reference;                        // Waitlist reference number, increasing in joining order
+    int busID;                            // Trip waited for
+    char username[WAITLIST_NAME_LENGTH];  // Customer waiting
+    int partySize;                        // Seats wanted
+    int state;                            // PARTY_WAITING, PARTY_HOLDING or PARTY_DONE
+    long long holdUntil;                  // When held seats go back on sale (time() seconds)
+    int next;                             // Next party in the same queue or hold list
+};
+
+// Waiting parties and holds of one trip. Parties wait in one FIFO queue per party size, so the
+// oldest party of any size, or the largest party that fits, is found without walking the queues.
+struct WaitlistTrip {
+    int busID;                            // Trip the queues belong to
+    int heads[MAX_SEATS + 1];             // Oldest waiting party of each party size
+    int tails[MAX_SEATS + 1];             // Newest waiting party of each party size
+    unsigned long long waitingSizes;      // Bit n set = a party of n seats is waiting
+    int holds;                            // Parties holding seats, linked through next
+    int heldSeats;                        // Seats those parties hold
+};
+
+static struct WaitlistParty *parties = NULL;  // Every party in waitlist.txt, in joining order
+static int partyCount = 0;
+static int partyCapacity = 0;
+static struct WaitlistTrip *trips = NULL;     // Trips with anyone waiting or holding, sorted by bus ID
+static int tripCount = 0;
+static int tripCapacity = 0;
+static int *memberSlots = NULL;               // Hash table of party positions by trip and customer (-1 = empty)
+static int memberSlotCount = 0;               // A power of two
+static int memberCount = 0;                   // Positions added since the table was last rebuilt
+static long long nextHoldExpiry = LLONG_MAX;  // Earliest time a hold runs out, or LLONG_MAX if none might
+static int nextReference = 1;                 // Reference number of the next party to join
+static int finishedLines = 0;                 // Lines in waitlist.txt for parties that are done
+
+// Function to find where a trip's queues are, or would go, in the sorted trip list
+static int findTripPosition(int busID) {
+    int low = 0, high = tripCount;
+    while (low < high) {
+        int middle = (low + high) / 2;
+        if (trips[middle].busID < busID) low = middle + 1;
+        else high = middle;
+    }
+    return low;
+}
+
+// Function to find a trip's queues, creating them if asked
+static struct WaitlistTrip *findWaitlistTrip(int busID, int create) {
+    int position = findTripPosition(busID);
+    if (position < tripCount && trips[position].busID == busID) return &trips[position];
+    if (!create) return NULL;
+
+    if (tripCount == tripCapacity) {
+        int capacity = tripCapacity ? tripCapacity * 2 : 16;
+        struct WaitlistTrip *grown = realloc(trips, (size_t)capacity * sizeof(*grown));
+        if (!grown) return NULL;
+        trips = grown;
+        tripCapacity = capacity;
+    }
+    memmove(&trips[position + 1], &trips[position], (size_t)(tripCount - position) * sizeof(*trips));
+    tripCount++;
+    struct WaitlistTrip *trip = &trips[position];
+    trip->busID = busID;
+    for (int size = 0; size <= MAX_SEATS; size++) {
+        trip->heads[size] = NO_PARTY;
+        trip->tails[size] = NO_PARTY;
+    }
+    trip->waitingSizes = 0;
+    trip->holds = NO_PARTY;
+    trip->heldSeats = 0;
+    return trip;
+}
+
+// Function to hash a trip and customer for the member table
+static unsigned int hashMember(int busID, const char *username) {
+    unsigned int hash = 2166136261u ^ (unsigned int)busID; // FNV-1a, seeded with the bus ID
+    for (const char *c = username; *c; c++) {
+        hash = (hash ^ (unsigned char)*c) * 16777619u;
+    }
+    return hash;
+}
+
+// Function to find the party a customer is waiting or holding seats as on a trip, or NO_PARTY.
+// Finished parties stay in the table until it is rebuilt, so they are probed past.
+static int findMember(int busID, const char *username) {
+    if (memberSlotCount == 0) return NO_PARTY;
+    unsigned int mask = (unsigned int)memberSlotCount - 1;
+    for (unsigned int slot = hashMember(busID, username) & mask; memberSlots[slot] != NO_PARTY; slot = (slot + 1) & mask) {
+        const struct WaitlistParty *party = &parties[memberSlots[slot]];
+        if (party->busID == busID && party->state != PARTY_DONE && strcmp(party->username, username) == 0) {
+            return memberSlots[slot];
+        }
+    }
+    return NO_PARTY;
+}
+
+// Function to put a party's position in the member table, rebuilding the table with only the
+// parties still waiting or holding once it is half full. Returns 0 if memory ran out.
+static int addMember(int index) {
+    if ((memberCount + 1) * 2 > memberSlotCount) {
+        int live = 0;
+        for (int i = 0; i < partyCount; i++) {
+            if (parties[i].state != PARTY_DONE && i != index) live++;
+        }
+        int slotCount = 16;
+        while (slotCount < (live + 1) * 4) slotCount *= 2;
+        int *slots = malloc((size_t)slotCount * sizeof(int));
+        if (!slots) return 0;
+        for (int i = 0; i < slotCount; i++) slots[i] = NO_PARTY;
+        free(memberSlots);
+        memberSlots = slots;
+        memberSlotCount = slotCount;
+        memberCount = 0;
+        for (int i = 0; i < partyCount; i++) {
+            if (parties[i].state != PARTY_DONE && i != index) addMember(i);
+        }
+    }
+
+    unsigned int mask = (unsigned int)memberSlotCount - 1;
+    unsigned int slot = hashMember(parties[index].busID, parties[index].username) & mask;
+    while (memberSlots[slot] != NO_PARTY) slot = (slot + 1) & mask;
+    memberSlots[slot] = index;
+    memberCount++;
+    return 1;
+}
+
+// Function to find a party by reference number; parties are kept in reference order
+static struct WaitlistParty *findParty(int reference) {
+    int low = 0, high = partyCount - 1;
+    while (low <= high) {
+        int middle = (low + high) / 2;
+        if (parties[middle].reference == reference) return &parties[middle];
+        if (parties[middle].reference < reference) low = middle + 1;
+        else high = middle - 1;
+    }
+    return NULL;
+}
+
+// Function to add a party at the back of its size's queue
+static void enqueueParty(struct WaitlistTrip *trip, int index) {
+    int size = parties[index].partySize;
+    parties[index].next = NO_PARTY;
+    if (trip->tails[size] == NO_PARTY) {
+        trip->heads[size] = index;
+    } else {
+        parties[trip->tails[size]].next = index;
+    }
+    trip->tails[size] = index;
+    trip->waitingSizes |= 1ULL << size;
+}
+
+// Function to take the oldest party of one size off the queue
+static int dequeueParty(struct WaitlistTrip *trip, int size) {
+    int index = trip->heads[size];
+    trip->heads[size] = parties[index].next;
+    if (trip->heads[size] == NO_PARTY) {
+        trip->tails[size] = NO_PARTY;
+        trip->waitingSizes &= ~(1ULL << size);
+    }
+    return index;
+}
+
+// Function to add a party to the trip's holds
+static void addHold(struct WaitlistTrip *trip, int index) {
+    parties[index].next = trip->holds;
+    trip->holds = index;
+    trip->heldSeats += parties[index].partySize;
+    if (parties[index].holdUntil < nextHoldExpiry) nextHoldExpiry = parties[index].holdUntil;
+}
+
+// Function to append one event line to waitlist.txt and put it on disk
+static int appendWaitlistLine(const char *line) {
+    FILE *file = fopen(WAITLIST_FILE, "a");
+    if (!file) {
+        printf("Error: Could not open %s for writing.\n", WAITLIST_FILE);
+        return 0;
+    }
+    fputs(line, file);
+    return syncAndCloseFile(file);
+}
+
+// Function to record that a party is done, with its hold used or expired
+static void finishParty(struct WaitlistParty *party) {
+    char line[32];
+    party->state = PARTY_DONE;
+    snprintf(line, sizeof(line), "D,%d\n", party->reference);
+    appendWaitlistLine(line);
+    finishedLines += 3; // Its join, hold and done lines
+}
+
+// Function to release the holds whose time has run out. Returns the number released; their
+// seats are free again, so the caller offers them on to the waitlist.
+static int expireHolds(struct WaitlistTrip *trip, long long now) {
+    int expired = 0;
+    int *link = &trip->holds;
+    while (*link != NO_PARTY) {
+        struct WaitlistParty *party = &parties[*link];
+        if (party->holdUntil > now) {
+            link = &party->next;
+            continue;
+        }
+        *link = party->next; // Unlink, then give the seats back
+        trip->heldSeats -= party->partySize;
+        finishParty(party);
+        expired++;
+    }
+    return expired;
+}
+
+// Function to choose the party size to promote next with freeSeats seats to offer, or 0 if none fits.
+// FIFO takes the party that joined first among those that fit; best-fit takes the largest that fits.
+static int choosePartySize(const struct WaitlistTrip *trip, int freeSeats, int policy) {
+    unsigned long long fits = freeSeats >= MAX_SEATS ? trip->waitingSizes
+                                                     : trip->waitingSizes & ((2ULL << freeSeats) - 1);
+    if (fits == 0) return 0;
+    if (policy == WAITLIST_BEST_FIT) return 63 - __builtin_clzll(fits);
+
+    int chosen = 0;
+    for (unsigned long long rest = fits; rest; rest &= rest - 1) {
+        int size = __builtin_ctzll(rest);
+        if (!chosen || parties[trip->heads[size]].reference < parties[trip->heads[chosen]].reference) {
+            chosen = size;
+        }
+    }
+    return chosen;
+}
+
+// Function to add a party to the in-memory list, keeping reference order
+static int addParty(int reference, int busID, struct StringView username, int partySize) {
+    if (partyCount == partyCapacity) {
+        int capacity = partyCapacity ? partyCapacity * 2 : 256;
+        struct WaitlistParty *grown = realloc(parties, (size_t)capacity * sizeof(*grown));
+        if (!grown) return NO_PARTY;
+        parties = grown;
+        partyCapacity = capacity;
+    }
+    struct WaitlistParty *party = &parties[partyCount];
+    party->reference = reference;
+    party->busID = busID;
+    copyView(username, party->username, sizeof(party->username));
+    party->partySize = partySize;
+    party->state = PARTY_WAITING;
+    party->holdUntil = 0;
+    party->next = NO_PARTY;
+    if (reference >= nextReference) nextReference = reference + 1;
+    return partyCount++;
+}
+
+// Function to rewrite waitlist.txt with only the parties still waiting or holding
+static void compactWaitlist() {
+    struct DurableFile out;
+    FILE *file = beginDurableWrite(&out, WAITLIST_FILE, 0);
+    if (!file) return;
+
+    for (int i = 0; i < partyCount; i++) {
+        const struct WaitlistParty *party = &parties[i];
+        if (party->state == PARTY_DONE) continue;
+        fprintf(file, "J,%d,%d,%s,%d\n", party->reference, party->busID, party->username, party->partySize);
+        if (party->state == PARTY_HOLDING) {
+            fprintf(file, "H,%d,%lld\n", party->reference, party->holdUntil);
+        }
+    }
+    if (ferror(file)) {
+        abortDurableWrite(&out);
+        return;
+    }
+    if (commitDurableWrite(&out)) finishedLines = 0;
+}
+
+// Function to load the waitlist by replaying waitlist.txt.
+// Format, one event per line: J,reference,busID,username,partySize (joined),
+// H,reference,holdUntil (promoted and holding seats), S,reference,seatsStillHeld (hold partly used)
+// and D,reference (hold used or expired).
+int loadWaitlist() {
+    struct RecordReader reader;
+    if (!openRecordReader(&reader, WAITLIST_FILE)) return 0; // Nobody has waited yet
+
+    struct StringView line;
+    struct StringView fields[6];
+    int lines = 0;
+    while (readRecordLine(&reader, &line)) {
+        int count = splitRecordFields(line, ',', fields, 6);
+        int reference, busID, partySize;
+        long long holdUntil;
+        struct WaitlistParty *party;
+        lines++;
+        if (count == 5 && viewEquals(fields[0], "J") && parseIntView(fields[1], &reference) &&
+            parseIntView(fields[2], &busID) && parseIntView(fields[4], &partySize) &&
+            partySize >= 1 && partySize <= MAX_SEATS && reference >= nextReference) {
+            addParty(reference, busID, fields[3], partySize);
+        } else if (count == 3 && viewEquals(fields[0], "H") && parseIntView(fields[1], &reference) &&
+                   parseLongView(fields[2], &holdUntil) && (party = findParty(reference)) != NULL) {
+            party->state = PARTY_HOLDING;
+            party->holdUntil = holdUntil;
+        } else if (count == 3 && viewEquals(fields[0], "S") && parseIntView(fields[1], &reference) &&
+                   parseIntView(fields[2], &partySize) && partySize >= 1 && partySize <= MAX_SEATS &&
+                   (party = findParty(reference)) != NULL) {
+            party->partySize = partySize;
+        } else if (count == 2 && viewEquals(fields[0], "D") && parseIntView(fields[1], &reference) &&
+                   (party = findParty(reference)) != NULL) {
+            party->state = PARTY_DONE;
+        }
+    }
+    closeRecordReader(&reader);
+
+    // Rebuild the queues in joining order
+    int live = 0;
+    for (int i = 0; i < partyCount; i++) {
+        if (parties[i].state == PARTY_DONE) continue;
+        struct WaitlistTrip *trip = findWaitlistTrip(parties[i].busID, 1);
+        if (!trip || !addMember(i)) break;
+        if (parties[i].state == PARTY_WAITING) enqueueParty(trip, i);
+        else addHold(trip, i);
+        live++;
+    }
+
+    // Drop the lines of finished parties once they outnumber the rest
+    finishedLines = lines - live;
+    if (finishedLines > live + WAITLIST_COMPACT_LINES) compactWaitlist();
+    return live;
+}
+
+// Function to put a party on a trip's waitlist. Returns its reference number, or 0 if it cannot join.
+int joinWaitlist(int busID, const char *username, int partySize) {
+    if (partySize < 1 || partySize > MAX_SEATS) return 0;
+
+    // A customer waits once per trip; joining again keeps their place
+    int member = findMember(busID, username);
+    if (member != NO_PARTY) return parties[member].reference;
+
+    struct WaitlistTrip *trip = findWaitlistTrip(busID, 1);
+    struct StringView name = { username, (int)strlen(username) };
+    int index = trip ? addParty(nextReference, busID, name, partySize) : NO_PARTY;
+    if (index == NO_PARTY) return 0;
+
+    char line[128];
+    snprintf(line, sizeof(line), "J,%d,%d,%s,%d\n", parties[index].reference, busID, parties[index].username, partySize);
+    if (!appendWaitlistLine(line)) {
+        partyCount--; // Not on disk, so not on the list either
+        return 0;
+    }
+    enqueueParty(trip, index);
+    addMember(index); // Without room in the table a second join is only not recognised
+    return parties[index].reference;
+}
+
+// Function to offer a trip's free seats to its waitlist. Seats not held for anyone are handed
+// to waiting parties in the order of the policy; each promoted party holds its seats for
+// WAITLIST_HOLD_MINUTES. Returns the number of parties promoted, described in promoted[].
+int promoteWaitlist(int busID, int availableSeats, int policy, long long now,
+                    struct WaitlistPromotion promoted[], int maxPromoted) {
+    struct WaitlistTrip *trip = findWaitlistTrip(busID, 0);
+    if (!trip) return 0;
+    expireHolds(trip, now);
+
+    int freeSeats = availableSeats - trip->heldSeats;
+    int count = 0;
+    while (count < maxPromoted && freeSeats > 0) {
+        int size = choosePartySize(trip, freeSeats, policy);
+        if (size == 0) break; // Nobody waiting fits in the seats left
+
+        int index = dequeueParty(trip, size);
+        struct WaitlistParty *party = &parties[index];
+        party->state = PARTY_HOLDING;
+        party->holdUntil = now + WAITLIST_HOLD_MINUTES * 60LL;
+        addHold(trip, index);
+        freeSeats -= size;
+
+        char line[64];
+        snprintf(line, sizeof(line), "H,%d,%lld\n", party->reference, party->holdUntil);
+        appendWaitlistLine(line);
+
+        promoted[count].reference = party->reference;
+        snprintf(promoted[count].username, sizeof(promoted[count].username), "%s", party->username);
+        promoted[count].partySize = party->partySize;
+        promoted[count].holdUntil = party->holdUntil;
+        count++;
+    }
+    return count;
+}
+
+// Function to count the seats of a trip held for customers other than the given one. Holds that
+// have run out are not counted; they are released by promoteWaitlist, which offers their seats on.
+int heldSeatsForOthers(int busID, const char *username, long long now) {
+    struct WaitlistTrip *trip = findWaitlistTrip(busID, 0);
+    if (!trip) return 0;
+
+    int held = 0;
+    for (int index = trip->holds; index != NO_PARTY; index = parties[index].next) {
+        if (parties[index].holdUntil > now && strcmp(parties[index].username, username) != 0) {
+            held += parties[index].partySize;
+        }
+    }
+    return held;
+}
+
+// Function to list the trips with holds that have run out, so their seats can be offered to the
+// next waiting parties through promoteWaitlist. Nothing is scanned until the earliest hold runs out.
+// Returns the number of bus IDs written to busIDs[]; call again while it fills the array.
+int expiredHoldTrips(long long now, int busIDs[], int maxTrips) {
+    if (now < nextHoldExpiry) return 0;
+
+    int count = 0;
+    long long earliest = LLONG_MAX;
+    for (int i = 0; i < tripCount; i++) {
+        for (int index = trips[i].holds; index != NO_PARTY; index = parties[index].next) {
+            if (parties[index].holdUntil <= now && count < maxTrips &&
+                (count == 0 || busIDs[count - 1] != trips[i].busID)) {
+                busIDs[count++] = trips[i].busID;
+            }
+            if (parties[index].holdUntil < earliest) earliest = parties[index].holdUntil;
+        }
+    }
+    nextHoldExpiry = earliest; // Still due if some trips did not fit in busIDs[]
+    return count;
+}
+
+// Function to use a customer's hold on a trip once they have paid for seats on it. A hold is only
+// used for the seats booked: a smaller booking leaves the rest of it held until it runs out.
+// Returns the held seats used.
+int takeHold(int busID, const char *username, int bookedSeats) {
+    struct WaitlistTrip *trip = findWaitlistTrip(busID, 0);
+    if (!trip) return 0;
+
+    int taken = 0;
+    int *link = &trip->holds;
+    while (*link != NO_PARTY && taken < bookedSeats) {
+        struct WaitlistParty *party = &parties[*link];
+        if (strcmp(party->username, username) != 0) {
+            link = &party->next;
+            continue;
+        }
+        int used = bookedSeats - taken;
+        if (used < party->partySize) { // Part of the hold is used; the party keeps the rest
+            char line[64];
+            party->partySize -= used;
+            trip->heldSeats -= used;
+            taken += used;
+            snprintf(line, sizeof(line), "S,%d,%d\n", party->reference, party->partySize);
+            appendWaitlistLine(line);
+            finishedLines++; // Replaces its earlier size
+            break;
+        }
+        *link = party->next;
+        trip->heldSeats -= party->partySize;
+        taken += party->partySize;
+        finishParty(party);
+    }
+    return taken;
+}
+
+// Function to end the waitlist of a trip that no longer runs, because it was deleted or purged.
+// Every party still waiting or holding seats on it is finished, so none is left behind for a new
+// trip that reuses the bus ID. Returns the number of parties finished.
+int closeWaitlist(int busID) {
+    int position = findTripPosition(busID);
+    if (position == tripCount || trips[position].busID != busID) return 0; // Nobody waiting or holding
+
+    // Walk the trip's own queues and holds
+    struct WaitlistTrip *trip = &trips[position];
+    int finished = 0;
+    for (int size = 1; size <= MAX_SEATS; size++) {
+        for (int index = trip->heads[size]; index != NO_PARTY; index = parties[index].next) {
+            finishParty(&parties[index]);
+            finished++;
+        }
+    }
+    for (int index = trip->holds; index != NO_PARTY; index = parties[index].next) {
+        finishParty(&parties[index]);
+        finished++;
+    }
+
+    // The trip's queues are empty now; the rest stay sorted
+    tripCount--;
+    memmove(&trips[position], &trips[position + 1], (size_t)(tripCount - position) * sizeof(*trips));
+    return finished;
+}
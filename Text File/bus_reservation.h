@@ -3,7 +3,562 @@
 
 #include <stdio.h>
 
-// Function prototype for printHeader
-void printBusHeader();
+#define MAX_BUSES 100             // Maximum number of buses in the system
+#define MAX_SEATS 50              // Maximum number of seats per bus
+
+// --- Money (money.c) ---
+typedef long long money_t;        // Amount of money in sen (1/100 ringgit), never a float
+#define SST_RATE_PERCENT 6        // Sales and Service Tax (SST) rate (6%)
+#define MONEY_TEXT_LENGTH 32      // Buffer size for a formatted amount such as "1234.50"
+
+money_t calculateSST(money_t baseFare); // SST on a base fare, rounded half up to the sen
+const char *formatMoney(money_t amount, char *buffer); // Format an amount as "123.45"
+int parseMoneyText(const char *text, money_t *amount); // Parse user or file text such as "30.5" into sen
+money_t sumMoney(const money_t amounts[], int count); // Exact sum of many amounts
+money_t averageMoney(money_t total, int count); // Average amount, rounded half up to the sen
+
+// --- Schedule Times (schedule_time.c) ---
+#define MINUTES_PER_DAY 1440      // Departure keys count minutes since 1970-01-01
+
+// One schedule in the departure index
+struct DepartureEntry {
+    int key;    // Departure day * MINUTES_PER_DAY + departure minute
+    int slot;   // Position of the schedule in the buses array
+};
+
+// Schedules sorted by departure time, for "next departures", purging and date-ordered reports
+struct DepartureIndex {
+    struct DepartureEntry entries[MAX_BUSES]; // Sorted by key, then slot
+    int count;                                // Number of indexed schedules
+};
+
+void buildDepartureIndex(struct DepartureIndex *index, const int keys[], int count); // Sort one key per slot into the index
+int findFirstDeparture(const struct DepartureIndex *index, int key); // Position of the first departure at or after key
+void insertDepartureEntry(struct DepartureIndex *index, int key, int slot); // Add a schedule, keeping the index sorted
+void removeDepartureEntry(struct DepartureIndex *index, int key, int slot); // Remove a schedule, keeping the index sorted
+int currentDepartureKey(); // Departure key of the current local time
+void formatDate(int epochDay, char *buffer); // Format a day number as YYYY-MM-DD
+void formatTime(int minutes, char *buffer); // Format minutes after midnight as HH:MMAM/PM
+
+
+#define RECORD_BLOCK_SIZE 65536   // Bytes read from disk in one block by the record reader
+#define MAX_RECORD_FIELDS 16      // Maximum number of comma-separated fields in one record
+
+// A non-owning view into a line held by a record reader (valid until the next line is read)
+struct StringView {
+    const char *data;   // First character of the field (not null-terminated)
+    int length;         // Number of characters in the field
+};
+
+// Streaming reader that hands out whole lines from large blocks of a file
+struct RecordReader {
+    FILE *file;                      // File being read
+    char block[RECORD_BLOCK_SIZE];   // Block buffer filled with fread
+    size_t start;                    // Offset of the first unread byte in the block
+    size_t end;                      // Offset one past the last valid byte in the block
+    long blockOffset;                // File offset of block[0]
+    long lineOffset;                 // File offset of the line most recently returned
+    int eof;                         // Set once fread reports the end of the file
+};
+
+// One line of reservation.txt or cancellations.txt
+// Format: username,ticketNumber,busID,busNumberPlate,date,numSeats,seat seat ...,amount
+struct ReservationRecord {
+    struct StringView username;        // Username of the passenger
+    int ticketNumber;                  // 6-digit ticket number
+    int busID;                         // Bus the booking belongs to
+    struct StringView busNumberPlate;  // Bus number plate
+    struct StringView date;            // Booking or cancellation date (YYYY-MM-DD)
+    int numSeats;                      // Number of seats in the booking
+    struct StringView seatList;        // Space-separated seat numbers
+    money_t amount;                    // Amount paid or refunded
+};
+
+// One line of buses.txt
+// Format: busID,plate,date,source,destination,departure,arrival,totalSeats,availableSeats,fare
+struct BusRecord {
+    int busID;                         // Unique identifier for the bus
+    struct StringView busNumberPlate;  // Bus number plate
+    struct StringView date;            // Date of travel
+    struct StringView source;          // Starting location
+    struct StringView destination;     // Destination location
+    struct StringView departureTime;   // Departure time
+    struct StringView arrivalTime;     // Arrival time
+    int totalSeats;                    // Total seats on the bus
+    int availableSeats;                // Seats still available
+    money_t fare;                      // Fare per seat
+};
+
+// One line of seats.txt
+// Format: busID,reservedCount,seat,seat,...
+struct SeatRecord {
+    int busID;          // Bus the seats belong to
+    int reservedCount;  // Number of reserved seats listed on the line
+};
+
+int openRecordReader(struct RecordReader *reader, const char *filename); // Open a file for block-wise line reading
+int attachRecordReader(struct RecordReader *reader, FILE *file); // Read lines from an already open stream
+void closeRecordReader(struct RecordReader *reader); // Close the reader's file
+int readRecordLine(struct RecordReader *reader, struct StringView *line); // Get the next line without copying it
+int seekRecordReader(struct RecordReader *reader, long offset); // Continue reading at a line's file offset
+int splitRecordFields(struct StringView line, char delimiter, struct StringView fields[], int maxFields); // Split a line into field views
+int parseIntView(struct StringView field, int *value); // Parse a decimal integer field
+int parseLongView(struct StringView field, long long *value); // Parse a decimal field wider than an int
+int parseAmountView(struct StringView field, money_t *amount); // Parse a fixed-point amount (e.g. "RM 63.60") into sen
+int parseSeatList(struct StringView field, char delimiter, int seats[], int maxSeats); // Parse a list of seat numbers
+void copyView(struct StringView field, char *destination, size_t size); // Copy a field into a null-terminated buffer
+int viewEquals(struct StringView field, const char *text); // Compare a field with a C string
+int viewContains(struct StringView field, const char *text); // Check if a field contains a substring
+int parseReservationRecord(struct StringView line, struct ReservationRecord *record); // Parse a reservation/cancellation line
+int parseBusRecord(struct StringView line, struct BusRecord *record); // Parse a buses.txt line
+int parseSeatRecord(struct StringView line, struct SeatRecord *record, int seats[], int maxSeats); // Parse a seats.txt line
+
+int parseDateView(struct StringView field, int *epochDay); // Parse and validate YYYY-MM-DD (schedule_time.c)
+int parseTimeView(struct StringView field, int *minutes); // Parse and validate HH:MMAM/PM or HH:MM (schedule_time.c)
+
+// --- String Interning (string_intern.c) ---
+typedef unsigned int string_id;   // Dense ID of an interned string, compared instead of the text
+#define NO_STRING 0               // ID of the empty string, held by cleared fields
+
+int reserveStrings(); // Set up the dictionary; called before anything is interned
+string_id internString(const char *text); // ID of a string, added on first use
+string_id internStringView(struct StringView text); // ID of a field, added on first use
+string_id findString(const char *text, int ignoreCase); // ID of known text, or NO_STRING; never adds it
+const char *stringText(string_id id); // Text of an ID
+string_id foldedString(string_id id); // ID shared by every spelling that differs only in case
+int compareStrings(string_id a, string_id b); // strcmp() order of two IDs
+int internedStringCount(); // IDs handed out so far
+long exportInternedStrings(char **pool); // Every string in ID order, for the snapshot image
+int importInternedStrings(const char *pool, long size); // Restore exported strings with their IDs
+
+// --- Request Arena (request_arena.c) ---
+// Scratch memory for one menu command: booking, cancellation and report state is carved out of
+// it and dropped all at once when the command completes, instead of being malloc'd and freed.
+// Each thread gets its own arena, but that alone does not make a request thread-safe: the
+// buses, waitlist, ticket index and string dictionary are shared globals with no locking, so
+// menu commands must keep running one at a time on the main thread.
+struct ArenaBlock;
+
+struct RequestArena {
+    struct ArenaBlock *first;       // First block, kept across requests
+    struct ArenaBlock *current;     // Block being handed out from
+};
+
+struct RequestArena *requestArena(); // Arena of the calling thread
+void *arenaAlloc(struct RequestArena *arena, size_t count, size_t size); // Memory until the next reset
+void resetArena(struct RequestArena *arena); // Drop everything handed out, in constant time
+
+// --- Recurring Schedules (schedule_template.c) ---
+#define MAX_TEMPLATES 100             // Maximum number of recurring schedule templates
+#define MAX_TEMPLATE_ID 899           // Largest template ID, keeps trip IDs within six digits
+#define MAX_TEMPLATE_DAYS 1000        // Longest validity range of one template, in days
+#define MAX_TEMPLATE_SEATS MAX_SEATS  // A template trip must fit the seat map
+#define TEMPLATE_TRIP_ID_BASE 100000  // Bus IDs from here on are template trips: base + templateID * 1000 + day offset
+#define TEMPLATE_SEARCH_DAYS 7        // Days ahead a search lists template trips for
+
+// A timetable that repeats on some days of the week between two dates
+struct ScheduleTemplate {
+    int templateID;            // Unique template number (1 to MAX_TEMPLATE_ID)
+    char busNumberPlate[20];   // Bus running the service
+    char source[50];           // Starting location
+    char destination[50];      // Destination location
+    int daysOfWeek;            // Bit 0 is Monday ... bit 6 is Sunday
+    int departureMinute;       // Departure time as minutes after midnight
+    int arrivalMinute;         // Arrival time as minutes after midnight
+    int totalSeats;            // Seats on every trip
+    money_t fare;              // Fare per seat
+    int validFromDay;          // First day the template runs (days since 1970-01-01)
+    int validToDay;            // Last day the template runs
+};
+
+int parseScheduleTemplate(struct StringView line, struct ScheduleTemplate *tpl); // Parse a templates.txt line
+int validateScheduleTemplate(const struct ScheduleTemplate *tpl); // Check IDs, seats, fare and validity range
+int loadScheduleTemplates(struct ScheduleTemplate templates[], int maxTemplates); // Load templates.txt
+int appendScheduleTemplate(const struct ScheduleTemplate *tpl); // Add a template to templates.txt
+int templateRunsOn(const struct ScheduleTemplate *tpl, int epochDay); // Check if a template has a trip that day
+int templateTripID(const struct ScheduleTemplate *tpl, int epochDay); // Stable bus ID of a template trip
+int findTemplateTrip(const struct ScheduleTemplate templates[], int templateCount, int busID, int *epochDay); // Template index of a trip ID, or -1
+
+// --- Bulk Schedule Import (schedule_import.c) ---
+#define MAX_IMPORT_THREADS 8            // Most threads used to parse one import file
+#define IMPORT_MIN_CHUNK_BYTES 65536    // Files smaller than this per thread are parsed on one thread
+#define MAX_IMPORT_ERRORS 10            // Invalid lines listed in detail when an import is rejected
+#define MAX_IMPORT_PATH 256             // Longest file name accepted
+
+// One validated trip from an import file; the text fields point into the file buffer
+struct ImportedTrip {
+    int busID;                         // Unique identifier for the bus
+    struct StringView busNumberPlate;  // Bus number plate
+    struct StringView source;          // Starting location
+    struct StringView destination;     // Destination location
+    int departureDay;                  // Travel date as days since 1970-01-01
+    int departureMinute;               // Departure time as minutes after midnight
+    int arrivalMinute;                 // Arrival time as minutes after midnight
+    int totalSeats;                    // Seats on the trip, all available
+    money_t fare;                      // Fare per seat
+    int lineNumber;                    // Line in the import file, for error messages
+};
+
+// A parsed import file, held in memory until it is merged or discarded
+struct ScheduleImport {
+    char *data;                                  // Whole file contents
+    size_t size;                                 // Bytes in data
+    struct ImportedTrip *trips;                  // Valid trips in file order
+    int tripCount;                               // Number of valid trips
+    int errorCount;                              // Number of invalid lines or duplicate IDs
+    int errorLines[MAX_IMPORT_ERRORS];           // Line numbers of the first errors
+    const char *errorReasons[MAX_IMPORT_ERRORS]; // Why each of those lines was rejected
+};
+
+int loadScheduleImport(const char *filename, struct ScheduleImport *import); // Read and validate a CSV in parallel
+void addImportError(struct ScheduleImport *import, int lineNumber, const char *reason); // Record an invalid line
+void checkImportAgainstExisting(struct ScheduleImport *import, const int existingIDs[], int existingCount); // Reject IDs already in use
+void freeScheduleImport(struct ScheduleImport *import); // Release an import's buffers
+
+// --- Durable Files (durable_file.c) ---
+#define REPLACE_MARKER_FILE "replace.pending" // Lists temp -> final renames while files are being replaced
+#define MAX_DURABLE_GROUP 5                   // Most files committed together
+
+// A file being replaced: written to <path>.tmp, then renamed over <path> when committed
+struct DurableFile {
+    FILE *file;                            // Temp file being written
+    char path[MAX_IMPORT_PATH];            // File being replaced
+    char tempPath[MAX_IMPORT_PATH + 8];    // <path>.tmp
+    int withChecksum;                      // Keep <path>.sum for the startup check
+};
+
+FILE *beginDurableWrite(struct DurableFile *out, const char *path, int withChecksum); // Start replacing a file
+FILE *beginDurableAppend(struct DurableFile *out, const char *path, int withChecksum); // Start replacing a file with a copy to add to
+int commitDurableWrite(struct DurableFile *out); // fsync, rename over the original, fsync the directory
+int commitDurableWrites(struct DurableFile files[], int count); // Commit several files all-or-nothing
+void abortDurableWrite(struct DurableFile *out); // Drop an uncommitted replacement
+void recoverDurableFiles(const char *paths[], int count); // Startup recovery and checksum check
+int syncAndCloseFile(FILE *file); // Flush a file to disk and close it
+int copyFileBytes(FILE *from, FILE *to, long count); // Block copy between files (-1 = to the end)
+int syncDirectory(); // Make renames in the working directory durable
+int replaceFilesTogether(const char *tempFiles[], const char *finalFiles[], int count); // Swap in several files all-or-nothing
+void recoverFileReplacement(); // Finish a file replacement interrupted by a crash
+int durableWriteFailureCount(); // Saves that did not reach the disk since startup
+
+// --- State Snapshot (state_snapshot.c) ---
+#define STATE_SNAPSHOT_FILE "state.snapshot"  // Image of the loaded state, mapped at startup instead of parsing
+#define MAX_SNAPSHOT_SOURCES 4                // Most text files one snapshot is checked against
+#define MAX_SNAPSHOT_SECTIONS 8               // Most arrays kept in one snapshot
+
+// Identity of one version of a file, taken from stat() without reading it
+struct FileFingerprint {
+    long long device;               // Device holding the file
+    long long inode;                // Changes whenever the file is replaced by a rename
+    long long size;                 // Bytes in the file
+    long long modifiedSeconds;      // Last modification time
+    long long modifiedNanoseconds;
+};
+
+// One array in a snapshot: written from memory, or read in place from the mapping
+struct SnapshotSection {
+    const void *data;               // First element
+    int elementSize;                // sizeof one element
+    int count;                      // Number of elements
+};
+
+// A snapshot image mapped into memory
+struct MappedSnapshot {
+    void *base;                                          // Start of the mapping
+    size_t size;                                         // Bytes mapped
+    const struct FileFingerprint *sources;               // Text files the image was taken from
+    int sourceCount;
+    struct SnapshotSection sections[MAX_SNAPSHOT_SECTIONS]; // Pointers into the mapping
+    int sectionCount;
+};
+
+int fingerprintFile(const char *path, struct FileFingerprint *print); // stat() a file into a fingerprint
+int sameFingerprint(const struct FileFingerprint *a, const struct FileFingerprint *b); // Same version of a file?
+int writeSnapshot(const char *path, const struct FileFingerprint sources[], int sourceCount,
+                  const struct SnapshotSection sections[], int sectionCount); // Durably write a snapshot image
+int mapSnapshot(const char *path, struct MappedSnapshot *snapshot); // mmap and verify a snapshot image
+void unmapSnapshot(struct MappedSnapshot *snapshot); // Release a mapped snapshot
+
+// --- Record Indexes (record_index.c) ---
+#define INDEX_USERNAME 'u'     // Criterion on the passenger's username (exact)
+#define INDEX_BUS_ID 'b'       // Criterion on the bus ID (exact)
+#define INDEX_PLATE 'p'        // Criterion on the bus number plate (exact)
+#define INDEX_DATE 'd'         // Criterion on the date (substring; years, months and days are indexed)
+#define MAX_INDEX_KEY 64       // Longest value that is indexed
+#define MAX_INDEX_CRITERIA 4   // One criterion per indexed field
+
+// One filter condition on reservation.txt or cancellations.txt
+struct IndexCriterion {
+    char type;                     // INDEX_USERNAME, INDEX_BUS_ID, INDEX_PLATE or INDEX_DATE
+    char value[MAX_INDEX_KEY];     // Value to look for
+};
+
+struct RecordIndex; // Posting lists of one journal, kept in <journal>.idx
+
+struct RecordIndex *getRecordIndex(const char *journal); // Load, extend or rebuild a journal's index; NULL if unavailable
+int canIndexCriterion(const struct IndexCriterion *criterion); // Check if a criterion is answered exactly by the index
+int queryRecordIndex(struct RecordIndex *index, const struct IndexCriterion criteria[], int criteriaCount, long **offsets); // Offsets of matching lines
+
+// --- Ticket Index (ticket_index.c) ---
+// One reservation, found by its ticket number
+struct TicketEntry {
+    int ticketNumber;              // 6-digit ticket number (the key)
+    int busID;                     // Bus the seats are on
+    long offset;                   // Byte offset of the line in reservation.txt
+    money_t amount;                // Amount paid
+    int firstSeat;                 // Position of the first seat number in the index's seat pool
+    int numSeats;                  // Number of seats booked
+    char date[11];                 // Booking date (YYYY-MM-DD)
+};
+
+// Every reservation by ticket number: packed entries, found through an open-addressing hash table
+struct TicketIndex {
+    struct TicketEntry *entries;   // Packed entries, in no particular order
+    int count;                     // Entries in use
+    int capacity;                  // Entries allocated
+    int *slots;                    // Hash table of entry positions (-1 = empty), a power of two in size
+    int slotCapacity;
+    int *seats;                    // Seat numbers of all entries, end to end
+    int seatCount;
+    int seatCapacity;
+};
+
+const struct TicketEntry *findTicket(const struct TicketIndex *index, int ticketNumber); // Look up a ticket; NULL if unknown
+const int *ticketSeats(const struct TicketIndex *index, const struct TicketEntry *entry); // Seat numbers of an entry
+int addTicket(struct TicketIndex *index, int ticketNumber, int busID, struct StringView date,
+              const int seats[], int numSeats, money_t amount, long offset); // Add a reservation (first one wins)
+int removeTicket(struct TicketIndex *index, int ticketNumber); // Remove a reservation
+void shiftTicketOffsets(struct TicketIndex *index, long after, long delta); // Adjust offsets after a line is removed
+void clearTicketIndex(struct TicketIndex *index); // Empty the index before a rebuild
+int restoreTicketIndex(struct TicketIndex *index, const struct TicketEntry entries[], int count,
+                       const int seats[], int seatCount); // Fill the index from saved arrays
+
+// --- Booking History (booking_history.c) ---
+#define MAX_CACHED_HISTORIES 8      // Users whose booking history is kept in memory
+#define HISTORY_PAGE_SIZE 5         // Bookings shown per page of a user's history
+
+// One user's bookings, as offsets of their lines in reservation.txt
+struct BookingHistory {
+    char username[MAX_INDEX_KEY];      // User the history belongs to
+    long *offsets;                     // Line offsets, oldest booking first
+    int count;                         // Bookings in the history
+    int capacity;                      // Offsets allocated
+    struct FileFingerprint source;     // Version of reservation.txt the offsets point into
+    unsigned long lastUsed;            // Lookup clock at the last use, for evicting the coldest user
+    int valid;                         // Set once loaded
+};
+
+struct BookingHistory *getBookingHistory(const char *username); // Cached history of a user; NULL if unavailable
+void noteBookingAppended(const char *username, long offset, const struct FileFingerprint *before,
+                         const struct FileFingerprint *after); // Keep cached histories current after an append
+void noteBookingRemoved(long offset, long length, const struct FileFingerprint *before,
+                        const struct FileFingerprint *after); // Keep cached histories current after a line is removed
+
+// --- Waitlist (waitlist.c) ---
+#define WAITLIST_FILE "waitlist.txt"  // Waitlist events: joins, promotions and finished holds
+#define WAITLIST_HOLD_MINUTES 30      // How long promoted seats are held for the waiting customer
+#define WAITLIST_NAME_LENGTH 50       // Username length kept for a waiting party
+#define WAITLIST_COMPACT_LINES 100    // Finished lines tolerated before waitlist.txt is rewritten
+#define WAITLIST_FIFO 0               // Freed seats go to the party that joined first among those that fit
+#define WAITLIST_BEST_FIT 1           // Freed seats go to the largest party that fits
+
+// A waiting party that has just been offered seats
+struct WaitlistPromotion {
+    int reference;                         // Waitlist reference number
+    char username[WAITLIST_NAME_LENGTH];   // Customer to notify
+    int partySize;                         // Seats held for them
+    long long holdUntil;                   // When the hold runs out (time() seconds)
+};
+
+int loadWaitlist(); // Replay waitlist.txt; returns the parties still waiting or holding
+int joinWaitlist(int busID, const char *username, int partySize); // Join a trip's waitlist; returns the reference or 0
+int promoteWaitlist(int busID, int availableSeats, int policy, long long now,
+                    struct WaitlistPromotion promoted[], int maxPromoted); // Hold free seats for waiting parties
+int heldSeatsForOthers(int busID, const char *username, long long now); // Seats held for other customers
+int expiredHoldTrips(long long now, int busIDs[], int maxTrips); // Trips whose holds have run out
+int takeHold(int busID, const char *username, int bookedSeats); // Use a customer's hold for the seats they paid for
+int closeWaitlist(int busID); // End the waitlist of a trip that is deleted or purged
+
+// --- Dynamic Pricing (dynamic_pricing.c) ---
+#define PRICING_FILE "pricing.txt"    // Load factor and days-before-departure tiers
+#define MAX_PRICE_TIERS 16            // Tiers per table
+#define NO_PRICED_DAY -1              // pricedDay before the first full repricing
+
+// Price multiplier that applies from a value upwards
+struct PriceTier {
+    int from;                         // Occupancy percent or days before departure
+    int percent;                      // Multiplier applied to the base fare, in percent
+};
+
+// Tier tables of the pricing engine
+struct PricingTiers {
+    struct PriceTier load[MAX_PRICE_TIERS];   // By share of seats sold, ascending
+    int loadCount;
+    struct PriceTier days[MAX_PRICE_TIERS];   // By days left before departure, ascending
+    int dayCount;
+};
+
+// Published per-seat prices, one per bus slot, and the slots waiting to be repriced
+struct PriceTable {
+    money_t *published;               // Prices readers see
+    money_t *buffers[2];              // published and the buffer the next full repricing fills
+    int capacity;                     // Slots in each buffer
+    unsigned char *stale;             // Set for a slot whose price must be recomputed
+    int *staleSlots;                  // Those slots, in the order they changed
+    int staleCount;
+    int pricedDay;                    // Day the last full repricing was for; days to departure move at midnight
+};
+
+int loadPricingTiers(struct PricingTiers *tiers, const char *filename); // Read the tier tables
+void priceTrips(const struct PricingTiers *tiers, const money_t fares[], const int availableSeats[],
+                const int totalSeats[], const int departureDays[], int today, int count, money_t prices[]); // Batch pricing
+int reservePriceTable(struct PriceTable *table, int slots); // Allocate the table
+void markPriceStale(struct PriceTable *table, int slot); // A slot's price must be recomputed
+void invalidatePrices(struct PriceTable *table); // Every slot must be recomputed
+money_t seatPrice(const struct PriceTable *table, int slot); // Published per-seat price of a slot
+money_t *beginRepricing(struct PriceTable *table); // Buffer for a full repricing
+void publishPrices(struct PriceTable *table, money_t *prices, int today); // Swap a full repricing in
+void setSeatPrice(struct PriceTable *table, int slot, money_t price); // Update one published price
+void clearStalePrices(struct PriceTable *table); // Forget the repriced stale slots
+
+// --- Report Paging (report_pager.c) ---
+#define REPORT_PAGE_SIZE 20          // Default rows per page in the reservation/cancellation reports
+#define MAX_REPORT_PAGE_SIZE 1000    // Largest page size that can be chosen
+#define OUTPUT_BUFFER_SIZE 65536     // Exports are written in blocks of about this size
+
+// Growable text buffer that is rendered first and written in one go
+struct OutputBuffer {
+    char *data;          // Rendered text
+    size_t length;       // Bytes used
+    size_t capacity;     // Bytes allocated
+};
+
+int appendOutput(struct OutputBuffer *out, const char *format, ...); // printf into the buffer
+int flushOutput(struct OutputBuffer *out, int fd); // Write the buffer to a file descriptor and empty it
+void freeOutput(struct OutputBuffer *out); // Release the buffer's memory
+void appendRecordHeader(struct OutputBuffer *out, const char *title); // Title and column headers of a record report
+void appendRecordRow(struct OutputBuffer *out, const struct ReservationRecord *record); // One record report row
+int readRecordPage(struct RecordReader *reader, long cursor, int pageSize, struct OutputBuffer *out, long *nextCursor); // Render one page
+int exportRecords(const char *filename, const char *title, const char *exportPath); // Write a whole report to a file
+void browseRecords(const char *filename, const char *title); // Interactive paged report viewer
+
+// --- Occupancy Analytics (occupancy_cube.c) ---
+#define OCCUPANCY_SHORT_WINDOW 7          // Days in the short rolling load factor
+#define OCCUPANCY_LONG_WINDOW 30          // Days in the long rolling load factor
+#define MAX_OCCUPANCY_CELLS 16000000      // Largest cube (series x days) that is built
+#define MAX_ANALYTICS_THREADS 8           // Most threads used to total one journal
+#define ANALYTICS_MIN_CHUNK_BYTES 65536   // Journals smaller than this per thread are read on one thread
+
+// One scheduled trip as the cube sees it
+struct OccupancyTrip {
+    int busID;                        // Bus ID used in the journals
+    string_id busNumberPlate;         // Plate written in the journals beside the bus ID
+    string_id source;                 // Route (interned)
+    string_id destination;
+    int departureDay;                 // Days since 1970-01-01
+    int departureHour;                // 0-23
+    int totalSeats;                   // Seats on the bus
+    int bookedSeats;                  // Seats taken in the seat state
+};
+
+// A route and departure hour: the first axis of the cube
+struct OccupancySeries {
+    string_id source;                 // Interned, so series are told apart by ID
+    string_id destination;
+    int hour;
+};
+
+// Totals of one series on one day
+struct OccupancyCell {
+    int trips;                        // Trips scheduled
+    int seats;                        // Seats on those trips
+    int booked;                       // Seats taken (seat state)
+    int sold;                         // Seats in current reservations (reservation.txt)
+    int cancelled;                    // Seats cancelled (cancellations.txt)
+    money_t revenue;                  // Paid for the current reservations
+    money_t refunded;                 // Refunded for the cancellations
+};
+
+// Dense cube of cells indexed by series ID and epoch day
+struct OccupancyCube {
+    struct OccupancySeries *series;   // Interned routes and departure hours
+    int seriesCount;
+    int firstDay;                     // Epoch day of the first column
+    int dayCount;                     // Days from the first to the last trip
+    struct OccupancyCell *cells;      // seriesCount x dayCount, the days of one series together
+    long long *bookedPrefix;          // Running booked seats along each series' days, for rolling windows
+    long long *seatPrefix;            // Running seats along each series' days
+    int unplacedSold;                 // Seats in journal rows whose trip is not on record
+    int unplacedCancelled;
+};
+
+int buildOccupancyCube(struct OccupancyCube *cube, const struct OccupancyTrip trips[], int tripCount,
+                       const char *reservationFile, const char *cancellationFile); // Aggregate the seat state and journals
+void freeOccupancyCube(struct OccupancyCube *cube); // Release the cube
+struct OccupancyCell *occupancyCell(const struct OccupancyCube *cube, int series, int epochDay); // Cell of a series on a day
+int rollingLoadPercent(const struct OccupancyCube *cube, int series, int epochDay, int window); // Load factor over a window ending on a day
+void appendOccupancyReport(struct OutputBuffer *out, const struct OccupancyCube *cube); // Render the cube as a table
+
+// --- Reservation Archive (reservation_archive.c) ---
+#define ARCHIVE_MANIFEST_FILE "archive.txt"  // One line per archived partition, with its zone map
+#define ARCHIVE_BLOCK_ROWS 4096              // Rows per block; each block has its own zone map
+#define ARCHIVE_NAME_LENGTH 255              // Longest username or plate kept in a dictionary
+
+// Row count and value ranges of a partition or a block, used to skip it without decoding
+struct ArchiveZone {
+    int rows;
+    int minBusID, maxBusID;
+    int minDay, maxDay;               // Booking dates, days since 1970-01-01
+};
+
+// One archived partition: the rows of one journal whose trips left in one month
+struct ArchivePartition {
+    char journal[32];                 // reservation.txt or cancellations.txt
+    char month[8];                    // Travel month, YYYY-MM
+    struct ArchiveZone zone;
+};
+
+// What a scan can be narrowed to; partitions and blocks outside it are not read
+struct ArchivePredicate {
+    int minBusID, maxBusID;
+    int minDay, maxDay;
+    char username[MAX_INDEX_KEY];     // Exact username, or empty for any
+    char plate[MAX_INDEX_KEY];        // Exact plate, or empty for any
+};
+
+struct ArchivePartitionReader; // Open partition file and its decoded block (reservation_archive.c)
+
+// Cursor over the archived rows of one journal, oldest travel month first
+struct ArchiveScan {
+    struct ArchivePredicate predicate;
+    struct ArchivePartition *partitions;      // Partitions of the journal from the manifest
+    int partitionCount;
+    int nextPartition;                        // Next partition to open
+    struct ArchivePartitionReader *reader;    // Partition being read, or NULL
+    char dateText[11];                        // Text of the current row's date
+    char seatText[MAX_SEATS * 4];             // Text of the current row's seat list
+    int partitionsRead, partitionsSkipped;    // Pruning statistics
+    int blocksRead, blocksSkipped;
+};
+
+int loadArchiveManifest(struct ArchivePartition **partitions); // Read the manifest; returns the partition count
+void archivePredicateFromCriteria(struct ArchivePredicate *predicate, const struct IndexCriterion criteria[], int count); // Ranges implied by filter criteria
+int openArchiveScan(struct ArchiveScan *scan, const char *journal, const struct ArchivePredicate *predicate); // Start a scan; NULL matches everything
+int nextArchiveRecord(struct ArchiveScan *scan, struct ReservationRecord *record); // Next row that may match; valid until the next call
+void closeArchiveScan(struct ArchiveScan *scan); // Release the scan
+int archiveTravelMonths(const char *journals[], int journalCount, const int scheduledIDs[], int scheduledCount,
+                        int today, int *partitionCount); // Move rows of trips that left in earlier months into the archive
+int countArchivedRows(const char *journal); // Rows of a journal that are only in the archive
+int loadArchivedBookings(const char *username, struct ReservationRecord **records); // A user's archived bookings, in the request arena
+int archivedTicketExists(int ticketNumber); // Does an archived reservation use this ticket number?
+int findArchivedTicket(int ticketNumber, struct ReservationRecord *record); // Archived reservation by ticket, in the request arena
+
+// --- Terminal Rendering (terminal_render.c, print_header.c) ---
+#define SEATS_PER_ROW 4              // Number of seats per row in a bus
+
+struct OutputBuffer *beginFrame(); // Start building one screen of output
+void emitFrame(); // Write the frame built so far to the terminal in one write
+void appendSeatMap(struct OutputBuffer *out, int totalSeats, const int reservedSeats[], int reservedCount); // Colored seat map from a cached layout
+void appendBusHeader(struct OutputBuffer *out); // Column headers of a bus table
+void appendBusTableEnd(struct OutputBuffer *out); // Closing line of a bus table
 
 #endif // BUS_RESERVATION_H